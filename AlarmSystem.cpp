@@ -4,7 +4,9 @@
 #include "AlarmSystem.h"
 #include "PinsConfig.h"
 #include "WiFiConfig.h"
-#include "TelegramHandler.h"
+#include "EventBus.h"
+#include "ConfigStore.h"
+#include "DeferredLog.h"
 
 // Initialize static member variables
 AlarmSystemStatus AlarmSystem::_systemStatus = AlarmSystemStatus::NORMAL;
@@ -18,16 +20,24 @@ bool AlarmSystem::_sensorStates[TOTAL_APARTMENTS] = {false};
 bool AlarmSystem::_enabledApartments[TOTAL_APARTMENTS] = {false};
 bool AlarmSystem::_alarmActive[2] = {false, false}; // [RIGHT_SIDE, LEFT_SIDE]
 uint32_t AlarmSystem::_alarmStartTime[2] = {0, 0};
+uint32_t AlarmSystem::_alarmRunDuration[2] = {ALARM_DURATION, ALARM_DURATION};
 bool AlarmSystem::_alarmState[2] = {false, false};
 uint32_t AlarmSystem::_lastAlarmToggle[2] = {0, 0};
+AlarmSystemStats AlarmSystem::_stats = {};
 const char *AlarmSystem::PREFERENCE_NAMESPACE = "alarm_sys"; // Namespace for Preferences
-Preferences AlarmSystem::_prefs;                             // Preferences object for storing state
 
 // Configuration settings with default values
 uint32_t AlarmSystem::_alarmDuration = ALARM_DURATION;
 uint32_t AlarmSystem::_alarmInterval = ALARM_INTERVAL;
 uint32_t AlarmSystem::_sensorSettlingTime = VCC_SETTLING_TIME;
 
+// Alarm profiles, "Standard" uses the compile-time defaults
+AlarmProfile AlarmSystem::_profiles[MAX_ALARM_PROFILES] = {{"Standard", ALARM_DURATION, ALARM_INTERVAL, VCC_SETTLING_TIME}};
+uint8_t AlarmSystem::_profileCount = 1;
+uint8_t AlarmSystem::_activeProfile = 0;
+uint32_t AlarmSystem::_timerInterval[2] = {ALARM_INTERVAL, ALARM_INTERVAL};
+volatile bool AlarmSystem::_cycleStarted[2] = {false, false};
+
 // Add near the top of AlarmSystem.cpp with other static declarations
 hw_timer_t *AlarmSystem::_rightSideTimer = NULL;
 hw_timer_t *AlarmSystem::_leftSideTimer = NULL;
@@ -49,19 +59,21 @@ bool AlarmSystem::begin()
     initializeSensorStates();
 
     // Load the enabled apartments (if existed) in initialization
-    loadApartmentsState();
+    loadConfiguration();
 
     // Set up timer for right side
     _rightSideTimer = timerBegin(1000000); // Timer with 1MHz resolution
     timerAttachInterrupt(_rightSideTimer, &AlarmSystem::rightSideTimerISR);
     timerAlarm(_rightSideTimer, _alarmInterval * 1000, true, 0); // Auto reload, unlimited
     timerStop(_rightSideTimer);                                  // Keep it stopped until alarm is activated
+    _timerInterval[RIGHT_SIDE] = _alarmInterval;
 
     // Set up timer for left side
     _leftSideTimer = timerBegin(1000000); // Timer with 1MHz resolution
     timerAttachInterrupt(_leftSideTimer, &AlarmSystem::leftSideTimerISR);
     timerAlarm(_leftSideTimer, _alarmInterval * 1000, true, 0); // Auto reload, unlimited
     timerStop(_leftSideTimer);                                  // Keep it stopped until alarm is activated
+    _timerInterval[LEFT_SIDE] = _alarmInterval;
 
     // Record system startup time
     _startupTime = millis();
@@ -73,35 +85,35 @@ bool AlarmSystem::begin()
     // Check for wire cuts at startup
     checkWireCutsAtStartup();
 
-    // Handle startup wire cut notifications
+    // Report startup wire cuts, the subscribers get them once loop() runs
     if (!_wireCutStatus.rightSideRightBoxEnabled)
     {
-        telegramHandler.sendStartupWireCutAlert(RIGHT_SIDE, RIGHT_BOX);
+        EventBus::publish(BusEventType::STARTUP_WIRE_CUT, 0, RIGHT_SIDE, RIGHT_BOX);
         Serial.println("Startup Wire cut detected on right side, right box.");
     }
     if (!_wireCutStatus.rightSideLeftBoxEnabled)
     {
-        telegramHandler.sendStartupWireCutAlert(RIGHT_SIDE, LEFT_BOX);
+        EventBus::publish(BusEventType::STARTUP_WIRE_CUT, 0, RIGHT_SIDE, LEFT_BOX);
         Serial.println("Startup Wire cut detected on right side, left box.");
     }
     if (!_wireCutStatus.leftSideRightBoxEnabled)
     {
-        telegramHandler.sendStartupWireCutAlert(LEFT_SIDE, RIGHT_BOX);
+        EventBus::publish(BusEventType::STARTUP_WIRE_CUT, 0, LEFT_SIDE, RIGHT_BOX);
         Serial.println("Startup Wire cut detected on left side, right box.");
     }
     if (!_wireCutStatus.leftSideLeftBoxEnabled)
     {
-        telegramHandler.sendStartupWireCutAlert(LEFT_SIDE, LEFT_BOX);
+        EventBus::publish(BusEventType::STARTUP_WIRE_CUT, 0, LEFT_SIDE, LEFT_BOX);
         Serial.println("Startup Wire cut detected on left side, left box.");
     }
     if (!_wireCutStatus.rightSideDistributionEnabled)
     {
-        telegramHandler.sendStartupDistributionWireCutAlert(RIGHT_SIDE);
+        EventBus::publish(BusEventType::STARTUP_DISTRIBUTION_WIRE_CUT, 0, RIGHT_SIDE);
         Serial.println("Startup Wire cut detected on right side, distribution box.");
     }
     if (!_wireCutStatus.leftSideDistributionEnabled)
     {
-        telegramHandler.sendStartupDistributionWireCutAlert(LEFT_SIDE);
+        EventBus::publish(BusEventType::STARTUP_DISTRIBUTION_WIRE_CUT, 0, LEFT_SIDE);
         Serial.println("Startup Wire cut detected on left side, distribution box.");
     }
 
@@ -134,6 +146,7 @@ void AlarmSystem::update()
 
     // Update alarms (toggle on/off based on interval)
     updateAlarms();
+    applyAlarmInterval();
 
     // Check wire cuts for both sides and boxes
     checkWireCuts();
@@ -169,8 +182,7 @@ bool AlarmSystem::enableSensor(uint8_t apartmentNumber)
     }
 
     _enabledApartments[index] = true;
-    // Save state for this specific apartment
-    saveApartmentState(index);
+    ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveConfiguration);
     return true;
 }
 
@@ -190,8 +202,7 @@ bool AlarmSystem::disableSensor(uint8_t apartmentNumber)
     }
 
     _enabledApartments[index] = false;
-    // Save state for this specific apartment
-    saveApartmentState(index);
+    ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveConfiguration);
     return true;
 }
 
@@ -238,12 +249,15 @@ void AlarmSystem::activateAlarm(BuildingSide side)
 
     if (!_alarmActive[sideIndex])
     {
+        // The timer is stopped, so a changed interval can be programmed right away
+        applyAlarmInterval();
         _alarmActive[sideIndex] = true;
         _alarmStartTime[sideIndex] = millis();
+        _alarmRunDuration[sideIndex] = _alarmDuration;
         _alarmState[sideIndex] = true;
 
         // Initially turn on the siren
-        Serial.println("Siren activated on side: " + String(sideIndex ? "Left" : "Right"));
+        DLOG_INFO("Siren activated on side: %s", sideIndex ? "Left" : "Right");
         activateSiren(side);
 
         // Start the corresponding timer
@@ -259,6 +273,7 @@ void AlarmSystem::activateAlarm(BuildingSide side)
         }
 
         _lastAlarmTime = millis();
+        EventBus::publish(BusEventType::SIREN_ON, 0, side);
     }
 }
 
@@ -277,7 +292,7 @@ void AlarmSystem::stopAlarm(BuildingSide side)
         _alarmState[sideIndex] = false;
 
         // Turn off the siren
-        Serial.println("Siren deactivated on side: " + String(sideIndex ? "Left" : "Right"));
+        DLOG_INFO("Siren deactivated on side: %s", sideIndex ? "Left" : "Right");
         stopSiren(side);
 
         // Stop the corresponding timer
@@ -289,6 +304,7 @@ void AlarmSystem::stopAlarm(BuildingSide side)
         {
             timerStop(_leftSideTimer);
         }
+        EventBus::publish(BusEventType::SIREN_OFF, 0, side);
     }
 }
 
@@ -436,22 +452,121 @@ WireCutStatus AlarmSystem::getWireCutStatus()
     return _wireCutStatus;
 }
 
-void AlarmSystem::setAlarmDuration(uint32_t duration)
+bool AlarmSystem::setAlarmDuration(uint32_t duration)
 {
-    _alarmDuration = duration;
+    AlarmProfile profile = _profiles[_activeProfile];
+    profile.duration = duration;
+    return saveAlarmProfile(_activeProfile, profile);
 }
 
-void AlarmSystem::setAlarmInterval(uint32_t interval)
+bool AlarmSystem::setAlarmInterval(uint32_t interval)
 {
-    _alarmInterval = interval;
-    // Update the timers with the new interval
-    timerAlarm(_rightSideTimer, _alarmInterval * 1000, true, 0); // Auto reload, unlimited
-    timerAlarm(_leftSideTimer, _alarmInterval * 1000, true, 0);  // Auto reload, unlimited
+    AlarmProfile profile = _profiles[_activeProfile];
+    profile.interval = min(interval, (uint32_t)UINT16_MAX);
+    return saveAlarmProfile(_activeProfile, profile);
+}
+
+bool AlarmSystem::setSensorSettlingTime(uint32_t time)
+{
+    AlarmProfile profile = _profiles[_activeProfile];
+    profile.settlingTime = min(time, (uint32_t)UINT16_MAX);
+    return saveAlarmProfile(_activeProfile, profile);
+}
+
+// Alarm Profiles
+bool AlarmSystem::saveAlarmProfile(uint8_t index, const AlarmProfile &profile)
+{
+    if (index > _profileCount || index >= MAX_ALARM_PROFILES)
+    {
+        setError("No room for another alarm profile");
+        return false;
+    }
+    if (!validateAlarmProfile(profile))
+    {
+        return false;
+    }
+
+    _profiles[index] = profile;
+    _profiles[index].name[ALARM_PROFILE_NAME_SIZE - 1] = '\0';
+    if (index == _profileCount)
+    {
+        _profileCount++;
+    }
+
+    if (index == _activeProfile)
+    {
+        applyActiveProfile();
+    }
+    ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveConfiguration);
+    return true;
 }
 
-void AlarmSystem::setSensorSettlingTime(uint32_t time)
+bool AlarmSystem::deleteAlarmProfile(uint8_t index)
 {
-    _sensorSettlingTime = time;
+    if (index >= _profileCount)
+    {
+        setError("Invalid alarm profile");
+        return false;
+    }
+    if (index == _activeProfile)
+    {
+        setError("The active alarm profile cannot be deleted");
+        return false;
+    }
+
+    for (uint8_t i = index; i + 1 < _profileCount; i++)
+    {
+        _profiles[i] = _profiles[i + 1];
+    }
+    _profileCount--;
+    if (_activeProfile > index)
+    {
+        _activeProfile--;
+    }
+
+    ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveConfiguration);
+    return true;
+}
+
+bool AlarmSystem::selectAlarmProfile(uint8_t index)
+{
+    if (index >= _profileCount)
+    {
+        setError("Invalid alarm profile");
+        return false;
+    }
+
+    _activeProfile = index;
+    applyActiveProfile();
+    ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveConfiguration);
+    Serial.printf("Alarm profile \"%s\" selected\n", _profiles[index].name);
+    return true;
+}
+
+uint8_t AlarmSystem::getAlarmProfileCount()
+{
+    return _profileCount;
+}
+
+bool AlarmSystem::getAlarmProfile(uint8_t index, AlarmProfile &profile)
+{
+    if (index >= _profileCount)
+    {
+        return false;
+    }
+
+    profile = _profiles[index];
+    return true;
+}
+
+uint8_t AlarmSystem::getActiveAlarmProfile()
+{
+    return _activeProfile;
+}
+
+bool AlarmSystem::isAlarmTimingPending()
+{
+    return _timerInterval[RIGHT_SIDE] != _alarmInterval || _timerInterval[LEFT_SIDE] != _alarmInterval;
 }
 
 void AlarmSystem::enableAllSensors()
@@ -560,6 +675,11 @@ uint8_t AlarmSystem::getActiveAlarmCount()
     return (_alarmActive[0] ? 1 : 0) + (_alarmActive[1] ? 1 : 0);
 }
 
+AlarmSystemStats AlarmSystem::getStats()
+{
+    return _stats;
+}
+
 // ===== PRIVATE METHODS =====
 
 void AlarmSystem::initializeSensorStates()
@@ -589,9 +709,12 @@ void AlarmSystem::checkSensors()
         // Record start time
         sideStartTime = millis();
         sideInitialized = true;
+        return;
+    }
 
-        // Wait for sensors to stabilize before first reading
-        delay(_sensorSettlingTime);
+    // Let the sensors stabilize before the first reading, without holding up the loop
+    if (millis() - sideStartTime < _sensorSettlingTime)
+    {
         return;
     }
 
@@ -612,11 +735,12 @@ void AlarmSystem::checkSensors()
             }
 
             // Read the sensor
+            _stats.sensorReads[currentSide]++;
             if (readSensor(apartment) && !_sensorStates[index])
             {
                 _sensorStates[index] = true;
-                Serial.println("Sensor triggered for apartment: " + String(apartment) +
-                               " on side: " + String(currentSide));
+                _stats.triggers[apartment - 1]++;
+                DLOG_INFO("Sensor triggered for apartment: %u on side: %u", apartment, currentSide);
                 // Handle theft detection
                 handleTheftDetection(apartment);
             }
@@ -625,6 +749,7 @@ void AlarmSystem::checkSensors()
     else
     {
         // 500ms window completed, switch to other side
+        _stats.sideScans[currentSide]++;
         currentSide = (currentSide == RIGHT_SIDE) ? LEFT_SIDE : RIGHT_SIDE;
         sideInitialized = false; // Reset for next side
 
@@ -693,7 +818,7 @@ void AlarmSystem::updateAlarms()
         uint32_t alarmElapsed = millis() - _alarmStartTime[0];
 
         // Check if alarm duration has expired
-        if (alarmElapsed >= _alarmDuration)
+        if (alarmElapsed >= _alarmRunDuration[0])
         {
             stopAlarm(RIGHT_SIDE);
         }
@@ -705,7 +830,7 @@ void AlarmSystem::updateAlarms()
         uint32_t alarmElapsed = millis() - _alarmStartTime[1];
 
         // Check if alarm duration has expired
-        if (alarmElapsed >= _alarmDuration)
+        if (alarmElapsed >= _alarmRunDuration[1])
         {
             stopAlarm(LEFT_SIDE);
         }
@@ -719,11 +844,9 @@ void AlarmSystem::handleTheftDetection(uint8_t apartmentNumber)
         return;
     }
 
-    // Send Telegram notifications
-    telegramHandler.sendTheftAlertsToAll(apartmentNumber);
-
     // Activate the alarm on the side where theft was detected
     BuildingSide side = getApartmentSide(apartmentNumber);
+    EventBus::publish(BusEventType::THEFT, apartmentNumber, side, getApartmentBox(apartmentNumber));
     activateAlarm(side);
 
     // Update system status
@@ -732,11 +855,13 @@ void AlarmSystem::handleTheftDetection(uint8_t apartmentNumber)
 
 void AlarmSystem::handleWireCutDetection(BuildingSide side, BoxPosition box)
 {
+    _stats.wireCuts++;
+
     // Activate the alarm on the affected side
     activateAlarm(side);
 
-    // Send notifications
-    telegramHandler.sendWireCutAlert(side, box);
+    // Report the cut
+    EventBus::publish(BusEventType::WIRE_CUT, 0, side, box);
 
     // Update system status
     _systemStatus = AlarmSystemStatus::WIRE_CUT_DETECTED;
@@ -744,8 +869,10 @@ void AlarmSystem::handleWireCutDetection(BuildingSide side, BoxPosition box)
 
 void AlarmSystem::handleDistributionWireCutDetection(BuildingSide side)
 {
-    // Send notifications
-    telegramHandler.sendDistributionWireCutAlert(side);
+    _stats.wireCuts++;
+
+    // Report the cut
+    EventBus::publish(BusEventType::DISTRIBUTION_WIRE_CUT, 0, side);
 
     // Activate the alarm on the affected side
     activateAlarm(side);
@@ -785,6 +912,7 @@ void AlarmSystem::toggleAlarm(BuildingSide side)
     {
         stopSiren(side);
     }
+    _cycleStarted[sideIndex] = _alarmState[sideIndex]; // Safe point to change the interval
 }
 
 bool AlarmSystem::shouldToggleAlarm(BuildingSide side)
@@ -816,6 +944,76 @@ bool AlarmSystem::isValidBox(BoxPosition box)
     return (box == RIGHT_BOX || box == LEFT_BOX);
 }
 
+bool AlarmSystem::validateAlarmProfile(const AlarmProfile &profile)
+{
+    if (profile.name[0] == '\0')
+    {
+        setError("Alarm profile name is required");
+        return false;
+    }
+    if (profile.duration < ALARM_DURATION_MIN || profile.duration > ALARM_DURATION_MAX)
+    {
+        setError("Alarm duration must be between " + String(ALARM_DURATION_MIN) + " and " + String(ALARM_DURATION_MAX) + " ms");
+        return false;
+    }
+    if (profile.interval < ALARM_INTERVAL_MIN || profile.interval > ALARM_INTERVAL_MAX)
+    {
+        setError("Alarm interval must be between " + String(ALARM_INTERVAL_MIN) + " and " + String(ALARM_INTERVAL_MAX) + " ms");
+        return false;
+    }
+    if (profile.settlingTime < SETTLING_TIME_MIN || profile.settlingTime > SETTLING_TIME_MAX)
+    {
+        setError("Sensor settling time must be between " + String(SETTLING_TIME_MIN) + " and " + String(SETTLING_TIME_MAX) + " ms");
+        return false;
+    }
+    return true;
+}
+
+void AlarmSystem::applyActiveProfile()
+{
+    const AlarmProfile &profile = _profiles[_activeProfile];
+    _alarmDuration = profile.duration;
+    _alarmInterval = profile.interval;
+    _sensorSettlingTime = profile.settlingTime;
+
+    // Only an ON phase that starts after this change may carry the new interval
+    _cycleStarted[RIGHT_SIDE] = false;
+    _cycleStarted[LEFT_SIDE] = false;
+}
+
+void AlarmSystem::applyAlarmInterval()
+{
+    for (uint8_t sideIndex = 0; sideIndex < 2; sideIndex++)
+    {
+        if (_timerInterval[sideIndex] == _alarmInterval)
+        {
+            continue;
+        }
+
+        // A running siren switches right after it turned on, so no phase is cut short
+        if (_alarmActive[sideIndex] && !_cycleStarted[sideIndex])
+        {
+            continue;
+        }
+
+        hw_timer_t *timer = (sideIndex == RIGHT_SIDE) ? _rightSideTimer : _leftSideTimer;
+        if (timer == NULL)
+        {
+            continue; // Not started yet, begin() programs the timers
+        }
+
+        timerStop(timer);
+        timerAlarm(timer, _alarmInterval * 1000, true, 0); // Auto reload, unlimited
+        if (_alarmActive[sideIndex])
+        {
+            timerWrite(timer, 0);
+            timerStart(timer);
+        }
+        _timerInterval[sideIndex] = _alarmInterval;
+        _cycleStarted[sideIndex] = false;
+    }
+}
+
 bool AlarmSystem::readSensor(uint8_t apartmentNumber)
 {
     if (!isValidApartment(apartmentNumber))
@@ -889,69 +1087,85 @@ void AlarmSystem::updateSystemStatus()
     }
 }
 
-void AlarmSystem::saveApartmentState(uint8_t apartmentIndex)
+bool AlarmSystem::saveConfiguration()
 {
-    // Begin Preferences with namespace
-    // Close any existing Preferences instance
-    _prefs.end();
+    StoredConfig config;
+    memset(&config, 0, sizeof(config));
 
-    // Try to begin new Preferences session
-    if (!_prefs.begin(PREFERENCE_NAMESPACE, false))
+    // Pack the enabled flags into bits
+    for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
     {
-        setError("Failed to begin Preferences");
-        return;
+        if (_enabledApartments[i])
+        {
+            config.enabledApartments[i / 8] |= (1 << (i % 8));
+        }
     }
 
-    // Calculate which byte contains our apartment's bit
-    uint8_t byteIndex = apartmentIndex / 8;
-    uint8_t bitPosition = apartmentIndex % 8;
-
-    // Read the current byte
-    uint8_t states[(TOTAL_APARTMENTS + 7) / 8] = {0};
-    _prefs.getBytes("apt_states", states, sizeof(states));
+    memcpy(config.profiles, _profiles, sizeof(config.profiles));
+    config.profileCount = _profileCount;
+    config.activeProfile = _activeProfile;
 
-    // Update the specific bit for this apartment
-    if (_enabledApartments[apartmentIndex])
+    if (!ConfigStore::save(PREFERENCE_NAMESPACE, CONFIG_VERSION, &config, sizeof(config)))
     {
-        states[byteIndex] |= (1 << bitPosition); // Set bit
-    }
-    else
-    {
-        states[byteIndex] &= ~(1 << bitPosition); // Clear bit
+        setError(ConfigStore::getLastError());
+        return false;
     }
-
-    // Save the updated states back to Preferences
-    _prefs.putBytes("apt_states", states, sizeof(states));
-
-    // Close Preferences
-    _prefs.end();
+    return true;
 }
 
-void AlarmSystem::loadApartmentsState()
+void AlarmSystem::loadConfiguration()
 {
-    // Begin Preferences with namespace
-    if (!_prefs.begin(PREFERENCE_NAMESPACE, true))
-    { // true for readonly
-        setError("Failed to begin Preferences");
-        return;
-    }
-
-    // Calculate size needed for storing all apartments
-    size_t stateSize = (TOTAL_APARTMENTS + 7) / 8;
-    uint8_t states[stateSize];
+    StoredConfig config;
+    memset(&config, 0, sizeof(config));
 
-    // Read the states from Preferences
-    if (_prefs.getBytes("apt_states", states, stateSize))
+    ConfigLoadResult result = ConfigStore::load(PREFERENCE_NAMESPACE, CONFIG_VERSION, &config, sizeof(config));
+    bool migrated = false;
+    if (result == ConfigLoadResult::MISSING)
     {
-        // Unpack the bits into boolean array
-        for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
+        // Older firmware kept only the packed bits under their own key
+        Preferences prefs;
+        if (prefs.begin(PREFERENCE_NAMESPACE, true))
         {
-            _enabledApartments[i] = (states[i / 8] & (1 << (i % 8))) != 0;
+            if (prefs.isKey("apt_states"))
+            {
+                migrated = prefs.getBytes("apt_states", config.enabledApartments, sizeof(config.enabledApartments)) > 0;
+            }
+            prefs.end();
         }
     }
+    else if (result == ConfigLoadResult::CORRUPT)
+    {
+        setError(ConfigStore::getLastError());
+    }
+
+    // Unpack the bits into boolean array
+    for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
+    {
+        _enabledApartments[i] = (config.enabledApartments[i / 8] & (1 << (i % 8))) != 0;
+    }
+
+    // Version 1 blobs have no profiles, keep the defaults for those and for invalid data
+    bool profilesValid = config.profileCount > 0 && config.profileCount <= MAX_ALARM_PROFILES &&
+                         config.activeProfile < config.profileCount;
+    for (uint8_t i = 0; profilesValid && i < config.profileCount; i++)
+    {
+        config.profiles[i].name[ALARM_PROFILE_NAME_SIZE - 1] = '\0';
+        profilesValid = validateAlarmProfile(config.profiles[i]);
+    }
+    if (profilesValid)
+    {
+        memcpy(_profiles, config.profiles, sizeof(_profiles));
+        _profileCount = config.profileCount;
+        _activeProfile = config.activeProfile;
+    }
+    else if (result == ConfigLoadResult::LOADED)
+    {
+        Serial.println("Stored alarm profiles are invalid, using defaults");
+    }
+    applyActiveProfile();
 
-    // Close Preferences
-    _prefs.end();
+    const char *legacyKeys[] = {"apt_states"};
+    ConfigStore::finishLoad(PREFERENCE_NAMESPACE, result, migrated, saveConfiguration, legacyKeys, 1);
 }
 
 void ARDUINO_ISR_ATTR AlarmSystem::rightSideTimerISR()
@@ -5,9 +5,28 @@
 #include "PinsConfig.h"
 #include <Preferences.h>
 #include "WiFiConfig.h"
-#include "TelegramHandler.h"
+#include "ApartmentGrouping.h"
 #include "esp32-hal-timer.h"
 
+// Alarm Profile Constants
+#define MAX_ALARM_PROFILES 4
+#define ALARM_PROFILE_NAME_SIZE 16
+#define ALARM_DURATION_MIN 5000       // Bounds for a profile's siren duration (ms)
+#define ALARM_DURATION_MAX 60000
+#define ALARM_INTERVAL_MIN 500        // Bounds for a profile's siren on/off phase (ms)
+#define ALARM_INTERVAL_MAX 5000
+#define SETTLING_TIME_MIN 50          // Bounds for a profile's sensor settling time (ms)
+#define SETTLING_TIME_MAX 500
+
+// Named set of alarm timings, selectable from the web portal
+struct AlarmProfile
+{
+    char name[ALARM_PROFILE_NAME_SIZE];
+    uint32_t duration;     // How long the siren runs per alarm (ms)
+    uint16_t interval;     // Length of each siren ON and OFF phase (ms)
+    uint16_t settlingTime; // Sensor settling time after powering a side (ms)
+} __attribute__((packed));
+
 // Alarm System Status Flags
 enum class AlarmSystemStatus
 {
@@ -38,6 +57,15 @@ struct WireCutStatus
     bool leftSideDistributionEnabled : 1;
 };
 
+// Sensor scan counters since boot, exported on /metrics
+struct AlarmSystemStats
+{
+    uint32_t sideScans[2];                 // Completed scan windows, indexed by BuildingSide
+    uint32_t sensorReads[2];
+    uint32_t triggers[TOTAL_APARTMENTS];   // Index 0 is apartment 1
+    uint32_t wireCuts;                     // Box and distribution wire cuts detected
+};
+
 class AlarmSystem
 {
 public:
@@ -68,16 +96,27 @@ public:
     static void resetDistributionWireCutStatus(BuildingSide side);
     static WireCutStatus getWireCutStatus();
 
-    // System Configuration
-    static void setAlarmDuration(uint32_t duration);
-    static void setAlarmInterval(uint32_t interval);
-    static void setSensorSettlingTime(uint32_t time);
+    // System Configuration (the setters change the active profile)
+    static bool setAlarmDuration(uint32_t duration);
+    static bool setAlarmInterval(uint32_t interval);
+    static bool setSensorSettlingTime(uint32_t time);
     static void enableAllSensors();
     static void disableAllSensors();
     static void checkSensors();
     static bool readSensor(uint8_t apartmentNumber);
     static void powerSide(BuildingSide side, bool enable);
 
+    // Alarm Profiles
+    // Changes to the active profile apply to a running siren at its next OFF-to-ON
+    // switch, and the new duration from the next alarm on
+    static bool saveAlarmProfile(uint8_t index, const AlarmProfile &profile); // index == count adds a profile
+    static bool deleteAlarmProfile(uint8_t index);
+    static bool selectAlarmProfile(uint8_t index);
+    static uint8_t getAlarmProfileCount();
+    static bool getAlarmProfile(uint8_t index, AlarmProfile &profile);
+    static uint8_t getActiveAlarmProfile();
+    static bool isAlarmTimingPending(); // A running siren still uses the previous interval
+
     // Diagnostic Functions
     static bool performSystemCheck();
     static String getSystemStatus();
@@ -85,6 +124,7 @@ public:
     static uint32_t getUptime();
     static uint32_t getLastAlarmTime();
     static uint8_t getActiveAlarmCount();
+    static AlarmSystemStats getStats();
 
 private:
     // Private member variables
@@ -99,20 +139,39 @@ private:
     static bool _enabledApartments[TOTAL_APARTMENTS];
     static bool _alarmActive[2]; // [RIGHT_SIDE, LEFT_SIDE]
     static uint32_t _alarmStartTime[2];
+    static uint32_t _alarmRunDuration[2]; // Duration in effect when the alarm started
     static bool _alarmState[2];
     static uint32_t _lastAlarmToggle[2];
-    static Preferences _prefs;
+    static AlarmSystemStats _stats;
     static const char *PREFERENCE_NAMESPACE; // Namespace for Preferences
 
+    // Enabled apartments and the alarm timing profiles
+    struct StoredConfig
+    {
+        uint8_t enabledApartments[(TOTAL_APARTMENTS + 7) / 8]; // Bit N = apartment index N
+        // Version 2
+        AlarmProfile profiles[MAX_ALARM_PROFILES];
+        uint8_t profileCount;
+        uint8_t activeProfile;
+    } __attribute__((packed));
+    static const uint16_t CONFIG_VERSION = 2;
+
     static hw_timer_t *_rightSideTimer;
     static hw_timer_t *_leftSideTimer;
     static portMUX_TYPE _timerMux;
 
-    // Configuration settings
+    // Configuration settings (from the active profile)
     static uint32_t _alarmDuration;
     static uint32_t _alarmInterval;
     static uint32_t _sensorSettlingTime;
 
+    // Alarm profiles
+    static AlarmProfile _profiles[MAX_ALARM_PROFILES];
+    static uint8_t _profileCount;
+    static uint8_t _activeProfile;
+    static uint32_t _timerInterval[2];     // Interval each side's timer is programmed with
+    static volatile bool _cycleStarted[2]; // Set by the timer ISR when a siren ON phase begins
+
     // Private helper methods
     static void initializeSensorStates();
     // static void checkSensors();
@@ -132,6 +191,11 @@ private:
     static bool isValidApartment(uint8_t apartmentNumber);
     static bool isValidSide(BuildingSide side);
     static bool isValidBox(BoxPosition box);
+    static bool validateAlarmProfile(const AlarmProfile &profile);
+
+    // Alarm profile helpers
+    static void applyActiveProfile();
+    static void applyAlarmInterval(); // Reprograms the siren timers at a safe point
 
 
     // Error handling
@@ -140,8 +204,8 @@ private:
 
     // System state management
     static void updateSystemStatus();
-    static void saveApartmentState(uint8_t apartmentIndex); // Save the current state of enabled apartments to EEPROM
-    static void loadApartmentsState();                      // Load the enabled apartments in startup
+    static bool saveConfiguration(); // Save the enabled apartments to NVS
+    static void loadConfiguration(); // Load the enabled apartments in startup, migrating the legacy key
 
     static void IRAM_ATTR rightSideTimerISR();
     static void IRAM_ATTR leftSideTimerISR();
@@ -0,0 +1,133 @@
+// CborWriter.cpp
+
+#include "CborWriter.h"
+
+// Major types and simple values
+#define CBOR_UNSIGNED 0
+#define CBOR_NEGATIVE 1
+#define CBOR_TEXT 3
+#define CBOR_ARRAY 4
+#define CBOR_MAP 5
+#define CBOR_FALSE 0xF4
+#define CBOR_TRUE 0xF5
+#define CBOR_NULL 0xF6
+#define CBOR_INDEFINITE 31
+#define CBOR_BREAK 0xFF
+
+CborWriter::CborWriter(Print& out)
+    : _out(out), _depth(0)
+{
+}
+
+void CborWriter::beginObject(const char* key)
+{
+    if (key != nullptr)
+        writeKey(key);
+    _out.write((uint8_t)(CBOR_MAP << 5 | CBOR_INDEFINITE));
+    _depth++;
+}
+
+void CborWriter::endObject()
+{
+    if (_depth == 0)
+        return;
+
+    _out.write((uint8_t)CBOR_BREAK);
+    _depth--;
+}
+
+void CborWriter::beginArray(const char* key)
+{
+    if (key != nullptr)
+        writeKey(key);
+    _out.write((uint8_t)(CBOR_ARRAY << 5 | CBOR_INDEFINITE));
+    _depth++;
+}
+
+void CborWriter::endArray()
+{
+    endObject();
+}
+
+// Scalars
+void CborWriter::writeKey(const char* key)
+{
+    writeString(key);
+}
+
+void CborWriter::beginElement()
+{
+    // Items follow each other without separators
+}
+
+void CborWriter::writeBool(bool value)
+{
+    _out.write((uint8_t)(value ? CBOR_TRUE : CBOR_FALSE));
+}
+
+void CborWriter::writeSigned(long long value)
+{
+    if (value < 0)
+        writeHead(CBOR_NEGATIVE, (uint64_t)(-1 - value));
+    else
+        writeHead(CBOR_UNSIGNED, (uint64_t)value);
+}
+
+void CborWriter::writeUnsigned(unsigned long long value)
+{
+    writeHead(CBOR_UNSIGNED, value);
+}
+
+void CborWriter::writeString(const char* text)
+{
+    if (text == nullptr)
+        text = "";
+
+    size_t length = strlen(text);
+    writeHead(CBOR_TEXT, length);
+    _out.write((const uint8_t*)text, length);
+}
+
+void CborWriter::writeNull()
+{
+    _out.write((uint8_t)CBOR_NULL);
+}
+
+// Private Helpers
+void CborWriter::writeHead(uint8_t major, uint64_t value)
+{
+    // Initial byte plus up to 8 bytes of big-endian argument
+    uint8_t head[9];
+    uint8_t size;
+
+    if (value < 24)
+    {
+        head[0] = major << 5 | value;
+        size = 0;
+    }
+    else if (value <= 0xFF)
+    {
+        head[0] = major << 5 | 24;
+        size = 1;
+    }
+    else if (value <= 0xFFFF)
+    {
+        head[0] = major << 5 | 25;
+        size = 2;
+    }
+    else if (value <= 0xFFFFFFFF)
+    {
+        head[0] = major << 5 | 26;
+        size = 4;
+    }
+    else
+    {
+        head[0] = major << 5 | 27;
+        size = 8;
+    }
+
+    for (uint8_t i = 0; i < size; i++)
+        head[size - i] = (uint8_t)(value >> (8 * i));
+
+    _out.write(head, size + 1);
+}
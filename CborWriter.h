@@ -0,0 +1,43 @@
+// CborWriter.h
+
+#ifndef CBOR_WRITER_H
+#define CBOR_WRITER_H
+
+#include <Arduino.h>
+#include "DocumentWriter.h"
+
+// CBOR Writer Constants
+#define CBOR_CONTENT_TYPE "application/cbor"
+
+// Streaming CBOR (RFC 8949) writer, no heap allocation
+//
+// Objects and arrays are written with indefinite lengths, so nothing has to
+// be counted up front and the same serializers that feed the JsonWriter work
+// unchanged. Integers use the shortest head that fits, strings are sent as
+// UTF-8 text without any escaping.
+class CborWriter : public DocumentWriter {
+public:
+    explicit CborWriter(Print& out);
+
+    void beginObject(const char* key = nullptr) override;
+    void endObject() override;
+    void beginArray(const char* key = nullptr) override;
+    void endArray() override;
+
+protected:
+    void writeKey(const char* key) override;
+    void beginElement() override;
+    void writeBool(bool value) override;
+    void writeSigned(long long value) override;
+    void writeUnsigned(unsigned long long value) override;
+    void writeString(const char* text) override;
+    void writeNull() override;
+
+private:
+    Print& _out;
+    uint8_t _depth;
+
+    void writeHead(uint8_t major, uint64_t value);
+};
+
+#endif // CBOR_WRITER_H
@@ -0,0 +1,549 @@
+// ConfigStore.cpp
+
+#include "ConfigStore.h"
+#include <Preferences.h>
+#include <esp_crc.h>
+#include <stddef.h>
+
+// Static member initialization
+ConfigStore::Record ConfigStore::_records[MAX_CONFIG_RECORDS];
+uint8_t ConfigStore::_recordCount = 0;
+uint32_t ConfigStore::_firstChangeTime = 0;
+uint32_t ConfigStore::_lastChangeTime = 0;
+ConfigStoreStats ConfigStore::_stats = {0, 0, 0, 0, 0, 0};
+uint8_t ConfigStore::_corruptCount = 0;
+String ConfigStore::_lastError = "";
+bool ConfigStore::_importPending = false;
+
+ConfigLoadResult ConfigStore::load(const char* ns, uint16_t version, void* data, size_t size)
+{
+    // Registered even without a blob, so a snapshot import can fill it in
+    findRecord(ns, true);
+
+    Preferences prefs;
+    // A read-only begin fails when the namespace was never written
+    if (!prefs.begin(ns, true))
+        return ConfigLoadResult::MISSING;
+
+    size_t length = prefs.getBytesLength(CONFIG_BLOB_KEY);
+    if (length == 0)
+    {
+        prefs.end();
+        return ConfigLoadResult::MISSING;
+    }
+
+    uint8_t* buffer = nullptr;
+    if (length > sizeof(ConfigBlobHeader) && length <= CONFIG_BLOB_MAX_SIZE)
+        buffer = (uint8_t*)malloc(length);
+    if (buffer == nullptr || prefs.getBytes(CONFIG_BLOB_KEY, buffer, length) != length)
+    {
+        prefs.end();
+        free(buffer);
+        _corruptCount++;
+        _lastError = String(ns) + ": unreadable configuration blob";
+        Serial.printf("[Config] Error: %s\n", _lastError.c_str());
+        return ConfigLoadResult::CORRUPT;
+    }
+    prefs.end();
+
+    ConfigBlobHeader header;
+    if (!parseBlob(buffer, length, header))
+    {
+        free(buffer);
+        _corruptCount++;
+        _lastError = String(ns) + ": configuration blob failed its integrity check";
+        Serial.printf("[Config] Error: %s\n", _lastError.c_str());
+        return ConfigLoadResult::CORRUPT;
+    }
+
+    memcpy(data, buffer + sizeof(header), min((size_t)header.size, size));
+    free(buffer);
+
+    Record* record = findRecord(ns, true);
+    if (record != nullptr)
+    {
+        record->stored = true;
+        record->version = header.version;
+        record->size = header.size;
+        record->crc = header.crc;
+        record->writeCount = header.writeCount;
+    }
+
+    if (header.version != version || header.size != size)
+    {
+        Serial.printf("[Config] %s: migrating configuration v%u to v%u\n", ns, header.version, version);
+        return ConfigLoadResult::OUTDATED;
+    }
+    return ConfigLoadResult::LOADED;
+}
+
+bool ConfigStore::save(const char* ns, uint16_t version, const void* data, size_t size)
+{
+    uint32_t crc = esp_crc32_le(0, (const uint8_t*)data, size);
+
+    // Rewriting identical settings would only wear the flash
+    Record* record = findRecord(ns, true);
+    if (record != nullptr && record->stored && record->version == version &&
+        record->size == size && record->crc == crc)
+    {
+        _stats.unchanged++;
+        return true;
+    }
+
+    size_t length = sizeof(ConfigBlobHeader) + size;
+    uint8_t* buffer = (uint8_t*)malloc(length);
+    if (buffer == nullptr)
+    {
+        _lastError = String(ns) + ": out of memory";
+        return false;
+    }
+
+    ConfigBlobHeader header;
+    header.magic = CONFIG_BLOB_MAGIC;
+    header.version = version;
+    header.size = size;
+    header.crc = crc;
+    header.writeCount = (record != nullptr ? record->writeCount : 0) + 1;
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + sizeof(header), data, size);
+
+    size_t written = 0;
+    Preferences prefs;
+    if (prefs.begin(ns, false))
+    {
+        // One putBytes, NVS only drops the old blob once the new one is complete
+        written = prefs.putBytes(CONFIG_BLOB_KEY, buffer, length);
+        prefs.end();
+    }
+    free(buffer);
+
+    if (written != length)
+    {
+        _lastError = String(ns) + ": failed to write configuration blob";
+        Serial.printf("[Config] Error: %s\n", _lastError.c_str());
+        return false;
+    }
+
+    _stats.writes++;
+    _stats.bytesWritten += length;
+    if (record != nullptr)
+    {
+        record->stored = true;
+        record->version = version;
+        record->size = size;
+        record->crc = crc;
+        record->writeCount = header.writeCount;
+    }
+    return true;
+}
+
+// Deferred Commits
+void ConfigStore::markDirty(const char* ns, ConfigCommitCallback commit)
+{
+    Record* record = findRecord(ns, true);
+    if (record == nullptr)
+    {
+        // No slot to defer it in, so write right away
+        commit();
+        return;
+    }
+
+    // The imported records must survive until the restart
+    if (_importPending)
+        return;
+
+    uint32_t now = millis();
+    if (_stats.pending == 0)
+        _firstChangeTime = now;
+    _lastChangeTime = now;
+
+    record->commit = commit;
+    if (record->dirty)
+    {
+        _stats.coalesced++;
+        return;
+    }
+    record->dirty = true;
+    _stats.pending++;
+}
+
+void ConfigStore::update()
+{
+    if (_stats.pending == 0)
+        return;
+
+    uint32_t now = millis();
+    if (now - _lastChangeTime >= CONFIG_COMMIT_DELAY || now - _firstChangeTime >= CONFIG_COMMIT_MAX_DELAY)
+    {
+        flush();
+    }
+}
+
+bool ConfigStore::flush()
+{
+    if (_stats.pending == 0)
+        return true;
+
+    bool success = true;
+    uint32_t writesBefore = _stats.writes;
+    uint32_t bytesBefore = _stats.bytesWritten;
+
+    for (uint8_t i = 0; i < _recordCount; i++)
+    {
+        Record& record = _records[i];
+        if (!record.dirty)
+            continue;
+
+        record.dirty = false;
+        _stats.pending--;
+        if (!record.commit())
+        {
+            // Retried with the next commit pass
+            record.dirty = true;
+            _stats.pending++;
+            success = false;
+        }
+    }
+
+    if (_stats.writes != writesBefore)
+    {
+        _stats.commits++;
+        Serial.printf("[Config] Committed %u record(s), %u bytes\n",
+                      (unsigned)(_stats.writes - writesBefore), (unsigned)(_stats.bytesWritten - bytesBefore));
+    }
+
+    // A failed record waits a full delay instead of being retried on every loop
+    _firstChangeTime = _lastChangeTime = millis();
+    return success;
+}
+
+bool ConfigStore::hasPendingChanges()
+{
+    return _stats.pending > 0;
+}
+
+bool ConfigStore::finishLoad(const char* ns, ConfigLoadResult result, bool migrated, ConfigCommitCallback save,
+                             const char* const legacyKeys[], size_t keyCount)
+{
+    if (!migrated && result != ConfigLoadResult::OUTDATED)
+        return false;
+
+    if (!save() || !migrated)
+        return false;
+
+    removeKeys(ns, legacyKeys, keyCount);
+    Serial.printf("[Config] %s: migrated legacy configuration keys\n", ns);
+    return true;
+}
+
+// Configuration Snapshots
+bool ConfigStore::writeSnapshot(Print& out)
+{
+    // Blobs are read one at a time, so only the largest one is ever in RAM
+    ConfigSnapshotHeader header = {CONFIG_SNAPSHOT_MAGIC, CONFIG_SNAPSHOT_VERSION, 0, 0};
+    for (uint8_t i = 0; i < _recordCount; i++)
+    {
+        size_t length = 0;
+        uint8_t* blob = readBlob(_records[i].ns, length);
+        if (blob != nullptr)
+            header.recordCount++;
+        free(blob);
+    }
+
+    uint32_t crc = esp_crc32_le(0, (const uint8_t*)&header, sizeof(header));
+    bool success = out.write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+
+    for (uint8_t i = 0; success && i < _recordCount; i++)
+    {
+        size_t length = 0;
+        uint8_t* blob = readBlob(_records[i].ns, length);
+        if (blob == nullptr)
+            continue;
+
+        uint8_t nsLength = strlen(_records[i].ns);
+        crc = esp_crc32_le(crc, &nsLength, 1);
+        crc = esp_crc32_le(crc, (const uint8_t*)_records[i].ns, nsLength);
+        crc = esp_crc32_le(crc, blob, length);
+        success = out.write(&nsLength, 1) == 1 &&
+                  out.write((const uint8_t*)_records[i].ns, nsLength) == nsLength &&
+                  out.write(blob, length) == length;
+        free(blob);
+    }
+
+    success = success && out.write((const uint8_t*)&crc, sizeof(crc)) == sizeof(crc);
+    if (!success)
+        _lastError = "Snapshot export was interrupted";
+    return success;
+}
+
+bool ConfigStore::writeSnapshotJson(Print& out)
+{
+    out.printf("{\"format\":%u,\"records\":[", CONFIG_SNAPSHOT_VERSION);
+
+    bool first = true;
+    for (uint8_t i = 0; i < _recordCount; i++)
+    {
+        size_t length = 0;
+        uint8_t* blob = readBlob(_records[i].ns, length);
+        if (blob == nullptr)
+            continue;
+
+        ConfigBlobHeader header;
+        parseBlob(blob, length, header);
+        out.printf("%s{\"namespace\":\"%s\",\"version\":%u,\"size\":%u,\"writeCount\":%lu,\"crc\":\"%08lx\",\"data\":\"",
+                   first ? "" : ",", _records[i].ns, header.version, header.size,
+                   (unsigned long)header.writeCount, (unsigned long)header.crc);
+        for (size_t j = sizeof(header); j < length; j++)
+            out.printf("%02x", blob[j]);
+        out.print("\"}");
+        free(blob);
+        first = false;
+    }
+
+    out.print("]}");
+    return true;
+}
+
+bool ConfigStore::importSnapshot(const uint8_t* data, size_t size)
+{
+    ConfigSnapshotHeader header;
+    if (size < sizeof(header) + sizeof(uint32_t) || size > CONFIG_SNAPSHOT_MAX_SIZE)
+    {
+        _lastError = "Snapshot has an invalid size";
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    uint32_t crc;
+    memcpy(&crc, data + size - sizeof(crc), sizeof(crc));
+    if (header.magic != CONFIG_SNAPSHOT_MAGIC || header.version != CONFIG_SNAPSHOT_VERSION)
+    {
+        _lastError = "Not a configuration snapshot of this firmware";
+        return false;
+    }
+    if (esp_crc32_le(0, data, size - sizeof(crc)) != crc)
+    {
+        _lastError = "Snapshot failed its integrity check";
+        return false;
+    }
+
+    // First pass validates every record, nothing is written unless all of them are usable
+    struct ImportRecord {
+        Record* record;
+        const uint8_t* blob;
+        size_t length;
+    } records[MAX_CONFIG_RECORDS];
+    const uint8_t* cursor = data + sizeof(header);
+    const uint8_t* end = data + size - sizeof(crc);
+
+    if (header.recordCount > MAX_CONFIG_RECORDS)
+    {
+        _lastError = "Snapshot has too many records";
+        return false;
+    }
+
+    for (uint8_t i = 0; i < header.recordCount; i++)
+    {
+        char ns[CONFIG_NAMESPACE_SIZE];
+        uint8_t nsLength = cursor < end ? *cursor++ : 0;
+        if (nsLength == 0 || nsLength >= sizeof(ns) || cursor + nsLength > end)
+        {
+            _lastError = "Snapshot record " + String(i) + " is malformed";
+            return false;
+        }
+        memcpy(ns, cursor, nsLength);
+        ns[nsLength] = '\0';
+        cursor += nsLength;
+
+        Record* record = findRecord(ns, false);
+        if (record == nullptr)
+        {
+            _lastError = String(ns) + ": not a configuration record of this firmware";
+            return false;
+        }
+        for (uint8_t j = 0; j < i; j++)
+        {
+            if (records[j].record == record)
+            {
+                _lastError = String(ns) + ": appears twice in the snapshot";
+                return false;
+            }
+        }
+
+        // The blob length follows from its own header
+        ConfigBlobHeader blobHeader;
+        if (end - cursor < (ptrdiff_t)sizeof(blobHeader))
+        {
+            _lastError = String(ns) + ": truncated record";
+            return false;
+        }
+        memcpy(&blobHeader, cursor, sizeof(blobHeader));
+        size_t length = sizeof(blobHeader) + blobHeader.size;
+        if (length > CONFIG_BLOB_MAX_SIZE || end - cursor < (ptrdiff_t)length ||
+            !parseBlob(cursor, length, blobHeader))
+        {
+            _lastError = String(ns) + ": record failed its integrity check";
+            return false;
+        }
+
+        records[i] = {record, cursor, length};
+        cursor += length;
+    }
+
+    if (cursor != end)
+    {
+        _lastError = "Snapshot has trailing data";
+        return false;
+    }
+
+    // Pending edits of the old configuration must not overwrite the import
+    for (uint8_t i = 0; i < _recordCount; i++)
+        _records[i].dirty = false;
+    _stats.pending = 0;
+    _importPending = true;
+
+    bool success = true;
+    for (uint8_t i = 0; i < header.recordCount; i++)
+    {
+        ImportRecord& item = records[i];
+        size_t written = 0;
+        Preferences prefs;
+        if (prefs.begin(item.record->ns, false))
+        {
+            written = prefs.putBytes(CONFIG_BLOB_KEY, item.blob, item.length);
+            prefs.end();
+        }
+
+        if (written != item.length)
+        {
+            _lastError = String(item.record->ns) + ": failed to write configuration blob";
+            Serial.printf("[Config] Error: %s\n", _lastError.c_str());
+            success = false;
+            continue;
+        }
+        _stats.writes++;
+        _stats.bytesWritten += item.length;
+        item.record->stored = false;
+    }
+
+    Serial.printf("[Config] Imported %u record(s) from a snapshot\n", header.recordCount);
+    return success;
+}
+
+bool ConfigStore::isImportPending()
+{
+    return _importPending;
+}
+
+// Statistics
+ConfigStoreStats ConfigStore::getStats()
+{
+    return _stats;
+}
+
+uint8_t ConfigStore::getRecordCount()
+{
+    return _recordCount;
+}
+
+bool ConfigStore::getRecordInfo(uint8_t index, ConfigRecordInfo& info)
+{
+    if (index >= _recordCount)
+        return false;
+
+    info.ns = _records[index].ns;
+    info.writeCount = _records[index].writeCount;
+    info.dirty = _records[index].dirty;
+    return true;
+}
+
+uint8_t ConfigStore::getCorruptCount()
+{
+    return _corruptCount;
+}
+
+String ConfigStore::getLastError()
+{
+    return _lastError;
+}
+
+const char* ConfigStore::getResultName(ConfigLoadResult result)
+{
+    switch (result)
+    {
+    case ConfigLoadResult::LOADED:
+        return "loaded";
+    case ConfigLoadResult::OUTDATED:
+        return "outdated";
+    case ConfigLoadResult::MISSING:
+        return "missing";
+    case ConfigLoadResult::CORRUPT:
+        return "corrupt";
+    }
+    return "unknown";
+}
+
+// Private Helpers
+bool ConfigStore::parseBlob(const uint8_t* blob, size_t length, ConfigBlobHeader& header)
+{
+    if (length < sizeof(header))
+        return false;
+
+    memcpy(&header, blob, sizeof(header));
+    return header.magic == CONFIG_BLOB_MAGIC && header.size == length - sizeof(header) &&
+           esp_crc32_le(0, blob + sizeof(header), header.size) == header.crc;
+}
+
+void ConfigStore::removeKeys(const char* ns, const char* const keys[], size_t count)
+{
+    Preferences prefs;
+    if (!prefs.begin(ns, false))
+        return;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (prefs.isKey(keys[i]))
+            prefs.remove(keys[i]);
+    }
+    prefs.end();
+}
+
+uint8_t* ConfigStore::readBlob(const char* ns, size_t& length)
+{
+    Preferences prefs;
+    if (!prefs.begin(ns, true))
+        return nullptr;
+
+    uint8_t* blob = nullptr;
+    length = prefs.getBytesLength(CONFIG_BLOB_KEY);
+    if (length > 0 && length <= CONFIG_BLOB_MAX_SIZE)
+        blob = (uint8_t*)malloc(length);
+    if (blob != nullptr && prefs.getBytes(CONFIG_BLOB_KEY, blob, length) != length)
+    {
+        free(blob);
+        blob = nullptr;
+    }
+    prefs.end();
+    return blob;
+}
+
+ConfigStore::Record* ConfigStore::findRecord(const char* ns, bool create)
+{
+    for (uint8_t i = 0; i < _recordCount; i++)
+    {
+        if (strcmp(_records[i].ns, ns) == 0)
+            return &_records[i];
+    }
+
+    if (!create || _recordCount >= MAX_CONFIG_RECORDS)
+        return nullptr;
+
+    // Namespaces are string constants of their subsystem, so the pointer is kept
+    Record& record = _records[_recordCount++];
+    memset(&record, 0, sizeof(record));
+    record.ns = ns;
+    return &record;
+}
+
+// Create a global instance
+ConfigStore configStore;
@@ -0,0 +1,145 @@
+// ConfigStore.h
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+// Configuration Store Constants
+#define CONFIG_BLOB_KEY "config"            // Blob key inside each subsystem's namespace
+#define CONFIG_BLOB_MAGIC 0x46434D57        // "WMCF"
+#define CONFIG_BLOB_MAX_SIZE 2048           // Sanity limit for a stored blob (bytes)
+#define MAX_CONFIG_RECORDS 8                // Namespaces tracked for deferred commits and wear
+#define CONFIG_COMMIT_DELAY 2000            // Idle time after the last change before it is written (ms)
+#define CONFIG_COMMIT_MAX_DELAY 10000       // Longest a change waits while edits keep coming (ms)
+#define CONFIG_SNAPSHOT_MAGIC 0x4E534D57    // "WMSN"
+#define CONFIG_SNAPSHOT_VERSION 1
+#define CONFIG_SNAPSHOT_MAX_SIZE 8192       // Largest snapshot accepted for import (bytes)
+#define CONFIG_NAMESPACE_SIZE 16            // NVS namespace names are at most 15 characters
+
+enum class ConfigLoadResult : uint8_t {
+    LOADED,           // Blob found, current version
+    OUTDATED,         // Blob from another firmware version, the common prefix was loaded
+    MISSING,          // Nothing stored yet (or only legacy keys)
+    CORRUPT           // Bad magic, length or CRC, nothing was loaded
+};
+
+// Stored in front of every configuration blob
+struct ConfigBlobHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;            // Payload bytes following the header
+    uint32_t crc;             // CRC-32 of the payload
+    uint32_t writeCount;      // Times this blob was written, over the life of the device
+} __attribute__((packed));
+
+// Configuration snapshot, every stored record in one stream:
+//   ConfigSnapshotHeader
+//   per record: uint8_t namespace length, the namespace, the blob exactly as stored
+//   uint32_t CRC-32 of everything before it
+struct ConfigSnapshotHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t recordCount;
+    uint8_t reserved;
+} __attribute__((packed));
+
+// Builds a subsystem's record from its live state and passes it to ConfigStore::save()
+typedef bool (*ConfigCommitCallback)();
+
+// Flash write statistics since boot
+struct ConfigStoreStats {
+    uint32_t commits;         // Deferred commit passes that wrote anything
+    uint32_t writes;          // Blobs written to flash
+    uint32_t bytesWritten;
+    uint32_t unchanged;       // Writes skipped because the blob was already stored
+    uint32_t coalesced;       // Changes merged into a write that was already pending
+    uint8_t pending;          // Records waiting for the next commit
+};
+
+// Per-namespace wear, shown in /api/status
+struct ConfigRecordInfo {
+    const char* ns;
+    uint32_t writeCount;      // Lifetime writes, from the blob header
+    bool dirty;
+};
+
+// Versioned, CRC-checked configuration records, one binary blob per subsystem
+//
+// Each subsystem keeps its settings in one packed struct, read with a single
+// getBytes() and written with a single putBytes(). NVS replaces a blob atomically,
+// so a power cut leaves either the old or the new record, never a mix of both.
+//
+// A subsystem's record is its packed StoredConfig struct, stored under its
+// CONFIG_VERSION. Fields are only ever appended to the struct, and the version
+// bumped with them, so any version can load the common prefix; new fields keep
+// the defaults the caller filled in before load().
+//
+// Frequent changes go through markDirty() instead of save(): the record is
+// written once, CONFIG_COMMIT_DELAY after the last change (or at the latest
+// CONFIG_COMMIT_MAX_DELAY after the first), from update() or flush().
+class ConfigStore {
+public:
+    static ConfigLoadResult load(const char* ns, uint16_t version, void* data, size_t size);
+    static bool save(const char* ns, uint16_t version, const void* data, size_t size);
+
+    // Deferred Commits
+    static void markDirty(const char* ns, ConfigCommitCallback commit);
+    static void update();
+    static bool flush();                        // Write everything pending now, e.g. before a restart
+    static bool hasPendingChanges();
+
+    // Ends a subsystem's load: a record migrated from legacy per-field keys or
+    // found outdated is written back with save, and the legacy keys are dropped
+    // only once the blob holds the same settings. True when a migration completed.
+    static bool finishLoad(const char* ns, ConfigLoadResult result, bool migrated, ConfigCommitCallback save,
+                           const char* const legacyKeys[], size_t keyCount);
+
+    // Configuration Snapshots (for cloning a controller)
+    // The whole snapshot is validated before the first record is written, and each
+    // record is replaced atomically. Afterwards the store ignores further changes,
+    // the device has to restart so every subsystem loads the imported records.
+    static bool writeSnapshot(Print& out);
+    static bool writeSnapshotJson(Print& out);  // Readable view, not accepted for import
+    static bool importSnapshot(const uint8_t* data, size_t size);
+    static bool isImportPending();
+
+    // Statistics
+    static ConfigStoreStats getStats();
+    static uint8_t getRecordCount();
+    static bool getRecordInfo(uint8_t index, ConfigRecordInfo& info);
+    static uint8_t getCorruptCount();           // Corrupt blobs found since boot
+    static String getLastError();
+    static const char* getResultName(ConfigLoadResult result);
+
+private:
+    struct Record {
+        const char* ns;
+        ConfigCommitCallback commit;
+        bool dirty;
+        bool stored;              // crc/size/version describe what is in flash
+        uint16_t version;
+        uint16_t size;
+        uint32_t crc;
+        uint32_t writeCount;
+    };
+
+    static Record _records[MAX_CONFIG_RECORDS];
+    static uint8_t _recordCount;
+    static uint32_t _firstChangeTime;
+    static uint32_t _lastChangeTime;
+    static ConfigStoreStats _stats;
+    static uint8_t _corruptCount;
+    static String _lastError;
+    static bool _importPending;
+
+    static Record* findRecord(const char* ns, bool create);
+    static bool parseBlob(const uint8_t* blob, size_t length, ConfigBlobHeader& header);
+    static uint8_t* readBlob(const char* ns, size_t& length);
+    static void removeKeys(const char* ns, const char* const keys[], size_t count);
+};
+
+// External declaration for global access
+extern ConfigStore configStore;
+
+#endif // CONFIG_STORE_H
@@ -19,29 +19,58 @@
 #include "PinsConfig.h"
 #include "WiFiConfig.h"
 #include "TelegramHandler.h"
+#include "Notifier.h"
+#include "MqttNotifier.h"
+#include "WebhookNotifier.h"
 #include "AlarmSystem.h"
 #include "WebPortal.h"
 #include "ApartmentGrouping.h"
+#include "ConfigStore.h"
+#include "EventStream.h"
+#include "Metrics.h"
+#include "LoopProfiler.h"
+#include "DeferredLog.h"
+#include "MemoryBudget.h"
+#include "EventBus.h"
 #include <esp_task_wdt.h>
 
 
 void setup() {
   // Initialize Serial for debugging
-  Serial.begin(9600);
+  Serial.begin(115200);
   Serial.println(F("\n\n--- Water Meter Anti-Theft System Starting ---"));
 
+  // Hot paths log through a queue drained by a background task
+  DeferredLog::begin();
+
+  // Report the loop section a watchdog reset interrupted, before anything else runs
+  loopProfiler.begin();
+
+  // Heap sampling, subsystems ask it before they allocate
+  memoryBudget.begin();
+
   // Initialize GPIO pins
   Serial.println(F("Initializing pins..."));
   PinConfiguration::initializeAllPins();
 
 
-  // Initialize Telegram handler
-  Serial.println(F("Initializing Telegram handler..."));
-  if (!telegramHandler.begin()) {
-    Serial.print(F("Failed to initialize Telegram handler: "));
-    Serial.println(telegramHandler.getLastError());
-    // Continue anyway - the system must work even without Telegram
+  // Alarm and WiFi events reach their consumers through the event bus
+  eventBus.begin();
+
+  // Initialize notification backends (Telegram, MQTT, webhook)
+  Serial.println(F("Initializing notifiers..."));
+  notifier.registerBackend(&telegramNotifier);
+  notifier.registerBackend(&mqttNotifier);
+  notifier.registerBackend(&webhookNotifier);
+  notifier.setStateLock(WebPortal::lock, WebPortal::unlock);
+  if (!notifier.begin()) {
+    Serial.println(F("Failed to initialize some notifiers"));
+    // Continue anyway - the system must work even without notifications
   }
+
+  // Other event bus subscribers, dispatched in this order after the notifiers
+  eventStream.begin();
+  Metrics::begin();
   
   // Initialize the alarm system (must be before WiFi to ensure alarm works even without WiFi)
   Serial.println(F("Initializing alarm system..."));
@@ -68,13 +97,6 @@ void setup() {
     // Continue anyway - the system must work even without web portal
   }
 
-  // Set up callbacks
-  WiFiManager::setOnConnectCallback([]() {
-    Serial.println(F("WiFi connected"));
-    // Send online notification to all enabled apartments
-    telegramHandler.sendSystemOnlineMessageToEnabledApartments();
-  });
-
    // First, ensure no watchdog is already configured
   esp_task_wdt_deinit();
   // Create and initialize the watchdog timer configuration structure
@@ -100,25 +122,49 @@ void setup() {
     return;
   }
   
-  
   Serial.println(F("System initialization complete"));
 }
 
 void loop() {
+  uint32_t loopStart = micros();
+
   // Reset the watchdog timer regularly when things are working correctly
   esp_task_wdt_reset();
+
+  // Web requests are served from their own task, they wait while the loop updates shared state
+  LOOP_PROFILE(LoopSection::LOCK, webPortal.lock());
   
   // Update WiFi connection (non-blocking)
-  WiFiManager::handleConnection();
+  LOOP_PROFILE(LoopSection::WIFI, WiFiManager::handleConnection());
+
+  // Sample the heap, decides which subsystems are shed before they allocate
+  LOOP_PROFILE(LoopSection::MEMORY, memoryBudget.update());
 
   // Update alarm system (higher priority than other tasks)
-  alarmSystem.update();
+  LOOP_PROFILE(LoopSection::ALARM, alarmSystem.update());
+
+  // Hand published events to their subscribers (notifiers, dashboards, metrics)
+  LOOP_PROFILE(LoopSection::BUS, eventBus.update());
+
+  // Update notification backends (process message queues), they release the lock while waiting on the network
+  LOOP_PROFILE(LoopSection::NOTIFIER, notifier.update());
+
+  // Update web portal (session timeouts, pending restart)
+  LOOP_PROFILE(LoopSection::WEB_PORTAL, webPortal.update());
+
+  // Push state changes to connected dashboards
+  LOOP_PROFILE(LoopSection::EVENTS, eventStream.update());
+
+  // Write settings changed a few seconds ago in one go
+  LOOP_PROFILE(LoopSection::CONFIG, configStore.update());
+
+  // Iteration time for /metrics, still under the lock /metrics reads it with
+  Metrics::recordLoop(micros() - loopStart);
 
-  // Update Telegram handler (process message queue)
-  telegramHandler.update();
+  webPortal.unlock();
 
-  // Update web portal (handle client requests)
-  webPortal.update();
+  // Periodic per-section timing summary on the serial console
+  loopProfiler.update();
   
   // Yield to allow for WiFi processing, especially in non-blocking mode
   yield();
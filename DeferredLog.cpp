@@ -0,0 +1,152 @@
+// DeferredLog.cpp
+
+#include "DeferredLog.h"
+
+// Static member initialization
+DeferredLog::Slot DeferredLog::_slots[DLOG_QUEUE_SIZE];
+std::atomic<uint32_t> DeferredLog::_head(0);
+uint32_t DeferredLog::_tail = 0;
+std::atomic<uint32_t> DeferredLog::_dropped(0);
+TaskHandle_t DeferredLog::_task = nullptr;
+
+bool DeferredLog::begin()
+{
+    if (_task != nullptr)
+        return true;
+
+    // Slot N is free for position N; a written slot holds position + 1
+    for (uint32_t i = 0; i < DLOG_QUEUE_SIZE; i++)
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    _head.store(0, std::memory_order_relaxed);
+    _tail = 0;
+
+    // Core 0, next to the WiFi tasks; the loop runs on core 1
+    if (xTaskCreatePinnedToCore(writerTask, "log", DLOG_TASK_STACK_SIZE, nullptr, DLOG_TASK_PRIORITY, &_task, 0) != pdPASS)
+    {
+        _task = nullptr;
+        Serial.println("[Log] Failed to start the writer task");
+        return false;
+    }
+    return true;
+}
+
+void DeferredLog::flush(uint32_t timeout)
+{
+    if (_task == nullptr)
+        return;
+
+    uint32_t start = millis();
+    while (_slots[_tail % DLOG_QUEUE_SIZE].sequence.load(std::memory_order_acquire) == _tail + 1 &&
+           millis() - start < timeout)
+    {
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    Serial.flush();
+}
+
+uint32_t DeferredLog::getDropped()
+{
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+// Private Helpers
+void DeferredLog::enqueue(const Record& record)
+{
+    // Bounded multi-producer queue: claim a position, fill the slot, then publish it
+    uint32_t position = _head.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;)
+    {
+        slot = &_slots[position % DLOG_QUEUE_SIZE];
+        int32_t difference = (int32_t)(slot->sequence.load(std::memory_order_acquire) - position);
+        if (difference == 0)
+        {
+            if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = _head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record = record;
+    slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+bool DeferredLog::dequeue(Record& record)
+{
+    Slot& slot = _slots[_tail % DLOG_QUEUE_SIZE];
+    if (slot.sequence.load(std::memory_order_acquire) != _tail + 1)
+        return false;
+
+    record = slot.record;
+    slot.sequence.store(_tail + DLOG_QUEUE_SIZE, std::memory_order_release);
+    _tail++;
+    return true;
+}
+
+void DeferredLog::writerTask(void* parameter)
+{
+    uint32_t reportedDrops = 0;
+    Record record;
+
+    for (;;)
+    {
+        while (dequeue(record))
+            writeRecord(record);
+
+        uint32_t dropped = getDropped();
+        if (dropped != reportedDrops)
+        {
+            Serial.printf("[Log] %lu message(s) dropped, the log queue was full\n", (unsigned long)(dropped - reportedDrops));
+            reportedDrops = dropped;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_INTERVAL));
+    }
+}
+
+void DeferredLog::writeRecord(const Record& record)
+{
+    uint32_t args[DLOG_MAX_ARGS];
+    memcpy(args, record.args, sizeof(args));
+    for (uint8_t i = 0; i < DLOG_MAX_ARGS; i++)
+    {
+        if (record.textArgs & (1 << i))
+            args[i] = (uint32_t)(uintptr_t)(record.text + args[i]);
+    }
+
+    // Timestamp of the call, not of the write
+    char line[DLOG_LINE_SIZE];
+    int length = snprintf(line, sizeof(line), "[%lu.%03lu] ", (unsigned long)(record.timestamp / 1000),
+                          (unsigned long)(record.timestamp % 1000));
+    int message = snprintf(line + length, sizeof(line) - length - 1, record.format, args[0], args[1], args[2], args[3],
+                           args[4], args[5]);
+    if (message > 0)
+        length += min(message, (int)sizeof(line) - length - 2);
+    line[length++] = '\n';
+    Serial.write((const uint8_t*)line, length);
+}
+
+uint32_t DeferredLog::copyText(Record& record, uint8_t index, const char* text)
+{
+    // Strings are packed one after another, once the buffer is full the rest are empty
+    if (text == nullptr)
+        text = "(null)";
+    size_t offset = min((size_t)record.textLength, sizeof(record.text) - 1);
+    size_t length = strnlen(text, sizeof(record.text) - 1 - offset);
+    memcpy(record.text + offset, text, length);
+    record.text[offset + length] = '\0';
+    record.textLength = offset + length + 1;
+    record.textArgs |= 1 << index;
+    return offset;
+}
+
+// Create a global instance
+DeferredLog deferredLog;
@@ -0,0 +1,136 @@
+// DeferredLog.h
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+
+// Log levels, calls above DLOG_LEVEL are removed at compile time
+#define DLOG_LEVEL_NONE 0
+#define DLOG_LEVEL_ERROR 1
+#define DLOG_LEVEL_WARN 2
+#define DLOG_LEVEL_INFO 3
+#define DLOG_LEVEL_DEBUG 4
+
+#ifndef DLOG_LEVEL
+#define DLOG_LEVEL DLOG_LEVEL_INFO
+#endif
+
+// Deferred Log Constants
+#define DLOG_QUEUE_SIZE 64          // Records, a power of two
+#define DLOG_MAX_ARGS 6             // 32-bit arguments per record
+#define DLOG_TEXT_SIZE 64           // Copies of the string arguments, shared; text that does not fit is truncated
+#define DLOG_LINE_SIZE 160          // Longest formatted line
+#define DLOG_DRAIN_INTERVAL 20      // Writer task sleep while the queue is empty (ms)
+#define DLOG_FLUSH_TIMEOUT 500      // Longest flush() wait (ms)
+#define DLOG_TASK_STACK_SIZE 3072
+#define DLOG_TASK_PRIORITY 1
+
+// Serial logging that never blocks the caller
+//
+// A call only stores the format string's address, a timestamp and its raw
+// arguments in a lock-free ring; a low-priority task formats the records and
+// writes them to Serial. Arguments are 32-bit integers, enums, characters or
+// strings: every string (const char* or String) is copied into the record,
+// since the caller's buffer may be gone by the time it is written. Floats and
+// 64-bit integers are rejected at compile time.
+//
+// When the ring is full the record is dropped and counted; the writer task
+// reports the count. Records still queued when the chip crashes are lost,
+// call flush() before a deliberate restart.
+class DeferredLog {
+public:
+    static bool begin();
+    static void flush(uint32_t timeout = DLOG_FLUSH_TIMEOUT); // Waits until the writer task has caught up
+    static uint32_t getDropped();
+
+    template <typename... Args>
+    static void push(uint8_t level, const char* format, Args&&... args)
+    {
+        static_assert(sizeof...(Args) <= DLOG_MAX_ARGS, "Too many log arguments");
+
+        Record record;
+        record.format = format;
+        record.timestamp = millis();
+        record.level = level;
+        record.textArgs = 0;
+        record.textLength = 0;
+        uint8_t index = 0;
+        int expand[] = {0, (record.args[index] = toArg(record, index, args), index++, 0)...};
+        (void)expand;
+        enqueue(record);
+    }
+
+private:
+    struct Record {
+        const char* format;   // String literal, its address identifies the message
+        uint32_t timestamp;   // millis()
+        uint32_t args[DLOG_MAX_ARGS];
+        char text[DLOG_TEXT_SIZE];
+        uint8_t textArgs;     // Bit per string argument, its args[] entry is an offset into text
+        uint8_t textLength;   // Bytes of text in use
+        uint8_t level;
+    };
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        Record record;
+    };
+
+    static Slot _slots[DLOG_QUEUE_SIZE];
+    static std::atomic<uint32_t> _head;     // Next position to write, shared by all producers
+    static uint32_t _tail;                  // Next position to read, writer task only
+    static std::atomic<uint32_t> _dropped;
+    static TaskHandle_t _task;
+
+    static void enqueue(const Record& record);
+    static bool dequeue(Record& record);
+    static void writerTask(void* parameter);
+    static void writeRecord(const Record& record);
+
+    // Argument conversion
+    static uint32_t copyText(Record& record, uint8_t index, const char* text);
+    static uint32_t toArg(Record& record, uint8_t index, const char* text) { return copyText(record, index, text); }
+    static uint32_t toArg(Record& record, uint8_t index, char* text) { return copyText(record, index, text); }
+    static uint32_t toArg(Record& record, uint8_t index, const String& text) { return copyText(record, index, text.c_str()); }
+
+    template <typename T>
+    static uint32_t toArg(Record& record, uint8_t index, T value)
+    {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                      "Log arguments must be integers, enums or strings");
+        static_assert(sizeof(T) <= sizeof(uint32_t), "64-bit log arguments are not supported");
+        return (uint32_t)(uintptr_t)value;
+    }
+};
+
+// Logging macros, the arguments of a removed call are not evaluated
+#if DLOG_LEVEL >= DLOG_LEVEL_ERROR
+#define DLOG_ERROR(...) DeferredLog::push(DLOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define DLOG_ERROR(...) do { } while (0)
+#endif
+
+#if DLOG_LEVEL >= DLOG_LEVEL_WARN
+#define DLOG_WARN(...) DeferredLog::push(DLOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define DLOG_WARN(...) do { } while (0)
+#endif
+
+#if DLOG_LEVEL >= DLOG_LEVEL_INFO
+#define DLOG_INFO(...) DeferredLog::push(DLOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define DLOG_INFO(...) do { } while (0)
+#endif
+
+#if DLOG_LEVEL >= DLOG_LEVEL_DEBUG
+#define DLOG_DEBUG(...) DeferredLog::push(DLOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define DLOG_DEBUG(...) do { } while (0)
+#endif
+
+extern DeferredLog deferredLog;
+
+#endif // DEFERRED_LOG_H
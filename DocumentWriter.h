@@ -0,0 +1,53 @@
+// DocumentWriter.h
+
+#ifndef DOCUMENT_WRITER_H
+#define DOCUMENT_WRITER_H
+
+#include <Arduino.h>
+
+// Streaming writer for structured documents (objects, arrays, scalars)
+//
+// Serializers are written once against this interface and produce JSON or
+// CBOR depending on the writer they are given. Implementations only provide
+// the containers and the scalar encodings; the typed field() and value()
+// overloads are shared.
+class DocumentWriter {
+public:
+    virtual ~DocumentWriter() {}
+
+    // Containers, the key is only used inside an object
+    virtual void beginObject(const char* key = nullptr) = 0;
+    virtual void endObject() = 0;
+    virtual void beginArray(const char* key = nullptr) = 0;
+    virtual void endArray() = 0;
+
+    // Object members
+    void field(const char* key, bool value) { writeKey(key); writeBool(value); }
+    void field(const char* key, int value) { writeKey(key); writeSigned(value); }
+    void field(const char* key, unsigned int value) { writeKey(key); writeUnsigned(value); }
+    void field(const char* key, long value) { writeKey(key); writeSigned(value); }
+    void field(const char* key, unsigned long value) { writeKey(key); writeUnsigned(value); }
+    void field(const char* key, const char* value) { writeKey(key); writeString(value); }
+    void field(const char* key, const String& value) { writeKey(key); writeString(value.c_str()); }
+    void fieldNull(const char* key) { writeKey(key); writeNull(); }
+
+    // Array elements
+    void value(bool value) { beginElement(); writeBool(value); }
+    void value(int value) { beginElement(); writeSigned(value); }
+    void value(unsigned int value) { beginElement(); writeUnsigned(value); }
+    void value(long value) { beginElement(); writeSigned(value); }
+    void value(unsigned long value) { beginElement(); writeUnsigned(value); }
+    void value(const char* value) { beginElement(); writeString(value); }
+    void value(const String& value) { beginElement(); writeString(value.c_str()); }
+
+protected:
+    virtual void writeKey(const char* key) = 0;
+    virtual void beginElement() = 0;
+    virtual void writeBool(bool value) = 0;
+    virtual void writeSigned(long long value) = 0;
+    virtual void writeUnsigned(unsigned long long value) = 0;
+    virtual void writeString(const char* text) = 0;
+    virtual void writeNull() = 0;
+};
+
+#endif // DOCUMENT_WRITER_H
@@ -0,0 +1,153 @@
+// EventBus.cpp
+
+#include "EventBus.h"
+#include "WiFiConfig.h"
+#include "DeferredLog.h"
+
+// Event names as used by the log, /api/status and /metrics
+static const char* const EVENT_NAMES[(uint8_t)BusEventType::COUNT] = {
+    "theft", "wire_cut", "distribution_wire_cut", "startup_wire_cut", "startup_distribution_wire_cut",
+    "siren_on", "siren_off", "wifi_connected", "wifi_disconnected"};
+
+// Static member initialization
+QueueHandle_t EventBus::_queue = NULL;
+EventBus::Subscriber EventBus::_subscribers[MAX_EVENT_SUBSCRIBERS] = {};
+uint8_t EventBus::_subscriberCount = 0;
+EventBusStats EventBus::_stats = {};
+portMUX_TYPE EventBus::_statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+bool EventBus::begin()
+{
+    if (_queue != NULL)
+        return true;
+
+    _queue = xQueueCreate(EVENT_BUS_QUEUE_SIZE, sizeof(BusEvent));
+    if (_queue == NULL)
+    {
+        Serial.println("[EventBus] Failed to create the event queue");
+        return false;
+    }
+    return true;
+}
+
+void EventBus::update()
+{
+    if (_queue == NULL)
+        return;
+
+    // One queue's worth at a time, events published by a subscriber wait for the next call
+    BusEvent event;
+    for (uint8_t i = 0; i < EVENT_BUS_QUEUE_SIZE && xQueueReceive(_queue, &event, 0) == pdTRUE; i++)
+    {
+        _stats.dispatched++;
+        dispatch(event);
+    }
+}
+
+bool EventBus::subscribe(uint32_t mask, BusEventHandler handler, const char* name)
+{
+    if (handler == nullptr || _subscriberCount >= MAX_EVENT_SUBSCRIBERS)
+    {
+        Serial.printf("[EventBus] Subscriber table is full, %s not added\n", name);
+        return false;
+    }
+
+    _subscribers[_subscriberCount].mask = mask;
+    _subscribers[_subscriberCount].handler = handler;
+    _subscribers[_subscriberCount].name = name;
+    _subscriberCount++;
+    _stats.subscribers = _subscriberCount;
+    return true;
+}
+
+bool EventBus::publish(BusEventType type, uint8_t apartment, BuildingSide side, BoxPosition box)
+{
+    BusEvent event;
+    event.type = type;
+    event.apartment = apartment;
+    event.side = side;
+    event.box = box;
+    event.eventTime = WiFiManager::getEpochTime();
+    event.eventMillis = millis();
+
+    // Never waits; other events leave the reserved slots to alarm events
+    bool alarm = isAlarmEvent(type);
+    bool queued = _queue != NULL &&
+                  (alarm || uxQueueMessagesWaiting(_queue) < EVENT_BUS_QUEUE_SIZE - EVENT_BUS_ALARM_RESERVE) &&
+                  xQueueSendToBack(_queue, &event, 0) == pdTRUE;
+
+    portENTER_CRITICAL(&_statsMux);
+    if (queued)
+    {
+        _stats.published++;
+        uint8_t waiting = uxQueueMessagesWaiting(_queue);
+        if (waiting > _stats.queueHighWater)
+            _stats.queueHighWater = waiting;
+    }
+    else if (alarm)
+    {
+        _stats.published++;
+        _stats.dispatched++;
+        _stats.direct++;
+    }
+    else
+    {
+        _stats.dropped++;
+    }
+    portEXIT_CRITICAL(&_statsMux);
+
+    if (queued)
+        return true;
+
+    if (alarm)
+    {
+        // An alarm must reach the notifiers even if it overtakes queued events
+        DLOG_WARN("[EventBus] Queue full, %s event dispatched at once", getEventName(type));
+        dispatch(event);
+        return true;
+    }
+
+    DLOG_WARN("[EventBus] Dropped a %s event, the queue is full", getEventName(type));
+    return false;
+}
+
+EventBusStats EventBus::getStats()
+{
+    portENTER_CRITICAL(&_statsMux);
+    EventBusStats stats = _stats;
+    portEXIT_CRITICAL(&_statsMux);
+    return stats;
+}
+
+const char* EventBus::getEventName(BusEventType type)
+{
+    return type < BusEventType::COUNT ? EVENT_NAMES[(uint8_t)type] : "unknown";
+}
+
+bool EventBus::isAlarmEvent(BusEventType type)
+{
+    switch (type)
+    {
+    case BusEventType::THEFT:
+    case BusEventType::WIRE_CUT:
+    case BusEventType::DISTRIBUTION_WIRE_CUT:
+    case BusEventType::STARTUP_WIRE_CUT:
+    case BusEventType::STARTUP_DISTRIBUTION_WIRE_CUT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Private Helpers
+void EventBus::dispatch(const BusEvent& event)
+{
+    for (uint8_t i = 0; i < _subscriberCount; i++)
+    {
+        if (_subscribers[i].mask & BUS_EVENT_MASK(event.type))
+            _subscribers[i].handler(event);
+    }
+}
+
+// Create a global instance
+EventBus eventBus;
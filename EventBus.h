@@ -0,0 +1,101 @@
+// EventBus.h
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "ApartmentGrouping.h"
+
+// Event Bus Constants
+#define EVENT_BUS_QUEUE_SIZE 32             // Events waiting for dispatch
+#define EVENT_BUS_ALARM_RESERVE 8           // Queue slots only alarm events may take
+#define MAX_EVENT_SUBSCRIBERS 8             // Entries in the subscriber table
+
+// Events published on the bus
+enum class BusEventType : uint8_t {
+    THEFT,
+    WIRE_CUT,
+    DISTRIBUTION_WIRE_CUT,
+    STARTUP_WIRE_CUT,
+    STARTUP_DISTRIBUTION_WIRE_CUT,
+    SIREN_ON,
+    SIREN_OFF,
+    WIFI_CONNECTED,
+    WIFI_DISCONNECTED,
+    COUNT
+};
+
+// Subscription masks
+#define BUS_EVENT_MASK(type) (1UL << static_cast<uint8_t>(type))
+#define BUS_EVENT_ALL ((1UL << static_cast<uint8_t>(BusEventType::COUNT)) - 1)
+
+struct BusEvent {
+    BusEventType type;
+    uint8_t apartment;        // THEFT only, 0 otherwise
+    BuildingSide side;        // Alarm events only
+    BoxPosition box;          // WIRE_CUT and STARTUP_WIRE_CUT only
+    uint32_t eventTime;       // Unix time at publish, 0 if the clock was not synced yet
+    uint32_t eventMillis;     // millis() at publish
+};
+
+typedef void (*BusEventHandler)(const BusEvent& event);
+
+// Event bus statistics since boot, shown in /api/status and /metrics
+struct EventBusStats {
+    uint32_t published;
+    uint32_t dispatched;      // Events taken off the queue
+    uint32_t dropped;         // Lost to a full queue, never an alarm event
+    uint32_t direct;          // Alarm events dispatched at once because even the reserve was full
+    uint8_t queueHighWater;
+    uint8_t subscribers;
+};
+
+// In-process publish/subscribe
+//
+// Publishers describe what happened and go on: publish() copies the
+// fixed-size event into a FreeRTOS queue without waiting, so it is safe from
+// any task (the WiFi events arrive on the WiFi task). update() takes the
+// events off the queue in the main loop and calls every subscriber whose mask
+// contains the type, in the order they subscribed. Subscribers are
+// registered during setup and never removed.
+//
+// Alarm events (theft and wire cuts) are never lost: the last
+// EVENT_BUS_ALARM_RESERVE slots are kept for them, and when even those are
+// taken the event goes to the subscribers right away, ahead of the queue.
+// Alarm events are only published by tasks holding the shared lock, as the
+// subscribers expect.
+class EventBus {
+public:
+    static bool begin();
+    static void update();     // Call this from loop()
+
+    static bool subscribe(uint32_t mask, BusEventHandler handler, const char* name);
+    static bool publish(BusEventType type, uint8_t apartment = 0, BuildingSide side = RIGHT_SIDE,
+                        BoxPosition box = RIGHT_BOX);
+
+    static EventBusStats getStats();
+    static const char* getEventName(BusEventType type);
+    static bool isAlarmEvent(BusEventType type);
+
+private:
+    struct Subscriber {
+        uint32_t mask;
+        BusEventHandler handler;
+        const char* name;
+    };
+
+    static QueueHandle_t _queue;
+    static Subscriber _subscribers[MAX_EVENT_SUBSCRIBERS];
+    static uint8_t _subscriberCount;
+    static EventBusStats _stats;
+    static portMUX_TYPE _statsMux;    // published and dropped are counted on the publisher's task
+
+    static void dispatch(const BusEvent& event);
+};
+
+// External declaration for global access
+extern EventBus eventBus;
+
+#endif // EVENT_BUS_H
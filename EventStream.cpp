@@ -0,0 +1,304 @@
+// EventStream.cpp
+
+#include "EventStream.h"
+#include "AlarmSystem.h"
+#include "TelegramHandler.h"
+#include <lwip/sockets.h>
+
+// Wire names as used by /api/wire-status, bit N of Snapshot::wires
+static const char* const WIRE_NAMES[] = {
+    "rightSideRightBox", "rightSideLeftBox", "leftSideRightBox",
+    "leftSideLeftBox", "rightSideDistribution", "leftSideDistribution"};
+static const uint8_t WIRE_COUNT = sizeof(WIRE_NAMES) / sizeof(WIRE_NAMES[0]);
+
+// Static member initialization
+EventStream::Client EventStream::_clients[MAX_EVENT_CLIENTS];
+EventStream::Snapshot EventStream::_sent;
+uint32_t EventStream::_lastCheck = 0;
+bool EventStream::_changed = false;
+uint32_t EventStream::_lastEvent = 0;
+EventStreamStats EventStream::_stats = {0, 0, 0, 0, 0};
+void (*EventStream::_activityCallback)(int socket) = nullptr;
+
+void EventStream::begin()
+{
+    EventBus::subscribe(BUS_EVENT_MASK(BusEventType::THEFT) | BUS_EVENT_MASK(BusEventType::WIRE_CUT) |
+                            BUS_EVENT_MASK(BusEventType::DISTRIBUTION_WIRE_CUT) |
+                            BUS_EVENT_MASK(BusEventType::SIREN_ON) | BUS_EVENT_MASK(BusEventType::SIREN_OFF),
+                        onBusEvent, "eventStream");
+}
+
+void EventStream::addClient(int socket)
+{
+    if (socket < 0)
+        return;
+
+    Client* slot = nullptr;
+    for (uint8_t i = 0; i < MAX_EVENT_CLIENTS && slot == nullptr; i++)
+    {
+        if (!_clients[i].active)
+            slot = &_clients[i];
+    }
+
+    if (slot == nullptr)
+    {
+        // The browser retries on its own once a slot is free
+        const char* busy = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        send(socket, busy, strlen(busy), MSG_DONTWAIT);
+        shutdown(socket, SHUT_RDWR);
+        return;
+    }
+
+    // Without other clients the last snapshot is stale
+    if (_stats.clients == 0)
+        takeSnapshot(_sent);
+
+    int noDelay = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    slot->socket = socket;
+    slot->active = true;
+    slot->length = 0;
+    _stats.connects++;
+    _stats.clients++;
+
+    char header[160];
+    int length = snprintf(header, sizeof(header),
+                          "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+                          "Connection: keep-alive\r\n\r\nretry: %u\n\n",
+                          EVENT_RETRY_DELAY);
+    queue(*slot, header, length);
+    flushClient(*slot);
+
+    sendHello(*slot);
+    flushClient(*slot);
+}
+
+void EventStream::removeClient(int socket)
+{
+    for (uint8_t i = 0; i < MAX_EVENT_CLIENTS; i++)
+    {
+        if (_clients[i].active && _clients[i].socket == socket)
+        {
+            // The server closes the socket itself
+            _clients[i].active = false;
+            _clients[i].length = 0;
+            _stats.clients--;
+        }
+    }
+}
+
+void EventStream::onActivity(void (*callback)(int socket))
+{
+    _activityCallback = callback;
+}
+
+void EventStream::update()
+{
+    uint32_t now = millis();
+    if (_stats.clients == 0 || (!_changed && now - _lastCheck < EVENT_CHECK_INTERVAL))
+        return;
+    _lastCheck = now;
+    _changed = false;
+
+    Snapshot current;
+    takeSnapshot(current);
+    char data[EVENT_DATA_SIZE];
+
+    for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
+    {
+        if (current.triggered[i] != _sent.triggered[i])
+        {
+            snprintf(data, sizeof(data), "{\"apt\":%u,\"triggered\":%s}", i + 1, current.triggered[i] ? "true" : "false");
+            broadcast("sensor", data);
+        }
+    }
+
+    for (uint8_t side = 0; side < 2; side++)
+    {
+        if (current.alarm[side] != _sent.alarm[side])
+        {
+            snprintf(data, sizeof(data), "{\"side\":\"%s\",\"active\":%s}", side == RIGHT_SIDE ? "right" : "left",
+                     current.alarm[side] ? "true" : "false");
+            broadcast("alarm", data);
+        }
+    }
+
+    for (uint8_t i = 0; i < WIRE_COUNT; i++)
+    {
+        bool cut = current.wires & (1 << i);
+        if (cut != (bool)(_sent.wires & (1 << i)))
+        {
+            snprintf(data, sizeof(data), "{\"wire\":\"%s\",\"cut\":%s}", WIRE_NAMES[i], cut ? "true" : "false");
+            broadcast("wire", data);
+        }
+    }
+
+    if (current.status != _sent.status)
+    {
+        snprintf(data, sizeof(data), "{\"status\":%u}", current.status);
+        broadcast("status", data);
+    }
+
+    if (current.queue != _sent.queue)
+    {
+        snprintf(data, sizeof(data), "{\"size\":%u}", current.queue);
+        broadcast("queue", data);
+    }
+
+    _sent = current;
+
+    if (now - _lastEvent >= EVENT_HEARTBEAT_INTERVAL)
+    {
+        snprintf(data, sizeof(data), "{\"uptime\":%lu}", (unsigned long)(now / 1000));
+        broadcast("heartbeat", data);
+    }
+
+    for (uint8_t i = 0; i < MAX_EVENT_CLIENTS; i++)
+    {
+        if (_clients[i].active)
+            flushClient(_clients[i]);
+    }
+}
+
+EventStreamStats EventStream::getStats()
+{
+    return _stats;
+}
+
+// Private Helpers
+void EventStream::onBusEvent(const BusEvent& event)
+{
+    // The deltas still come from the state, the event only says to look now
+    _changed = true;
+}
+
+void EventStream::takeSnapshot(Snapshot& snapshot)
+{
+    for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
+        snapshot.triggered[i] = alarmSystem.isSensorTriggered(i + 1);
+
+    snapshot.alarm[RIGHT_SIDE] = alarmSystem.isAlarmActive(RIGHT_SIDE);
+    snapshot.alarm[LEFT_SIDE] = alarmSystem.isAlarmActive(LEFT_SIDE);
+
+    WireCutStatus wires = alarmSystem.getWireCutStatus();
+    const bool cut[WIRE_COUNT] = {wires.rightSideRightBox, wires.rightSideLeftBox, wires.leftSideRightBox,
+                                  wires.leftSideLeftBox, wires.rightSideDistribution, wires.leftSideDistribution};
+    snapshot.wires = 0;
+    for (uint8_t i = 0; i < WIRE_COUNT; i++)
+    {
+        if (cut[i])
+            snapshot.wires |= 1 << i;
+    }
+
+    snapshot.status = static_cast<uint8_t>(alarmSystem.getStatus());
+    snapshot.queue = telegramHandler.getQueueSize();
+}
+
+void EventStream::sendHello(Client& client)
+{
+    // Full state in one event, the deltas that follow build on it
+    String data = "{\"triggered\":[";
+    bool first = true;
+    for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
+    {
+        if (!_sent.triggered[i])
+            continue;
+        data += (first ? "" : ",") + String(i + 1);
+        first = false;
+    }
+    data += "],\"alarm\":{\"right\":" + String(_sent.alarm[RIGHT_SIDE] ? "true" : "false");
+    data += ",\"left\":" + String(_sent.alarm[LEFT_SIDE] ? "true" : "false") + "},\"wires\":{";
+    for (uint8_t i = 0; i < WIRE_COUNT; i++)
+    {
+        data += (i > 0 ? ",\"" : "\"") + String(WIRE_NAMES[i]) + "\":" + String(_sent.wires & (1 << i) ? "true" : "false");
+    }
+    data += "},\"status\":" + String(_sent.status) + ",\"queue\":" + String(_sent.queue);
+    data += ",\"uptime\":" + String(millis() / 1000) + "}";
+
+    queueEvent(client, "hello", data.c_str());
+}
+
+void EventStream::broadcast(const char* event, const char* data)
+{
+    for (uint8_t i = 0; i < MAX_EVENT_CLIENTS; i++)
+    {
+        if (_clients[i].active)
+            queueEvent(_clients[i], event, data);
+    }
+    _lastEvent = millis();
+}
+
+bool EventStream::queue(Client& client, const char* text, size_t length)
+{
+    // A burst of deltas can outgrow the buffer in one pass, hand what is queued to the socket first
+    if (client.length + length > sizeof(client.buffer))
+        flushClient(client);
+
+    // Only a client whose socket stopped taking data is dropped
+    if (!client.active || client.length + length > sizeof(client.buffer))
+    {
+        dropClient(client, true);
+        return false;
+    }
+
+    memcpy(client.buffer + client.length, text, length);
+    client.length += length;
+    return true;
+}
+
+bool EventStream::queueEvent(Client& client, const char* event, const char* data)
+{
+    if (!client.active)
+        return false;
+
+    String text = "event: " + String(event) + "\ndata: " + String(data) + "\n\n";
+    if (!queue(client, text.c_str(), text.length()))
+        return false;
+
+    _stats.events++;
+    return true;
+}
+
+void EventStream::flushClient(Client& client)
+{
+    if (!client.active || client.length == 0)
+        return;
+
+    // Whatever the socket does not take now stays queued for the next pass
+    int written = send(client.socket, client.buffer, client.length, MSG_DONTWAIT);
+    if (written < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            dropClient(client, false);
+        return;
+    }
+    if (written > 0)
+    {
+        memmove(client.buffer, client.buffer + written, client.length - written);
+        client.length -= written;
+        _stats.bytesSent += written;
+        if (_activityCallback != nullptr)
+            _activityCallback(client.socket);
+    }
+}
+
+void EventStream::dropClient(Client& client, bool overflow)
+{
+    if (!client.active)
+        return;
+
+    if (overflow)
+    {
+        _stats.dropped++;
+        Serial.println("[Events] Dropped a client that could not keep up");
+    }
+
+    // The server sees the connection end and closes the socket
+    shutdown(client.socket, SHUT_RDWR);
+    client.active = false;
+    client.length = 0;
+    _stats.clients--;
+}
+
+// Create a global instance
+EventStream eventStream;
@@ -0,0 +1,102 @@
+// EventStream.h
+
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <Arduino.h>
+#include "ApartmentGrouping.h"
+#include "EventBus.h"
+
+// Event Stream Constants
+#define MAX_EVENT_CLIENTS 4                 // Dashboards connected at the same time
+#define EVENT_CLIENT_BUFFER_SIZE 512        // Events waiting for one client (bytes)
+#define EVENT_CHECK_INTERVAL 200            // How often state is compared for changes (ms)
+#define EVENT_HEARTBEAT_INTERVAL 15000      // Heartbeat when nothing changed (ms)
+#define EVENT_RETRY_DELAY 3000              // Reconnect delay suggested to the browser (ms)
+#define EVENT_DATA_SIZE 160                 // Longest single event (bytes)
+
+// Event stream statistics since boot, shown in /api/status
+struct EventStreamStats {
+    uint32_t connects;
+    uint32_t events;          // Events queued, counted once per client
+    uint32_t bytesSent;
+    uint32_t dropped;         // Clients dropped because their buffer overflowed
+    uint8_t clients;
+};
+
+// Server-Sent Events for the dashboard
+//
+// A browser opens an EventSource on ROUTE_API_EVENTS and gets a "hello" event
+// with the full state, then only compact deltas when something changes:
+// sensor (apartment triggered or cleared), alarm (siren on or off), wire
+// (cut or restored), status (overall system status) and queue (alert queue
+// depth). A heartbeat with the uptime keeps idle connections alive.
+//
+// State is compared against what was last sent every EVENT_CHECK_INTERVAL,
+// so detection never waits for a client, and right away when an alarm event
+// arrives on the event bus. Each client has a fixed buffer; when an event
+// does not fit, the buffer is flushed to the socket first, and only a client
+// whose socket still refuses the data is dropped and reconnects with a fresh
+// hello.
+//
+// The web server hands over the socket of the request and keeps it open;
+// writes never block, and the server reports through removeClient() when a
+// connection closes.
+//
+// The server closes its least recently used socket when a new connection
+// arrives and all HTTP_MAX_CONNECTIONS are open. An event stream never sends
+// another request, so it would always be the one closed; every write that
+// reaches the socket is reported to the onActivity() callback, which marks the
+// socket as used, and idle browser connections are closed first instead.
+// With all MAX_EVENT_CLIENTS connected, HTTP_MAX_CONNECTIONS leaves 4 sockets
+// for page requests; a browser that opens more has its idle ones closed.
+class EventStream {
+public:
+    static void begin();
+    static void addClient(int socket);
+    static void removeClient(int socket);
+    static void update();  // Call this from loop()
+    // Called with the socket whenever data was written to it
+    static void onActivity(void (*callback)(int socket));
+
+    static EventStreamStats getStats();
+
+private:
+    struct Client {
+        int socket;
+        bool active;
+        char buffer[EVENT_CLIENT_BUFFER_SIZE];
+        size_t length;
+    };
+
+    // State the clients have seen
+    struct Snapshot {
+        bool triggered[TOTAL_APARTMENTS];
+        bool alarm[2];
+        uint16_t wires;           // Bit per wire in WIRE_NAMES order, set when cut
+        uint8_t status;
+        uint8_t queue;
+    };
+
+    static Client _clients[MAX_EVENT_CLIENTS];
+    static Snapshot _sent;
+    static uint32_t _lastCheck;
+    static bool _changed;         // An alarm event arrived since the last check
+    static uint32_t _lastEvent;
+    static EventStreamStats _stats;
+    static void (*_activityCallback)(int socket);
+
+    static void onBusEvent(const BusEvent& event);
+    static void takeSnapshot(Snapshot& snapshot);
+    static void sendHello(Client& client);
+    static void broadcast(const char* event, const char* data);
+    static bool queue(Client& client, const char* text, size_t length);
+    static bool queueEvent(Client& client, const char* event, const char* data);
+    static void flushClient(Client& client);
+    static void dropClient(Client& client, bool overflow);
+};
+
+// External declaration for global access
+extern EventStream eventStream;
+
+#endif // EVENT_STREAM_H
@@ -0,0 +1,109 @@
+// HtmlStream.cpp
+
+#include "HtmlStream.h"
+
+// Static member initialization
+size_t HtmlStream::_largestPage = 0;
+
+HtmlStream::HtmlStream(HttpServer& server)
+    : _server(server), _length(0), _bytesSent(0), _started(false), _ended(false)
+{
+}
+
+HtmlStream::~HtmlStream()
+{
+    // A handler that returns early still completes the response
+    if (_started && !_ended)
+        end();
+}
+
+void HtmlStream::begin(int code, const char* contentType)
+{
+    if (_started)
+        return;
+
+    _server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _server.send(code, contentType, "");
+    _started = true;
+}
+
+void HtmlStream::end()
+{
+    if (!_started || _ended)
+        return;
+
+    sendBuffer();
+    _server.sendContent("");
+    _ended = true;
+
+    if (_bytesSent > _largestPage)
+        _largestPage = _bytesSent;
+}
+
+size_t HtmlStream::write(uint8_t c)
+{
+    if (_length == sizeof(_buffer))
+        sendBuffer();
+    _buffer[_length++] = c;
+    return 1;
+}
+
+size_t HtmlStream::write(const uint8_t* data, size_t size)
+{
+    size_t remaining = size;
+    while (remaining > 0)
+    {
+        if (_length == sizeof(_buffer))
+            sendBuffer();
+
+        size_t count = min(remaining, sizeof(_buffer) - _length);
+        memcpy(_buffer + _length, data, count);
+        _length += count;
+        data += count;
+        remaining -= count;
+    }
+    return size;
+}
+
+HtmlStream& HtmlStream::operator+=(const char* text)
+{
+    write((const uint8_t*)text, strlen(text));
+    return *this;
+}
+
+HtmlStream& HtmlStream::operator+=(const String& text)
+{
+    write((const uint8_t*)text.c_str(), text.length());
+    return *this;
+}
+
+HtmlStream& HtmlStream::operator+=(char c)
+{
+    write((uint8_t)c);
+    return *this;
+}
+
+size_t HtmlStream::getBytesSent() const
+{
+    return _bytesSent + _length;
+}
+
+size_t HtmlStream::getLargestPage()
+{
+    return _largestPage;
+}
+
+// Private Helpers
+void HtmlStream::sendBuffer()
+{
+    if (_length == 0)
+        return;
+
+    // Output before begin() would have no headers, start a default page
+    if (!_started)
+        begin();
+
+    _server.sendContent(_buffer, _length);
+    _bytesSent += _length;
+    _length = 0;
+}
@@ -0,0 +1,54 @@
+// HtmlStream.h
+
+#ifndef HTML_STREAM_H
+#define HTML_STREAM_H
+
+#include <Arduino.h>
+#include "HttpServer.h"
+
+// HTML Stream Constants
+#define HTML_STREAM_BUFFER_SIZE 512         // Bytes collected before a chunk is sent
+
+// Writes a page to the client while it is generated
+//
+// Output is collected in a small fixed buffer and sent as one HTTP chunk
+// whenever it fills up, so a page needs HTML_STREAM_BUFFER_SIZE bytes of RAM
+// however long it gets, instead of a String that grows to the full page.
+// Supports += like String so page code reads the same as before.
+class HtmlStream : public Print {
+public:
+    explicit HtmlStream(HttpServer& server);
+    ~HtmlStream();
+
+    // Sends the status line and headers, the body follows chunked
+    void begin(int code = 200, const char* contentType = "text/html");
+    // Sends what is left and the terminating empty chunk
+    void end();
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t size) override;
+    using Print::write;
+
+    HtmlStream& operator+=(const char* text);
+    HtmlStream& operator+=(const String& text);
+    HtmlStream& operator+=(char c);
+
+    size_t getBytesSent() const;
+
+    // Largest page sent since boot (bytes), shown in /api/status
+    static size_t getLargestPage();
+
+private:
+    HttpServer& _server;
+    char _buffer[HTML_STREAM_BUFFER_SIZE];
+    size_t _length;
+    size_t _bytesSent;
+    bool _started;
+    bool _ended;
+
+    static size_t _largestPage;
+
+    void sendBuffer();
+};
+
+#endif // HTML_STREAM_H
@@ -0,0 +1,798 @@
+// HttpServer.cpp
+
+#include "HttpServer.h"
+#include <lwip/sockets.h>
+
+// Alert delivery must always find a socket, whatever the portal has open
+static_assert(HTTP_MAX_CONNECTIONS + HTTP_INTERNAL_SOCKETS + HTTP_RESERVED_SOCKETS <= CONFIG_LWIP_MAX_SOCKETS,
+              "HTTP connections leave too few lwIP sockets for the outgoing clients");
+
+HttpServer::HttpServer(uint16_t port)
+    : _port(port), _handle(nullptr), _routeCount(0), _closeCallback(nullptr), _admitCallback(nullptr),
+      _stats(),
+      _request(nullptr), _argCount(0), _upload(nullptr), _headerCount(0), _chunked(false),
+      _sendFailed(false), _requestStart(0),
+      _handlerRunning(false), _stopping(false)
+{
+    _lock = xSemaphoreCreateRecursiveMutex();
+    _status[0] = '\0';
+}
+
+bool HttpServer::begin()
+{
+    if (_handle != nullptr)
+        return true;
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = _port;
+    config.stack_size = HTTP_TASK_STACK_SIZE;
+    config.max_open_sockets = HTTP_MAX_CONNECTIONS;
+    config.max_uri_handlers = MAX_HTTP_ROUTES;
+    config.max_resp_headers = MAX_HTTP_RESPONSE_HEADERS;
+    config.lru_purge_enable = true;
+    config.recv_wait_timeout = HTTP_RECV_TIMEOUT;
+    config.send_wait_timeout = HTTP_SEND_TIMEOUT;
+    config.global_user_ctx = this;
+    config.global_user_ctx_free_fn = keepContext;
+    config.open_fn = openSocket;
+    config.close_fn = closeSocket;
+
+    _stopping = false;
+    if (httpd_start(&_handle, &config) != ESP_OK)
+    {
+        _handle = nullptr;
+        Serial.println("[HTTP] Failed to start the server");
+        return false;
+    }
+
+    for (uint8_t i = 0; i < _routeCount; i++)
+    {
+        httpd_uri_t uri = {};
+        uri.uri = _routes[i].uri;
+        uri.method = (httpd_method_t)_routes[i].method;
+        uri.handler = dispatch;
+        uri.user_ctx = &_routes[i];
+        if (httpd_register_uri_handler(_handle, &uri) != ESP_OK)
+            Serial.printf("[HTTP] Failed to register %s\n", _routes[i].uri);
+    }
+    httpd_register_err_handler(_handle, HTTPD_404_NOT_FOUND, dispatchNotFound);
+
+    Serial.printf("[HTTP] Listening on port %u\n", _port);
+    return true;
+}
+
+void HttpServer::stop()
+{
+    if (_handle == nullptr)
+        return;
+
+    // Closing the sockets runs the close callback while the caller waits here,
+    // so it must not wait for a lock the caller may be holding
+    _stopping = true;
+    httpd_stop(_handle);
+    _handle = nullptr;
+}
+
+void HttpServer::on(const char* uri, http_method method, HttpHandler handler)
+{
+    on(uri, method, handler, nullptr);
+}
+
+void HttpServer::on(const char* uri, http_method method, HttpHandler handler, HttpHandler uploadHandler)
+{
+    addRoute(uri, method, handler, uploadHandler, true);
+}
+
+void HttpServer::onUnlocked(const char* uri, http_method method, HttpHandler handler)
+{
+    addRoute(uri, method, handler, nullptr, false);
+}
+
+void HttpServer::addRoute(const char* uri, http_method method, HttpHandler handler, HttpHandler uploadHandler,
+                          bool locked)
+{
+    if (_routeCount >= MAX_HTTP_ROUTES)
+    {
+        Serial.printf("[HTTP] Route table full, %s not registered\n", uri);
+        return;
+    }
+
+    Route& route = _routes[_routeCount++];
+    route.uri = uri;
+    route.method = method;
+    route.handler = handler;
+    route.uploadHandler = uploadHandler;
+    route.locked = locked;
+}
+
+void HttpServer::onNotFound(HttpHandler handler)
+{
+    _notFoundHandler = handler;
+}
+
+void HttpServer::onClose(void (*callback)(int socket))
+{
+    _closeCallback = callback;
+}
+
+void HttpServer::onAdmit(bool (*callback)())
+{
+    _admitCallback = callback;
+}
+
+// Request
+String HttpServer::uri()
+{
+    if (_request == nullptr)
+        return String();
+
+    String path = _request->uri;
+    int query = path.indexOf('?');
+    if (query >= 0)
+        path.remove(query);
+    return path;
+}
+
+http_method HttpServer::method()
+{
+    return _request != nullptr ? (http_method)_request->method : HTTP_GET;
+}
+
+bool HttpServer::hasArg(const String& name)
+{
+    for (uint8_t i = 0; i < _argCount; i++)
+    {
+        if (_args[i].name == name)
+            return true;
+    }
+    return false;
+}
+
+String HttpServer::arg(const String& name)
+{
+    for (uint8_t i = 0; i < _argCount; i++)
+    {
+        if (_args[i].name == name)
+            return _args[i].value;
+    }
+    return String();
+}
+
+bool HttpServer::hasHeader(const char* name)
+{
+    return _request != nullptr && httpd_req_get_hdr_value_len(_request, name) > 0;
+}
+
+String HttpServer::header(const char* name)
+{
+    if (_request == nullptr)
+        return String();
+
+    size_t length = httpd_req_get_hdr_value_len(_request, name);
+    if (length == 0)
+        return String();
+
+    char* value = (char*)malloc(length + 1);
+    if (value == nullptr)
+        return String();
+
+    String result;
+    if (httpd_req_get_hdr_value_str(_request, name, value, length + 1) == ESP_OK)
+        result = value;
+    free(value);
+    return result;
+}
+
+String HttpServer::remoteIP()
+{
+    int socket = clientSocket();
+    if (socket < 0)
+        return String();
+
+    struct sockaddr_storage address;
+    socklen_t length = sizeof(address);
+    if (getpeername(socket, (struct sockaddr*)&address, &length) != 0)
+        return String();
+
+    char text[INET6_ADDRSTRLEN];
+    if (address.ss_family == AF_INET)
+    {
+        inet_ntop(AF_INET, &((struct sockaddr_in*)&address)->sin_addr, text, sizeof(text));
+        return String(text);
+    }
+
+    // The server listens on IPv6, IPv4 clients show up as ::ffff:a.b.c.d
+    const uint8_t* bytes = ((struct sockaddr_in6*)&address)->sin6_addr.s6_addr;
+    static const uint8_t V4_MAPPED[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    if (memcmp(bytes, V4_MAPPED, sizeof(V4_MAPPED)) == 0)
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[12], bytes[13], bytes[14], bytes[15]);
+    else
+        inet_ntop(AF_INET6, bytes, text, sizeof(text));
+    return String(text);
+}
+
+int HttpServer::clientSocket()
+{
+    return _request != nullptr ? httpd_req_to_sockfd(_request) : -1;
+}
+
+void HttpServer::markActive(int socket)
+{
+    // A socket kept open after its request never counts as used again on its own
+    if (_handle != nullptr)
+        httpd_sess_update_lru_counter(_handle, socket);
+}
+
+HttpUpload& HttpServer::upload()
+{
+    // Only called from an upload handler, while a file part is being received
+    return *_upload;
+}
+
+// Response
+void HttpServer::sendHeader(const String& name, const String& value)
+{
+    if (_headerCount >= MAX_HTTP_RESPONSE_HEADERS)
+    {
+        Serial.printf("[HTTP] Too many headers, %s dropped\n", name.c_str());
+        return;
+    }
+
+    _headers[_headerCount].name = name;
+    _headers[_headerCount].value = value;
+    _headerCount++;
+}
+
+void HttpServer::setContentLength(size_t length)
+{
+    // A known length is taken from the content passed to send()
+    _chunked = length == CONTENT_LENGTH_UNKNOWN;
+}
+
+void HttpServer::send(int code, const char* contentType, const String& content)
+{
+    if (_request == nullptr)
+        return;
+
+    startResponse(code, contentType);
+    if (_chunked)
+    {
+        // Headers go out with the first chunk
+        if (content.length() > 0)
+            sendContent(content);
+        return;
+    }
+
+    if (_handlerRunning)
+        unlock();
+    httpd_resp_send(_request, content.c_str(), content.length());
+    if (_handlerRunning)
+        lock();
+}
+
+void HttpServer::send_P(int code, const char* contentType, PGM_P content, size_t length)
+{
+    if (_request == nullptr)
+        return;
+
+    // Flash is memory mapped, the data can be sent in place
+    startResponse(code, contentType);
+    if (_handlerRunning)
+        unlock();
+    httpd_resp_send(_request, content, length);
+    if (_handlerRunning)
+        lock();
+}
+
+void HttpServer::sendContent(const char* content, size_t length)
+{
+    if (_request == nullptr)
+        return;
+
+    // A client that stopped reading gets nothing more, the rest of the handler runs without waiting on it
+    if (_sendFailed)
+        return;
+    if (isPastDeadline())
+    {
+        _sendFailed = true;
+        _stats.timeouts++;
+        return;
+    }
+
+    // An empty chunk ends the response
+    if (_handlerRunning)
+        unlock();
+    if (httpd_resp_send_chunk(_request, length > 0 ? content : nullptr, length) != ESP_OK)
+        _sendFailed = true;
+    if (_handlerRunning)
+        lock();
+}
+
+void HttpServer::sendContent(const String& content)
+{
+    sendContent(content.c_str(), content.length());
+}
+
+void HttpServer::lock()
+{
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+}
+
+void HttpServer::unlock()
+{
+    xSemaphoreGiveRecursive(_lock);
+}
+
+HttpServerStats HttpServer::getStats()
+{
+    return _stats;
+}
+
+// Server Task Callbacks
+esp_err_t HttpServer::dispatch(httpd_req_t* request)
+{
+    HttpServer* server = (HttpServer*)httpd_get_global_user_ctx(request->handle);
+    return server->handleRequest(request, (const Route*)request->user_ctx);
+}
+
+esp_err_t HttpServer::dispatchNotFound(httpd_req_t* request, httpd_err_code_t error)
+{
+    HttpServer* server = (HttpServer*)httpd_get_global_user_ctx(request->handle);
+    return server->handleRequest(request, nullptr);
+}
+
+esp_err_t HttpServer::openSocket(httpd_handle_t handle, int socket)
+{
+    HttpServer* server = (HttpServer*)httpd_get_global_user_ctx(handle);
+    server->_stats.connections++;
+    return ESP_OK;
+}
+
+void HttpServer::closeSocket(httpd_handle_t handle, int socket)
+{
+    HttpServer* server = (HttpServer*)httpd_get_global_user_ctx(handle);
+    if (server->_closeCallback != nullptr)
+    {
+        if (!server->_stopping)
+            server->lock();
+        server->_closeCallback(socket);
+        if (!server->_stopping)
+            server->unlock();
+    }
+
+    if (server->_stats.connections > 0)
+        server->_stats.connections--;
+    close(socket);
+}
+
+void HttpServer::keepContext(void* context)
+{
+    // The server object outlives the task, nothing to free
+}
+
+// Private Helpers
+esp_err_t HttpServer::handleRequest(httpd_req_t* request, const Route* route)
+{
+    _request = request;
+    _argCount = 0;
+    _headerCount = 0;
+    _chunked = false;
+    _sendFailed = false;
+    _requestStart = millis();
+    _stats.requests++;
+    uint32_t start = micros();
+
+    size_t queryLength = httpd_req_get_url_query_len(request);
+    if (queryLength > 0)
+    {
+        char* query = (char*)malloc(queryLength + 1);
+        if (query != nullptr && httpd_req_get_url_query_str(request, query, queryLength + 1) == ESP_OK)
+            parseArgs(query, queryLength);
+        free(query);
+    }
+
+    // The body is read before taking the lock, a slow client holds up the server task but not the main loop
+    bool ok = true;
+    String contentType = header("Content-Type");
+    if (_admitCallback != nullptr && !_admitCallback())
+    {
+        // A refused request never reads its body, the connection is closed instead
+        sendHeader("Retry-After", String(HTTP_SHED_RETRY_AFTER));
+        ok = fail(503, "Service temporarily unavailable, low memory");
+    }
+    else if (route != nullptr && route->uploadHandler && contentType.startsWith("multipart/form-data"))
+        ok = readMultipart(*route, contentType);
+    else if (request->content_len > 0)
+        ok = readForm(contentType);
+
+    if (ok)
+    {
+        bool locked = route == nullptr || route->locked;
+        if (locked)
+            lock();
+        _handlerRunning = locked;
+        if (route != nullptr)
+            route->handler();
+        else if (_notFoundHandler)
+            _notFoundHandler();
+        else
+            send(404, "text/plain", "Not Found");
+        _handlerRunning = false;
+        if (locked)
+            unlock();
+        if (_sendFailed)
+            ok = false;
+    }
+
+    for (uint8_t i = 0; i < _argCount; i++)
+        _args[i] = Arg();
+    for (uint8_t i = 0; i < _headerCount; i++)
+        _headers[i] = Header();
+    _argCount = 0;
+    _headerCount = 0;
+    delete _upload;
+    _upload = nullptr;
+    _request = nullptr;
+    Metrics::observe(_stats.latency, micros() - start);
+
+    // A body that was not read completely or a response cut short leaves the connection unusable, the server closes it
+    return ok ? ESP_OK : ESP_FAIL;
+}
+
+bool HttpServer::readForm(const String& contentType)
+{
+    size_t length = _request->content_len;
+    if (length > HTTP_MAX_FORM_SIZE)
+    {
+        _stats.rejected++;
+        return fail(413, "Request body too large");
+    }
+
+    char* body = (char*)malloc(length + 1);
+    if (body == nullptr)
+        return fail(500, "Out of memory");
+
+    size_t received = 0;
+    while (received < length)
+    {
+        int count = receive(body + received, length - received);
+        if (count < 0)
+        {
+            free(body);
+            return false;
+        }
+        received += count;
+    }
+    body[length] = '\0';
+
+    if (contentType.startsWith("application/x-www-form-urlencoded"))
+        parseArgs(body, length);
+    else
+        addArg("plain", String(body));
+
+    free(body);
+    return true;
+}
+
+bool HttpServer::readMultipart(const Route& route, const String& contentType)
+{
+    if (_request->content_len > HTTP_MAX_UPLOAD_SIZE)
+    {
+        _stats.rejected++;
+        return fail(413, "Upload too large");
+    }
+
+    int start = contentType.indexOf("boundary=");
+    if (start < 0)
+        return fail(400, "Missing multipart boundary");
+
+    String boundary = contentType.substring(start + 9);
+    int end = boundary.indexOf(';');
+    if (end >= 0)
+        boundary.remove(end);
+    boundary.trim();
+    if (boundary.startsWith("\"") && boundary.endsWith("\"") && boundary.length() >= 2)
+        boundary = boundary.substring(1, boundary.length() - 1);
+    if (boundary.length() == 0 || boundary.length() > 70)
+        return fail(400, "Invalid multipart boundary");
+
+    // Every delimiter is CRLF "--" boundary; the boundary never contains CR,
+    // so a mismatch can only restart the match at the current byte
+    const String delimiter = "\r\n--" + boundary;
+    const char* delim = delimiter.c_str();
+    const size_t delimLength = delimiter.length();
+
+    enum { PREAMBLE, HEADERS, DATA, AFTER_DELIMITER, DONE } state = PREAMBLE;
+    size_t matched = 2;       // The body starts with the first delimiter, without the CRLF
+    String partHeaders;
+    String fieldName;
+    String fieldValue;
+    bool isFile = false;
+    char suffix[2];
+    uint8_t suffixLength = 0;
+
+    auto flushUpload = [&]() {
+        if (_upload->currentSize == 0)
+            return;
+        _upload->status = HTTP_UPLOAD_WRITE;
+        lock();
+        route.uploadHandler();
+        unlock();
+        _upload->currentSize = 0;
+    };
+
+    auto emit = [&](const char* data, size_t length) {
+        if (!isFile)
+        {
+            if (fieldValue.length() + length <= HTTP_MAX_FORM_SIZE)
+                fieldValue.concat(data, length);
+            return;
+        }
+        _upload->totalSize += length;
+        while (length > 0)
+        {
+            size_t count = min(length, sizeof(_upload->buf) - _upload->currentSize);
+            memcpy(_upload->buf + _upload->currentSize, data, count);
+            _upload->currentSize += count;
+            data += count;
+            length -= count;
+            if (_upload->currentSize == sizeof(_upload->buf))
+                flushUpload();
+        }
+    };
+
+    auto abortUpload = [&]() {
+        if (state == DATA && isFile)
+        {
+            _upload->status = HTTP_UPLOAD_ABORTED;
+            lock();
+            route.uploadHandler();
+            unlock();
+        }
+    };
+
+    char buffer[512];
+    size_t remaining = _request->content_len;
+    while (remaining > 0 && state != DONE)
+    {
+        int count = receive(buffer, min(remaining, sizeof(buffer)));
+        if (count < 0)
+        {
+            abortUpload();
+            return false;
+        }
+        remaining -= count;
+
+        for (int i = 0; i < count && state != DONE; i++)
+        {
+            char c = buffer[i];
+
+            if (state == PREAMBLE || state == DATA)
+            {
+                if (c == delim[matched])
+                {
+                    if (++matched < delimLength)
+                        continue;
+
+                    // End of a part
+                    if (state == DATA && isFile)
+                    {
+                        flushUpload();
+                        _upload->status = HTTP_UPLOAD_END;
+                        lock();
+                        route.uploadHandler();
+                        unlock();
+                    }
+                    else if (state == DATA && fieldName.length() > 0)
+                    {
+                        addArg(fieldName, fieldValue);
+                    }
+                    state = AFTER_DELIMITER;
+                    suffixLength = 0;
+                    matched = 0;
+                    continue;
+                }
+
+                // The partial match was data after all
+                if (state == DATA && matched > 0)
+                    emit(delim, matched);
+                matched = c == delim[0] ? 1 : 0;
+                if (state == DATA && matched == 0)
+                    emit(&c, 1);
+            }
+            else if (state == AFTER_DELIMITER)
+            {
+                suffix[suffixLength++] = c;
+                if (suffixLength < 2)
+                    continue;
+
+                if (suffix[0] == '-' && suffix[1] == '-')
+                {
+                    state = DONE;
+                }
+                else if (suffix[0] == '\r' && suffix[1] == '\n')
+                {
+                    state = HEADERS;
+                    partHeaders = "";
+                }
+                else
+                {
+                    return fail(400, "Malformed multipart body");
+                }
+            }
+            else if (state == HEADERS)
+            {
+                partHeaders += c;
+                if (partHeaders.length() > 1024)
+                    return fail(400, "Multipart headers too large");
+                if (!partHeaders.endsWith("\r\n\r\n"))
+                    continue;
+
+                fieldName = getHeaderParam(partHeaders, " name=\"");
+                String filename = getHeaderParam(partHeaders, "filename=\"");
+                isFile = partHeaders.indexOf("filename=\"") >= 0;
+                fieldValue = "";
+                state = DATA;
+
+                if (isFile)
+                {
+                    if (_upload == nullptr)
+                        _upload = new HttpUpload();
+                    _upload->status = HTTP_UPLOAD_START;
+                    _upload->name = fieldName;
+                    _upload->filename = filename;
+                    _upload->totalSize = 0;
+                    _upload->currentSize = 0;
+                    lock();
+                    route.uploadHandler();
+                    unlock();
+                }
+            }
+        }
+    }
+
+    if (state != DONE)
+    {
+        abortUpload();
+        return fail(400, "Incomplete multipart body");
+    }
+
+    // Whatever follows the closing delimiter is ignored
+    while (remaining > 0)
+    {
+        int count = receive(buffer, min(remaining, sizeof(buffer)));
+        if (count < 0)
+            return false;
+        remaining -= count;
+    }
+    return true;
+}
+
+int HttpServer::receive(char* buffer, size_t length)
+{
+    // A client trickling its body in still has to finish within the deadline
+    int count = isPastDeadline() ? HTTPD_SOCK_ERR_TIMEOUT : httpd_req_recv(_request, buffer, length);
+    if (count == HTTPD_SOCK_ERR_TIMEOUT)
+    {
+        _stats.timeouts++;
+        fail(408, "Request timeout");
+        return -1;
+    }
+    return count > 0 ? count : -1;
+}
+
+void HttpServer::parseArgs(const char* text, size_t length)
+{
+    size_t start = 0;
+    while (start < length)
+    {
+        const char* separator = (const char*)memchr(text + start, '&', length - start);
+        size_t end = separator != nullptr ? separator - text : length;
+
+        const char* equals = (const char*)memchr(text + start, '=', end - start);
+        if (equals != nullptr)
+        {
+            size_t nameEnd = equals - text;
+            addArg(urlDecode(text + start, nameEnd - start), urlDecode(equals + 1, end - nameEnd - 1));
+        }
+        else if (end > start)
+        {
+            addArg(urlDecode(text + start, end - start), String());
+        }
+
+        start = end + 1;
+    }
+}
+
+void HttpServer::addArg(const String& name, const String& value)
+{
+    if (_argCount >= MAX_HTTP_ARGS)
+        return;
+
+    _args[_argCount].name = name;
+    _args[_argCount].value = value;
+    _argCount++;
+}
+
+void HttpServer::startResponse(int code, const char* contentType)
+{
+    snprintf(_status, sizeof(_status), "%d %s", code, getReason(code));
+    httpd_resp_set_status(_request, _status);
+    if (code >= 200 && code < 600)
+        _stats.responses[code / 100 - 2]++;
+
+    if (contentType != nullptr)
+    {
+        _contentType = contentType;
+        httpd_resp_set_type(_request, _contentType.c_str());
+    }
+
+    // The server keeps pointers to the header strings until the response is sent
+    for (uint8_t i = 0; i < _headerCount; i++)
+        httpd_resp_set_hdr(_request, _headers[i].name.c_str(), _headers[i].value.c_str());
+}
+
+bool HttpServer::fail(int code, const char* message)
+{
+    send(code, "text/plain", message);
+    return false;
+}
+
+bool HttpServer::isPastDeadline() const
+{
+    return millis() - _requestStart >= HTTP_REQUEST_DEADLINE;
+}
+
+String HttpServer::getHeaderParam(const String& headers, const char* key)
+{
+    int start = headers.indexOf(key);
+    if (start < 0)
+        return String();
+
+    start += strlen(key);
+    int end = headers.indexOf('"', start);
+    return end >= 0 ? headers.substring(start, end) : String();
+}
+
+String HttpServer::urlDecode(const char* text, size_t length)
+{
+    String result;
+    result.reserve(length);
+
+    for (size_t i = 0; i < length; i++)
+    {
+        char c = text[i];
+        if (c == '+')
+        {
+            c = ' ';
+        }
+        else if (c == '%' && i + 2 < length && isxdigit(text[i + 1]) && isxdigit(text[i + 2]))
+        {
+            char hex[3] = {text[i + 1], text[i + 2], '\0'};
+            c = (char)strtol(hex, nullptr, 16);
+            i += 2;
+        }
+        result += c;
+    }
+    return result;
+}
+
+const char* HttpServer::getReason(int code)
+{
+    switch (code)
+    {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 408: return "Request Timeout";
+    case 413: return "Payload Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+    }
+}
@@ -0,0 +1,192 @@
+// HttpServer.h
+
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <Arduino.h>
+#include <esp_http_server.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <functional>
+#include "Metrics.h"
+
+// HTTP Server Constants
+#define MAX_HTTP_ROUTES 40                  // Routes registered with on()
+#define MAX_HTTP_ARGS 32                    // Query and form fields kept per request
+#define MAX_HTTP_RESPONSE_HEADERS 8         // sendHeader() calls per response
+#define HTTP_MAX_CONNECTIONS 8              // Open sockets, the least recently used is closed for a new one
+#define HTTP_INTERNAL_SOCKETS 3             // The server's listening and control sockets
+#define HTTP_RESERVED_SOCKETS 5             // Left for outgoing clients: Telegram sender and poll task, MQTT, webhook, one spare
+#define HTTP_MAX_FORM_SIZE 4096             // Largest form body accepted (bytes)
+#define HTTP_MAX_UPLOAD_SIZE 16384          // Largest multipart upload accepted (bytes)
+#define HTTP_UPLOAD_BUFFER_SIZE 1024        // Upload bytes passed to the handler at a time
+#define HTTP_RECV_TIMEOUT 2                 // Longest wait for one piece of a request body (s)
+#define HTTP_SEND_TIMEOUT 2                 // Longest wait for the client to take one response chunk (s)
+#define HTTP_REQUEST_DEADLINE 5000          // Longest time one request may hold the server task (ms)
+#define HTTP_TASK_STACK_SIZE 8192           // Route handlers run on this stack (bytes)
+#define HTTP_SHED_RETRY_AFTER 30            // Retry-After of a request refused by the admission check (s)
+
+#ifndef CONTENT_LENGTH_UNKNOWN
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#endif
+
+typedef std::function<void(void)> HttpHandler;
+
+enum HttpUploadStatus {
+    HTTP_UPLOAD_START,
+    HTTP_UPLOAD_WRITE,
+    HTTP_UPLOAD_END,
+    HTTP_UPLOAD_ABORTED
+};
+
+// File part of a multipart request, passed to the upload handler piece by piece
+struct HttpUpload {
+    HttpUploadStatus status;
+    String name;              // Form field
+    String filename;
+    size_t totalSize;         // Bytes received so far
+    size_t currentSize;       // Bytes in buf
+    uint8_t buf[HTTP_UPLOAD_BUFFER_SIZE];
+};
+
+// HTTP server statistics since boot, shown in /api/status and /metrics
+struct HttpServerStats {
+    uint32_t requests;
+    uint32_t rejected;        // Bodies over the size limits (413)
+    uint32_t timeouts;        // Clients that stalled mid-request (408) or ran past HTTP_REQUEST_DEADLINE
+    uint8_t connections;      // Sockets open right now
+    uint32_t responses[4];    // By status class, 2xx to 5xx
+    MetricHistogram latency;  // Request received to handler done
+};
+
+// Event-driven HTTP server running in its own task
+//
+// Wraps the ESP-IDF server (esp_http_server), which waits on all sockets at
+// once in a dedicated task, so a slow or stalled client never holds up the
+// main loop. The API follows the parts of the Arduino WebServer the portal
+// uses, so route handlers read the same as before.
+//
+// Requests are still served one at a time by that task: while a client is
+// slow to send its body or to take the response, every other socket waits.
+// Short socket timeouts and HTTP_REQUEST_DEADLINE only bound that wait, one
+// slow phone on the access point can still stall the portal for up to the
+// deadline. A request that runs past it is answered 408 or cut off, and its
+// connection closed.
+//
+// Handlers run in the server task while holding the shared lock; the main
+// loop holds the same lock while it updates, so state does not change while
+// a handler is producing output. The lock is released while each chunk of a
+// response is on the wire, though, so a page streamed in several chunks can
+// show state from before and after a loop iteration. Handlers that need one
+// consistent view copy a snapshot first, as the /api paths do. Routes
+// registered with onUnlocked() skip the lock altogether.
+class HttpServer {
+public:
+    explicit HttpServer(uint16_t port);
+
+    bool begin();
+    void stop();
+
+    void on(const char* uri, http_method method, HttpHandler handler);
+    void on(const char* uri, http_method method, HttpHandler handler, HttpHandler uploadHandler);
+    // For handlers that touch no shared state, they run without the lock
+    void onUnlocked(const char* uri, http_method method, HttpHandler handler);
+    void onNotFound(HttpHandler handler);
+    // Called with the socket when a connection closes, under the lock
+    void onClose(void (*callback)(int socket));
+    // Called before the body is read, without the lock; false answers 503
+    void onAdmit(bool (*callback)());
+
+    // Current request, only valid inside a handler
+    String uri();
+    http_method method();
+    bool hasArg(const String& name);
+    String arg(const String& name);
+    bool hasHeader(const char* name);
+    String header(const char* name);
+    String remoteIP();
+    int clientSocket();                         // Socket of the request, stays open after the handler
+    void markActive(int socket);                // Keeps a handed-over socket from being the least recently used
+    HttpUpload& upload();
+
+    // Response
+    void sendHeader(const String& name, const String& value);
+    void setContentLength(size_t length);       // CONTENT_LENGTH_UNKNOWN sends the body chunked
+    void send(int code, const char* contentType = nullptr, const String& content = String());
+    void send_P(int code, const char* contentType, PGM_P content, size_t length);
+    void sendContent(const char* content, size_t length);
+    void sendContent(const String& content);
+
+    // Shared state lock, recursive
+    void lock();
+    void unlock();
+
+    HttpServerStats getStats();
+
+private:
+    struct Route {
+        const char* uri;
+        http_method method;
+        HttpHandler handler;
+        HttpHandler uploadHandler;
+        bool locked;
+    };
+
+    struct Arg {
+        String name;
+        String value;
+    };
+
+    struct Header {
+        String name;
+        String value;
+    };
+
+    uint16_t _port;
+    httpd_handle_t _handle;
+    SemaphoreHandle_t _lock;
+    Route _routes[MAX_HTTP_ROUTES];
+    uint8_t _routeCount;
+    HttpHandler _notFoundHandler;
+    void (*_closeCallback)(int socket);
+    bool (*_admitCallback)();
+    HttpServerStats _stats;
+
+    // Request state
+    httpd_req_t* _request;
+    Arg _args[MAX_HTTP_ARGS];
+    uint8_t _argCount;
+    HttpUpload* _upload;
+    Header _headers[MAX_HTTP_RESPONSE_HEADERS];
+    uint8_t _headerCount;
+    String _contentType;
+    char _status[40];
+    bool _chunked;
+    bool _sendFailed;         // The client stopped taking data or the deadline passed, nothing more is sent
+    uint32_t _requestStart;   // millis(), for HTTP_REQUEST_DEADLINE
+    bool _handlerRunning;     // The lock is released while a response is sent
+    volatile bool _stopping;
+
+    static esp_err_t dispatch(httpd_req_t* request);
+    static esp_err_t dispatchNotFound(httpd_req_t* request, httpd_err_code_t error);
+    static esp_err_t openSocket(httpd_handle_t handle, int socket);
+    static void closeSocket(httpd_handle_t handle, int socket);
+    static void keepContext(void* context);
+
+    esp_err_t handleRequest(httpd_req_t* request, const Route* route);
+    bool readForm(const String& contentType);
+    void addRoute(const char* uri, http_method method, HttpHandler handler, HttpHandler uploadHandler, bool locked);
+    bool readMultipart(const Route& route, const String& contentType);
+    int receive(char* buffer, size_t length);
+    void parseArgs(const char* text, size_t length);
+    void addArg(const String& name, const String& value);
+    void startResponse(int code, const char* contentType);
+    bool fail(int code, const char* message);
+    bool isPastDeadline() const;
+
+    static String getHeaderParam(const String& headers, const char* key);
+    static String urlDecode(const char* text, size_t length);
+    static const char* getReason(int code);
+};
+
+#endif // HTTP_SERVER_H
@@ -0,0 +1,324 @@
+// JsonStream.cpp
+
+#include "JsonStream.h"
+
+void JsonStream::begin(JsonCallback callback, void* context)
+{
+    _callback = callback;
+    _context = context;
+    _state = STATE_VALUE;
+    _depth = 0;
+    _arrayMask = 0;
+    _expectKey = false;
+    _stringIsKey = false;
+    _valueIsString = false;
+    _truncated = false;
+    _unicodeDigits = 0;
+    _codepoint = 0;
+    _value[0] = '\0';
+    _valueLength = 0;
+}
+
+bool JsonStream::feed(char c)
+{
+    switch (_state)
+    {
+    case STATE_DONE:
+        // Only whitespace may follow the top level value
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            return true;
+        _state = STATE_ERROR;
+        return false;
+
+    case STATE_ERROR:
+        return false;
+
+    case STATE_STRING:
+        if (c == '"')
+        {
+            _state = STATE_VALUE;
+            finishString();
+        }
+        else if (c == '\\')
+        {
+            _state = STATE_ESCAPE;
+        }
+        else
+        {
+            append(c);
+        }
+        return true;
+
+    case STATE_ESCAPE:
+        _state = STATE_STRING;
+        switch (c)
+        {
+        case 'n': append('\n'); break;
+        case 't': append('\t'); break;
+        case 'r': append('\r'); break;
+        case 'b': append('\b'); break;
+        case 'f': append('\f'); break;
+        case 'u':
+            _state = STATE_UNICODE;
+            _unicodeDigits = 0;
+            _codepoint = 0;
+            break;
+        default: append(c); break; // \" \\ and \/
+        }
+        return true;
+
+    case STATE_UNICODE:
+    {
+        uint8_t digit;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            digit = c - 'A' + 10;
+        else
+        {
+            _state = STATE_ERROR;
+            return false;
+        }
+
+        _codepoint = (_codepoint << 4) | digit;
+        if (++_unicodeDigits == 4)
+        {
+            appendCodepoint(_codepoint);
+            _state = STATE_STRING;
+        }
+        return true;
+    }
+
+    case STATE_SCALAR:
+        if (isAlphaNumeric(c) || c == '+' || c == '-' || c == '.')
+        {
+            append(c);
+            return true;
+        }
+        // The character that ended the number or literal is structural
+        _state = STATE_VALUE;
+        finishScalar();
+        break;
+
+    default:
+        break;
+    }
+
+    switch (c)
+    {
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+        return true;
+
+    case '{':
+        return openContainer(false);
+
+    case '[':
+        return openContainer(true);
+
+    case '}':
+        return closeContainer(false);
+
+    case ']':
+        return closeContainer(true);
+
+    case ',':
+        if (_depth == 0)
+            break;
+        if (inArray())
+            _indexes[_depth - 1]++;
+        else
+            _expectKey = true;
+        return true;
+
+    case ':':
+        if (_depth == 0 || inArray())
+            break;
+        _expectKey = false;
+        return true;
+
+    case '"':
+        _stringIsKey = _depth > 0 && !inArray() && _expectKey;
+        _valueIsString = true;
+        _truncated = false;
+        _valueLength = 0;
+        _value[0] = '\0';
+        _state = STATE_STRING;
+        return true;
+
+    default:
+        if (!isAlphaNumeric(c) && c != '-')
+            break;
+        _valueIsString = false;
+        _truncated = false;
+        _valueLength = 0;
+        _value[0] = '\0';
+        append(c);
+        _state = STATE_SCALAR;
+        return true;
+    }
+
+    _state = STATE_ERROR;
+    return false;
+}
+
+bool JsonStream::isComplete() const
+{
+    return _state == STATE_DONE;
+}
+
+bool JsonStream::hasError() const
+{
+    return _state == STATE_ERROR;
+}
+
+uint8_t JsonStream::depth() const
+{
+    return _depth;
+}
+
+const char* JsonStream::keyAt(uint8_t level) const
+{
+    if (level < 1 || level > _depth)
+        return "";
+    return _keys[level - 1];
+}
+
+uint16_t JsonStream::indexAt(uint8_t level) const
+{
+    if (level < 1 || level > _depth)
+        return 0;
+    return _indexes[level - 1];
+}
+
+bool JsonStream::isPath(const char* k1, const char* k2, const char* k3,
+                        const char* k4, const char* k5, const char* k6) const
+{
+    const char* keys[6] = {k1, k2, k3, k4, k5, k6};
+    uint8_t count = 0;
+    while (count < 6 && keys[count] != nullptr)
+        count++;
+
+    if (_depth != count)
+        return false;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (strcmp(_keys[i], keys[i]) != 0)
+            return false;
+    }
+    return true;
+}
+
+bool JsonStream::isString() const
+{
+    return _valueIsString;
+}
+
+bool JsonStream::isTruncated() const
+{
+    return _truncated;
+}
+
+// Private helpers
+bool JsonStream::openContainer(bool isArray)
+{
+    if (_depth >= JSON_MAX_DEPTH || (_depth > 0 && !inArray() && _expectKey))
+    {
+        _state = STATE_ERROR;
+        return false;
+    }
+
+    if (isArray)
+        _arrayMask |= (1 << _depth);
+    else
+        _arrayMask &= ~(1 << _depth);
+
+    _keys[_depth][0] = '\0';
+    _indexes[_depth] = 0;
+    _depth++;
+    _expectKey = !isArray;
+    return true;
+}
+
+bool JsonStream::closeContainer(bool isArray)
+{
+    if (_depth == 0 || inArray() != isArray)
+    {
+        _state = STATE_ERROR;
+        return false;
+    }
+
+    // Report the container with the path pointing at the container itself
+    _depth--;
+    _expectKey = false;
+    if (_callback)
+        _callback(_context, *this, isArray ? JsonEvent::ARRAY_END : JsonEvent::OBJECT_END, nullptr);
+
+    if (_depth == 0)
+        _state = STATE_DONE;
+    return true;
+}
+
+void JsonStream::append(char c)
+{
+    if (_valueLength >= JSON_VALUE_SIZE - 1)
+    {
+        _truncated = true;
+        return;
+    }
+    _value[_valueLength++] = c;
+    _value[_valueLength] = '\0';
+}
+
+void JsonStream::appendCodepoint(uint16_t codepoint)
+{
+    // Surrogate pairs are outside anything the system needs to read
+    if (codepoint >= 0xD800 && codepoint <= 0xDFFF)
+    {
+        append('?');
+    }
+    else if (codepoint < 0x80)
+    {
+        append((char)codepoint);
+    }
+    else if (codepoint < 0x800)
+    {
+        append((char)(0xC0 | (codepoint >> 6)));
+        append((char)(0x80 | (codepoint & 0x3F)));
+    }
+    else
+    {
+        append((char)(0xE0 | (codepoint >> 12)));
+        append((char)(0x80 | ((codepoint >> 6) & 0x3F)));
+        append((char)(0x80 | (codepoint & 0x3F)));
+    }
+}
+
+void JsonStream::finishString()
+{
+    if (_stringIsKey)
+    {
+        strncpy(_keys[_depth - 1], _value, JSON_KEY_SIZE - 1);
+        _keys[_depth - 1][JSON_KEY_SIZE - 1] = '\0';
+        return;
+    }
+
+    if (_callback)
+        _callback(_context, *this, JsonEvent::VALUE, _value);
+}
+
+void JsonStream::finishScalar()
+{
+    if (_callback)
+        _callback(_context, *this, JsonEvent::VALUE, _value);
+}
+
+bool JsonStream::inArray() const
+{
+    return _depth > 0 && (_arrayMask & (1 << (_depth - 1)));
+}
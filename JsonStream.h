@@ -0,0 +1,78 @@
+// JsonStream.h
+
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <Arduino.h>
+
+// Streaming JSON Tokenizer Constants
+#define JSON_MAX_DEPTH 8         // Maximum nesting of objects and arrays
+#define JSON_KEY_SIZE 24         // Longest tracked key (longer keys are truncated)
+#define JSON_VALUE_SIZE 128      // Longest scalar value (longer values are truncated)
+
+// Events reported while the document is being fed
+enum class JsonEvent {
+    VALUE,          // A string, number, true, false or null value
+    OBJECT_END,     // An object closed; the path still points at it
+    ARRAY_END       // An array closed; the path still points at it
+};
+
+class JsonStream;
+typedef void (*JsonCallback)(void* context, const JsonStream& stream, JsonEvent event, const char* value);
+
+// Incremental JSON tokenizer working byte by byte from fixed buffers, no heap allocation.
+// Every value is reported together with the path of keys leading to it, so callers
+// only copy out the few fields they care about.
+class JsonStream {
+public:
+    void begin(JsonCallback callback, void* context);
+    bool feed(char c);                    // Returns false once the input is not valid JSON
+    bool isComplete() const;              // The top level value has been closed
+    bool hasError() const;
+
+    // Path of the current value
+    uint8_t depth() const;                // Number of enclosing containers
+    const char* keyAt(uint8_t level) const; // Key at level 1..depth, "" inside arrays
+    uint16_t indexAt(uint8_t level) const;  // Element index at level 1..depth, 0 inside objects
+    bool isPath(const char* k1, const char* k2 = nullptr, const char* k3 = nullptr,
+                const char* k4 = nullptr, const char* k5 = nullptr, const char* k6 = nullptr) const;
+    bool isString() const;                // The current value was a quoted string
+    bool isTruncated() const;             // The current value did not fit in the buffer
+
+private:
+    enum State : uint8_t {
+        STATE_VALUE,
+        STATE_STRING,
+        STATE_ESCAPE,
+        STATE_UNICODE,
+        STATE_SCALAR,
+        STATE_DONE,
+        STATE_ERROR
+    };
+
+    JsonCallback _callback;
+    void* _context;
+    State _state;
+    uint8_t _depth;
+    uint8_t _arrayMask;                   // Bit N set when level N+1 is an array
+    bool _expectKey;
+    bool _stringIsKey;
+    bool _valueIsString;
+    bool _truncated;
+    uint8_t _unicodeDigits;
+    uint16_t _codepoint;
+    char _keys[JSON_MAX_DEPTH][JSON_KEY_SIZE];
+    uint16_t _indexes[JSON_MAX_DEPTH];
+    char _value[JSON_VALUE_SIZE];
+    uint8_t _valueLength;
+
+    bool openContainer(bool isArray);
+    bool closeContainer(bool isArray);
+    void append(char c);
+    void appendCodepoint(uint16_t codepoint);
+    void finishString();
+    void finishScalar();
+    bool inArray() const;
+};
+
+#endif // JSON_STREAM_H
@@ -0,0 +1,171 @@
+// JsonWriter.cpp
+
+#include "JsonWriter.h"
+
+JsonWriter::JsonWriter(Print& out)
+    : _out(out), _depth(0), _hasItems(0)
+{
+}
+
+void JsonWriter::beginObject(const char* key)
+{
+    open('{', key);
+}
+
+void JsonWriter::endObject()
+{
+    close('}');
+}
+
+void JsonWriter::beginArray(const char* key)
+{
+    open('[', key);
+}
+
+void JsonWriter::endArray()
+{
+    close(']');
+}
+
+// Scalars
+void JsonWriter::writeKey(const char* key)
+{
+    beginElement();
+    writeString(key);
+    _out.write(':');
+}
+
+void JsonWriter::writeBool(bool value)
+{
+    _out.print(value ? "true" : "false");
+}
+
+void JsonWriter::writeSigned(long long value)
+{
+    char number[24];
+    _out.write((const uint8_t*)number, snprintf(number, sizeof(number), "%lld", value));
+}
+
+void JsonWriter::writeUnsigned(unsigned long long value)
+{
+    char number[24];
+    _out.write((const uint8_t*)number, snprintf(number, sizeof(number), "%llu", value));
+}
+
+void JsonWriter::writeString(const char* text)
+{
+    _out.write('"');
+    writeEscaped(_out, text != nullptr ? text : "");
+    _out.write('"');
+}
+
+void JsonWriter::writeNull()
+{
+    _out.print("null");
+}
+
+// Escaping
+size_t JsonWriter::escapedLength(const char* text)
+{
+    size_t length = 0;
+    for (const uint8_t* c = (const uint8_t*)text; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\' || *c == '\n' || *c == '\r' || *c == '\t')
+            length += 2;
+        else if (*c < 0x20 || *c == '<')
+            length += 6;
+        else
+            length += 1;
+    }
+    return length;
+}
+
+void JsonWriter::writeEscaped(Print& out, const char* text)
+{
+    // Batch the output so a TLS connection doesn't send one record per character
+    char buffer[64];
+    size_t used = 0;
+
+    for (const uint8_t* c = (const uint8_t*)text; *c != '\0'; c++)
+    {
+        // Room for the longest escape, \u00XX
+        if (used > sizeof(buffer) - 6)
+        {
+            out.write((const uint8_t*)buffer, used);
+            used = 0;
+        }
+
+        switch (*c)
+        {
+        case '"':
+        case '\\':
+            buffer[used++] = '\\';
+            buffer[used++] = (char)*c;
+            break;
+        case '\n':
+            buffer[used++] = '\\';
+            buffer[used++] = 'n';
+            break;
+        case '\r':
+            buffer[used++] = '\\';
+            buffer[used++] = 'r';
+            break;
+        case '\t':
+            buffer[used++] = '\\';
+            buffer[used++] = 't';
+            break;
+        default:
+            if (*c < 0x20 || *c == '<')
+            {
+                // Written by hand, snprintf() would need a seventh byte for its NUL
+                static const char HEX_DIGITS[] = "0123456789abcdef";
+                buffer[used++] = '\\';
+                buffer[used++] = 'u';
+                buffer[used++] = '0';
+                buffer[used++] = '0';
+                buffer[used++] = HEX_DIGITS[*c >> 4];
+                buffer[used++] = HEX_DIGITS[*c & 0x0F];
+            }
+            else
+                buffer[used++] = (char)*c;
+            break;
+        }
+    }
+
+    if (used > 0)
+        out.write((const uint8_t*)buffer, used);
+}
+
+// Private Helpers
+void JsonWriter::beginElement()
+{
+    if (_depth == 0 || _depth > JSON_WRITER_MAX_DEPTH)
+        return;
+
+    uint8_t bit = 1 << (_depth - 1);
+    if (_hasItems & bit)
+        _out.write(',');
+    _hasItems |= bit;
+}
+
+void JsonWriter::open(char bracket, const char* key)
+{
+    if (key != nullptr)
+        writeKey(key);
+    else
+        beginElement();
+
+    _out.write(bracket);
+    _depth++;
+    if (_depth <= JSON_WRITER_MAX_DEPTH)
+        _hasItems &= ~(1 << (_depth - 1));
+}
+
+void JsonWriter::close(char bracket)
+{
+    if (_depth == 0)
+        return;
+
+    _out.write(bracket);
+    _depth--;
+}
@@ -0,0 +1,50 @@
+// JsonWriter.h
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+#include "DocumentWriter.h"
+
+// JSON Writer Constants
+#define JSON_WRITER_MAX_DEPTH 8             // Maximum nesting of objects and arrays
+
+// Streaming JSON writer, no heap allocation
+//
+// Writes straight to any Print; for an HTTP response that is an HtmlStream,
+// so the document leaves in HTML_STREAM_BUFFER_SIZE chunks however large it
+// gets. Commas between members and string escaping are handled here, numbers
+// are printed in place instead of going through temporary Strings.
+class JsonWriter : public DocumentWriter {
+public:
+    explicit JsonWriter(Print& out);
+
+    void beginObject(const char* key = nullptr) override;
+    void endObject() override;
+    void beginArray(const char* key = nullptr) override;
+    void endArray() override;
+
+    // Escaping for callers that write JSON by hand; '<' is escaped too, so the
+    // text can go into a <script> block without closing it
+    static size_t escapedLength(const char* text);
+    static void writeEscaped(Print& out, const char* text);
+
+protected:
+    void writeKey(const char* key) override;
+    void beginElement() override;
+    void writeBool(bool value) override;
+    void writeSigned(long long value) override;
+    void writeUnsigned(unsigned long long value) override;
+    void writeString(const char* text) override;
+    void writeNull() override;
+
+private:
+    Print& _out;
+    uint8_t _depth;
+    uint8_t _hasItems;        // Bit N set once level N+1 has a member or element
+
+    void open(char bracket, const char* key);
+    void close(char bracket);
+};
+
+#endif // JSON_WRITER_H
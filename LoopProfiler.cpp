@@ -0,0 +1,162 @@
+// LoopProfiler.cpp
+
+#include "LoopProfiler.h"
+#include "DeferredLog.h"
+#include <esp_system.h>
+
+// Section names as used by the serial report, /api/profile and /metrics
+static const char* const SECTION_NAMES[(uint8_t)LoopSection::COUNT] = {
+    "lock", "wifi", "memory", "alarm", "bus", "notifier", "webPortal", "events", "config"};
+
+// Default budgets (us); the notifiers include a blocking Telegram request,
+// the heap sample a walk of the free list
+static const uint32_t DEFAULT_BUDGETS[(uint8_t)LoopSection::COUNT] = {
+    100000, 50000, 5000, 20000, 20000, 3000000, 20000, 50000, 200000};
+
+// Section in progress, kept across a watchdog reset
+static const uint32_t PROFILER_RTC_MAGIC = 0x50524F46; // "PROF"
+struct ProfilerRtcState {
+    uint32_t magic;
+    int8_t section;           // -1 between sections
+};
+static RTC_NOINIT_ATTR ProfilerRtcState rtcState;
+
+// Static member initialization
+LoopSectionStats LoopProfiler::_sections[(uint8_t)LoopSection::COUNT];
+uint32_t LoopProfiler::_cyclesPerMicro = 240;
+uint32_t LoopProfiler::_lastReport = 0;
+uint32_t LoopProfiler::_lastWarning[(uint8_t)LoopSection::COUNT] = {};
+int8_t LoopProfiler::_resetSection = -1;
+
+void LoopProfiler::begin()
+{
+    _cyclesPerMicro = ESP.getCpuFreqMHz();
+
+    // Only a reset from a stuck loop says anything about the section it stopped in
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (rtcState.magic == PROFILER_RTC_MAGIC && rtcState.section >= 0 &&
+        rtcState.section < (int8_t)LoopSection::COUNT &&
+        (reason == ESP_RST_TASK_WDT || reason == ESP_RST_INT_WDT || reason == ESP_RST_WDT))
+    {
+        _resetSection = rtcState.section;
+        DLOG_WARN("[Profiler] Watchdog reset during loop section '%s'", SECTION_NAMES[_resetSection]);
+    }
+    rtcState.magic = PROFILER_RTC_MAGIC;
+    rtcState.section = -1;
+
+    for (uint8_t i = 0; i < (uint8_t)LoopSection::COUNT; i++)
+        _sections[i].budget = DEFAULT_BUDGETS[i];
+    reset();
+    _lastReport = millis();
+}
+
+void LoopProfiler::update()
+{
+#ifdef LOOP_PROFILING
+    if (LOOP_PROFILER_REPORT_INTERVAL == 0 || millis() - _lastReport < LOOP_PROFILER_REPORT_INTERVAL)
+        return;
+    _lastReport = millis();
+    printReport();
+#endif
+}
+
+void LoopProfiler::enter(LoopSection section)
+{
+    rtcState.section = (int8_t)section;
+}
+
+void LoopProfiler::leave(LoopSection section, uint32_t startCycles, uint32_t startMillis)
+{
+    uint32_t cycles = esp_cpu_get_cycle_count() - startCycles;
+    rtcState.section = -1;
+
+    // The 32-bit cycle counter wraps after about 17 s at 240 MHz
+    uint32_t elapsedMillis = millis() - startMillis;
+    uint64_t total = elapsedMillis > LOOP_CYCLE_WRAP_MS ? (uint64_t)elapsedMillis * 1000 * _cyclesPerMicro : cycles;
+    uint32_t micros = (uint32_t)(total / _cyclesPerMicro);
+
+    LoopSectionStats& stats = _sections[(uint8_t)section];
+    stats.calls++;
+    stats.totalCycles += total;
+    if (total < stats.minCycles)
+        stats.minCycles = total;
+    if (total > stats.maxCycles)
+        stats.maxCycles = total;
+    Metrics::observe(stats.histogram, micros);
+
+    if (micros <= stats.budget)
+        return;
+
+    stats.overBudget++;
+    uint32_t now = millis();
+    if (now - _lastWarning[(uint8_t)section] >= LOOP_PROFILER_WARN_INTERVAL)
+    {
+        _lastWarning[(uint8_t)section] = now;
+        DLOG_WARN("[Profiler] Section '%s' took %u us, budget %u us", SECTION_NAMES[(uint8_t)section],
+                  (unsigned)micros, (unsigned)stats.budget);
+    }
+}
+
+bool LoopProfiler::setBudget(LoopSection section, uint32_t micros)
+{
+    if (section >= LoopSection::COUNT || micros == 0)
+        return false;
+
+    _sections[(uint8_t)section].budget = micros;
+    return true;
+}
+
+uint32_t LoopProfiler::getBudget(LoopSection section)
+{
+    return section < LoopSection::COUNT ? _sections[(uint8_t)section].budget : 0;
+}
+
+LoopSectionStats LoopProfiler::getStats(LoopSection section)
+{
+    return section < LoopSection::COUNT ? _sections[(uint8_t)section] : LoopSectionStats();
+}
+
+const char* LoopProfiler::getSectionName(LoopSection section)
+{
+    return section < LoopSection::COUNT ? SECTION_NAMES[(uint8_t)section] : "unknown";
+}
+
+const char* LoopProfiler::getResetSection()
+{
+    return _resetSection >= 0 ? SECTION_NAMES[_resetSection] : nullptr;
+}
+
+void LoopProfiler::reset()
+{
+    for (uint8_t i = 0; i < (uint8_t)LoopSection::COUNT; i++)
+        clear(_sections[i]);
+}
+
+void LoopProfiler::printReport()
+{
+    // Through the deferred log, the report must not hold up the loop it measures
+    DLOG_INFO("[Profiler] section      calls   min us   avg us   max us  over");
+    for (uint8_t i = 0; i < (uint8_t)LoopSection::COUNT; i++)
+    {
+        const LoopSectionStats& stats = _sections[i];
+        if (stats.calls == 0)
+            continue;
+
+        DLOG_INFO("[Profiler] %-10s %8u %8u %8u %8u %5u", SECTION_NAMES[i], (unsigned)stats.calls,
+                  (unsigned)(stats.minCycles / _cyclesPerMicro),
+                  (unsigned)(stats.totalCycles / stats.calls / _cyclesPerMicro),
+                  (unsigned)(stats.maxCycles / _cyclesPerMicro), (unsigned)stats.overBudget);
+    }
+}
+
+// Private Helpers
+void LoopProfiler::clear(LoopSectionStats& stats)
+{
+    uint32_t budget = stats.budget;
+    stats = LoopSectionStats();
+    stats.budget = budget;
+    stats.minCycles = UINT64_MAX;
+}
+
+// Create a global instance
+LoopProfiler loopProfiler;
@@ -0,0 +1,93 @@
+// LoopProfiler.h
+
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+#include <esp_cpu.h>
+#include "Metrics.h"
+
+// Comment out to compile the profiler out; LOOP_PROFILE() then leaves only the call
+#define LOOP_PROFILING
+
+// Loop Profiler Constants
+#define LOOP_PROFILER_REPORT_INTERVAL 300000 // Serial summary (ms), 0 disables it
+#define LOOP_PROFILER_WARN_INTERVAL 10000    // At most one over-budget line per section in this time (ms)
+#define LOOP_CYCLE_WRAP_MS 10000             // Longer sections are timed with millis(), the cycle counter wraps
+
+// The parts of loop() that are timed, in call order
+enum class LoopSection : uint8_t {
+    LOCK,           // Waiting for a web request to release the shared lock
+    WIFI,
+    MEMORY,         // Heap sampling for the memory budget
+    ALARM,
+    BUS,            // Event bus dispatch to the subscribers
+    NOTIFIER,
+    WEB_PORTAL,
+    EVENTS,
+    CONFIG,
+    COUNT
+};
+
+// Timing of one section since boot or the last reset()
+struct LoopSectionStats {
+    uint32_t calls;
+    uint32_t overBudget;      // Calls that took longer than the budget
+    uint32_t budget;          // us
+    uint64_t minCycles;
+    uint64_t maxCycles;
+    uint64_t totalCycles;
+    MetricHistogram histogram;
+};
+
+// Per-section timing of the main loop
+//
+// LOOP_PROFILE() reads the CPU cycle counter around a call and keeps
+// min/avg/max and a histogram per section. A call over its budget is counted
+// and logged (rate limited). The section in progress is kept in RTC memory,
+// so after a watchdog reset the next boot says which one was stuck.
+class LoopProfiler {
+public:
+    static void begin();
+    static void update();     // Serial summary every LOOP_PROFILER_REPORT_INTERVAL
+
+    static void enter(LoopSection section);
+    static void leave(LoopSection section, uint32_t startCycles, uint32_t startMillis);
+
+    // Budgets in microseconds
+    static bool setBudget(LoopSection section, uint32_t micros);
+    static uint32_t getBudget(LoopSection section);
+
+    static LoopSectionStats getStats(LoopSection section);
+    static const char* getSectionName(LoopSection section);
+    static const char* getResetSection(); // Section the watchdog interrupted before this boot, nullptr if none
+    static void reset();
+    static void printReport();
+
+private:
+    static LoopSectionStats _sections[(uint8_t)LoopSection::COUNT];
+    static uint32_t _cyclesPerMicro;
+    static uint32_t _lastReport;
+    static uint32_t _lastWarning[(uint8_t)LoopSection::COUNT];
+    static int8_t _resetSection;
+
+    static void clear(LoopSectionStats& stats);
+};
+
+#ifdef LOOP_PROFILING
+#define LOOP_PROFILE(section, call)                                     \
+    do                                                                  \
+    {                                                                   \
+        LoopProfiler::enter(section);                                   \
+        uint32_t profileStartMillis = millis();                         \
+        uint32_t profileStartCycles = esp_cpu_get_cycle_count();        \
+        call;                                                           \
+        LoopProfiler::leave(section, profileStartCycles, profileStartMillis); \
+    } while (0)
+#else
+#define LOOP_PROFILE(section, call) call
+#endif
+
+extern LoopProfiler loopProfiler;
+
+#endif // LOOP_PROFILER_H
@@ -0,0 +1,139 @@
+// MemoryBudget.cpp
+
+#include "MemoryBudget.h"
+#include "DeferredLog.h"
+
+// Names as used by /api/status and /metrics
+static const char* const LEVEL_NAMES[] = {"normal", "shedWeb", "shedInfo", "critical"};
+static const char* const CLIENT_NAMES[(uint8_t)MemoryClient::COUNT] = {"tls", "telegram", "web"};
+
+static const uint32_t RESERVES[(uint8_t)MemoryClient::COUNT] = {
+    MEMORY_TLS_RESERVE, MEMORY_TELEGRAM_RESERVE, MEMORY_WEB_RESERVE};
+static const uint32_t BLOCKS[(uint8_t)MemoryClient::COUNT] = {
+    MEMORY_TLS_BLOCK, MEMORY_TELEGRAM_BLOCK, MEMORY_WEB_BLOCK};
+
+// Static member initialization
+MemoryBudgetStats MemoryBudget::_stats = {};
+volatile uint8_t MemoryBudget::_level = (uint8_t)MemoryLevel::NORMAL;
+uint32_t MemoryBudget::_lastSample = 0;
+uint32_t MemoryBudget::_criticalSince = 0;
+
+void MemoryBudget::begin()
+{
+    _stats = MemoryBudgetStats();
+    _stats.minFreeHeap = UINT32_MAX;
+    _stats.minLargestBlock = UINT32_MAX;
+    _level = (uint8_t)MemoryLevel::NORMAL;
+    sample();
+}
+
+void MemoryBudget::update()
+{
+    if (millis() - _lastSample < MEMORY_SAMPLE_INTERVAL)
+        return;
+    sample();
+}
+
+bool MemoryBudget::admit(MemoryClient client)
+{
+    // Level N sheds the last N clients
+    if ((uint8_t)client < (uint8_t)MemoryClient::COUNT - _level)
+        return true;
+    _stats.shed[(uint8_t)client]++;
+    return false;
+}
+
+MemoryLevel MemoryBudget::getLevel()
+{
+    return (MemoryLevel)_level;
+}
+
+bool MemoryBudget::shouldRestart()
+{
+    return _level == (uint8_t)MemoryLevel::CRITICAL && millis() - _criticalSince >= MEMORY_RESTART_GRACE;
+}
+
+uint32_t MemoryBudget::getReserve(MemoryClient client)
+{
+    return client < MemoryClient::COUNT ? RESERVES[(uint8_t)client] : 0;
+}
+
+uint32_t MemoryBudget::getBlock(MemoryClient client)
+{
+    return client < MemoryClient::COUNT ? BLOCKS[(uint8_t)client] : 0;
+}
+
+MemoryBudgetStats MemoryBudget::getStats()
+{
+    MemoryBudgetStats stats = _stats;
+    stats.level = (MemoryLevel)_level;
+    stats.criticalMillis = _level == (uint8_t)MemoryLevel::CRITICAL ? millis() - _criticalSince : 0;
+    return stats;
+}
+
+const char* MemoryBudget::getLevelName(MemoryLevel level)
+{
+    return (uint8_t)level < sizeof(LEVEL_NAMES) / sizeof(LEVEL_NAMES[0]) ? LEVEL_NAMES[(uint8_t)level] : "unknown";
+}
+
+const char* MemoryBudget::getClientName(MemoryClient client)
+{
+    return client < MemoryClient::COUNT ? CLIENT_NAMES[(uint8_t)client] : "unknown";
+}
+
+// Private Helpers
+void MemoryBudget::sample()
+{
+    _lastSample = millis();
+    uint32_t freeHeap = ESP.getFreeHeap();
+    uint32_t largestBlock = ESP.getMaxAllocHeap();
+
+    _stats.freeHeap = freeHeap;
+    _stats.largestBlock = largestBlock;
+    if (freeHeap < _stats.minFreeHeap)
+        _stats.minFreeHeap = freeHeap;
+    if (largestBlock < _stats.minLargestBlock)
+        _stats.minLargestBlock = largestBlock;
+
+    // Worse is taken at once, better only with the margin, so a level does not flap
+    uint8_t level = (uint8_t)classify(freeHeap, largestBlock);
+    if (level < _level)
+    {
+        uint32_t margin = MEMORY_RECOVERY_MARGIN;
+        level = (uint8_t)classify(freeHeap > margin ? freeHeap - margin : 0,
+                                  largestBlock > margin ? largestBlock - margin : 0);
+        if (level >= _level)
+            return;
+    }
+    else if (level == _level)
+    {
+        return;
+    }
+
+    if (level == (uint8_t)MemoryLevel::CRITICAL)
+        _criticalSince = millis();
+    DLOG_WARN("[Memory] Level %s, free heap %u, largest block %u",
+              getLevelName((MemoryLevel)level), (unsigned)freeHeap, (unsigned)largestBlock);
+    _level = level;
+    _stats.levelChanges++;
+}
+
+MemoryLevel MemoryBudget::classify(uint32_t freeHeap, uint32_t largestBlock)
+{
+    // Each client needs its own reservation on top of those above it
+    uint32_t heap = 0;
+    uint32_t block = 0;
+    uint8_t admitted = 0;
+    for (uint8_t i = 0; i < (uint8_t)MemoryClient::COUNT; i++)
+    {
+        heap += RESERVES[i];
+        block = max(block, BLOCKS[i]);
+        if (freeHeap < heap || largestBlock < block)
+            break;
+        admitted++;
+    }
+    return (MemoryLevel)((uint8_t)MemoryClient::COUNT - admitted);
+}
+
+// Create a global instance
+MemoryBudget memoryBudget;
@@ -0,0 +1,89 @@
+// MemoryBudget.h
+
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <Arduino.h>
+
+// Memory Budget Constants
+#define MEMORY_SAMPLE_INTERVAL 1000         // Heap sampling period (ms)
+#define MEMORY_RECOVERY_MARGIN 4096         // Extra headroom before a shed client is admitted again (bytes)
+#define MEMORY_RESTART_GRACE 120000         // Time spent critical before a restart is allowed (ms)
+
+// Reservations (bytes): heap kept free for the client, and the contiguous block it needs
+#define MEMORY_TLS_RESERVE 40000            // mbedTLS handshake and record buffers
+#define MEMORY_TLS_BLOCK 20000              // 16 KB input record buffer plus allocator overhead
+#define MEMORY_TELEGRAM_RESERVE 8192        // Queued message texts and the command poll connection
+#define MEMORY_TELEGRAM_BLOCK 4096
+#define MEMORY_WEB_RESERVE 16384            // Request parsing, page rendering and response buffers
+#define MEMORY_WEB_BLOCK 8192
+
+// Heap users, highest priority first
+//
+// A client is admitted while the heap covers its own reservation and those of
+// every client above it, so the lower ones are shed first.
+enum class MemoryClient : uint8_t {
+    TLS,              // Alert delivery over TLS
+    TELEGRAM,         // Informational alerts and bot command polling
+    WEB,              // Web portal requests
+    COUNT
+};
+
+// Degradation level, each one sheds one more client
+enum class MemoryLevel : uint8_t {
+    NORMAL,
+    SHED_WEB,         // Web requests answered 503
+    SHED_INFO,        // Informational alerts dropped, command polling paused
+    CRITICAL          // No room for a TLS handshake, sends wait for the heap to recover
+};
+
+// Heap figures since boot
+struct MemoryBudgetStats {
+    uint32_t freeHeap;
+    uint32_t largestBlock;
+    uint32_t minFreeHeap;
+    uint32_t minLargestBlock;
+    MemoryLevel level;
+    uint32_t levelChanges;
+    uint32_t criticalMillis;                  // Time spent critical right now, 0 below critical
+    uint32_t shed[(uint8_t)MemoryClient::COUNT]; // Requests refused per client
+};
+
+// Heap budget shared by the subsystems
+//
+// Replaces a fixed "restart below N bytes" check: free heap alone says little
+// when fragmentation leaves no block large enough for a TLS handshake, so both
+// the free heap and the largest free block are sampled and compared with the
+// clients' reservations. Components ask admit() before they allocate and
+// degrade in order; only a heap that stays critical for MEMORY_RESTART_GRACE
+// ends in a restart.
+class MemoryBudget {
+public:
+    static void begin();
+    static void update();     // Call this from loop()
+
+    // Whether the client may allocate now; refusals are counted
+    static bool admit(MemoryClient client);
+    static MemoryLevel getLevel();
+    static bool shouldRestart();
+
+    static uint32_t getReserve(MemoryClient client);
+    static uint32_t getBlock(MemoryClient client);
+    static MemoryBudgetStats getStats();
+    static const char* getLevelName(MemoryLevel level);
+    static const char* getClientName(MemoryClient client);
+
+private:
+    static MemoryBudgetStats _stats;
+    static volatile uint8_t _level;
+    static uint32_t _lastSample;
+    static uint32_t _criticalSince;
+
+    static void sample();
+    static MemoryLevel classify(uint32_t freeHeap, uint32_t largestBlock);
+};
+
+// External declaration for global access
+extern MemoryBudget memoryBudget;
+
+#endif // MEMORY_BUDGET_H
@@ -0,0 +1,154 @@
+// Metrics.cpp
+
+#include "Metrics.h"
+
+const uint32_t METRIC_BUCKET_BOUNDS[METRIC_BUCKET_COUNT] = {
+    1000, 2500, 5000, 10000, 25000, 50000, 100000,
+    250000, 500000, 1000000, 2500000, 5000000, 10000000};
+
+// Static member initialization
+MetricHistogram Metrics::_loop = {};
+uint32_t Metrics::_events[(uint8_t)BusEventType::COUNT] = {};
+MetricHistogram Metrics::_eventDelay = {};
+
+void Metrics::observe(MetricHistogram& histogram, uint32_t micros)
+{
+    uint8_t bucket = 0;
+    while (bucket < METRIC_BUCKET_COUNT && micros > METRIC_BUCKET_BOUNDS[bucket])
+        bucket++;
+
+    histogram.buckets[bucket]++;
+    histogram.count++;
+    histogram.sum += micros;
+}
+
+void Metrics::recordLoop(uint32_t micros)
+{
+    observe(_loop, micros);
+}
+
+MetricHistogram Metrics::getLoopHistogram()
+{
+    return _loop;
+}
+
+void Metrics::begin()
+{
+    EventBus::subscribe(BUS_EVENT_ALL, onBusEvent, "metrics");
+}
+
+uint32_t Metrics::getEventCount(BusEventType type)
+{
+    return type < BusEventType::COUNT ? _events[(uint8_t)type] : 0;
+}
+
+MetricHistogram Metrics::getEventDelayHistogram()
+{
+    return _eventDelay;
+}
+
+void Metrics::onBusEvent(const BusEvent& event)
+{
+    _events[(uint8_t)event.type]++;
+    observe(_eventDelay, (millis() - event.eventMillis) * 1000);
+}
+
+// Metrics Writer
+MetricsWriter::MetricsWriter(Print& out)
+    : _out(out)
+{
+}
+
+void MetricsWriter::family(const char* name, const char* type, const char* help)
+{
+    // Printed in pieces, printf() would allocate for lines over 64 bytes
+    _out.print("# HELP ");
+    _out.print(name);
+    _out.write(' ');
+    _out.print(help);
+    _out.print("\n# TYPE ");
+    _out.print(name);
+    _out.write(' ');
+    _out.print(type);
+    _out.write('\n');
+}
+
+void MetricsWriter::sample(const char* name, const char* labels, long long value)
+{
+    writeName(name, nullptr, labels);
+    _out.printf(" %lld\n", value);
+}
+
+void MetricsWriter::sampleSeconds(const char* name, const char* labels, uint64_t micros)
+{
+    writeName(name, nullptr, labels);
+    _out.write(' ');
+    writeSeconds(micros);
+    _out.write('\n');
+}
+
+void MetricsWriter::sampleRatio(const char* name, const char* labels, uint32_t part, uint32_t whole)
+{
+    // Three decimals are plenty for a gauge and avoid float formatting
+    uint32_t permille = whole > 0 ? (uint32_t)((uint64_t)part * 1000 / whole) : 0;
+    writeName(name, nullptr, labels);
+    _out.printf(" %u.%03u\n", (unsigned)(permille / 1000), (unsigned)(permille % 1000));
+}
+
+void MetricsWriter::histogram(const char* name, const char* help, const MetricHistogram& histogram)
+{
+    family(name, "histogram", help);
+    histogramSamples(name, nullptr, histogram);
+}
+
+void MetricsWriter::histogramSamples(const char* name, const char* labels, const MetricHistogram& histogram)
+{
+    // Bucket labels are the caller's labels plus le
+    char bucketLabels[64];
+    const char* separator = labels != nullptr ? "," : "";
+    if (labels == nullptr)
+        labels = "";
+
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < METRIC_BUCKET_COUNT; i++)
+    {
+        cumulative += histogram.buckets[i];
+        uint32_t bound = METRIC_BUCKET_BOUNDS[i];
+        snprintf(bucketLabels, sizeof(bucketLabels), "%s%sle=\"%u.%06u\"", labels, separator,
+                 (unsigned)(bound / 1000000), (unsigned)(bound % 1000000));
+        writeName(name, "_bucket", bucketLabels);
+        _out.printf(" %lu\n", (unsigned long)cumulative);
+    }
+    snprintf(bucketLabels, sizeof(bucketLabels), "%s%sle=\"+Inf\"", labels, separator);
+    writeName(name, "_bucket", bucketLabels);
+    _out.printf(" %lu\n", (unsigned long)histogram.count);
+
+    writeName(name, "_sum", *labels != '\0' ? labels : nullptr);
+    _out.write(' ');
+    writeSeconds(histogram.sum);
+    _out.write('\n');
+    writeName(name, "_count", *labels != '\0' ? labels : nullptr);
+    _out.printf(" %lu\n", (unsigned long)histogram.count);
+}
+
+// Private Helpers
+void MetricsWriter::writeName(const char* name, const char* suffix, const char* labels)
+{
+    _out.print(name);
+    if (suffix != nullptr)
+        _out.print(suffix);
+    if (labels != nullptr)
+    {
+        _out.write('{');
+        _out.print(labels);
+        _out.write('}');
+    }
+}
+
+void MetricsWriter::writeSeconds(uint64_t micros)
+{
+    _out.printf("%llu.%06lu", (unsigned long long)(micros / 1000000), (unsigned long)(micros % 1000000));
+}
+
+// Create a global instance
+Metrics metrics;
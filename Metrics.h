@@ -0,0 +1,74 @@
+// Metrics.h
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include "EventBus.h"
+
+// Metrics Constants
+#define METRIC_BUCKET_COUNT 13              // Upper bounds in METRIC_BUCKET_BOUNDS, +Inf comes on top
+#define METRICS_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+// Bucket upper bounds shared by every histogram (microseconds, 1 ms to 10 s)
+extern const uint32_t METRIC_BUCKET_BOUNDS[METRIC_BUCKET_COUNT];
+
+// Duration histogram with fixed buckets, 64 bytes whatever it counts
+struct MetricHistogram {
+    uint32_t buckets[METRIC_BUCKET_COUNT + 1]; // Per bucket, not cumulative; the last one is +Inf
+    uint32_t count;
+    uint64_t sum;             // Microseconds
+};
+
+// Pre-aggregated process metrics for /metrics
+//
+// The subsystems keep their own counters (getStats()); this only holds what
+// belongs to no subsystem: the main loop timing, the events seen on the event
+// bus, and the histogram helper.
+class Metrics {
+public:
+    static void observe(MetricHistogram& histogram, uint32_t micros);
+
+    // Main loop iteration time
+    static void recordLoop(uint32_t micros);
+    static MetricHistogram getLoopHistogram();
+
+    // Event bus subscriber, counts every event and its publish to dispatch delay
+    static void begin();
+    static uint32_t getEventCount(BusEventType type);
+    static MetricHistogram getEventDelayHistogram();
+
+private:
+    static MetricHistogram _loop;
+    static uint32_t _events[(uint8_t)BusEventType::COUNT];
+    static MetricHistogram _eventDelay;
+
+    static void onBusEvent(const BusEvent& event);
+};
+
+// Writes the Prometheus text exposition format to any Print
+//
+// Every family starts with family(), which prints HELP and TYPE; the
+// samples of that family follow. Labels are passed preformatted
+// (side="right"), durations are converted from microseconds to seconds.
+class MetricsWriter {
+public:
+    explicit MetricsWriter(Print& out);
+
+    void family(const char* name, const char* type, const char* help);
+    void sample(const char* name, const char* labels, long long value);
+    void sampleSeconds(const char* name, const char* labels, uint64_t micros);
+    void sampleRatio(const char* name, const char* labels, uint32_t part, uint32_t whole);
+    void histogram(const char* name, const char* help, const MetricHistogram& histogram);
+    void histogramSamples(const char* name, const char* labels, const MetricHistogram& histogram);
+
+private:
+    Print& _out;
+
+    void writeName(const char* name, const char* suffix, const char* labels);
+    void writeSeconds(uint64_t micros);
+};
+
+extern Metrics metrics;
+
+#endif // METRICS_H
@@ -0,0 +1,343 @@
+// MqttNotifier.cpp
+
+#include "MqttNotifier.h"
+#include "WiFiConfig.h"
+#include "ConfigStore.h"
+#include <Preferences.h>
+
+const char* MqttNotifier::PREFERENCE_NAMESPACE = "mqtt";
+
+MqttNotifier::MqttNotifier()
+    : _queue(MQTT_RATE_LIMIT), _client(nullptr), _connected(false), _ackedMessageId(-1),
+      _inFlightMessageId(-1), _publishTime(0), _startFailed(false), _lastError(""), _enabled(false)
+{
+    _brokerUri[0] = '\0';
+    _username[0] = '\0';
+    _password[0] = '\0';
+    strcpy(_baseTopic, MQTT_DEFAULT_TOPIC);
+    _clientId[0] = '\0';
+    _statusTopic[0] = '\0';
+}
+
+const char* MqttNotifier::getName() const
+{
+    return "MQTT";
+}
+
+bool MqttNotifier::begin()
+{
+    loadConfiguration();
+
+    // Persistent sessions are keyed by client ID, so it must not change between boots
+    strncpy(_clientId, Notifier::getDeviceId().c_str(), sizeof(_clientId) - 1);
+    _clientId[sizeof(_clientId) - 1] = '\0';
+
+    // The client is started from update() once the network stack is up
+    return true;
+}
+
+void MqttNotifier::update()
+{
+    if (!_enabled)
+        return;
+
+    if (_client == nullptr)
+    {
+        // esp-mqtt reconnects by itself once started, so it is only started once per configuration
+        if (WiFiManager::isConnected() && !_startFailed)
+            _startFailed = !startClient();
+        return;
+    }
+
+    if (_inFlightMessageId >= 0)
+    {
+        if (_ackedMessageId == _inFlightMessageId)
+        {
+            // Broker confirmed with PUBACK
+            _queue.pop();
+            _inFlightMessageId = -1;
+        }
+        else if (millis() - _publishTime >= MQTT_ACK_TIMEOUT)
+        {
+            // QoS 1 allows duplicates, losing the event is worse
+            _lastError = "No PUBACK from broker";
+            _inFlightMessageId = -1;
+            _queue.retry();
+        }
+        return;
+    }
+
+    if (_connected && _queue.isReady())
+    {
+        publishNext();
+    }
+}
+
+bool MqttNotifier::notify(const NotifierEvent& event)
+{
+    if (!_queue.push(event))
+    {
+        _lastError = "Event queue is full";
+        return false;
+    }
+    return true;
+}
+
+bool MqttNotifier::isEnabled() const
+{
+    return _enabled;
+}
+
+bool MqttNotifier::isConnected() const
+{
+    return _connected;
+}
+
+String MqttNotifier::getLastError() const
+{
+    return _lastError;
+}
+
+// Configuration
+bool MqttNotifier::configure(bool enabled, const String& brokerUri, const String& username,
+                             const String& password, const String& baseTopic)
+{
+    if (enabled && !brokerUri.startsWith("mqtt://") && !brokerUri.startsWith("mqtts://"))
+    {
+        _lastError = "Broker URI must start with mqtt:// or mqtts://";
+        return false;
+    }
+
+    if (brokerUri.length() >= MQTT_URI_SIZE || username.length() >= MQTT_CREDENTIAL_SIZE ||
+        password.length() >= MQTT_CREDENTIAL_SIZE || baseTopic.length() >= MQTT_TOPIC_SIZE)
+    {
+        _lastError = "MQTT setting is too long";
+        return false;
+    }
+
+    if (baseTopic.indexOf('#') >= 0 || baseTopic.indexOf('+') >= 0)
+    {
+        _lastError = "Base topic must not contain wildcards";
+        return false;
+    }
+
+    stopClient();
+
+    _enabled = enabled;
+    strcpy(_brokerUri, brokerUri.c_str());
+    strcpy(_username, username.c_str());
+    strcpy(_password, password.c_str());
+    strcpy(_baseTopic, baseTopic.length() > 0 ? baseTopic.c_str() : MQTT_DEFAULT_TOPIC);
+    saveConfiguration();
+
+    if (!_enabled)
+        _queue.clear();
+
+    _startFailed = false;
+    return true;
+}
+
+String MqttNotifier::getBrokerUri() const
+{
+    return String(_brokerUri);
+}
+
+String MqttNotifier::getUsername() const
+{
+    return String(_username);
+}
+
+String MqttNotifier::getPassword() const
+{
+    return String(_password);
+}
+
+String MqttNotifier::getBaseTopic() const
+{
+    return String(_baseTopic);
+}
+
+uint8_t MqttNotifier::getQueueSize() const
+{
+    return _queue.size();
+}
+
+// Private Helpers
+bool MqttNotifier::startClient()
+{
+    snprintf(_statusTopic, sizeof(_statusTopic), "%s/status", _baseTopic);
+
+    // esp-mqtt copies the configuration strings, runs its own task and reconnects by itself
+    esp_mqtt_client_config_t config = {};
+    config.broker.address.uri = _brokerUri;
+    config.credentials.client_id = _clientId;
+    if (_username[0] != '\0')
+    {
+        config.credentials.username = _username;
+        config.credentials.authentication.password = _password;
+    }
+    config.session.disable_clean_session = true;
+    config.session.keepalive = MQTT_KEEPALIVE;
+    config.session.last_will.topic = _statusTopic;
+    config.session.last_will.msg = "offline";
+    config.session.last_will.qos = 1;
+    config.session.last_will.retain = 1;
+
+    _client = esp_mqtt_client_init(&config);
+    if (_client == nullptr)
+    {
+        _lastError = "Failed to create MQTT client";
+        return false;
+    }
+
+    esp_mqtt_client_register_event(_client, MQTT_EVENT_ANY, onMqttEvent, this);
+    if (esp_mqtt_client_start(_client) != ESP_OK)
+    {
+        _lastError = "Failed to start MQTT client";
+        esp_mqtt_client_destroy(_client);
+        _client = nullptr;
+        return false;
+    }
+
+    Serial.printf("[MQTT] Connecting to %s as %s\n", _brokerUri, _clientId);
+    return true;
+}
+
+void MqttNotifier::stopClient()
+{
+    if (_client == nullptr)
+        return;
+
+    esp_mqtt_client_stop(_client);
+    esp_mqtt_client_destroy(_client);
+    _client = nullptr;
+    _connected = false;
+    _inFlightMessageId = -1;
+}
+
+void MqttNotifier::loadConfiguration()
+{
+    StoredConfig config;
+    memset(&config, 0, sizeof(config));
+    strcpy(config.baseTopic, MQTT_DEFAULT_TOPIC);
+
+    ConfigLoadResult result = ConfigStore::load(PREFERENCE_NAMESPACE, CONFIG_VERSION, &config, sizeof(config));
+    bool migrated = false;
+    if (result == ConfigLoadResult::MISSING)
+    {
+        // Settings from before the configuration blob
+        Preferences prefs;
+        if (prefs.begin(PREFERENCE_NAMESPACE, true))
+        {
+            if (prefs.isKey("uri"))
+            {
+                config.enabled = prefs.getBool("enabled", false);
+                prefs.getString("uri", config.brokerUri, sizeof(config.brokerUri));
+                prefs.getString("user", config.username, sizeof(config.username));
+                prefs.getString("pass", config.password, sizeof(config.password));
+                prefs.getString("topic", config.baseTopic, sizeof(config.baseTopic));
+                migrated = true;
+            }
+            prefs.end();
+        }
+    }
+    else if (result == ConfigLoadResult::CORRUPT)
+    {
+        _lastError = ConfigStore::getLastError();
+    }
+
+    if (result != ConfigLoadResult::CORRUPT)
+    {
+        _enabled = config.enabled != 0;
+        memcpy(_brokerUri, config.brokerUri, sizeof(_brokerUri));
+        memcpy(_username, config.username, sizeof(_username));
+        memcpy(_password, config.password, sizeof(_password));
+        memcpy(_baseTopic, config.baseTopic, sizeof(_baseTopic));
+        _brokerUri[sizeof(_brokerUri) - 1] = '\0';
+        _username[sizeof(_username) - 1] = '\0';
+        _password[sizeof(_password) - 1] = '\0';
+        _baseTopic[sizeof(_baseTopic) - 1] = '\0';
+    }
+    if (_baseTopic[0] == '\0')
+        strcpy(_baseTopic, MQTT_DEFAULT_TOPIC);
+
+    // An enabled backend without a broker would only fill its queue
+    if (_brokerUri[0] == '\0')
+        _enabled = false;
+
+    const char* legacyKeys[] = {"enabled", "uri", "user", "pass", "topic"};
+    ConfigStore::finishLoad(PREFERENCE_NAMESPACE, result, migrated, []()
+                            { return mqttNotifier.saveConfiguration(); }, legacyKeys, 5);
+}
+
+bool MqttNotifier::saveConfiguration()
+{
+    StoredConfig config;
+    memset(&config, 0, sizeof(config));
+    config.enabled = _enabled;
+    strcpy(config.brokerUri, _brokerUri);
+    strcpy(config.username, _username);
+    strcpy(config.password, _password);
+    strcpy(config.baseTopic, _baseTopic);
+
+    if (!ConfigStore::save(PREFERENCE_NAMESPACE, CONFIG_VERSION, &config, sizeof(config)))
+    {
+        _lastError = ConfigStore::getLastError();
+        return false;
+    }
+    return true;
+}
+
+void MqttNotifier::publishNext()
+{
+    const NotifierEvent& event = _queue.front();
+
+    char topic[MQTT_TOPIC_SIZE + 40];
+    char payload[NOTIFIER_PAYLOAD_SIZE];
+    snprintf(topic, sizeof(topic), "%s/event/%s", _baseTopic, Notifier::getEventName(event.type));
+    size_t length = Notifier::formatEventJson(event, payload, sizeof(payload));
+    if (length == 0)
+    {
+        _queue.pop();
+        return;
+    }
+
+    _queue.startAttempt();
+    // Queued for the MQTT task to send, publish() would write to the socket here under the shared lock
+    int messageId = esp_mqtt_client_enqueue(_client, topic, payload, length, 1, 0, true);
+    if (messageId < 0)
+    {
+        _lastError = "Publish failed";
+        _queue.retry();
+        return;
+    }
+
+    _inFlightMessageId = messageId;
+    _publishTime = millis();
+}
+
+void MqttNotifier::onMqttEvent(void* handlerArgs, esp_event_base_t base, int32_t eventId, void* eventData)
+{
+    // Runs in the esp-mqtt task; only flags are touched here
+    MqttNotifier* self = (MqttNotifier*)handlerArgs;
+    esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)eventData;
+
+    switch ((esp_mqtt_event_id_t)eventId)
+    {
+    case MQTT_EVENT_CONNECTED:
+        self->_connected = true;
+        esp_mqtt_client_publish(self->_client, self->_statusTopic, "online", 0, 1, 1);
+        break;
+    case MQTT_EVENT_DISCONNECTED:
+        self->_connected = false;
+        break;
+    case MQTT_EVENT_PUBLISHED:
+        self->_ackedMessageId = event->msg_id;
+        break;
+    default:
+        break;
+    }
+}
+
+// Create a global instance
+MqttNotifier mqttNotifier;
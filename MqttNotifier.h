@@ -0,0 +1,86 @@
+// MqttNotifier.h
+
+#ifndef MQTT_NOTIFIER_H
+#define MQTT_NOTIFIER_H
+
+#include <Arduino.h>
+#include <mqtt_client.h>
+#include "Notifier.h"
+
+// MQTT Configuration Constants
+#define MQTT_RATE_LIMIT 100             // Min delay between publishes (ms)
+#define MQTT_ACK_TIMEOUT 30000          // Wait for PUBACK before publishing the event again (ms)
+#define MQTT_KEEPALIVE 30               // Keepalive interval (s)
+#define MQTT_DEFAULT_TOPIC "water-meter"
+#define MQTT_URI_SIZE 96
+#define MQTT_CREDENTIAL_SIZE 48
+#define MQTT_TOPIC_SIZE 64
+
+// MQTT backend, publishes every event with QoS 1 to <base topic>/event/<name>
+// The broker keeps the session (clean session off), so events published while the
+// link is down are still delivered once it comes back. <base topic>/status carries a
+// retained "online"/"offline" (last will) message.
+class MqttNotifier : public NotifierBackend {
+public:
+    MqttNotifier();
+
+    const char* getName() const override;
+    bool begin() override;
+    void update() override;
+    bool notify(const NotifierEvent& event) override;
+    bool isEnabled() const override;
+    bool isConnected() const override;
+    String getLastError() const override;
+
+    // Configuration
+    bool configure(bool enabled, const String& brokerUri, const String& username,
+                   const String& password, const String& baseTopic);
+    String getBrokerUri() const;
+    String getUsername() const;
+    String getPassword() const;
+    String getBaseTopic() const;
+    uint8_t getQueueSize() const;
+
+private:
+    NotifierQueue _queue;
+    esp_mqtt_client_handle_t _client;
+    volatile bool _connected;           // Written from the MQTT task
+    volatile int _ackedMessageId;       // Written from the MQTT task
+    int _inFlightMessageId;             // -1 when no publish waits for its PUBACK
+    uint32_t _publishTime;
+    bool _startFailed;                  // Not retried until the configuration changes
+    String _lastError;
+
+    bool _enabled;
+    char _brokerUri[MQTT_URI_SIZE];
+    char _username[MQTT_CREDENTIAL_SIZE];
+    char _password[MQTT_CREDENTIAL_SIZE];
+    char _baseTopic[MQTT_TOPIC_SIZE];
+    char _clientId[24];
+    char _statusTopic[MQTT_TOPIC_SIZE + 8];
+
+    // Broker connection and topic settings
+    struct StoredConfig {
+        uint8_t enabled;
+        char brokerUri[MQTT_URI_SIZE];
+        char username[MQTT_CREDENTIAL_SIZE];
+        char password[MQTT_CREDENTIAL_SIZE];
+        char baseTopic[MQTT_TOPIC_SIZE];
+    } __attribute__((packed));
+
+    // Constants for Storage
+    static const uint16_t CONFIG_VERSION = 1;
+    static const char* PREFERENCE_NAMESPACE;
+
+    bool startClient();
+    void stopClient();
+    void loadConfiguration();
+    bool saveConfiguration();
+    void publishNext();
+    static void onMqttEvent(void* handlerArgs, esp_event_base_t base, int32_t eventId, void* eventData);
+};
+
+// External declaration for global access
+extern MqttNotifier mqttNotifier;
+
+#endif // MQTT_NOTIFIER_H
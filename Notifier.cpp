@@ -0,0 +1,351 @@
+// Notifier.cpp
+
+#include "Notifier.h"
+#include "TelegramHandler.h"
+#include "WiFiConfig.h"
+
+// Static member initialization
+NotifierBackend* Notifier::_backends[MAX_NOTIFIER_BACKENDS] = {nullptr};
+uint8_t Notifier::_backendCount = 0;
+void (*Notifier::_lock)() = nullptr;
+void (*Notifier::_unlock)() = nullptr;
+
+// Notifier Queue
+NotifierQueue::NotifierQueue(uint32_t minInterval)
+    : _head(0), _size(0), _retries(0), _minInterval(minInterval),
+      _lastAttempt(0), _nextAttempt(0), _dropped(0)
+{
+}
+
+bool NotifierQueue::push(const NotifierEvent& event)
+{
+    if (_size >= NOTIFIER_QUEUE_SIZE)
+    {
+        _dropped++;
+        return false;
+    }
+
+    _events[(_head + _size) % NOTIFIER_QUEUE_SIZE] = event;
+    _size++;
+    return true;
+}
+
+bool NotifierQueue::isEmpty() const
+{
+    return _size == 0;
+}
+
+uint8_t NotifierQueue::size() const
+{
+    return _size;
+}
+
+uint32_t NotifierQueue::getDropped() const
+{
+    return _dropped;
+}
+
+bool NotifierQueue::isReady() const
+{
+    if (_size == 0)
+        return false;
+
+    uint32_t now = millis();
+    if (_lastAttempt != 0 && now - _lastAttempt < _minInterval)
+        return false;
+
+    // Signed difference keeps the backoff working across the millis() rollover
+    return (int32_t)(now - _nextAttempt) >= 0;
+}
+
+const NotifierEvent& NotifierQueue::front() const
+{
+    return _events[_head];
+}
+
+void NotifierQueue::startAttempt()
+{
+    _lastAttempt = millis();
+    if (_lastAttempt == 0)
+        _lastAttempt = 1; // 0 means "never"
+}
+
+void NotifierQueue::pop()
+{
+    if (_size == 0)
+        return;
+
+    _head = (_head + 1) % NOTIFIER_QUEUE_SIZE;
+    _size--;
+    _retries = 0;
+    _nextAttempt = millis();
+}
+
+void NotifierQueue::retry()
+{
+    if (_size == 0)
+        return;
+
+    if (++_retries >= NOTIFIER_MAX_RETRIES)
+    {
+        _dropped++;
+        pop();
+        return;
+    }
+
+    _nextAttempt = millis() + NOTIFIER_RETRY_DELAY * (1UL << _retries);
+}
+
+void NotifierQueue::clear()
+{
+    _head = 0;
+    _size = 0;
+    _retries = 0;
+    _nextAttempt = millis();
+}
+
+// Backend Registry
+bool Notifier::registerBackend(NotifierBackend* backend)
+{
+    if (backend == nullptr || _backendCount >= MAX_NOTIFIER_BACKENDS)
+        return false;
+
+    _backends[_backendCount++] = backend;
+    return true;
+}
+
+bool Notifier::begin()
+{
+    // A failing backend must not keep the others from starting
+    bool allStarted = true;
+    for (uint8_t i = 0; i < _backendCount; i++)
+    {
+        if (!_backends[i]->begin())
+        {
+            Serial.printf("[Notifier] Failed to start %s backend: %s\n",
+                          _backends[i]->getName(), _backends[i]->getLastError().c_str());
+            allStarted = false;
+        }
+    }
+
+    EventBus::subscribe(BUS_EVENT_MASK(BusEventType::THEFT) | BUS_EVENT_MASK(BusEventType::WIRE_CUT) |
+                            BUS_EVENT_MASK(BusEventType::DISTRIBUTION_WIRE_CUT) |
+                            BUS_EVENT_MASK(BusEventType::STARTUP_WIRE_CUT) |
+                            BUS_EVENT_MASK(BusEventType::STARTUP_DISTRIBUTION_WIRE_CUT) |
+                            BUS_EVENT_MASK(BusEventType::WIFI_CONNECTED),
+                        onBusEvent, "notifier");
+
+    Serial.printf("[Notifier] %d backend(s) registered\n", _backendCount);
+    return allStarted;
+}
+
+void Notifier::update()
+{
+    for (uint8_t i = 0; i < _backendCount; i++)
+    {
+        _backends[i]->update();
+    }
+}
+
+void Notifier::setStateLock(void (*lock)(), void (*unlock)())
+{
+    _lock = lock;
+    _unlock = unlock;
+}
+
+void Notifier::releaseStateLock()
+{
+    if (_unlock != nullptr)
+        _unlock();
+}
+
+void Notifier::acquireStateLock()
+{
+    if (_lock != nullptr)
+        _lock();
+}
+
+uint8_t Notifier::getBackendCount()
+{
+    return _backendCount;
+}
+
+NotifierBackend* Notifier::getBackend(uint8_t index)
+{
+    if (index >= _backendCount)
+        return nullptr;
+    return _backends[index];
+}
+
+// Event Bus
+void Notifier::onBusEvent(const BusEvent& busEvent)
+{
+    NotifierEvent event;
+    switch (busEvent.type)
+    {
+    case BusEventType::THEFT:
+        event.type = NotifierEventType::THEFT;
+        break;
+    case BusEventType::WIRE_CUT:
+        event.type = NotifierEventType::WIRE_CUT;
+        break;
+    case BusEventType::DISTRIBUTION_WIRE_CUT:
+        event.type = NotifierEventType::DISTRIBUTION_WIRE_CUT;
+        break;
+    case BusEventType::STARTUP_WIRE_CUT:
+        event.type = NotifierEventType::STARTUP_WIRE_CUT;
+        break;
+    case BusEventType::STARTUP_DISTRIBUTION_WIRE_CUT:
+        event.type = NotifierEventType::STARTUP_DISTRIBUTION_WIRE_CUT;
+        break;
+    case BusEventType::WIFI_CONNECTED:
+        event.type = NotifierEventType::SYSTEM_ONLINE;
+        break;
+    default:
+        return;
+    }
+
+    // Times are the ones of the detection, not of the dispatch
+    event.apartment = busEvent.apartment;
+    event.side = busEvent.side;
+    event.box = busEvent.box;
+    event.eventTime = busEvent.eventTime;
+    event.eventUptime = busEvent.eventMillis / 1000;
+    dispatch(event);
+}
+
+void Notifier::dispatch(const NotifierEvent& event)
+{
+    for (uint8_t i = 0; i < _backendCount; i++)
+    {
+        if (!_backends[i]->isEnabled())
+            continue;
+
+        if (!_backends[i]->notify(event))
+        {
+            Serial.printf("[Notifier] %s backend dropped a %s event\n", _backends[i]->getName(), getEventName(event.type));
+        }
+    }
+}
+
+// Payload Helpers
+const char* Notifier::getEventName(NotifierEventType type)
+{
+    switch (type)
+    {
+    case NotifierEventType::THEFT:
+        return "theft";
+    case NotifierEventType::WIRE_CUT:
+        return "wire_cut";
+    case NotifierEventType::DISTRIBUTION_WIRE_CUT:
+        return "distribution_wire_cut";
+    case NotifierEventType::STARTUP_WIRE_CUT:
+        return "startup_wire_cut";
+    case NotifierEventType::STARTUP_DISTRIBUTION_WIRE_CUT:
+        return "startup_distribution_wire_cut";
+    case NotifierEventType::SYSTEM_ONLINE:
+        return "online";
+    }
+    return "unknown";
+}
+
+size_t Notifier::formatEventJson(const NotifierEvent& event, char* buffer, size_t size)
+{
+    int length = snprintf(buffer, size, "{\"device\":\"%s\",\"event\":\"%s\"",
+                          getDeviceId().c_str(), getEventName(event.type));
+
+    // Only the fields that mean something for this kind of event
+    if (event.type == NotifierEventType::THEFT && length > 0 && (size_t)length < size)
+    {
+        length += snprintf(buffer + length, size - length, ",\"apartment\":%d", event.apartment);
+    }
+    if (event.type != NotifierEventType::SYSTEM_ONLINE && length > 0 && (size_t)length < size)
+    {
+        length += snprintf(buffer + length, size - length, ",\"side\":\"%s\"",
+                           event.side == RIGHT_SIDE ? "right" : "left");
+    }
+    if ((event.type == NotifierEventType::THEFT ||
+         event.type == NotifierEventType::WIRE_CUT ||
+         event.type == NotifierEventType::STARTUP_WIRE_CUT) &&
+        length > 0 && (size_t)length < size)
+    {
+        length += snprintf(buffer + length, size - length, ",\"box\":\"%s\"",
+                           event.box == RIGHT_BOX ? "right" : "left");
+    }
+    if (length > 0 && (size_t)length < size)
+    {
+        length += snprintf(buffer + length, size - length, ",\"time\":%lu,\"uptime\":%lu}",
+                           (unsigned long)event.eventTime, (unsigned long)event.eventUptime);
+    }
+
+    if (length < 0 || (size_t)length >= size)
+        return 0;
+    return length;
+}
+
+String Notifier::getDeviceId()
+{
+    // The low three bytes of the factory MAC are unique enough inside one building
+    uint64_t mac = ESP.getEfuseMac();
+    char deviceId[24];
+    snprintf(deviceId, sizeof(deviceId), "water-meter-%02x%02x%02x",
+             (uint8_t)(mac >> 24), (uint8_t)(mac >> 32), (uint8_t)(mac >> 40));
+    return String(deviceId);
+}
+
+// Telegram Backend
+const char* TelegramNotifier::getName() const
+{
+    return "Telegram";
+}
+
+bool TelegramNotifier::begin()
+{
+    return telegramHandler.begin();
+}
+
+void TelegramNotifier::update()
+{
+    telegramHandler.update();
+}
+
+bool TelegramNotifier::notify(const NotifierEvent& event)
+{
+    switch (event.type)
+    {
+    case NotifierEventType::THEFT:
+        telegramHandler.sendTheftAlertsToAll(event.apartment);
+        return true;
+    case NotifierEventType::WIRE_CUT:
+        return telegramHandler.sendWireCutAlert(event.side, event.box);
+    case NotifierEventType::DISTRIBUTION_WIRE_CUT:
+        return telegramHandler.sendDistributionWireCutAlert(event.side);
+    case NotifierEventType::STARTUP_WIRE_CUT:
+        return telegramHandler.sendStartupWireCutAlert(event.side, event.box);
+    case NotifierEventType::STARTUP_DISTRIBUTION_WIRE_CUT:
+        return telegramHandler.sendStartupDistributionWireCutAlert(event.side);
+    case NotifierEventType::SYSTEM_ONLINE:
+        telegramHandler.sendSystemOnlineMessageToEnabledApartments();
+        return true;
+    }
+    return false;
+}
+
+bool TelegramNotifier::isEnabled() const
+{
+    return true;
+}
+
+bool TelegramNotifier::isConnected() const
+{
+    return telegramHandler.isReady();
+}
+
+String TelegramNotifier::getLastError() const
+{
+    return telegramHandler.getLastError();
+}
+
+// Create global instances
+Notifier notifier;
+TelegramNotifier telegramNotifier;
@@ -0,0 +1,133 @@
+// Notifier.h
+
+#ifndef NOTIFIER_H
+#define NOTIFIER_H
+
+#include <Arduino.h>
+#include "ApartmentGrouping.h"
+#include "EventBus.h"
+
+// Notifier Configuration Constants
+#define MAX_NOTIFIER_BACKENDS 4     // Telegram, MQTT, webhook and one spare
+#define NOTIFIER_QUEUE_SIZE 16      // Events waiting in each backend
+#define NOTIFIER_MAX_RETRIES 5      // Attempts before an event is given up
+#define NOTIFIER_RETRY_DELAY 1000   // Base of the exponential retry backoff (ms)
+#define NOTIFIER_PAYLOAD_SIZE 192   // Buffer size for one JSON event payload
+
+// Events delivered to every notifier backend
+enum class NotifierEventType : uint8_t {
+    THEFT,
+    WIRE_CUT,
+    DISTRIBUTION_WIRE_CUT,
+    STARTUP_WIRE_CUT,
+    STARTUP_DISTRIBUTION_WIRE_CUT,
+    SYSTEM_ONLINE
+};
+
+struct NotifierEvent {
+    NotifierEventType type;
+    uint8_t apartment;        // THEFT only, 0 otherwise
+    BuildingSide side;
+    BoxPosition box;          // WIRE_CUT and STARTUP_WIRE_CUT only
+    uint32_t eventTime;       // Unix time, 0 if the clock was not synced yet
+    uint32_t eventUptime;     // Seconds since boot
+};
+
+// Notification backend
+// notify() only queues the event; the backend delivers it from update() at its own pace
+class NotifierBackend {
+public:
+    virtual ~NotifierBackend() {}
+    virtual const char* getName() const = 0;
+    virtual bool begin() = 0;
+    virtual void update() = 0;
+    virtual bool notify(const NotifierEvent& event) = 0;
+    virtual bool isEnabled() const = 0;
+    virtual bool isConnected() const = 0;
+    virtual String getLastError() const = 0;
+};
+
+// Fixed-size event queue with retry backoff and a minimum interval between sends
+class NotifierQueue {
+public:
+    explicit NotifierQueue(uint32_t minInterval);
+
+    bool push(const NotifierEvent& event);  // Returns false when the queue is full
+    bool isEmpty() const;
+    uint8_t size() const;
+    uint32_t getDropped() const;            // Events lost to a full queue or too many retries
+
+    bool isReady() const;                   // The head may be sent now
+    const NotifierEvent& front() const;
+    void startAttempt();                    // Call right before sending the head
+    void pop();                             // The head was delivered
+    void retry();                           // The head failed, dropped after NOTIFIER_MAX_RETRIES
+    void clear();
+
+private:
+    NotifierEvent _events[NOTIFIER_QUEUE_SIZE];
+    uint8_t _head;
+    uint8_t _size;
+    uint8_t _retries;
+    uint32_t _minInterval;
+    uint32_t _lastAttempt;
+    uint32_t _nextAttempt;
+    uint32_t _dropped;
+};
+
+// Dispatches alarm events to every registered backend
+//
+// Subscribes to the alarm events and WIFI_CONNECTED (sent as SYSTEM_ONLINE)
+// on the event bus; nothing calls it directly.
+//
+// update() runs under the shared lock loop() holds. A backend that waits on
+// the network copies what it sends, calls releaseStateLock() for the
+// connection and the response, and acquireStateLock() before it touches its
+// state again, so web requests are not held up by a slow server.
+class Notifier {
+public:
+    static bool registerBackend(NotifierBackend* backend);
+    static bool begin();
+    static void update();
+
+    // Shared state lock, unset (no-op) until setStateLock() is called
+    static void setStateLock(void (*lock)(), void (*unlock)());
+    static void releaseStateLock();
+    static void acquireStateLock();
+
+    static uint8_t getBackendCount();
+    static NotifierBackend* getBackend(uint8_t index);
+
+    // Payload Helpers
+    static const char* getEventName(NotifierEventType type);
+    static size_t formatEventJson(const NotifierEvent& event, char* buffer, size_t size);
+    static String getDeviceId();              // Stable per board, e.g. "water-meter-a1b2c3"
+
+private:
+    static NotifierBackend* _backends[MAX_NOTIFIER_BACKENDS];
+    static uint8_t _backendCount;
+    static void (*_lock)();
+    static void (*_unlock)();
+
+    static void onBusEvent(const BusEvent& event);
+    static void dispatch(const NotifierEvent& event);
+};
+
+// Telegram backend, a thin adapter over TelegramHandler which keeps its own
+// message queue, rate limiter and per-resident fan-out
+class TelegramNotifier : public NotifierBackend {
+public:
+    const char* getName() const override;
+    bool begin() override;
+    void update() override;
+    bool notify(const NotifierEvent& event) override;
+    bool isEnabled() const override;
+    bool isConnected() const override;
+    String getLastError() const override;
+};
+
+// External declarations for global access
+extern Notifier notifier;
+extern TelegramNotifier telegramNotifier;
+
+#endif // NOTIFIER_H
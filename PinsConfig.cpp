@@ -1,5 +1,6 @@
 #include "PinsConfig.h"
 #include <Arduino.h>
+#include "DeferredLog.h"
 
 // Initialize all hardware components
 void PinConfiguration::initializeAllPins() {
@@ -102,14 +103,14 @@ uint8_t getSirenPin(BuildingSide side) {
 void enableSideVCC(BuildingSide side) {
     uint8_t pin = getVCCControlPin(side);
     digitalWrite(pin, LOW);  // LOW enables the NPN transistor
-    Serial.println("VCC Enabled for side: " + String(side) + " on pin: " + String(pin));
+    DLOG_DEBUG("VCC Enabled for side: %u on pin: %u", side, pin);
 }
 
 // Disable VCC for a specific side
 void disableSideVCC(BuildingSide side) {
     uint8_t pin = getVCCControlPin(side);
     digitalWrite(pin, HIGH);  // HIGH disables the NPN transistor
-    Serial.println("VCC Disabled for side: " + String(side) + " on pin: " + String(pin));
+    DLOG_DEBUG("VCC Disabled for side: %u on pin: %u", side, pin);
 }
 
 // Activate siren for a specific side
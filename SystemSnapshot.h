@@ -0,0 +1,92 @@
+// SystemSnapshot.h
+
+#ifndef SYSTEM_SNAPSHOT_H
+#define SYSTEM_SNAPSHOT_H
+
+#include <Arduino.h>
+#include "AlarmSystem.h"
+#include "ApartmentGrouping.h"
+#include "ConfigStore.h"
+#include "EventStream.h"
+#include "HttpServer.h"
+#include "Metrics.h"
+#include "LoopProfiler.h"
+#include "MemoryBudget.h"
+#include "TelegramHandler.h"
+#include "WiFiConfig.h"
+
+// Snapshot Constants
+#define SNAPSHOT_IP_SIZE 16                 // "255.255.255.255" + terminator
+#define SNAPSHOT_URL_SIZE (TELEGRAM_API_HOST_SIZE + 16) // Scheme, host and port
+
+// Per-apartment state, index 0 is apartment 1
+struct ApartmentSnapshot {
+    bool enabled : 1;
+    bool triggered : 1;
+    bool telegramConfigured : 1;
+    bool telegramEnabled : 1;
+};
+
+// Everything the status API reports, taken in one pass
+//
+// WebPortal::captureSnapshot() fills it while holding the lock, so every
+// field belongs to the same moment; the JSON writers only read from it and
+// never call back into the subsystems.
+struct SystemSnapshot {
+    uint32_t timestamp;       // millis() when it was taken
+    uint32_t version;         // Changes whenever the state (not the counters) changes
+
+    // WiFi
+    bool wifiConnected;
+    char ssid[WIFI_SSID_SIZE];
+    int32_t rssi;
+    char ipAddress[SNAPSHOT_IP_SIZE];
+    WiFiStats wifiStats;
+
+    // Alarm
+    AlarmSystemStatus status;
+    bool alarmActive[2];      // Indexed by BuildingSide
+    uint32_t alarmUptime;     // ms
+    uint32_t lastAlarmTime;   // ms
+    WireCutStatus wires;
+    ApartmentSnapshot apartments[TOTAL_APARTMENTS];
+    AlarmSystemStats alarmStats;
+
+    // Telegram
+    uint8_t queueSize;
+    uint8_t queueHighWater;
+    char apiBaseUrl[SNAPSHOT_URL_SIZE];
+    TelegramStats telegramStats;
+
+    // Settings Storage
+    ConfigStoreStats config;
+    uint8_t corruptConfigs;
+    uint32_t nvsUsedEntries;
+    uint32_t nvsFreeEntries;
+    uint8_t recordCount;
+    ConfigRecordInfo records[MAX_CONFIG_RECORDS];
+
+    // Web
+    EventStreamStats events;
+    HttpServerStats http;
+    size_t largestPage;
+    bool adminSession;
+
+    // System
+    uint8_t buildingNumber;
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;     // Lowest free heap since boot
+    uint32_t largestFreeBlock;
+    MemoryBudgetStats memory; // Degradation level and shed requests
+    uint32_t cpuFreqMHz;
+    MetricHistogram loop;     // Main loop iteration time
+    uint32_t logDropped;      // Deferred log records lost to a full queue
+    EventBusStats bus;
+    uint32_t busEvents[(uint8_t)BusEventType::COUNT];
+    MetricHistogram busDelay; // Publish to dispatch
+#ifdef LOOP_PROFILING
+    LoopSectionStats profile[(uint8_t)LoopSection::COUNT];
+#endif
+};
+
+#endif // SYSTEM_SNAPSHOT_H
@@ -1,32 +1,77 @@
 // TelegramHandler.cpp
 
 #include "TelegramHandler.h"
+#include "AlarmSystem.h"
+#include "ConfigStore.h"
+#include "JsonWriter.h"
+#include "DeferredLog.h"
+#include "MemoryBudget.h"
+#include "Notifier.h"
 #include <Preferences.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <esp_crc.h>
 
 // Add debug logging macro for Telegram operations
 #ifdef TELEGRAM_DEBUG
-#define TELEGRAM_LOG(format, ...) Serial.printf("[Telegram Debug] " format "\n", ##__VA_ARGS__)
+#define TELEGRAM_LOG(format, ...) DLOG_DEBUG("[Telegram Debug] " format, ##__VA_ARGS__)
 #else
 #define TELEGRAM_LOG(format, ...)
 #endif
 
 // Static member initialization
 TelegramHandler::ApartmentConfig TelegramHandler::_apartmentConfigs[MAX_APARTMENTS];
+TelegramHandler::BotToken TelegramHandler::_botTokens[MAX_BOT_TOKENS];
 String TelegramHandler::_lastError = "";
 WiFiClientSecure TelegramHandler::_client;
+WiFiClient TelegramHandler::_plainClient;
+TelegramHandler::ApiEndpoint TelegramHandler::_api = {"api.telegram.org", 443, true};
 uint32_t TelegramHandler::_lastMessageTime = 0;
 bool TelegramHandler::_isInitialized = false;
-CTBot TelegramHandler::_bot; // Initialize the static CTBot member
+TelegramResult TelegramHandler::_lastResult;
+JsonStream TelegramHandler::_responseParser;
 const char *TelegramHandler::PREFERENCE_NAMESPACE = "telegram";
 const char *TelegramHandler::TOKEN_KEY_PREFIX = "token_";
 const char *TelegramHandler::CHAT_ID_KEY_PREFIX = "chatid_";
 const char *TelegramHandler::ENABLED_KEY_PREFIX = "enabled_";
+const char *TelegramHandler::COALESCE_WINDOW_KEY = "coalesce_ms";
+const char *TelegramHandler::ESCALATION_DELAY_KEY = "escalate_s";
+const char *TelegramHandler::API_URL_KEY = "api_url";
+
+uint32_t TelegramHandler::_pendingTheftMask = 0;
+uint8_t TelegramHandler::_pendingWireCutMask = 0;
+uint8_t TelegramHandler::_pendingDistWireCutMask = 0;
+uint32_t TelegramHandler::_pendingSince = 0;
+uint32_t TelegramHandler::_coalesceWindow = ALERT_COALESCE_WINDOW;
+
+TelegramHandler::FanoutEntry TelegramHandler::_fanoutPlans[MAX_APARTMENTS][MAX_APARTMENTS];
+uint8_t TelegramHandler::_fanoutCounts[MAX_APARTMENTS];
+bool TelegramHandler::_fanoutDirty = true;
+
+bool TelegramHandler::_pollBotsDirty = true;
+uint8_t TelegramHandler::_changedBotSlots = 0;
+static_assert(MAX_BOT_TOKENS <= 8, "_changedBotSlots holds one bit per bot slot");
+SemaphoreHandle_t TelegramHandler::_pollMutex = NULL;
+QueueHandle_t TelegramHandler::_commandQueue = NULL;
+TaskHandle_t TelegramHandler::_pollTask = NULL;
+uint32_t TelegramHandler::_ackTime[MAX_APARTMENTS] = {0};
+
+Incident TelegramHandler::_incidents[MAX_APARTMENTS];
+uint16_t TelegramHandler::_escalationDelay = ESCALATION_DELAY;
+
+HistoryEntry TelegramHandler::_history[ALERT_HISTORY_SIZE];
+uint8_t TelegramHandler::_historyHead = 0;
+uint8_t TelegramHandler::_historyCount = 0;
+
+// Not cleared at startup, validated by magic and CRC in initPersistedAlerts()
+RTC_NOINIT_ATTR PersistedAlertRing TelegramHandler::_persistedAlerts;
 
 QueuedMessage TelegramHandler::_messageQueue[MAX_QUEUE_SIZE];
 uint8_t TelegramHandler::_queueHead = 0;
 uint8_t TelegramHandler::_queueTail = 0;
 uint8_t TelegramHandler::_queueSize = 0;
+uint8_t TelegramHandler::_queueHighWater = 0;
+TelegramStats TelegramHandler::_stats = {};
 bool TelegramHandler::_processingQueue = false;
 
 // Initialization
@@ -42,26 +87,40 @@ bool TelegramHandler::begin()
   loadAllConfigurations();
   TELEGRAM_LOG("Loaded configurations from storage");
 
-  // We'll use the first configured apartment's token
-  String token = "";
+  // Requeue alerts that were still undelivered when the system restarted
+  initPersistedAlerts();
+  replayPersistedAlerts();
+
+  // Each apartment refers to its own bot token, so only warn when none is configured
+  bool hasToken = false;
   for (uint8_t i = 0; i < MAX_APARTMENTS; i++)
   {
     if (_apartmentConfigs[i].configured)
     {
-      token = _apartmentConfigs[i].token;
+      hasToken = true;
       break;
     }
   }
 
-  if (token.isEmpty())
+  if (!hasToken)
   {
     Serial.println(F("[Telegram] Warning: No configured token found"));
-    token = "DEFAULT_TOKEN"; // You might want to set a default token or handle this differently
   }
 
-  // set the telegram bot token - using the static _bot instance
-  _bot.setTelegramToken(token);
-  TELEGRAM_LOG("Telegram bot token set: %s", token.c_str());
+  // The Bot API server certificate is not pinned
+  _client.setInsecure();
+  _client.setTimeout(TELEGRAM_RESPONSE_TIMEOUT); // Milliseconds on arduino-esp32 3.x
+  _plainClient.setTimeout(TELEGRAM_RESPONSE_TIMEOUT);
+
+  // Bot commands are long-polled on core 0 so the detection loop never waits on the network
+  _pollMutex = xSemaphoreCreateMutex();
+  _commandQueue = xQueueCreate(COMMAND_QUEUE_SIZE, sizeof(BotCommand));
+  if (_pollMutex == NULL || _commandQueue == NULL ||
+      xTaskCreatePinnedToCore(pollTaskLoop, "tg_poll", 8192, NULL, 1, &_pollTask, 0) != pdPASS)
+  {
+    _lastError = "Failed to start bot command polling";
+    Serial.println(F("[Telegram] Error: Failed to start bot command polling"));
+  }
 
   _isInitialized = true;
   Serial.println(F("[Telegram] Initialization complete"));
@@ -111,13 +170,27 @@ bool TelegramHandler::configureApartment(uint8_t apartmentNumber, const String &
     return false;
   }
 
+  // Apartments sharing a bot share one table entry
+  uint8_t tokenIndex = internToken(token);
+  if (tokenIndex == NO_BOT_TOKEN)
+  {
+    _lastError = "Too many different bot tokens";
+    Serial.println(F("[Telegram] Error: Too many different bot tokens"));
+    return false;
+  }
+
+  // Saving the token again gives a rejected bot another chance
+  if (_botTokens[tokenIndex].stats.state == BotTokenState::UNAUTHORIZED)
+    _botTokens[tokenIndex].stats.state = BotTokenState::UNKNOWN;
+
   uint8_t index = apartmentNumber - 1;
-  _apartmentConfigs[index].token = token;
+  setApartmentToken(apartmentNumber, tokenIndex);
   _apartmentConfigs[index].chatId = chatId;
   _apartmentConfigs[index].configured = true;
+  markConfigChanged();
 
   // Save the configuration
-  saveApartmentConfig(apartmentNumber);
+  ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveAllConfigurations);
 
   Serial.printf("[Telegram] Apartment %d configured successfully\n", apartmentNumber);
   return true;
@@ -132,13 +205,14 @@ bool TelegramHandler::removeApartmentConfig(uint8_t apartmentNumber)
   }
 
   uint8_t index = apartmentNumber - 1;
-  _apartmentConfigs[index].token = "";
+  setApartmentToken(apartmentNumber, NO_BOT_TOKEN);
   _apartmentConfigs[index].chatId = 0;
   _apartmentConfigs[index].enabled = false;
   _apartmentConfigs[index].configured = false;
+  markConfigChanged();
 
   // Save the empty configuration
-  saveApartmentConfig(apartmentNumber);
+  ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveAllConfigurations);
 
   return true;
 }
@@ -172,7 +246,8 @@ bool TelegramHandler::enableApartment(uint8_t apartmentNumber)
   }
 
   _apartmentConfigs[index].enabled = true;
-  saveApartmentConfig(apartmentNumber);
+  markConfigChanged();
+  ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveAllConfigurations);
 
   // Send notification about service activation
   sendServiceEnabledMessage(apartmentNumber);
@@ -196,7 +271,8 @@ bool TelegramHandler::disableApartment(uint8_t apartmentNumber)
   }
 
   _apartmentConfigs[index].enabled = false;
-  saveApartmentConfig(apartmentNumber);
+  markConfigChanged();
+  ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveAllConfigurations);
 
   // Send notification about service deactivation
   sendServiceDisabledMessage(apartmentNumber);
@@ -219,28 +295,64 @@ void TelegramHandler::loadAllConfigurations()
 {
   Serial.println(F("[Telegram] Loading all configurations from storage"));
 
-  Preferences prefs;
-  if (prefs.begin(PREFERENCE_NAMESPACE, true))
+  // Defaults for anything the stored blob does not cover
+  StoredConfig config;
+  memset(&config, 0, sizeof(config));
+  for (uint8_t i = 0; i < MAX_APARTMENTS; i++)
+    config.apartments[i].tokenIndex = NO_BOT_TOKEN;
+  config.coalesceWindow = ALERT_COALESCE_WINDOW;
+  config.escalationDelay = ESCALATION_DELAY;
+  ApiEndpoint defaultApi;
+  parseApiBaseUrl(TELEGRAM_API_BASE_URL, defaultApi);
+  strcpy(config.apiHost, defaultApi.host);
+  config.apiPort = defaultApi.port;
+  config.apiSecure = defaultApi.secure;
+
+  ConfigLoadResult result = ConfigStore::load(PREFERENCE_NAMESPACE, CONFIG_VERSION, &config, sizeof(config));
+  bool migrated = result == ConfigLoadResult::MISSING && loadLegacyConfig(config);
+  applyStoredConfig(config);
+
+  // Per-apartment legacy keys are named by prefix, removeLegacyConfig() drops those
+  const char *legacyKeys[] = {COALESCE_WINDOW_KEY, ESCALATION_DELAY_KEY, API_URL_KEY};
+  if (ConfigStore::finishLoad(PREFERENCE_NAMESPACE, result, migrated, saveAllConfigurations, legacyKeys, 3))
   {
-    for (uint8_t i = 1; i <= MAX_APARTMENTS; i++)
-    {
-      loadApartmentConfig(i);
-    }
-    prefs.end();
+    removeLegacyConfig();
   }
 
-  Serial.println(F("[Telegram] Configurations loaded successfully"));
+  Serial.printf("[Telegram] Configurations %s\n", ConfigStore::getResultName(result));
 }
 
-void TelegramHandler::saveAllConfigurations()
+bool TelegramHandler::saveAllConfigurations()
 {
-  for (uint8_t i = 1; i <= MAX_APARTMENTS; i++)
+  StoredConfig config;
+  memset(&config, 0, sizeof(config));
+
+  for (uint8_t i = 0; i < MAX_BOT_TOKENS; i++)
   {
-    if (_apartmentConfigs[i - 1].configured)
-    {
-      saveApartmentConfig(i);
-    }
+    if (isBotTokenInUse(i))
+      strcpy(config.tokens[i], _botTokens[i].token);
   }
+
+  for (uint8_t i = 0; i < MAX_APARTMENTS; i++)
+  {
+    const ApartmentConfig &apartment = _apartmentConfigs[i];
+    config.apartments[i].chatId = apartment.configured ? apartment.chatId : 0;
+    config.apartments[i].tokenIndex = apartment.configured ? apartment.tokenIndex : NO_BOT_TOKEN;
+    config.apartments[i].enabled = apartment.enabled;
+  }
+
+  config.coalesceWindow = _coalesceWindow;
+  config.escalationDelay = _escalationDelay;
+  strcpy(config.apiHost, _api.host);
+  config.apiPort = _api.port;
+  config.apiSecure = _api.secure;
+
+  if (!ConfigStore::save(PREFERENCE_NAMESPACE, CONFIG_VERSION, &config, sizeof(config)))
+  {
+    _lastError = ConfigStore::getLastError();
+    return false;
+  }
+  return true;
 }
 
 // System Status Messages
@@ -302,7 +414,7 @@ bool TelegramHandler::sendTheftAlertToOwner(uint8_t apartmentNumber)
 
   uint8_t index = apartmentNumber - 1;
   return sendMessage(
-      _apartmentConfigs[index].token,
+      _apartmentConfigs[index].tokenIndex,
       _apartmentConfigs[index].chatId,
       THEFT_ALERT_OWNER_AR,
       THEFT_ALERT_OWNER_EN);
@@ -347,83 +459,34 @@ bool TelegramHandler::sendTheftAlertToOtherSide(uint8_t targetApartment, uint8_t
 // Wire Cut Alert Messages
 bool TelegramHandler::sendWireCutAlert(BuildingSide side, BoxPosition box)
 {
-  Serial.printf("[Telegram] Sending wire cut alert for side: %d, box: %d\n", (int)side, (int)box);
-
-  // Get all apartments on this side
-  uint8_t apartments[12];
-  uint8_t count = 0;
-
-  for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
-  {
-    uint8_t aptNum = i + 1;
-    uint8_t index = getApartmentIndex(aptNum);
+  DLOG_INFO("[Telegram] Sending wire cut alert for side: %d, box: %d", (int)side, (int)box);
 
-    if (index != 0xFF &&
-        APARTMENT_LOCATIONS[index].side == side &&
-        isApartmentEnabled(aptNum))
-    {
-      apartments[count++] = aptNum;
-    }
-  }
+  recordHistory(HistoryEventType::WIRE_CUT, (uint8_t)side * 2 + (uint8_t)box);
 
-  // Send message to all enabled apartments on this side
-  bool success = true;
-  for (uint8_t i = 0; i < count; i++)
-  {
-    uint8_t aptNum = apartments[i];
-    uint8_t index = aptNum - 1;
+  // Every enabled apartment on this side is notified when the digest is flushed
+  if (!hasPendingAlerts())
+    _pendingSince = millis();
+  _pendingWireCutMask |= (1 << ((uint8_t)side * 2 + (uint8_t)box));
 
-    if (!sendMessage(
-            _apartmentConfigs[index].token,
-            _apartmentConfigs[index].chatId,
-            SENSOR_WIRE_CUT_ALERT_AR,
-            SENSOR_WIRE_CUT_ALERT_EN))
-    {
-      success = false;
-    }
-  }
+  if (_coalesceWindow == 0)
+    flushPendingAlerts();
 
-  return success;
+  return true;
 }
 
 bool TelegramHandler::sendDistributionWireCutAlert(BuildingSide side)
 {
+  recordHistory(HistoryEventType::DISTRIBUTION_WIRE_CUT, (uint8_t)side);
 
-  // Get all apartments on this side
-  uint8_t apartments[12];
-  uint8_t count = 0;
-
-  for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
-  {
-    uint8_t aptNum = i + 1;
-    uint8_t index = getApartmentIndex(aptNum);
-
-    if (index != 0xFF &&
-        APARTMENT_LOCATIONS[index].side == side &&
-        isApartmentEnabled(aptNum))
-    {
-      apartments[count++] = aptNum;
-    }
-  }
-
-  // Send message to all enabled apartments on this side
-  bool success = true;
-  for (uint8_t i = 0; i < count; i++)
-  {
-    uint8_t aptNum = apartments[i];
-    uint8_t index = aptNum - 1;
+  // Every enabled apartment on this side is notified when the digest is flushed
+  if (!hasPendingAlerts())
+    _pendingSince = millis();
+  _pendingDistWireCutMask |= (1 << (uint8_t)side);
 
-    if (!sendMessage(
-            _apartmentConfigs[index].token,
-            _apartmentConfigs[index].chatId,
-            DIST_CTRL_WIRE_CUT_ALERT_AR,
-            DIST_CTRL_WIRE_CUT_ALERT_EN))
-    {
-      success = false;
-    }
-  }
+  if (_coalesceWindow == 0)
+    flushPendingAlerts();
 
-  return success;
+  return true;
 }
 
 bool TelegramHandler::sendStartupWireCutAlert(BuildingSide side, BoxPosition box)
@@ -455,7 +518,7 @@ bool TelegramHandler::sendStartupWireCutAlert(BuildingSide side, BoxPosition box
     uint8_t index = aptNum - 1;
 
     if (!sendMessage(
-            _apartmentConfigs[index].token,
+            _apartmentConfigs[index].tokenIndex,
             _apartmentConfigs[index].chatId,
             STARTUP_SENSOR_WIRE_CUT_AR,
             STARTUP_SENSOR_WIRE_CUT_EN))
@@ -495,7 +558,7 @@ bool TelegramHandler::sendStartupDistributionWireCutAlert(BuildingSide side)
     uint8_t index = aptNum - 1;
 
     if (!sendMessage(
-            _apartmentConfigs[index].token,
+            _apartmentConfigs[index].tokenIndex,
             _apartmentConfigs[index].chatId,
             STARTUP_DIST_CTRL_WIRE_CUT_AR,
             STARTUP_DIST_CTRL_WIRE_CUT_EN))
@@ -510,98 +573,290 @@ bool TelegramHandler::sendStartupDistributionWireCutAlert(BuildingSide side)
 // Batch Message Sending
 void TelegramHandler::sendTheftAlertsToAll(uint8_t targetApartment)
 {
-  Serial.printf("[Telegram] Sending theft alerts for apartment %d to all recipients\n", targetApartment);
+  DLOG_INFO("[Telegram] Sending theft alerts for apartment %d to all recipients", targetApartment);
+
+  if (getApartmentIndex(targetApartment) == 0xFF)
+    return;
+
+  recordHistory(HistoryEventType::THEFT, targetApartment);
+
+  // Recipients are resolved when the digest is flushed, so several meters hit
+  // within the coalescing window end up in a single message per resident
+  if (!hasPendingAlerts())
+    _pendingSince = millis();
+  _pendingTheftMask |= (1UL << (targetApartment - 1));
+
+  if (_coalesceWindow == 0)
+    flushPendingAlerts();
+}
+
+void TelegramHandler::sendWireCutAlertsToSide(BuildingSide side)
+{
+  // For a wire cut, we need to notify all apartments on that side
+  sendWireCutAlert(side, BoxPosition::RIGHT_BOX); // Box position doesn't matter here
+}
+
+void TelegramHandler::sendStartupWireCutAlertsToSide(BuildingSide side)
+{
+  // For a startup wire cut, we need to notify all apartments on that side
+  sendStartupWireCutAlert(side, BoxPosition::RIGHT_BOX); // Box position doesn't matter here
+}
+
+// Alert Coalescing
+void TelegramHandler::setAlertCoalesceWindow(uint32_t windowMs)
+{
+  _coalesceWindow = windowMs;
+  ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveAllConfigurations);
+
+  // Don't hold back anything that is already waiting
+  if (windowMs == 0)
+    flushPendingAlerts();
+}
+
+uint32_t TelegramHandler::getAlertCoalesceWindow()
+{
+  return _coalesceWindow;
+}
 
-  // Send alert to owner first
-  sendTheftAlertToOwner(targetApartment);
+bool TelegramHandler::hasPendingAlerts()
+{
+  return _pendingTheftMask != 0 || _pendingWireCutMask != 0 || _pendingDistWireCutMask != 0;
+}
 
-  // Get apartment index and location
-  uint8_t targetIndex = getApartmentIndex(targetApartment);
-  if (targetIndex == 0xFF)
+void TelegramHandler::flushPendingAlerts()
+{
+  if (!hasPendingAlerts())
     return;
 
-  BuildingSide targetSide = APARTMENT_LOCATIONS[targetIndex].side;
-  BoxPosition targetBox = APARTMENT_LOCATIONS[targetIndex].box;
+  uint32_t theftMask = _pendingTheftMask;
+  uint8_t wireCutMask = _pendingWireCutMask;
+  uint8_t distWireCutMask = _pendingDistWireCutMask;
+  uint32_t eventMillis = _pendingSince;
+  _pendingTheftMask = 0;
+  _pendingWireCutMask = 0;
+  _pendingDistWireCutMask = 0;
+  _pendingSince = 0;
 
-  // Find apartments in the same box
-  uint8_t sameBoxApts[6];
-  uint8_t sameBoxCount = 0;
-  getApartmentsInSameBox(targetApartment, sameBoxApts, sameBoxCount);
+  // Meters whose owner already answered the alert are not reported again
+  theftMask &= ~getAcknowledgedIncidents();
+  openIncidents(theftMask);
 
-  // Find apartments in the adjacent box
-  uint8_t adjacentBoxApts[6];
-  uint8_t adjacentBoxCount = 0;
-  // For adjacent box, we need to get apartments on the same side but different box
-  for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
+  TELEGRAM_LOG("Flushing alert digest: theft mask 0x%06lx, wire cut mask 0x%02x, distribution mask 0x%02x",
+               (unsigned long)theftMask, wireCutMask, distWireCutMask);
+
+  // Sort the affected meters per recipient with one walk over the fan-out plans
+  uint32_t recipientMasks[MAX_APARTMENTS][ALERT_TYPE_COUNT];
+  collectFanout(theftMask, recipientMasks);
+
+  for (uint8_t apt = 1; apt <= MAX_APARTMENTS; apt++)
   {
-    uint8_t aptNum = i + 1;
-    uint8_t index = getApartmentIndex(aptNum);
+    if (!isApartmentEnabled(apt))
+      continue;
 
-    if (index != 0xFF &&
-        APARTMENT_LOCATIONS[index].side == targetSide &&
-        APARTMENT_LOCATIONS[index].box != targetBox)
-    {
-      adjacentBoxApts[adjacentBoxCount++] = aptNum;
-    }
+    uint8_t side = (uint8_t)getApartmentSide(apt);
+    bool sensorWireCut = (wireCutMask & (0x03 << (side * 2))) != 0;
+    bool distributionWireCut = (distWireCutMask & (1 << side)) != 0;
+
+    // Residents who sent /ack only keep getting wire cut alerts
+    if (isAlertSilenced(apt))
+      memset(recipientMasks[apt - 1], 0, sizeof(recipientMasks[apt - 1]));
+
+    sendAlertDigest(apt, theftMask, recipientMasks[apt - 1], sensorWireCut, distributionWireCut, eventMillis);
   }
+}
 
-  // Find apartments on the other side
-  uint8_t otherSideApts[12];
-  uint8_t otherSideCount = 0;
-  BuildingSide otherSide = (targetSide == BuildingSide::RIGHT_SIDE) ? BuildingSide::LEFT_SIDE : BuildingSide::RIGHT_SIDE;
+void TelegramHandler::sendAlertDigest(uint8_t apartmentNumber, uint32_t theftMask, const uint32_t typeMasks[ALERT_TYPE_COUNT],
+                                      bool sensorWireCut, bool distributionWireCut, uint32_t eventMillis)
+{
+  String messageAR;
+  String messageEN;
 
-  for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
-  {
-    uint8_t aptNum = i + 1;
-    uint8_t index = getApartmentIndex(aptNum);
+  if (!buildAlertDigest(typeMasks, sensorWireCut, distributionWireCut, messageAR, messageEN))
+    return;
 
-    if (index != 0xFF && APARTMENT_LOCATIONS[index].side == otherSide)
-    {
-      otherSideApts[otherSideCount++] = aptNum;
-    }
+  // Keep a compact copy in RTC memory until Telegram confirms delivery
+  uint8_t flags = (sensorWireCut ? PERSISTED_FLAG_SENSOR_WIRE_CUT : 0) |
+                  (distributionWireCut ? PERSISTED_FLAG_DIST_WIRE_CUT : 0);
+  uint32_t sequence = persistAlert(apartmentNumber, theftMask, flags, eventMillis);
+
+  // The owner gets the acknowledge buttons; alerts about other meters only
+  // can still be cancelled once those owners answer
+  uint32_t ownerMask = typeMasks[(uint8_t)AlertType::OWNER];
+  uint32_t incidentMask = 0;
+  for (uint8_t type = 0; type < ALERT_TYPE_COUNT; type++)
+    incidentMask |= typeMasks[type];
+  bool neighbourOnly = ownerMask == 0 && !sensorWireCut && !distributionWireCut;
+
+  uint8_t configIndex = apartmentNumber - 1;
+  sendMessage(
+      _apartmentConfigs[configIndex].tokenIndex,
+      _apartmentConfigs[configIndex].chatId,
+      messageAR,
+      messageEN,
+      sequence,
+      incidentMask,
+      neighbourOnly ? MessageTier::NEIGHBOUR : MessageTier::NORMAL,
+      ownerMask != 0 ? apartmentNumber : 0);
+}
+
+bool TelegramHandler::buildAlertDigest(const uint32_t typeMasks[ALERT_TYPE_COUNT], bool sensorWireCut, bool distributionWireCut,
+                                       String &messageAR, String &messageEN)
+{
+  // Most urgent section first
+  if (typeMasks[(uint8_t)AlertType::OWNER] != 0)
+  {
+    messageAR += THEFT_ALERT_OWNER_AR;
+    messageEN += THEFT_ALERT_OWNER_EN;
+  }
+  if (distributionWireCut)
+  {
+    if (messageAR.length() > 0)
+      messageAR += "\n\n";
+    messageAR += DIST_CTRL_WIRE_CUT_ALERT_AR;
+    messageEN += DIST_CTRL_WIRE_CUT_ALERT_EN;
   }
+  if (sensorWireCut)
+  {
+    if (messageAR.length() > 0)
+      messageAR += "\n\n";
+    messageAR += SENSOR_WIRE_CUT_ALERT_AR;
+    messageEN += SENSOR_WIRE_CUT_ALERT_EN;
+  }
+  appendDigestSection(messageAR, messageEN, typeMasks[(uint8_t)AlertType::SAME_BOX],
+                      THEFT_ALERT_SAME_BOX_AR, THEFT_ALERT_SAME_BOX_EN,
+                      THEFT_DIGEST_SAME_BOX_AR, THEFT_DIGEST_SAME_BOX_EN);
+  appendDigestSection(messageAR, messageEN, typeMasks[(uint8_t)AlertType::ADJACENT_BOX],
+                      THEFT_ALERT_ADJACENT_BOX_AR, THEFT_ALERT_ADJACENT_BOX_EN,
+                      THEFT_DIGEST_ADJACENT_BOX_AR, THEFT_DIGEST_ADJACENT_BOX_EN);
+  appendDigestSection(messageAR, messageEN, typeMasks[(uint8_t)AlertType::OTHER_SIDE],
+                      THEFT_ALERT_OTHER_SIDE_AR, THEFT_ALERT_OTHER_SIDE_EN,
+                      THEFT_DIGEST_OTHER_SIDE_AR, THEFT_DIGEST_OTHER_SIDE_EN);
+
+  return messageAR.length() > 0;
+}
+
+void TelegramHandler::appendDigestSection(String &messageAR, String &messageEN, uint32_t apartmentMask,
+                                          const char *singleAR, const char *singleEN,
+                                          const char *digestAR, const char *digestEN)
+{
+  if (apartmentMask == 0)
+    return;
+
+  char formattedAR[512];
+  char formattedEN[512];
 
-  // Send messages to apartments in the same box
-  for (uint8_t i = 0; i < sameBoxCount; i++)
+  // A single meter keeps the original per-apartment wording
+  if ((apartmentMask & (apartmentMask - 1)) == 0)
   {
-    uint8_t aptNum = sameBoxApts[i];
-    if (aptNum != targetApartment && isApartmentEnabled(aptNum))
-    {
-      sendTheftAlertToSameBox(targetApartment, aptNum);
-    }
+    int apartmentNumber = __builtin_ctzl(apartmentMask) + 1;
+    snprintf(formattedAR, sizeof(formattedAR), singleAR, apartmentNumber);
+    snprintf(formattedEN, sizeof(formattedEN), singleEN, apartmentNumber);
+  }
+  else
+  {
+    char apartmentList[96];
+    formatApartmentList(apartmentMask, apartmentList, sizeof(apartmentList));
+    snprintf(formattedAR, sizeof(formattedAR), digestAR, apartmentList);
+    snprintf(formattedEN, sizeof(formattedEN), digestEN, apartmentList);
   }
 
-  // Send messages to apartments in the adjacent box
-  for (uint8_t i = 0; i < adjacentBoxCount; i++)
+  if (messageAR.length() > 0)
+    messageAR += "\n\n";
+  messageAR += formattedAR;
+  messageEN += formattedEN;
+}
+
+void TelegramHandler::formatApartmentList(uint32_t apartmentMask, char *buffer, size_t size)
+{
+  size_t used = 0;
+  buffer[0] = '\0';
+
+  for (uint8_t apt = 1; apt <= MAX_APARTMENTS && used < size; apt++)
   {
-    uint8_t aptNum = adjacentBoxApts[i];
-    if (isApartmentEnabled(aptNum))
-    {
-      sendTheftAlertToAdjacentBox(targetApartment, aptNum);
-    }
+    if (!(apartmentMask & (1UL << (apt - 1))))
+      continue;
+
+    int written = snprintf(buffer + used, size - used, used == 0 ? "%d" : ", %d", apt);
+    if (written < 0)
+      break;
+    used += written;
   }
+}
+
+// Fan-out Plan Helpers
+void TelegramHandler::rebuildFanoutPlans()
+{
+  TELEGRAM_LOG("Rebuilding fan-out plans");
 
-  // Send messages to apartments on the other side
-  for (uint8_t i = 0; i < otherSideCount; i++)
+  for (uint8_t target = 1; target <= MAX_APARTMENTS; target++)
   {
-    uint8_t aptNum = otherSideApts[i];
-    if (isApartmentEnabled(aptNum))
+    FanoutEntry *plan = _fanoutPlans[target - 1];
+    uint8_t &count = _fanoutCounts[target - 1];
+    count = 0;
+
+    uint8_t targetIndex = getApartmentIndex(target);
+    if (targetIndex == 0xFF)
+      continue;
+
+    BuildingSide side = APARTMENT_LOCATIONS[targetIndex].side;
+    BoxPosition box = APARTMENT_LOCATIONS[targetIndex].box;
+
+    if (isApartmentEnabled(target))
+      plan[count++] = {target, AlertType::OWNER};
+
+    // Same box, then adjacent box, then the other side of the building
+    for (uint8_t pass = 0; pass < 3; pass++)
     {
-      sendTheftAlertToOtherSide(targetApartment, aptNum);
+      for (uint8_t recipient = 1; recipient <= MAX_APARTMENTS; recipient++)
+      {
+        if (recipient == target || !isApartmentEnabled(recipient))
+          continue;
+
+        uint8_t recipientIndex = getApartmentIndex(recipient);
+        if (recipientIndex == 0xFF)
+          continue;
+
+        bool sameSide = APARTMENT_LOCATIONS[recipientIndex].side == side;
+        bool sameBox = sameSide && APARTMENT_LOCATIONS[recipientIndex].box == box;
+
+        if (pass == 0 && sameBox)
+          plan[count++] = {recipient, AlertType::SAME_BOX};
+        else if (pass == 1 && sameSide && !sameBox)
+          plan[count++] = {recipient, AlertType::ADJACENT_BOX};
+        else if (pass == 2 && !sameSide)
+          plan[count++] = {recipient, AlertType::OTHER_SIDE};
+      }
     }
   }
+
+  _fanoutDirty = false;
 }
 
-void TelegramHandler::sendWireCutAlertsToSide(BuildingSide side)
+void TelegramHandler::markConfigChanged()
 {
-  // For a wire cut, we need to notify all apartments on that side
-  sendWireCutAlert(side, BoxPosition::RIGHT_BOX); // Box position doesn't matter here
+  _fanoutDirty = true;
+  _pollBotsDirty = true;
 }
 
-void TelegramHandler::sendStartupWireCutAlertsToSide(BuildingSide side)
+void TelegramHandler::collectFanout(uint32_t theftMask, uint32_t recipientMasks[MAX_APARTMENTS][ALERT_TYPE_COUNT])
 {
-  // For a startup wire cut, we need to notify all apartments on that side
-  sendStartupWireCutAlert(side, BoxPosition::RIGHT_BOX); // Box position doesn't matter here
+  if (_fanoutDirty)
+    rebuildFanoutPlans();
+
+  memset(recipientMasks, 0, sizeof(uint32_t) * MAX_APARTMENTS * ALERT_TYPE_COUNT);
+
+  for (uint8_t target = 1; target <= MAX_APARTMENTS; target++)
+  {
+    uint32_t targetBit = 1UL << (target - 1);
+    if (!(theftMask & targetBit))
+      continue;
+
+    const FanoutEntry *plan = _fanoutPlans[target - 1];
+    for (uint8_t i = 0; i < _fanoutCounts[target - 1]; i++)
+    {
+      recipientMasks[plan[i].recipient - 1][(uint8_t)plan[i].type] |= targetBit;
+    }
+  }
 }
 
 // Private Helper Methods
@@ -638,6 +893,51 @@ bool TelegramHandler::validateApartmentNumber(uint8_t apartmentNumber)
   return (apartmentNumber >= 1 && apartmentNumber <= MAX_APARTMENTS);
 }
 
+bool TelegramHandler::parseApiBaseUrl(const String &url, ApiEndpoint &endpoint)
+{
+  ApiEndpoint parsed;
+  String rest;
+  if (url.startsWith("https://"))
+  {
+    parsed.secure = true;
+    parsed.port = 443;
+    rest = url.substring(8);
+  }
+  else if (url.startsWith("http://"))
+  {
+    parsed.secure = false;
+    parsed.port = 80;
+    rest = url.substring(7);
+  }
+  else
+  {
+    return false;
+  }
+
+  // Only scheme, host and port; the /bot<token>/<method> path is always appended
+  if (rest.endsWith("/"))
+    rest.remove(rest.length() - 1);
+  if (rest.indexOf('/') >= 0)
+    return false;
+
+  int colon = rest.indexOf(':');
+  if (colon >= 0)
+  {
+    long port = rest.substring(colon + 1).toInt();
+    if (port <= 0 || port > 65535)
+      return false;
+    parsed.port = port;
+    rest = rest.substring(0, colon);
+  }
+
+  if (rest.length() == 0 || rest.length() >= TELEGRAM_API_HOST_SIZE)
+    return false;
+  strcpy(parsed.host, rest.c_str());
+
+  endpoint = parsed;
+  return true;
+}
+
 // Get apartment token
 String TelegramHandler::getApartmentToken(uint8_t apartmentNumber)
 {
@@ -650,7 +950,7 @@ String TelegramHandler::getApartmentToken(uint8_t apartmentNumber)
   if (index == 0xFF)
     return "";
   // Return the token for the specified apartment number
-  return _apartmentConfigs[index].token;
+  return String(_botTokens[_apartmentConfigs[index].tokenIndex].token);
 }
 
 // Get apartment chat ID
@@ -667,91 +967,374 @@ int64_t TelegramHandler::getApartmentChatId(uint8_t apartmentNumber)
   return _apartmentConfigs[index].chatId;
 }
 
-// Message Sending Helpers: add to queue
-bool TelegramHandler::sendMessage(const String &token, int64_t chatId, const String &messageAR, const String &messageEN)
+// Bot API Server
+bool TelegramHandler::setApiBaseUrl(const String &url)
 {
-  String fullMessage = messageAR + "\n\n" + messageEN;
-  Serial.printf("[Telegram] Queueing message to chat ID: %s\n", String(chatId));
+  ApiEndpoint endpoint;
+  if (!parseApiBaseUrl(url.length() > 0 ? url : String(TELEGRAM_API_BASE_URL), endpoint))
+  {
+    _lastError = "Invalid API base URL";
+    return false;
+  }
 
-  // Instead of sending directly, add to queue
-  return enqueueMessage(token, chatId, fullMessage);
+  if (_pollMutex != NULL)
+    xSemaphoreTake(_pollMutex, portMAX_DELAY);
+  _api = endpoint;
+  if (_pollMutex != NULL)
+    xSemaphoreGive(_pollMutex);
+  ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveAllConfigurations);
+
+  Serial.printf("[Telegram] Bot API server set to %s\n", getApiBaseUrl().c_str());
+  return true;
 }
 
-bool TelegramHandler::sendFormattedMessage(uint8_t apartmentNumber, const char *messageAR, const char *messageEN, ...)
+String TelegramHandler::getApiBaseUrl()
 {
-  if (!isApartmentEnabled(apartmentNumber))
-    return false;
-
-  uint8_t index = apartmentNumber - 1;
-  String token = _apartmentConfigs[index].token;
-  int64_t chatId = _apartmentConfigs[index].chatId;
+  String url = _api.secure ? "https://" : "http://";
+  url += _api.host;
+  if (_api.port != (_api.secure ? 443 : 80))
+    url += ":" + String(_api.port);
+  return url;
+}
 
-  // Format the messages with variable arguments
-  va_list args;
-  char formattedAR[512];
-  char formattedEN[512];
+// Queue Statistics
+uint8_t TelegramHandler::getQueueSize()
+{
+  return _queueSize;
+}
 
-  va_start(args, messageEN);
+uint8_t TelegramHandler::getQueueHighWater()
+{
+  return _queueHighWater;
+}
 
-  va_list args_copy;
-  va_copy(args_copy, args);
+TelegramStats TelegramHandler::getStats()
+{
+  return _stats;
+}
 
-  vsnprintf(formattedAR, sizeof(formattedAR), messageAR, args);
-  vsnprintf(formattedEN, sizeof(formattedEN), messageEN, args_copy);
+// Bot Token Table
+bool TelegramHandler::isBotTokenInUse(uint8_t tokenIndex)
+{
+  return tokenIndex < MAX_BOT_TOKENS && _botTokens[tokenIndex].token[0] != '\0';
+}
 
-  va_end(args_copy);
-  va_end(args);
+String TelegramHandler::getBotTokenLabel(uint8_t tokenIndex)
+{
+  if (!isBotTokenInUse(tokenIndex))
+    return "";
 
-  return sendMessage(token, chatId, String(formattedAR), String(formattedEN));
+  // The part before ':' is the public bot ID, the rest is the secret
+  const char *token = _botTokens[tokenIndex].token;
+  size_t idLength = strcspn(token, ":");
+  size_t length = strlen(token);
+  String label = String(token).substring(0, idLength);
+  if (length > idLength + 4)
+    label += ":..." + String(token + length - 4);
+  return label;
 }
 
-// Storage Helpers
-void TelegramHandler::saveApartmentConfig(uint8_t apartmentNumber)
+bool TelegramHandler::getBotTokenStats(uint8_t tokenIndex, BotTokenStats &stats)
 {
-  if (!validateApartmentNumber(apartmentNumber))
-    return;
-
-  uint8_t index = apartmentNumber - 1;
-  Preferences prefs;
+  if (!isBotTokenInUse(tokenIndex))
+    return false;
 
-  if (prefs.begin(PREFERENCE_NAMESPACE, false))
-  {
-    String tokenKey = generateStorageKey(TOKEN_KEY_PREFIX, apartmentNumber);
-    String chatIdKey = generateStorageKey(CHAT_ID_KEY_PREFIX, apartmentNumber);
-    String enabledKey = generateStorageKey(ENABLED_KEY_PREFIX, apartmentNumber);
+  stats = _botTokens[tokenIndex].stats;
+  return true;
+}
 
-    prefs.putString(tokenKey.c_str(), _apartmentConfigs[index].token);
-    // Store the int64_t chatId as a string
-    prefs.putString(chatIdKey.c_str(), String(_apartmentConfigs[index].chatId));
-    prefs.putBool(enabledKey.c_str(), _apartmentConfigs[index].enabled);
+uint8_t TelegramHandler::internToken(const String &token)
+{
+  if (token.length() == 0 || token.length() >= TELEGRAM_TOKEN_SIZE)
+    return NO_BOT_TOKEN;
 
-    prefs.end();
+  uint8_t freeSlot = NO_BOT_TOKEN;
+  for (uint8_t i = 0; i < MAX_BOT_TOKENS; i++)
+  {
+    if (strcmp(_botTokens[i].token, token.c_str()) == 0)
+    {
+      _botTokens[i].stats.apartments++;
+      return i;
+    }
+    if (_botTokens[i].token[0] == '\0' && freeSlot == NO_BOT_TOKEN)
+      freeSlot = i;
   }
+
+  if (freeSlot == NO_BOT_TOKEN)
+    return NO_BOT_TOKEN;
+
+  // The poll task reads token strings, so slots only change under its mutex
+  if (_pollMutex != NULL)
+    xSemaphoreTake(_pollMutex, portMAX_DELAY);
+  BotToken &entry = _botTokens[freeSlot];
+  memset(&entry, 0, sizeof(entry));
+  strcpy(entry.token, token.c_str());
+  entry.stats.apartments = 1;
+  _changedBotSlots |= 1 << freeSlot;
+  if (_pollMutex != NULL)
+    xSemaphoreGive(_pollMutex);
+
+  TELEGRAM_LOG("Bot token %s added to slot %d", getBotTokenLabel(freeSlot).c_str(), freeSlot);
+  return freeSlot;
 }
 
-void TelegramHandler::loadApartmentConfig(uint8_t apartmentNumber)
+void TelegramHandler::releaseToken(uint8_t tokenIndex)
 {
-  if (!validateApartmentNumber(apartmentNumber))
+  if (!isBotTokenInUse(tokenIndex))
+    return;
+
+  BotToken &entry = _botTokens[tokenIndex];
+  if (entry.stats.apartments > 1)
+  {
+    entry.stats.apartments--;
+    return;
+  }
+
+  // Last user gone: queued messages must not go out through whatever token takes the slot next
+  dropTokenMessages(tokenIndex);
+
+  if (_pollMutex != NULL)
+    xSemaphoreTake(_pollMutex, portMAX_DELAY);
+  memset(&entry, 0, sizeof(entry));
+  _changedBotSlots |= 1 << tokenIndex;
+  if (_pollMutex != NULL)
+    xSemaphoreGive(_pollMutex);
+}
+
+void TelegramHandler::setApartmentToken(uint8_t apartmentNumber, uint8_t tokenIndex)
+{
+  // Only configured apartments hold a reference to their table entry
+  ApartmentConfig &config = _apartmentConfigs[apartmentNumber - 1];
+  if (config.configured)
+    releaseToken(config.tokenIndex);
+  config.tokenIndex = tokenIndex;
+}
+
+void TelegramHandler::recordTokenResult(uint8_t tokenIndex, bool delivered)
+{
+  if (!isBotTokenInUse(tokenIndex))
+    return;
+
+  BotTokenStats &stats = _botTokens[tokenIndex].stats;
+  if (delivered)
+  {
+    stats.sent++;
+    stats.lastSuccess = millis();
+    stats.state = BotTokenState::VALID;
     return;
+  }
+
+  stats.failed++;
+  stats.lastErrorCode = _lastResult.errorCode;
+  // Telegram answers 401 for a revoked token and 404 for a malformed one
+  if (_lastResult.errorCode == 401 || _lastResult.errorCode == 404)
+    stats.state = BotTokenState::UNAUTHORIZED;
+}
+
+void TelegramHandler::dropTokenMessages(uint8_t tokenIndex)
+{
+  uint8_t dropped = 0;
+  uint8_t current = _queueHead;
+
+  for (uint8_t i = 0; i < _queueSize; i++)
+  {
+    QueuedMessage &msg = _messageQueue[current];
+    if (!msg.cancelled && msg.tokenIndex == tokenIndex)
+    {
+      msg.cancelled = true;
+      msg.message = String();
+      releasePersistedAlert(msg.sequence);
+      msg.sequence = 0;
+      dropped++;
+    }
+    current = (current + 1) % MAX_QUEUE_SIZE;
+  }
+
+  if (dropped > 0)
+  {
+    DLOG_WARN("[Telegram] Dropped %d queued message(s) for bot %s", dropped, getBotTokenLabel(tokenIndex));
+  }
+}
+
+// Message Sending Helpers: add to queue
+bool TelegramHandler::sendMessage(uint8_t tokenIndex, int64_t chatId, const String &messageAR, const String &messageEN,
+                                  uint32_t sequence, uint32_t incidentMask, MessageTier tier, uint8_t keyboardApartment)
+{
+  // Alerts about a neighbour's meter are informational, shed before anything else Telegram sends
+  if (tier == MessageTier::NEIGHBOUR && !MemoryBudget::admit(MemoryClient::TELEGRAM))
+  {
+    _lastError = "Low memory, informational alert not sent";
+    releasePersistedAlert(sequence);
+    return false;
+  }
+
+  String fullMessage = messageAR + "\n\n" + messageEN;
+  DLOG_DEBUG("[Telegram] Queueing message to chat ID: %s", String(chatId));
+
+  // Instead of sending directly, add to queue
+  return enqueueMessage(tokenIndex, chatId, fullMessage, sequence, incidentMask, tier, keyboardApartment);
+}
+
+bool TelegramHandler::sendFormattedMessage(uint8_t apartmentNumber, const char *messageAR, const char *messageEN, ...)
+{
+  if (!isApartmentEnabled(apartmentNumber))
+    return false;
 
   uint8_t index = apartmentNumber - 1;
+  uint8_t tokenIndex = _apartmentConfigs[index].tokenIndex;
+  int64_t chatId = _apartmentConfigs[index].chatId;
+
+  // Format the messages with variable arguments
+  va_list args;
+  char formattedAR[512];
+  char formattedEN[512];
+
+  va_start(args, messageEN);
+
+  va_list args_copy;
+  va_copy(args_copy, args);
+
+  vsnprintf(formattedAR, sizeof(formattedAR), messageAR, args);
+  vsnprintf(formattedEN, sizeof(formattedEN), messageEN, args_copy);
+
+  va_end(args_copy);
+  va_end(args);
+
+  return sendMessage(tokenIndex, chatId, String(formattedAR), String(formattedEN));
+}
+
+// Storage Helpers
+void TelegramHandler::applyStoredConfig(const StoredConfig &config)
+{
+  for (uint8_t i = 0; i < MAX_APARTMENTS; i++)
+  {
+    const StoredApartment &stored = config.apartments[i];
+    uint8_t tokenIndex = NO_BOT_TOKEN;
+    if (stored.tokenIndex < MAX_BOT_TOKENS && stored.chatId != 0)
+    {
+      char token[TELEGRAM_TOKEN_SIZE];
+      memcpy(token, config.tokens[stored.tokenIndex], sizeof(token));
+      token[sizeof(token) - 1] = '\0';
+      tokenIndex = internToken(String(token));
+      if (tokenIndex == NO_BOT_TOKEN)
+        Serial.printf("[Telegram] Warning: Stored bot token for apartment %d is unusable, apartment not loaded\n", i + 1);
+    }
+    setApartmentToken(i + 1, tokenIndex);
+    _apartmentConfigs[i].chatId = stored.chatId;
+    _apartmentConfigs[i].enabled = stored.enabled != 0;
+    _apartmentConfigs[i].configured = tokenIndex != NO_BOT_TOKEN;
+  }
+
+  _coalesceWindow = config.coalesceWindow;
+  _escalationDelay = config.escalationDelay;
+
+  ApiEndpoint endpoint;
+  memcpy(endpoint.host, config.apiHost, sizeof(endpoint.host));
+  endpoint.host[sizeof(endpoint.host) - 1] = '\0';
+  endpoint.port = config.apiPort;
+  endpoint.secure = config.apiSecure != 0;
+  if (endpoint.host[0] == '\0' || endpoint.port == 0)
+  {
+    Serial.println(F("[Telegram] Warning: Stored API base URL is invalid, using the default"));
+    parseApiBaseUrl(TELEGRAM_API_BASE_URL, endpoint);
+  }
+
+  if (_pollMutex != NULL)
+    xSemaphoreTake(_pollMutex, portMAX_DELAY);
+  _api = endpoint;
+  if (_pollMutex != NULL)
+    xSemaphoreGive(_pollMutex);
+  if (getApiBaseUrl() != TELEGRAM_API_BASE_URL)
+    Serial.printf("[Telegram] Using Bot API server %s\n", getApiBaseUrl().c_str());
+
+  markConfigChanged();
+}
+
+bool TelegramHandler::loadLegacyConfig(StoredConfig &config)
+{
   Preferences prefs;
+  if (!prefs.begin(PREFERENCE_NAMESPACE, true))
+    return false;
 
-  if (prefs.begin(PREFERENCE_NAMESPACE, true))
+  bool found = false;
+  for (uint8_t apartmentNumber = 1; apartmentNumber <= MAX_APARTMENTS; apartmentNumber++)
   {
     String tokenKey = generateStorageKey(TOKEN_KEY_PREFIX, apartmentNumber);
+    if (!prefs.isKey(tokenKey.c_str()))
+      continue;
+    found = true;
+
     String chatIdKey = generateStorageKey(CHAT_ID_KEY_PREFIX, apartmentNumber);
     String enabledKey = generateStorageKey(ENABLED_KEY_PREFIX, apartmentNumber);
-
-    _apartmentConfigs[index].token = prefs.getString(tokenKey.c_str(), "");
-    // Convert stored string back to int64_t
+    String token = prefs.getString(tokenKey.c_str(), "");
+    // Older firmware stored the int64_t chat ID as a string
     String chatIdStr = prefs.getString(chatIdKey.c_str(), "0");
-    _apartmentConfigs[index].chatId = atoll(chatIdStr.c_str());
-    _apartmentConfigs[index].enabled = prefs.getBool(enabledKey.c_str(), false);
-    _apartmentConfigs[index].configured = (_apartmentConfigs[index].token.length() > 0 && _apartmentConfigs[index].chatId != 0);
 
-    prefs.end();
+    StoredApartment &stored = config.apartments[apartmentNumber - 1];
+    stored.chatId = atoll(chatIdStr.c_str());
+    stored.enabled = prefs.getBool(enabledKey.c_str(), false);
+    if (token.length() == 0 || token.length() >= TELEGRAM_TOKEN_SIZE)
+      continue;
+
+    // Slots fill from the front, so this finds the token or the first free slot
+    uint8_t slot = NO_BOT_TOKEN;
+    for (uint8_t i = 0; i < MAX_BOT_TOKENS && slot == NO_BOT_TOKEN; i++)
+    {
+      if (config.tokens[i][0] == '\0' || strcmp(config.tokens[i], token.c_str()) == 0)
+        slot = i;
+    }
+    if (slot == NO_BOT_TOKEN)
+    {
+      Serial.printf("[Telegram] Warning: Too many different bot tokens, apartment %d not migrated\n", apartmentNumber);
+      continue;
+    }
+    strcpy(config.tokens[slot], token.c_str());
+    stored.tokenIndex = slot;
+  }
+
+  if (prefs.isKey(COALESCE_WINDOW_KEY))
+  {
+    found = true;
+    config.coalesceWindow = prefs.getUInt(COALESCE_WINDOW_KEY, ALERT_COALESCE_WINDOW);
+  }
+  if (prefs.isKey(ESCALATION_DELAY_KEY))
+  {
+    found = true;
+    config.escalationDelay = prefs.getUInt(ESCALATION_DELAY_KEY, ESCALATION_DELAY);
+  }
+  if (prefs.isKey(API_URL_KEY))
+  {
+    found = true;
+    ApiEndpoint endpoint;
+    if (parseApiBaseUrl(prefs.getString(API_URL_KEY, ""), endpoint))
+    {
+      strcpy(config.apiHost, endpoint.host);
+      config.apiPort = endpoint.port;
+      config.apiSecure = endpoint.secure;
+    }
+  }
+
+  prefs.end();
+  return found;
+}
+
+void TelegramHandler::removeLegacyConfig()
+{
+  Preferences prefs;
+  if (!prefs.begin(PREFERENCE_NAMESPACE, false))
+    return;
+
+  for (uint8_t apartmentNumber = 1; apartmentNumber <= MAX_APARTMENTS; apartmentNumber++)
+  {
+    const char *prefixes[] = {TOKEN_KEY_PREFIX, CHAT_ID_KEY_PREFIX, ENABLED_KEY_PREFIX};
+    for (const char *prefix : prefixes)
+    {
+      String key = generateStorageKey(prefix, apartmentNumber);
+      if (prefs.isKey(key.c_str()))
+        prefs.remove(key.c_str());
+    }
   }
+  prefs.end();
 }
 
 String TelegramHandler::generateStorageKey(const char *prefix, uint8_t apartmentNumber)
@@ -759,13 +1342,199 @@ String TelegramHandler::generateStorageKey(const char *prefix, uint8_t apartment
   return String(prefix) + String(apartmentNumber);
 }
 
+// Persisted Alert Helpers
+void TelegramHandler::initPersistedAlerts()
+{
+  // RTC memory holds garbage after a power-on or brown-out reset
+  if (_persistedAlerts.magic == PERSISTED_ALERT_MAGIC &&
+      _persistedAlerts.crc == calculatePersistedChecksum())
+  {
+    TELEGRAM_LOG("Persisted alert ring is valid, next sequence %lu", (unsigned long)_persistedAlerts.nextSequence);
+    return;
+  }
+
+  Serial.println(F("[Telegram] No valid persisted alerts, starting with an empty ring"));
+  memset(&_persistedAlerts, 0, sizeof(_persistedAlerts));
+  _persistedAlerts.magic = PERSISTED_ALERT_MAGIC;
+  _persistedAlerts.nextSequence = 1;
+  updatePersistedChecksum();
+}
+
+void TelegramHandler::replayPersistedAlerts()
+{
+  // Replay in the order the alerts were originally raised
+  uint8_t order[MAX_PERSISTED_ALERTS];
+  uint8_t count = 0;
+
+  for (uint8_t i = 0; i < MAX_PERSISTED_ALERTS; i++)
+  {
+    if (_persistedAlerts.slots[i].sequence == 0)
+      continue;
+
+    uint8_t pos = count++;
+    while (pos > 0 && _persistedAlerts.slots[order[pos - 1]].sequence > _persistedAlerts.slots[i].sequence)
+    {
+      order[pos] = order[pos - 1];
+      pos--;
+    }
+    order[pos] = i;
+  }
+
+  if (count == 0)
+    return;
+
+  Serial.printf("[Telegram] Replaying %d undelivered alert(s)\n", count);
+
+  // The clock is synced later, but the stored event times can already be shown in local time
+  setenv("TZ", NTP_TIMEZONE, 1);
+  tzset();
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    PersistedAlert alert = _persistedAlerts.slots[order[i]];
+
+    uint32_t recipientMasks[MAX_APARTMENTS][ALERT_TYPE_COUNT];
+    collectFanout(alert.theftMask, recipientMasks);
+
+    String messageAR;
+    String messageEN;
+    if (!isApartmentEnabled(alert.apartment) ||
+        !buildAlertDigest(recipientMasks[alert.apartment - 1],
+                          alert.flags & PERSISTED_FLAG_SENSOR_WIRE_CUT,
+                          alert.flags & PERSISTED_FLAG_DIST_WIRE_CUT,
+                          messageAR, messageEN))
+    {
+      // The recipient was removed or disabled since the alert was raised
+      releasePersistedAlert(alert.sequence);
+      continue;
+    }
+
+    char prefixAR[256];
+    char prefixEN[256];
+    if (alert.eventTime != 0)
+    {
+      time_t eventTime = alert.eventTime;
+      struct tm timeInfo;
+      char timeString[24];
+      localtime_r(&eventTime, &timeInfo);
+      strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", &timeInfo);
+
+      snprintf(prefixAR, sizeof(prefixAR), DELAYED_ALERT_AR, timeString);
+      snprintf(prefixEN, sizeof(prefixEN), DELAYED_ALERT_EN, timeString);
+    }
+    else
+    {
+      snprintf(prefixAR, sizeof(prefixAR), DELAYED_ALERT_UPTIME_AR, (unsigned long)alert.eventUptime);
+      snprintf(prefixEN, sizeof(prefixEN), DELAYED_ALERT_UPTIME_EN, (unsigned long)alert.eventUptime);
+    }
+
+    // The record keeps its sequence number and is released once Telegram accepts the message
+    uint8_t configIndex = alert.apartment - 1;
+    sendMessage(
+        _apartmentConfigs[configIndex].tokenIndex,
+        _apartmentConfigs[configIndex].chatId,
+        String(prefixAR) + messageAR,
+        String(prefixEN) + messageEN,
+        alert.sequence);
+  }
+}
+
+void TelegramHandler::persistPendingAlerts()
+{
+  // Used right before a restart: records the digest that is still being
+  // coalesced without building any message text
+  if (!hasPendingAlerts())
+    return;
+
+  for (uint8_t apt = 1; apt <= MAX_APARTMENTS; apt++)
+  {
+    if (!isApartmentEnabled(apt))
+      continue;
+
+    uint8_t side = (uint8_t)getApartmentSide(apt);
+    uint8_t flags = 0;
+    if (_pendingWireCutMask & (0x03 << (side * 2)))
+      flags |= PERSISTED_FLAG_SENSOR_WIRE_CUT;
+    if (_pendingDistWireCutMask & (1 << side))
+      flags |= PERSISTED_FLAG_DIST_WIRE_CUT;
+
+    if (_pendingTheftMask != 0 || flags != 0)
+      persistAlert(apt, _pendingTheftMask, flags, _pendingSince);
+  }
+
+  _pendingTheftMask = 0;
+  _pendingWireCutMask = 0;
+  _pendingDistWireCutMask = 0;
+  _pendingSince = 0;
+}
+
+uint32_t TelegramHandler::persistAlert(uint8_t apartmentNumber, uint32_t theftMask, uint8_t flags, uint32_t eventMillis)
+{
+  for (uint8_t i = 0; i < MAX_PERSISTED_ALERTS; i++)
+  {
+    PersistedAlert &slot = _persistedAlerts.slots[i];
+    if (slot.sequence != 0)
+      continue;
+
+    uint32_t ageSeconds = (millis() - eventMillis) / 1000;
+    uint32_t now = WiFiManager::getEpochTime();
+
+    slot.sequence = _persistedAlerts.nextSequence++;
+    if (_persistedAlerts.nextSequence == 0)
+      _persistedAlerts.nextSequence = 1;
+    slot.eventTime = now != 0 ? now - ageSeconds : 0;
+    slot.eventUptime = eventMillis / 1000;
+    slot.theftMask = theftMask;
+    slot.apartment = apartmentNumber;
+    slot.flags = flags;
+    slot.reserved = 0;
+    updatePersistedChecksum();
+
+    TELEGRAM_LOG("Persisted alert %lu for apartment %d", (unsigned long)slot.sequence, apartmentNumber);
+    return slot.sequence;
+  }
+
+  // Still delivered from RAM, just not protected against a restart
+  DLOG_WARN("[Telegram] Warning: Persisted alert ring is full");
+  return 0;
+}
+
+void TelegramHandler::releasePersistedAlert(uint32_t sequence)
+{
+  if (sequence == 0)
+    return;
+
+  for (uint8_t i = 0; i < MAX_PERSISTED_ALERTS; i++)
+  {
+    if (_persistedAlerts.slots[i].sequence == sequence)
+    {
+      memset(&_persistedAlerts.slots[i], 0, sizeof(PersistedAlert));
+      updatePersistedChecksum();
+      TELEGRAM_LOG("Released persisted alert %lu", (unsigned long)sequence);
+      return;
+    }
+  }
+}
+
+void TelegramHandler::updatePersistedChecksum()
+{
+  _persistedAlerts.crc = calculatePersistedChecksum();
+}
+
+uint32_t TelegramHandler::calculatePersistedChecksum()
+{
+  return esp_crc32_le(0, (const uint8_t *)&_persistedAlerts, offsetof(PersistedAlertRing, crc));
+}
+
 // Queue management implementation
-bool TelegramHandler::enqueueMessage(const String &token, int64_t chatId, const String &message)
+bool TelegramHandler::enqueueMessage(uint8_t tokenIndex, int64_t chatId, const String &message, uint32_t sequence,
+                                     uint32_t incidentMask, MessageTier tier, uint8_t keyboardApartment)
 {
   if (_queueSize >= MAX_QUEUE_SIZE)
   {
     _lastError = "Message queue is full";
-    Serial.println(F("[Telegram] Error: Message queue is full"));
+    DLOG_ERROR("[Telegram] Error: Message queue is full");
+    releasePersistedAlert(sequence);
     return false;
   }
 
@@ -773,94 +1542,215 @@ bool TelegramHandler::enqueueMessage(const String &token, int64_t chatId, const
   uint8_t current = _queueHead;
   for (uint8_t i = 0; i < _queueSize; i++)
   {
-    if (_messageQueue[current].token == token &&
+    if (_messageQueue[current].tokenIndex == tokenIndex &&
         _messageQueue[current].chatId == chatId &&
         _messageQueue[current].message == message)
     {
-      Serial.println(F("[Telegram] Duplicate message skipped"));
+      DLOG_DEBUG("[Telegram] Duplicate message skipped");
+      releasePersistedAlert(sequence);
       return true;
     }
     current = (current + 1) % MAX_QUEUE_SIZE;
   }
 
   // No duplicate found, add message to queue
-  _messageQueue[_queueTail].token = token;
+  _messageQueue[_queueTail].tokenIndex = tokenIndex;
   _messageQueue[_queueTail].chatId = chatId;
   _messageQueue[_queueTail].message = message;
   _messageQueue[_queueTail].retries = 0;
   _messageQueue[_queueTail].nextAttemptTime = millis();
+  _messageQueue[_queueTail].sequence = sequence;
+  _messageQueue[_queueTail].incidentMask = incidentMask;
+  _messageQueue[_queueTail].tier = tier;
+  _messageQueue[_queueTail].keyboardApartment = keyboardApartment;
+  _messageQueue[_queueTail].cancelled = false;
 
   _queueTail = (_queueTail + 1) % MAX_QUEUE_SIZE;
   _queueSize++;
+  if (_queueSize > _queueHighWater)
+    _queueHighWater = _queueSize;
 
-  Serial.printf("[Telegram] Message queued. Queue size: %d\n", _queueSize);
+  DLOG_DEBUG("[Telegram] Message queued. Queue size: %d", _queueSize);
   return true;
 }
 
-bool TelegramHandler::sendMessageWithTimeout(const String &token, int64_t chatId, const String &message)
+bool TelegramHandler::sendMessageWithTimeout(uint8_t tokenIndex, int64_t chatId, const String &message, uint8_t keyboardApartment)
 {
-  // Set the bot's token for this message
-  _bot.setTelegramToken(token);
+  memset(&_lastResult, 0, sizeof(_lastResult));
+
+  char keyboard[256];
+  int keyboardLength = 0;
+  if (keyboardApartment != 0)
+    keyboardLength = formatIncidentKeyboard(keyboardApartment, keyboard, sizeof(keyboard));
+
+  // HTTP/1.0 keeps the response body plain (no chunked transfer encoding)
+  String chatIdText = String(chatId);
+  size_t contentLength = strlen("{\"chat_id\":") + chatIdText.length() + strlen(",\"text\":\"") +
+                         JsonWriter::escapedLength(message.c_str()) + strlen("\"") + keyboardLength + strlen("}");
+
+  char request[320];
+  int requestLength = snprintf(request, sizeof(request),
+                               "POST /bot%s/sendMessage HTTP/1.0\r\n"
+                               "Host: %s\r\n"
+                               "Content-Type: application/json\r\n"
+                               "Content-Length: %u\r\n"
+                               "Connection: close\r\n\r\n"
+                               "{\"chat_id\":%s,\"text\":\"",
+                               _botTokens[tokenIndex].token, _api.host, (unsigned)contentLength, chatIdText.c_str());
+  if (requestLength < 0 || requestLength >= (int)sizeof(request))
+  {
+    _lastError = "Invalid token length";
+    DLOG_WARN("[Telegram] %s", _lastError);
+    return false;
+  }
 
-  // Check for low memory condition
-  if (ESP.getFreeHeap() < 10000)
+  // Web requests are served while this waits on Telegram, a handler may drop
+  // the queued message or change the endpoint, so only copies are used
+  ApiEndpoint api = _api;
+  String text = message;
+  TelegramResult result;
+  memset(&result, 0, sizeof(result));
+  WiFiClient &client = api.secure ? (WiFiClient &)_client : _plainClient;
+
+  Notifier::releaseStateLock();
+  bool connected = client.connect(api.host, api.port);
+  bool complete = false;
+  if (connected)
   {
-    TELEGRAM_LOG("Critical: Low memory condition detected: %d bytes", ESP.getFreeHeap());
-    ESP.restart();
+    // Send message with timeout
+    client.write((const uint8_t *)request, requestLength);
+    JsonWriter::writeEscaped(client, text.c_str());
+    client.write((const uint8_t *)"\"", 1);
+    if (keyboardLength > 0)
+      client.write((const uint8_t *)keyboard, keyboardLength);
+    client.write((const uint8_t *)"}", 1);
+
+    complete = readApiResponse(client, _responseParser, onResponseValue, &result, TELEGRAM_RESPONSE_TIMEOUT);
+    client.stop();
   }
+  Notifier::acquireStateLock();
 
-  // Send message with timeout
-  int32_t messageId = _bot.sendMessage(chatId, message);
+  _lastResult = result;
   _lastMessageTime = millis();
+  if (!connected)
+  {
+    _lastError = "Connection to Telegram failed";
+    DLOG_WARN("[Telegram] %s", _lastError);
+    return false;
+  }
+  recordTokenResult(tokenIndex, complete && _lastResult.ok);
 
-  // Parse response handling various conditions
-  if (messageId == 0)
+  if (!complete)
   {
-    // Get the last response from CTBot library
-    String lastResponse = _bot.getLastResponse();
+    _lastError = "No valid response from Telegram";
+    DLOG_WARN("[Telegram] %s", _lastError);
+    return false;
+  }
 
-    // Check for rate limiting (HTTP 429)
-    if (lastResponse.indexOf("\"error_code\":429") > 0)
-    {
-      // Parse the retry_after value
-      int retryAfter = 60; // Default to 60 seconds if we can't parse
-      int retryPos = lastResponse.indexOf("\"retry_after\":");
-      if (retryPos > 0)
-      {
-        retryAfter = lastResponse.substring(retryPos + 14).toInt();
-      }
+  if (_lastResult.ok)
+  {
+    TELEGRAM_LOG("Message %ld delivered", (long)_lastResult.messageId);
+    return true;
+  }
 
-      _lastError = "Rate limited by Telegram, retry after " + String(retryAfter) + " seconds";
-      Serial.println(_lastError);
+  // Check for rate limiting (HTTP 429)
+  if (_lastResult.errorCode == 429)
+  {
+    if (_lastResult.retryAfter == 0)
+      _lastResult.retryAfter = 60; // Default to 60 seconds if Telegram didn't say
 
-      // You could update your queue to respect this retry time
-      return false;
-    }
-    // Check for chat not found (user blocked bot)
-    else if (lastResponse.indexOf("\"error_code\":400") > 0 &&
-             lastResponse.indexOf("chat not found") > 0)
+    _lastError = "Rate limited by Telegram, retry after " + String(_lastResult.retryAfter) + " seconds";
+  }
+  // Check for chat not found (user blocked bot)
+  else if (_lastResult.errorCode == 400 && strstr(_lastResult.description, "chat not found") != nullptr)
+  {
+    _lastError = "Chat not found (user may have blocked the bot)";
+  }
+  // Check for unauthorized (invalid token)
+  else if (_lastResult.errorCode == 401 || _lastResult.errorCode == 404)
+  {
+    _lastError = "Unauthorized (invalid token)";
+  }
+  // Other errors
+  else
+  {
+    _lastError = "Failed to send message: " + String(_lastResult.errorCode) + " " + String(_lastResult.description);
+  }
+
+  DLOG_WARN("[Telegram] %s", _lastError);
+  return false;
+}
+
+bool TelegramHandler::readApiResponse(WiFiClient &client, JsonStream &parser, JsonCallback callback, void *context, uint32_t timeout)
+{
+  parser.begin(callback, context);
+
+  // Skip the status line and headers, then feed the body to the tokenizer as it arrives
+  const char *headerEnd = "\r\n\r\n";
+  uint8_t matched = 0;
+  bool inBody = false;
+  uint32_t startTime = millis();
+
+  while (millis() - startTime < timeout)
+  {
+    if (!client.available())
     {
-      _lastError = "Chat not found (user may have blocked the bot)";
-      Serial.println(_lastError);
-      return false;
+      if (!client.connected())
+        break;
+      delay(1);
+      continue;
     }
-    // Check for unauthorized (invalid token)
-    else if (lastResponse.indexOf("\"error_code\":401") > 0)
+
+    char c = (char)client.read();
+
+    if (!inBody)
     {
-      _lastError = "Unauthorized (invalid token)";
-      Serial.println(_lastError);
-      return false;
+      matched = (c == headerEnd[matched]) ? matched + 1 : (c == '\r' ? 1 : 0);
+      inBody = (matched == 4);
+      continue;
     }
-    // Other errors
-    else
+
+    if (!parser.feed(c))
     {
-      _lastError = "Failed to send message: " + lastResponse;
-      Serial.println(_lastError);
+      TELEGRAM_LOG("Malformed JSON in Telegram response");
       return false;
     }
+
+    if (parser.isComplete())
+      return true;
   }
 
-  return true;
+  return false;
+}
+
+void TelegramHandler::onResponseValue(void *context, const JsonStream &stream, JsonEvent event, const char *value)
+{
+  if (event != JsonEvent::VALUE)
+    return;
+
+  TelegramResult *result = (TelegramResult *)context;
+
+  if (stream.isPath("ok"))
+  {
+    result->ok = strcmp(value, "true") == 0;
+  }
+  else if (stream.isPath("error_code"))
+  {
+    result->errorCode = atoi(value);
+  }
+  else if (stream.isPath("description"))
+  {
+    strncpy(result->description, value, sizeof(result->description) - 1);
+    result->description[sizeof(result->description) - 1] = '\0';
+  }
+  else if (stream.isPath("parameters", "retry_after"))
+  {
+    result->retryAfter = strtoul(value, nullptr, 10);
+  }
+  else if (stream.isPath("result", "message_id"))
+  {
+    result->messageId = atol(value);
+  }
 }
 
 bool TelegramHandler::processMessageQueue()
@@ -870,6 +1760,17 @@ bool TelegramHandler::processMessageQueue()
     return true;
   }
 
+  // Drop sends that an acknowledgement made pointless
+  while (_queueSize > 0 && _messageQueue[_queueHead].cancelled)
+  {
+    _queueHead = (_queueHead + 1) % MAX_QUEUE_SIZE;
+    _queueSize--;
+  }
+  if (_queueSize == 0)
+  {
+    return true;
+  }
+
   _processingQueue = true;
 
   uint32_t currentTime = millis();
@@ -891,50 +1792,97 @@ bool TelegramHandler::processMessageQueue()
     return true;
   }
 
-  // Try to send the message
-  bool success = sendMessageWithTimeout(msg.token, msg.chatId, msg.message);
+  // Without room for a TLS handshake the attempt would fail, wait for the heap instead of using up a retry
+  if (!MemoryBudget::admit(MemoryClient::TLS))
+  {
+    if (MemoryBudget::shouldRestart())
+    {
+      DLOG_ERROR("[Telegram] Critical: heap has not recovered, restarting");
+      // Queued alerts are already in RTC memory and get replayed after the restart
+      persistPendingAlerts();
+      ConfigStore::flush();
+      DeferredLog::flush();
+      ESP.restart();
+    }
+    msg.nextAttemptTime = currentTime + MEMORY_SAMPLE_INTERVAL;
+    _processingQueue = false;
+    return true;
+  }
 
-  if (success)
+  // Messages for a bot Telegram already rejected would only fail the same way
+  if (!isBotTokenInUse(msg.tokenIndex) || _botTokens[msg.tokenIndex].stats.state == BotTokenState::UNAUTHORIZED)
   {
-    // Message sent successfully, remove from queue
+    releasePersistedAlert(msg.sequence);
     _queueHead = (_queueHead + 1) % MAX_QUEUE_SIZE;
     _queueSize--;
-    Serial.printf("Message sent successfully. Queue size: %d\n", _queueSize);
-  }
+    _processingQueue = false;
+    _stats.dropped++;
+    DLOG_WARN("[Telegram] Message dropped, bot token was rejected");
+    return false;
+  }
+
+  // Try to send the message
+  uint32_t sendStart = micros();
+  bool success = sendMessageWithTimeout(msg.tokenIndex, msg.chatId, msg.message, msg.keyboardApartment);
+  Metrics::observe(_stats.latency, micros() - sendStart);
+
+  // Dropped by a web request while it was on the wire, it was already released
+  if (msg.cancelled)
+  {
+    _queueHead = (_queueHead + 1) % MAX_QUEUE_SIZE;
+    _queueSize--;
+    _processingQueue = false;
+    return success;
+  }
+
+  if (success)
+  {
+    _stats.sent++;
+    // Message sent successfully, remove from queue
+    releasePersistedAlert(msg.sequence);
+    _queueHead = (_queueHead + 1) % MAX_QUEUE_SIZE;
+    _queueSize--;
+    DLOG_INFO("[Telegram] Message sent successfully. Queue size: %d", _queueSize);
+  }
   else
   {
     // Message failed
     msg.retries++;
+    _stats.failed++;
+    if (_lastResult.errorCode == 429)
+      _stats.rateLimited++;
+
+    // Bad request, invalid token or bot blocked: the same request will never succeed
+    bool permanentFailure = _lastResult.errorCode == 400 ||
+                            _lastResult.errorCode == 401 ||
+                            _lastResult.errorCode == 403 ||
+                            _lastResult.errorCode == 404;
 
-    if (msg.retries >= MAX_RETRIES)
+    if (msg.retries >= MAX_RETRIES || permanentFailure)
     {
       // Max retries reached, remove from queue
+      releasePersistedAlert(msg.sequence);
       _queueHead = (_queueHead + 1) % MAX_QUEUE_SIZE;
       _queueSize--;
-      Serial.println("Message failed after max retries");
+      _stats.dropped++;
+      DLOG_WARN("[Telegram] Message failed after max retries");
     }
     else
     {
+      _stats.retries++;
       // Schedule retry with dynamic backoff
-      // Check if the error contains rate limit information
-      if (_lastError.indexOf("Rate limited") >= 0)
+      // Telegram tells us exactly how long to wait when rate limiting
+      if (_lastResult.errorCode == 429)
       {
-        // Extract retry_after from error
-        int retryAfter = 60; // Default
-        int pos = _lastError.indexOf("retry after ");
-        if (pos > 0)
-        {
-          retryAfter = _lastError.substring(pos + 12).toInt();
-        }
-        msg.nextAttemptTime = currentTime + (retryAfter * 1000);
-        Serial.printf("Rate limited. Will retry in %d seconds\n", retryAfter);
+        msg.nextAttemptTime = currentTime + (_lastResult.retryAfter * 1000);
+        DLOG_WARN("[Telegram] Rate limited. Will retry in %u seconds", (unsigned)_lastResult.retryAfter);
       }
       else
       {
         // Standard exponential backoff
         uint16_t backoff = RETRY_DELAY * (1 << msg.retries);
         msg.nextAttemptTime = currentTime + backoff;
-        Serial.printf("Message failed. Will retry in %d ms\n", backoff);
+        DLOG_INFO("[Telegram] Message failed. Will retry in %d ms", backoff);
       }
     }
   }
@@ -943,9 +1891,726 @@ bool TelegramHandler::processMessageQueue()
   return success;
 }
 
+// Incident Escalation
+bool TelegramHandler::acknowledgeIncident(uint8_t apartmentNumber, bool falseAlarm)
+{
+  if (!validateApartmentNumber(apartmentNumber))
+    return false;
+
+  Incident &incident = _incidents[apartmentNumber - 1];
+  if (incident.state != IncidentState::OPEN)
+    return false;
+
+  incident.state = falseAlarm ? IncidentState::FALSE_ALARM : IncidentState::ACKNOWLEDGED;
+  incident.ackTime = millis();
+  DLOG_INFO("[Telegram] Incident for apartment %d acknowledged%s", apartmentNumber, falseAlarm ? " as a false alarm" : "");
+
+  cancelIncidentMessages();
+  return true;
+}
+
+void TelegramHandler::setEscalationDelay(uint16_t seconds)
+{
+  _escalationDelay = seconds;
+  ConfigStore::markDirty(PREFERENCE_NAMESPACE, saveAllConfigurations);
+}
+
+uint16_t TelegramHandler::getEscalationDelay()
+{
+  return _escalationDelay;
+}
+
+void TelegramHandler::openIncidents(uint32_t theftMask)
+{
+  for (uint8_t apt = 1; apt <= MAX_APARTMENTS; apt++)
+  {
+    if (!(theftMask & (1UL << (apt - 1))))
+      continue;
+
+    // Repeated vibration of the same meter belongs to the incident that is already open
+    Incident &incident = _incidents[apt - 1];
+    if (incident.state == IncidentState::OPEN)
+      continue;
+
+    incident.state = IncidentState::OPEN;
+    incident.tier = 0;
+    incident.startTime = millis();
+    incident.ackTime = 0;
+  }
+}
+
+uint32_t TelegramHandler::getAcknowledgedIncidents()
+{
+  uint32_t mask = 0;
+  for (uint8_t apt = 1; apt <= MAX_APARTMENTS; apt++)
+  {
+    IncidentState state = _incidents[apt - 1].state;
+    if (state == IncidentState::ACKNOWLEDGED || state == IncidentState::FALSE_ALARM)
+      mask |= (1UL << (apt - 1));
+  }
+  return mask;
+}
+
+void TelegramHandler::checkIncidents()
+{
+  uint32_t now = millis();
+
+  for (uint8_t apt = 1; apt <= MAX_APARTMENTS; apt++)
+  {
+    Incident &incident = _incidents[apt - 1];
+
+    if (incident.state == IncidentState::ACKNOWLEDGED || incident.state == IncidentState::FALSE_ALARM)
+    {
+      // Alerts about this meter resume once the acknowledgement expires
+      if (now - incident.ackTime >= ACK_SILENCE_PERIOD)
+        incident.state = IncidentState::NONE;
+      continue;
+    }
+
+    if (incident.state != IncidentState::OPEN || _escalationDelay == 0)
+      continue;
+
+    uint32_t elapsed = now - incident.startTime;
+    if (elapsed < (uint32_t)_escalationDelay * 1000UL * (incident.tier + 1))
+      continue;
+
+    if (incident.tier < MAX_ESCALATIONS)
+    {
+      incident.tier++;
+      sendEscalation(apt, elapsed / 1000);
+    }
+    else
+    {
+      // Nobody answered; the next vibration opens a fresh incident
+      incident.state = IncidentState::NONE;
+    }
+  }
+}
+
+void TelegramHandler::sendEscalation(uint8_t apartmentNumber, uint32_t elapsedSeconds)
+{
+  DLOG_INFO("[Telegram] Escalating unacknowledged incident for apartment %d", apartmentNumber);
+
+  if (_fanoutDirty)
+    rebuildFanoutPlans();
+
+  char messageAR[512];
+  char messageEN[512];
+  snprintf(messageAR, sizeof(messageAR), ESCALATION_SAME_BOX_AR, apartmentNumber, (unsigned long)elapsedSeconds);
+  snprintf(messageEN, sizeof(messageEN), ESCALATION_SAME_BOX_EN, apartmentNumber, (unsigned long)elapsedSeconds);
+
+  const FanoutEntry *plan = _fanoutPlans[apartmentNumber - 1];
+  for (uint8_t i = 0; i < _fanoutCounts[apartmentNumber - 1]; i++)
+  {
+    if (plan[i].type != AlertType::SAME_BOX || isAlertSilenced(plan[i].recipient))
+      continue;
+
+    const ApartmentConfig &config = _apartmentConfigs[plan[i].recipient - 1];
+    sendMessage(config.tokenIndex, config.chatId, messageAR, messageEN,
+                0, 1UL << (apartmentNumber - 1), MessageTier::ESCALATION);
+  }
+}
+
+void TelegramHandler::cancelIncidentMessages()
+{
+  // Neighbour alerts and escalations that only concern acknowledged incidents
+  uint32_t acknowledged = getAcknowledgedIncidents();
+  uint8_t cancelled = 0;
+  uint8_t current = _queueHead;
+
+  for (uint8_t i = 0; i < _queueSize; i++)
+  {
+    QueuedMessage &msg = _messageQueue[current];
+    if (!msg.cancelled && msg.tier != MessageTier::NORMAL &&
+        msg.incidentMask != 0 && (msg.incidentMask & ~acknowledged) == 0)
+    {
+      msg.cancelled = true;
+      msg.message = String();
+      releasePersistedAlert(msg.sequence);
+      msg.sequence = 0;
+      cancelled++;
+    }
+    current = (current + 1) % MAX_QUEUE_SIZE;
+  }
+
+  if (cancelled > 0)
+  {
+    DLOG_INFO("[Telegram] Cancelled %d pending alert(s) after acknowledgement", cancelled);
+  }
+}
+
+int TelegramHandler::formatIncidentKeyboard(uint8_t apartmentNumber, char *buffer, size_t size)
+{
+  int length = snprintf(buffer, size,
+                        ",\"reply_markup\":{\"inline_keyboard\":[["
+                        "{\"text\":\"%s\",\"callback_data\":\"ack:%d\"},"
+                        "{\"text\":\"%s\",\"callback_data\":\"fa:%d\"}]]}",
+                        INCIDENT_BUTTON_CHECKING, apartmentNumber,
+                        INCIDENT_BUTTON_FALSE_ALARM, apartmentNumber);
+
+  // Send the alert without buttons rather than with broken JSON
+  if (length < 0 || length >= (int)size)
+    return 0;
+  return length;
+}
+
+// Parse state for one getUpdates response
+struct UpdateParseContext
+{
+  bool ok;
+  int32_t lastUpdateId;
+  int32_t updateId;
+  BotCommand current;
+  char currentCallbackId[CALLBACK_ID_SIZE];
+  BotCommand commands[COMMAND_QUEUE_SIZE];
+  int32_t commandUpdateIds[COMMAND_QUEUE_SIZE];
+  char callbackIds[COMMAND_QUEUE_SIZE][CALLBACK_ID_SIZE];
+  uint8_t commandCount;
+};
+
+// Bot Commands
+bool TelegramHandler::isAlertSilenced(uint8_t apartmentNumber)
+{
+  if (!validateApartmentNumber(apartmentNumber))
+    return false;
+
+  uint32_t ackTime = _ackTime[apartmentNumber - 1];
+  return ackTime != 0 && millis() - ackTime < ACK_SILENCE_PERIOD;
+}
+
+void TelegramHandler::refreshPollBots()
+{
+  if (_pollMutex == NULL)
+    return;
+
+  // Only tokens of enabled apartments are polled; offsets stay with their slot
+  bool polled[MAX_BOT_TOKENS] = {false};
+  for (uint8_t apt = 1; apt <= MAX_APARTMENTS; apt++)
+  {
+    if (isApartmentEnabled(apt))
+      polled[_apartmentConfigs[apt - 1].tokenIndex] = true;
+  }
+
+  uint8_t count = 0;
+  xSemaphoreTake(_pollMutex, portMAX_DELAY);
+  for (uint8_t i = 0; i < MAX_BOT_TOKENS; i++)
+  {
+    _botTokens[i].polled = polled[i];
+    if (polled[i])
+      count++;
+  }
+  _pollBotsDirty = false;
+
+  // Queued commands refer to bots by slot; only those of a slot that now holds
+  // another token are dropped. The poll task only enqueues under the mutex, so
+  // the kept commands go back in their original order.
+  UBaseType_t waiting = uxQueueMessagesWaiting(_commandQueue);
+  uint8_t dropped = 0;
+  BotCommand command;
+  for (UBaseType_t i = 0; i < waiting && xQueueReceive(_commandQueue, &command, 0) == pdTRUE; i++)
+  {
+    if (_changedBotSlots & (1 << command.botIndex))
+      dropped++;
+    else
+      xQueueSend(_commandQueue, &command, 0);
+  }
+  _changedBotSlots = 0;
+  xSemaphoreGive(_pollMutex);
+
+  if (dropped > 0)
+    TELEGRAM_LOG("Dropped %d queued command(s) of changed bot tokens", dropped);
+
+  TELEGRAM_LOG("Polling %d bot(s) for commands", count);
+}
+
+void TelegramHandler::pollTaskLoop(void *parameter)
+{
+  // The poll task has its own connection, _client stays with the sender in the main loop
+  WiFiClientSecure secureClient;
+  WiFiClient plainClient;
+  JsonStream parser;
+  secureClient.setInsecure();
+  uint8_t nextBot = 0;
+
+  for (;;)
+  {
+    // Commands wait while the heap is short, the poll holds a second TLS connection
+    if (!isReady() || !MemoryBudget::admit(MemoryClient::TELEGRAM))
+    {
+      vTaskDelay(pdMS_TO_TICKS(POLL_RETRY_DELAY));
+      continue;
+    }
+
+    char token[TELEGRAM_TOKEN_SIZE];
+    int32_t offset = 0;
+    uint8_t botIndex = 0;
+    uint8_t timeoutSeconds = LONG_POLL_TIMEOUT;
+    bool haveBot = false;
+
+    xSemaphoreTake(_pollMutex, portMAX_DELAY);
+    ApiEndpoint api = _api;
+    uint8_t polledCount = 0;
+    for (uint8_t i = 0; i < MAX_BOT_TOKENS; i++)
+    {
+      if (_botTokens[i].polled)
+        polledCount++;
+    }
+
+    // Bots take turns, sharing the long-poll time between them
+    for (uint8_t i = 0; i < MAX_BOT_TOKENS && !haveBot; i++)
+    {
+      botIndex = nextBot++ % MAX_BOT_TOKENS;
+      if (!_botTokens[botIndex].polled)
+        continue;
+
+      strcpy(token, _botTokens[botIndex].token);
+      offset = _botTokens[botIndex].updateOffset;
+      timeoutSeconds = max(1, LONG_POLL_TIMEOUT / polledCount);
+      haveBot = true;
+    }
+    xSemaphoreGive(_pollMutex);
+
+    WiFiClient &client = api.secure ? (WiFiClient &)secureClient : plainClient;
+    if (!haveBot || !pollUpdates(client, parser, api, botIndex, token, offset, timeoutSeconds))
+    {
+      vTaskDelay(pdMS_TO_TICKS(POLL_RETRY_DELAY));
+    }
+  }
+}
+
+bool TelegramHandler::pollUpdates(WiFiClient &client, JsonStream &parser, const ApiEndpoint &api, uint8_t botIndex,
+                                  const char *token, int32_t offset, uint8_t timeoutSeconds)
+{
+  if (!client.connect(api.host, api.port))
+  {
+    TELEGRAM_LOG("Command poll connection failed");
+    return false;
+  }
+
+  // Never ask for more updates than the command queue can take
+  char request[256];
+  int requestLength = snprintf(request, sizeof(request),
+                               "GET /bot%s/getUpdates?offset=%ld&limit=%u&timeout=%u&allowed_updates=%%5B%%22message%%22%%2C%%22callback_query%%22%%5D HTTP/1.0\r\n"
+                               "Host: %s\r\n"
+                               "Connection: close\r\n\r\n",
+                               token, (long)offset, COMMAND_QUEUE_SIZE, timeoutSeconds, api.host);
+  if (requestLength < 0 || requestLength >= (int)sizeof(request))
+  {
+    client.stop();
+    return false;
+  }
+  client.write((const uint8_t *)request, requestLength);
+
+  UpdateParseContext context;
+  memset(&context, 0, sizeof(context));
+  context.lastUpdateId = -1;
+  context.current.botIndex = botIndex;
+
+  bool complete = readApiResponse(client, parser, onUpdateValue, &context,
+                                  timeoutSeconds * 1000UL + TELEGRAM_RESPONSE_TIMEOUT);
+  client.stop();
+
+  if (!complete || !context.ok)
+  {
+    TELEGRAM_LOG("Command poll failed");
+    return false;
+  }
+
+  // Hand the commands to the main loop, unless the slot changed token meanwhile
+  uint8_t enqueued = 0;
+  xSemaphoreTake(_pollMutex, portMAX_DELAY);
+  if (_botTokens[botIndex].polled && strcmp(_botTokens[botIndex].token, token) == 0)
+  {
+    while (enqueued < context.commandCount && xQueueSend(_commandQueue, &context.commands[enqueued], 0) == pdTRUE)
+      enqueued++;
+
+    // A full queue leaves the rest with Telegram, the next poll fetches them again
+    if (enqueued < context.commandCount)
+    {
+      _botTokens[botIndex].updateOffset = context.commandUpdateIds[enqueued];
+      Serial.println(F("[Telegram] Warning: Command queue is full, commands left for the next poll"));
+    }
+    else if (context.lastUpdateId >= 0)
+    {
+      _botTokens[botIndex].updateOffset = context.lastUpdateId + 1;
+    }
+  }
+  xSemaphoreGive(_pollMutex);
+
+  // Stop the loading indicator on the pressed buttons that were taken
+  for (uint8_t i = 0; i < enqueued; i++)
+  {
+    if (context.commands[i].isCallback)
+      answerCallbackQuery(client, parser, api, token, context.callbackIds[i]);
+  }
+
+  return true;
+}
+
+bool TelegramHandler::answerCallbackQuery(WiFiClient &client, JsonStream &parser, const ApiEndpoint &api,
+                                          const char *token, const char *callbackId)
+{
+  if (!client.connect(api.host, api.port))
+    return false;
+
+  // The ID is opaque, it goes into the query string encoded
+  char encodedId[CALLBACK_ID_SIZE * 3];
+  urlEncode(callbackId, encodedId, sizeof(encodedId));
+
+  char request[256];
+  int requestLength = snprintf(request, sizeof(request),
+                               "GET /bot%s/answerCallbackQuery?callback_query_id=%s HTTP/1.0\r\n"
+                               "Host: %s\r\n"
+                               "Connection: close\r\n\r\n",
+                               token, encodedId, api.host);
+  if (requestLength < 0 || requestLength >= (int)sizeof(request))
+  {
+    client.stop();
+    return false;
+  }
+  client.write((const uint8_t *)request, requestLength);
+
+  TelegramResult result;
+  memset(&result, 0, sizeof(result));
+  readApiResponse(client, parser, onResponseValue, &result, TELEGRAM_RESPONSE_TIMEOUT);
+  client.stop();
+
+  return result.ok;
+}
+
+void TelegramHandler::urlEncode(const char *text, char *buffer, size_t size)
+{
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+  size_t length = 0;
+
+  // Unreserved characters as they are, everything else percent-encoded; stops before a character that does not fit
+  for (; *text != '\0'; text++)
+  {
+    uint8_t c = (uint8_t)*text;
+    if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~')
+    {
+      if (length + 1 >= size)
+        break;
+      buffer[length++] = (char)c;
+    }
+    else
+    {
+      if (length + 3 >= size)
+        break;
+      buffer[length++] = '%';
+      buffer[length++] = HEX_DIGITS[c >> 4];
+      buffer[length++] = HEX_DIGITS[c & 0x0F];
+    }
+  }
+  buffer[length] = '\0';
+}
+
+void TelegramHandler::onUpdateValue(void *context, const JsonStream &stream, JsonEvent event, const char *value)
+{
+  UpdateParseContext *update = (UpdateParseContext *)context;
+
+  if (event == JsonEvent::VALUE)
+  {
+    if (stream.isPath("ok"))
+    {
+      update->ok = strcmp(value, "true") == 0;
+    }
+    else if (stream.isPath("result", "", "update_id"))
+    {
+      update->updateId = atol(value);
+    }
+    else if (stream.isPath("result", "", "message", "chat", "id"))
+    {
+      update->current.chatId = atoll(value);
+    }
+    else if (stream.isPath("result", "", "message", "text"))
+    {
+      strncpy(update->current.text, value, sizeof(update->current.text) - 1);
+      update->current.text[sizeof(update->current.text) - 1] = '\0';
+    }
+    else if (stream.isPath("result", "", "callback_query", "id"))
+    {
+      strncpy(update->currentCallbackId, value, CALLBACK_ID_SIZE - 1);
+      update->currentCallbackId[CALLBACK_ID_SIZE - 1] = '\0';
+    }
+    else if (stream.isPath("result", "", "callback_query", "data"))
+    {
+      strncpy(update->current.text, value, sizeof(update->current.text) - 1);
+      update->current.text[sizeof(update->current.text) - 1] = '\0';
+      update->current.isCallback = true;
+    }
+    else if (stream.isPath("result", "", "callback_query", "message", "chat", "id"))
+    {
+      update->current.chatId = atoll(value);
+    }
+  }
+  else if (event == JsonEvent::OBJECT_END && stream.isPath("result", ""))
+  {
+    // One update is complete; plain chat messages are ignored
+    if (update->updateId > update->lastUpdateId)
+      update->lastUpdateId = update->updateId;
+
+    if ((update->current.text[0] == '/' || update->current.isCallback) &&
+        update->current.chatId != 0 && update->commandCount < COMMAND_QUEUE_SIZE)
+    {
+      strcpy(update->callbackIds[update->commandCount], update->currentCallbackId);
+      update->commandUpdateIds[update->commandCount] = update->updateId;
+      update->commands[update->commandCount++] = update->current;
+    }
+
+    uint8_t botIndex = update->current.botIndex;
+    memset(&update->current, 0, sizeof(update->current));
+    update->current.botIndex = botIndex;
+    update->currentCallbackId[0] = '\0';
+    update->updateId = 0;
+  }
+}
+
+void TelegramHandler::processBotCommands()
+{
+  if (_commandQueue == NULL)
+    return;
+
+  BotCommand command;
+  while (xQueueReceive(_commandQueue, &command, 0) == pdTRUE)
+  {
+    handleBotCommand(command);
+  }
+}
+
+void TelegramHandler::handleBotCommand(const BotCommand &command)
+{
+  // Slots only change on the main loop, and their queued commands are dropped when they do
+  if (!isBotTokenInUse(command.botIndex))
+    return;
+
+  // Drop the "@BotName" suffix used in group chats and any arguments
+  char name[sizeof(command.text)];
+  size_t length = strcspn(command.text, " @");
+  memcpy(name, command.text, length);
+  name[length] = '\0';
+
+  Serial.printf("[Telegram] Command %s from chat %lld\n", name, (long long)command.chatId);
+
+  // A chat only controls the apartments it is registered for on this bot
+  bool handled = false;
+  for (uint8_t apt = 1; apt <= MAX_APARTMENTS; apt++)
+  {
+    if (!isApartmentEnabled(apt))
+      continue;
+
+    const ApartmentConfig &config = _apartmentConfigs[apt - 1];
+    if (config.chatId != command.chatId || config.tokenIndex != command.botIndex)
+      continue;
+
+    executeBotCommand(apt, name);
+    handled = true;
+  }
+
+  if (!handled)
+  {
+    Serial.println(F("[Telegram] Ignoring command from an unregistered chat"));
+  }
+}
+
+void TelegramHandler::executeBotCommand(uint8_t apartmentNumber, const char *command)
+{
+  unsigned long silenceMinutes = ACK_SILENCE_PERIOD / 60000UL;
+
+  if (strcmp(command, "/status") == 0)
+  {
+    sendStatusReply(apartmentNumber);
+  }
+  else if (strcmp(command, "/arm") == 0)
+  {
+    if (AlarmSystem::enableSensor(apartmentNumber))
+      sendFormattedMessage(apartmentNumber, CMD_ARMED_AR, CMD_ARMED_EN, apartmentNumber);
+    else
+      sendFormattedMessage(apartmentNumber, CMD_FAILED_AR, CMD_FAILED_EN);
+  }
+  else if (strcmp(command, "/disarm") == 0)
+  {
+    if (AlarmSystem::disableSensor(apartmentNumber))
+      sendFormattedMessage(apartmentNumber, CMD_DISARMED_AR, CMD_DISARMED_EN, apartmentNumber);
+    else
+      sendFormattedMessage(apartmentNumber, CMD_FAILED_AR, CMD_FAILED_EN);
+  }
+  else if (strncmp(command, "ack:", 4) == 0 || strncmp(command, "fa:", 3) == 0)
+  {
+    // Alert buttons only act on the resident's own meter
+    bool falseAlarm = command[0] == 'f';
+    if (atoi(strchr(command, ':') + 1) != apartmentNumber)
+      return;
+
+    if (!acknowledgeIncident(apartmentNumber, falseAlarm))
+      sendFormattedMessage(apartmentNumber, INCIDENT_NONE_AR, INCIDENT_NONE_EN);
+    else if (falseAlarm)
+      sendFormattedMessage(apartmentNumber, INCIDENT_FALSE_ALARM_AR, INCIDENT_FALSE_ALARM_EN);
+    else
+      sendFormattedMessage(apartmentNumber, INCIDENT_ACK_AR, INCIDENT_ACK_EN);
+  }
+  else if (strcmp(command, "/ack") == 0)
+  {
+    // Also stops the escalation of an open alert about the resident's own meter
+    acknowledgeIncident(apartmentNumber, false);
+    _ackTime[apartmentNumber - 1] = millis() | 1; // 0 means "not acknowledged"
+    sendFormattedMessage(apartmentNumber, CMD_ACK_AR, CMD_ACK_EN, silenceMinutes);
+  }
+  else if (strcmp(command, "/history") == 0)
+  {
+    sendHistoryReply(apartmentNumber);
+  }
+  else
+  {
+    // /start, /help and anything unknown
+    sendFormattedMessage(apartmentNumber, CMD_HELP_AR, CMD_HELP_EN, silenceMinutes);
+  }
+}
+
+void TelegramHandler::sendStatusReply(uint8_t apartmentNumber)
+{
+  uint8_t index = getApartmentIndex(apartmentNumber);
+  if (index == 0xFF)
+    return;
+
+  BuildingSide side = APARTMENT_LOCATIONS[index].side;
+  BoxPosition box = APARTMENT_LOCATIONS[index].box;
+
+  bool armed = AlarmSystem::isSensorEnabled(apartmentNumber);
+  bool triggered = AlarmSystem::isSensorTriggered(apartmentNumber);
+  bool sirenOn = AlarmSystem::isAlarmActive(side);
+
+  // The resident's box wires and the main wire of their side
+  WireCutStatus wires = AlarmSystem::getWireCutStatus();
+  bool wireCut;
+  if (side == RIGHT_SIDE)
+    wireCut = wires.rightSideDistribution || (box == RIGHT_BOX ? wires.rightSideRightBox : wires.rightSideLeftBox);
+  else
+    wireCut = wires.leftSideDistribution || (box == RIGHT_BOX ? wires.leftSideRightBox : wires.leftSideLeftBox);
+
+  char messageAR[512];
+  char messageEN[512];
+  snprintf(messageAR, sizeof(messageAR), CMD_STATUS_AR, apartmentNumber,
+           armed ? STATUS_ARMED_AR : STATUS_DISARMED_AR,
+           triggered ? STATUS_METER_TRIGGERED_AR : STATUS_METER_OK_AR,
+           sirenOn ? STATUS_SIREN_ON_AR : STATUS_SIREN_OFF_AR,
+           wireCut ? STATUS_WIRING_CUT_AR : STATUS_WIRING_OK_AR);
+  snprintf(messageEN, sizeof(messageEN), CMD_STATUS_EN, apartmentNumber,
+           armed ? STATUS_ARMED_EN : STATUS_DISARMED_EN,
+           triggered ? STATUS_METER_TRIGGERED_EN : STATUS_METER_OK_EN,
+           sirenOn ? STATUS_SIREN_ON_EN : STATUS_SIREN_OFF_EN,
+           wireCut ? STATUS_WIRING_CUT_EN : STATUS_WIRING_OK_EN);
+
+  const ApartmentConfig &config = _apartmentConfigs[apartmentNumber - 1];
+  sendMessage(config.tokenIndex, config.chatId, messageAR, messageEN);
+}
+
+void TelegramHandler::sendHistoryReply(uint8_t apartmentNumber)
+{
+  if (_historyCount == 0)
+  {
+    sendFormattedMessage(apartmentNumber, HISTORY_EMPTY_AR, HISTORY_EMPTY_EN);
+    return;
+  }
+
+  String messageAR = HISTORY_HEADER_AR;
+  String messageEN = HISTORY_HEADER_EN;
+  char timeString[24];
+  char line[192];
+
+  // Newest first
+  for (uint8_t i = 0; i < _historyCount; i++)
+  {
+    const HistoryEntry &entry = _history[(_historyHead + ALERT_HISTORY_SIZE - 1 - i) % ALERT_HISTORY_SIZE];
+    formatEventTime(entry.eventTime, entry.eventUptime, timeString, sizeof(timeString));
+
+    bool rightSide = (entry.type == HistoryEventType::WIRE_CUT ? entry.detail / 2 : entry.detail) == RIGHT_SIDE;
+
+    switch (entry.type)
+    {
+    case HistoryEventType::THEFT:
+      snprintf(line, sizeof(line), HISTORY_THEFT_AR, timeString, entry.detail);
+      messageAR += line;
+      snprintf(line, sizeof(line), HISTORY_THEFT_EN, timeString, entry.detail);
+      messageEN += line;
+      break;
+
+    case HistoryEventType::WIRE_CUT:
+      snprintf(line, sizeof(line), HISTORY_WIRE_CUT_AR, timeString, rightSide ? SIDE_RIGHT_AR : SIDE_LEFT_AR);
+      messageAR += line;
+      snprintf(line, sizeof(line), HISTORY_WIRE_CUT_EN, timeString, rightSide ? SIDE_RIGHT_EN : SIDE_LEFT_EN);
+      messageEN += line;
+      break;
+
+    case HistoryEventType::DISTRIBUTION_WIRE_CUT:
+      snprintf(line, sizeof(line), HISTORY_DIST_WIRE_CUT_AR, timeString, rightSide ? SIDE_RIGHT_AR : SIDE_LEFT_AR);
+      messageAR += line;
+      snprintf(line, sizeof(line), HISTORY_DIST_WIRE_CUT_EN, timeString, rightSide ? SIDE_RIGHT_EN : SIDE_LEFT_EN);
+      messageEN += line;
+      break;
+    }
+  }
+
+  const ApartmentConfig &config = _apartmentConfigs[apartmentNumber - 1];
+  sendMessage(config.tokenIndex, config.chatId, messageAR, messageEN);
+}
+
+void TelegramHandler::recordHistory(HistoryEventType type, uint8_t detail)
+{
+  uint32_t uptime = millis() / 1000;
+
+  // A meter that keeps vibrating is one event, not ten
+  if (_historyCount > 0)
+  {
+    const HistoryEntry &newest = _history[(_historyHead + ALERT_HISTORY_SIZE - 1) % ALERT_HISTORY_SIZE];
+    if (newest.type == type && newest.detail == detail && uptime - newest.eventUptime < 60)
+      return;
+  }
+
+  HistoryEntry &entry = _history[_historyHead];
+  entry.eventTime = WiFiManager::getEpochTime();
+  entry.eventUptime = uptime;
+  entry.type = type;
+  entry.detail = detail;
+
+  _historyHead = (_historyHead + 1) % ALERT_HISTORY_SIZE;
+  if (_historyCount < ALERT_HISTORY_SIZE)
+    _historyCount++;
+}
+
+void TelegramHandler::formatEventTime(uint32_t eventTime, uint32_t eventUptime, char *buffer, size_t size)
+{
+  if (eventTime != 0)
+  {
+    time_t time = eventTime;
+    struct tm timeInfo;
+    localtime_r(&time, &timeInfo);
+    strftime(buffer, size, "%Y-%m-%d %H:%M", &timeInfo);
+  }
+  else
+  {
+    // Clock not synced yet, fall back to the time since start-up
+    snprintf(buffer, size, "+%lus", (unsigned long)eventUptime);
+  }
+}
+
 // Update method to be called from main loop
 void TelegramHandler::update()
 {
+  // Digests are queued even while offline; the queue holds them until we reconnect
+  if (hasPendingAlerts() && millis() - _pendingSince >= _coalesceWindow)
+  {
+    flushPendingAlerts();
+  }
+
+  // Pick up token changes for the poll task and run commands it received
+  if (_pollBotsDirty)
+  {
+    refreshPollBots();
+  }
+  processBotCommands();
+  checkIncidents();
+
   if (isReady())
   {
     processMessageQueue();
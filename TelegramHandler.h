@@ -4,24 +4,119 @@
 #define TELEGRAM_HANDLER_H
 
 #include <Arduino.h>
-// #include <UniversalTelegramBot.h>
-#include "CTBot.h"
 #include <WiFiClientSecure.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "JsonStream.h"
 #include "WiFiConfig.h"
 #include "PinsConfig.h"
 #include "TelegramMessages.h"
+#include "Metrics.h"
 
 // Telegram Configuration Constants
 #define MAX_APARTMENTS 24
 
+// Message tiers, used to cancel sends that an acknowledgement made pointless
+enum class MessageTier : uint8_t {
+    NORMAL,           // Owner alerts, wire cuts, replies: always delivered
+    NEIGHBOUR,        // Theft alerts about someone else's meter
+    ESCALATION        // Re-notification of an unacknowledged incident
+};
+
+// Bot Token Table Constants
+// Apartments and queued messages refer to a shared bot token by its index
+static const uint8_t MAX_BOT_TOKENS = 4;            // Distinct bot tokens in use at once
+static const uint8_t NO_BOT_TOKEN = 0xFF;           // Token index of an unconfigured apartment
+static const uint8_t TELEGRAM_TOKEN_SIZE = 64;      // Buffer size for a bot token
+
+// What Telegram said about a bot token the last time it was used
+enum class BotTokenState : uint8_t {
+    UNKNOWN,          // Nothing sent with the token yet
+    VALID,            // The last request was accepted
+    UNAUTHORIZED      // Telegram rejected the token
+};
+
+// Per-bot health, shown in the web portal
+struct BotTokenStats {
+    BotTokenState state;
+    uint8_t apartments;       // Configured apartments using the token
+    uint32_t sent;            // Messages delivered
+    uint32_t failed;          // Failed send attempts
+    uint32_t lastSuccess;     // millis() of the last delivery, 0 = never
+    int16_t lastErrorCode;    // error_code of the last failure
+};
+
+// Queue delivery counters since boot, exported on /metrics
+struct TelegramStats {
+    uint32_t sent;
+    uint32_t failed;          // Attempts that did not deliver
+    uint32_t retries;         // Failed attempts scheduled again
+    uint32_t rateLimited;     // Attempts answered with 429
+    uint32_t dropped;         // Messages given up on
+    MetricHistogram latency;  // Connect to response, every attempt
+};
+
 // Message queue structure
 struct QueuedMessage {
-    String token;
+    uint8_t tokenIndex;       // Index into the bot token table
     int64_t chatId;
     String message;
     uint8_t retries;
     uint32_t nextAttemptTime;
     bool inProgress;
+    uint32_t sequence;        // Persisted alert record, 0 if the message is not persisted
+    uint32_t incidentMask;    // Incidents (bit N = apartment N+1) this message is about
+    MessageTier tier;
+    uint8_t keyboardApartment; // Attach the acknowledge buttons for this apartment, 0 = none
+    bool cancelled;           // Dropped when it reaches the head of the queue
+};
+
+// Parsed Telegram Bot API response
+struct TelegramResult {
+    bool ok;                  // Telegram accepted the request
+    int16_t errorCode;        // error_code, 0 if missing (e.g. no response at all)
+    uint32_t retryAfter;      // parameters.retry_after in seconds, set on 429
+    int32_t messageId;        // result.message_id of the sent message
+    char description[96];     // Human readable error from Telegram
+};
+
+// Bot command received by the poll task, executed from the main loop
+struct BotCommand {
+    int64_t chatId;
+    uint8_t botIndex;         // Index into the bot token table
+    char text[32];            // Command text, e.g. "/status", or the button data
+    bool isCallback;          // An inline keyboard button was pressed
+};
+
+// Theft incident (one per meter), escalated until the owner acknowledges it
+enum class IncidentState : uint8_t {
+    NONE,
+    OPEN,                     // Alert sent, waiting for the owner
+    ACKNOWLEDGED,             // Owner is checking, further alerts are held back
+    FALSE_ALARM               // Owner reported a false alarm
+};
+
+struct Incident {
+    IncidentState state;
+    uint8_t tier;             // Escalations sent so far
+    uint32_t startTime;       // millis() when the incident opened
+    uint32_t ackTime;         // millis() of the acknowledgement
+};
+
+// Alert event kept for the /history command
+enum class HistoryEventType : uint8_t {
+    THEFT,                    // detail = apartment number
+    WIRE_CUT,                 // detail = side * 2 + box
+    DISTRIBUTION_WIRE_CUT     // detail = side
+};
+
+struct HistoryEntry {
+    uint32_t eventTime;       // Unix time, 0 if the clock was not synced yet
+    uint32_t eventUptime;     // Seconds since boot
+    HistoryEventType type;
+    uint8_t detail;
 };
     
 // Alert Types for Different Scenarios
@@ -31,13 +126,55 @@ enum class AlertType {
     ADJACENT_BOX,      // Alert for apartments in the adjacent box
     OTHER_SIDE         // Alert for apartments on the other side
 };
+static const uint8_t ALERT_TYPE_COUNT = 4;
 
 // Constants for message sending
 static const uint16_t HTTP_TIMEOUT = 1000;          // 1 second timeout
+static const uint16_t TELEGRAM_RESPONSE_TIMEOUT = 5000; // Max time to wait for a complete API response (ms)
+static const char TELEGRAM_API_BASE_URL[] = "https://api.telegram.org"; // Default Bot API server
+static const uint8_t TELEGRAM_API_HOST_SIZE = 64;   // Buffer size for the API server host name
+
+// Constants for bot commands
+static const uint8_t LONG_POLL_TIMEOUT = 25;        // getUpdates long-poll timeout (s)
+static const uint16_t POLL_RETRY_DELAY = 5000;      // Delay after a failed or idle poll (ms)
+static const uint8_t COMMAND_QUEUE_SIZE = 8;        // Commands waiting for the main loop
+static const uint32_t ACK_SILENCE_PERIOD = 15UL * 60 * 1000; // /ack mutes theft alerts for 15 minutes
+static const uint8_t ALERT_HISTORY_SIZE = 10;       // Events listed by /history
+
+// Constants for incident escalation
+static const uint16_t ESCALATION_DELAY = 120;       // Default seconds without acknowledgement before escalating
+static const uint8_t MAX_ESCALATIONS = 2;           // Escalations sent before an incident is closed
+static const uint8_t CALLBACK_ID_SIZE = 24;         // Buffer size for a callback query ID
 static const uint8_t MAX_RETRIES = 3;              // Max retries for failed messages
 static const uint16_t RETRY_DELAY = 100;          // Delay between retries in ms
 static const uint16_t RATE_LIMIT_DELAY = 500;       // Min delay between messages (ms)
 static const uint8_t MAX_QUEUE_SIZE = 50;          // Maximum queue size
+static const uint16_t ALERT_COALESCE_WINDOW = 2000; // Default window for merging alerts into one digest (ms)
+static const uint8_t MAX_PERSISTED_ALERTS = MAX_QUEUE_SIZE; // One record for every alert the queue can hold
+static const uint32_t PERSISTED_ALERT_MAGIC = 0x414C5254; // "ALRT"
+
+// Persisted alert flags
+#define PERSISTED_FLAG_SENSOR_WIRE_CUT 0x01
+#define PERSISTED_FLAG_DIST_WIRE_CUT 0x02
+
+// Undelivered alert digest, kept in RTC memory so it survives a restart
+// The message text is rebuilt from these fields when the alert is replayed
+struct PersistedAlert {
+    uint32_t sequence;        // Monotonic sequence number, 0 = free slot
+    uint32_t eventTime;       // Unix time of the event, 0 if the clock was not synced yet
+    uint32_t eventUptime;     // Seconds since boot when the event happened
+    uint32_t theftMask;       // Bit N = apartment N+1
+    uint8_t apartment;        // Recipient apartment number
+    uint8_t flags;            // PERSISTED_FLAG_* bits
+    uint16_t reserved;
+};
+
+struct PersistedAlertRing {
+    uint32_t magic;
+    uint32_t nextSequence;
+    PersistedAlert slots[MAX_PERSISTED_ALERTS];
+    uint32_t crc;             // CRC32 of everything above
+};
 
 
 class TelegramHandler {
@@ -58,7 +195,7 @@ public:
     static bool disableApartment(uint8_t apartmentNumber);
     static bool isApartmentEnabled(uint8_t apartmentNumber);
     static void loadAllConfigurations();
-    static void saveAllConfigurations();
+    static bool saveAllConfigurations();
     
     // System Status Messages
     static bool sendSystemOnlineMessage(uint8_t apartmentNumber);
@@ -69,6 +206,11 @@ public:
     // Apartment Configuration Getters
     static String getApartmentToken(uint8_t apartmentNumber);
     static int64_t getApartmentChatId(uint8_t apartmentNumber);
+
+    // Bot Token Table
+    static bool isBotTokenInUse(uint8_t tokenIndex);
+    static String getBotTokenLabel(uint8_t tokenIndex); // Bot ID with the secret part masked
+    static bool getBotTokenStats(uint8_t tokenIndex, BotTokenStats& stats);
     
     // Theft Alert Messages
     static bool sendTheftAlertToOwner(uint8_t apartmentNumber);
@@ -87,57 +229,234 @@ public:
     static void sendWireCutAlertsToSide(BuildingSide side);
     static void sendStartupWireCutAlertsToSide(BuildingSide side);
 
+    // Alert Coalescing
+    // Theft and wire-cut events arriving within the window are merged into one digest per recipient
+    static void setAlertCoalesceWindow(uint32_t windowMs); // 0 sends every event immediately
+    static uint32_t getAlertCoalesceWindow();
+    static void flushPendingAlerts();
+
+    // Bot Commands
+    // A background task long-polls getUpdates once per distinct bot token;
+    // the commands it receives are executed from update()
+    static bool isAlertSilenced(uint8_t apartmentNumber);
+
+    // Bot API Server
+    // Tests point the handler at a local stand-in (see tools/telegram_standin.py)
+    static bool setApiBaseUrl(const String& url); // "http(s)://host[:port]", empty restores the default
+    static String getApiBaseUrl();
+
+    // Queue Statistics
+    static uint8_t getQueueSize();
+    static uint8_t getQueueHighWater();         // Largest queue size since boot
+    static TelegramStats getStats();
+
+    // Incident Escalation
+    // Theft alerts to the owner carry "I'm checking" / "False alarm" buttons; without an
+    // answer the same-box residents are notified again every escalation delay
+    static bool acknowledgeIncident(uint8_t apartmentNumber, bool falseAlarm);
+    static void setEscalationDelay(uint16_t seconds); // 0 disables escalation
+    static uint16_t getEscalationDelay();
+
     // Process pending messages - call this from the main loop
     static void update();
 
 private:
     // Apartment Configuration Structure
     struct ApartmentConfig {
-        String token;
+        uint8_t tokenIndex;       // Index into _botTokens, NO_BOT_TOKEN if unset
         int64_t chatId;
         bool enabled;
         bool configured;
     };
     
     // Static Member Variables
+    // Interned Bot Token (one entry per distinct token, shared by its apartments)
+    struct BotToken {
+        char token[TELEGRAM_TOKEN_SIZE]; // Empty for a free slot
+        BotTokenStats stats;
+        bool polled;              // An enabled apartment uses the token
+        int32_t updateOffset;     // Next update_id to request from getUpdates
+    };
+
+    // Bot API Server Endpoint
+    struct ApiEndpoint {
+        char host[TELEGRAM_API_HOST_SIZE];
+        uint16_t port;
+        bool secure;              // HTTPS, plain HTTP is only meant for a local stand-in
+    };
+
+    // Fan-out Plan Entry (who is notified, and how, when a meter is hit)
+    struct FanoutEntry {
+        uint8_t recipient;
+        AlertType type;
+    };
+
     static ApartmentConfig _apartmentConfigs[MAX_APARTMENTS];
+    static BotToken _botTokens[MAX_BOT_TOKENS];
     static String _lastError;
     static WiFiClientSecure _client;
+    static WiFiClient _plainClient;
+    static ApiEndpoint _api;                    // Shared with the poll task under _pollMutex
     static uint32_t _lastMessageTime;
     static bool _isInitialized;
-    static CTBot _bot; // Added CTBot as a static member
+    static TelegramResult _lastResult;
+    static JsonStream _responseParser;
     
+    // One apartment's recipient chat and bot
+    struct StoredApartment {
+        int64_t chatId;
+        uint8_t tokenIndex;       // Into StoredConfig::tokens, NO_BOT_TOKEN if not configured
+        uint8_t enabled;
+    } __attribute__((packed));
+
+    // Bot token table, per-apartment recipients and alert settings
+    struct StoredConfig {
+        char tokens[MAX_BOT_TOKENS][TELEGRAM_TOKEN_SIZE];
+        StoredApartment apartments[MAX_APARTMENTS];
+        uint32_t coalesceWindow;
+        uint16_t escalationDelay;
+        char apiHost[TELEGRAM_API_HOST_SIZE];
+        uint16_t apiPort;
+        uint8_t apiSecure;
+    } __attribute__((packed));
+
     // Constants for Storage
+    static const uint16_t CONFIG_VERSION = 1;
     static const char* PREFERENCE_NAMESPACE;
+    // Legacy per-field keys, only read to migrate older configurations
     static const char* TOKEN_KEY_PREFIX;
     static const char* CHAT_ID_KEY_PREFIX;
     static const char* ENABLED_KEY_PREFIX;
-    
+    static const char* COALESCE_WINDOW_KEY;
+    static const char* ESCALATION_DELAY_KEY;
+    static const char* API_URL_KEY;
+
+    // Pending alert digest (bit N = apartment N+1, side*2+box, or side)
+    static uint32_t _pendingTheftMask;
+    static uint8_t _pendingWireCutMask;
+    static uint8_t _pendingDistWireCutMask;
+    static uint32_t _pendingSince;
+    static uint32_t _coalesceWindow;
+
+    // Precomputed recipients per target apartment, ordered by urgency
+    // Rebuilt lazily after any token, chat ID or enabled flag change
+    static FanoutEntry _fanoutPlans[MAX_APARTMENTS][MAX_APARTMENTS];
+    static uint8_t _fanoutCounts[MAX_APARTMENTS];
+    static bool _fanoutDirty;
+
+    // Bot command polling (the token table is shared with the poll task under _pollMutex)
+    static bool _pollBotsDirty;
+    static uint8_t _changedBotSlots;  // Bit per slot that was freed or took a token since the last refresh
+    static SemaphoreHandle_t _pollMutex;
+    static QueueHandle_t _commandQueue;
+    static TaskHandle_t _pollTask;
+    static uint32_t _ackTime[MAX_APARTMENTS];   // millis() of the last /ack, 0 = none
+
+    // Theft incidents, indexed by apartment number - 1
+    static Incident _incidents[MAX_APARTMENTS];
+    static uint16_t _escalationDelay;
+
+    // Recent alert events for /history
+    static HistoryEntry _history[ALERT_HISTORY_SIZE];
+    static uint8_t _historyHead;
+    static uint8_t _historyCount;
+
+    // Undelivered alerts, survives software resets, watchdog resets and panics
+    static PersistedAlertRing _persistedAlerts;
     
     static QueuedMessage _messageQueue[MAX_QUEUE_SIZE];
     static uint8_t _queueHead;
     static uint8_t _queueTail;
     static uint8_t _queueSize;
+    static uint8_t _queueHighWater;
+    static TelegramStats _stats;
     static bool _processingQueue;
 
     // Helper Methods
     static bool validateToken(const String& token);
     static bool validateChatId(int64_t chatId);
     static bool validateApartmentNumber(uint8_t apartmentNumber);
+    static bool parseApiBaseUrl(const String& url, ApiEndpoint& endpoint);
+
+    // Bot Token Table Helpers
+    static uint8_t internToken(const String& token);
+    static void releaseToken(uint8_t tokenIndex);
+    static void setApartmentToken(uint8_t apartmentNumber, uint8_t tokenIndex);
+    static void recordTokenResult(uint8_t tokenIndex, bool delivered);
+    static void dropTokenMessages(uint8_t tokenIndex);
     
     // Message Sending Helpers
-    static bool sendMessage(const String& token, int64_t chatId, const String& messageAR, const String& messageEN);
+    static bool sendMessage(uint8_t tokenIndex, int64_t chatId, const String& messageAR, const String& messageEN,
+                            uint32_t sequence = 0, uint32_t incidentMask = 0,
+                            MessageTier tier = MessageTier::NORMAL, uint8_t keyboardApartment = 0);
     static bool sendFormattedMessage(uint8_t apartmentNumber, const char* messageAR, const char* messageEN, ...);
+
+    // Digest Helpers
+    static bool hasPendingAlerts();
+    static void sendAlertDigest(uint8_t apartmentNumber, uint32_t theftMask, const uint32_t typeMasks[ALERT_TYPE_COUNT],
+                                bool sensorWireCut, bool distributionWireCut, uint32_t eventMillis);
+    static bool buildAlertDigest(const uint32_t typeMasks[ALERT_TYPE_COUNT], bool sensorWireCut, bool distributionWireCut,
+                                 String& messageAR, String& messageEN);
+    static void appendDigestSection(String& messageAR, String& messageEN, uint32_t apartmentMask,
+                                    const char* singleAR, const char* singleEN,
+                                    const char* digestAR, const char* digestEN);
+    static void formatApartmentList(uint32_t apartmentMask, char* buffer, size_t size);
+
+    // Fan-out Plan Helpers
+    static void rebuildFanoutPlans();
+    static void collectFanout(uint32_t theftMask, uint32_t recipientMasks[MAX_APARTMENTS][ALERT_TYPE_COUNT]);
+    static void markConfigChanged();
+
+    // Bot Command Helpers
+    static void refreshPollBots();
+    static void pollTaskLoop(void* parameter);
+    static bool pollUpdates(WiFiClient& client, JsonStream& parser, const ApiEndpoint& api, uint8_t botIndex,
+                            const char* token, int32_t offset, uint8_t timeoutSeconds);
+    static void onUpdateValue(void* context, const JsonStream& stream, JsonEvent event, const char* value);
+    static void processBotCommands();
+    static void handleBotCommand(const BotCommand& command);
+    static void executeBotCommand(uint8_t apartmentNumber, const char* command);
+    static void sendStatusReply(uint8_t apartmentNumber);
+    static void sendHistoryReply(uint8_t apartmentNumber);
+    static void recordHistory(HistoryEventType type, uint8_t detail);
+    static void formatEventTime(uint32_t eventTime, uint32_t eventUptime, char* buffer, size_t size);
+    static bool answerCallbackQuery(WiFiClient& client, JsonStream& parser, const ApiEndpoint& api,
+                                    const char* token, const char* callbackId);
+    static void urlEncode(const char* text, char* buffer, size_t size);
+
+    // Incident Helpers
+    static void openIncidents(uint32_t theftMask);
+    static uint32_t getAcknowledgedIncidents();
+    static void checkIncidents();
+    static void sendEscalation(uint8_t apartmentNumber, uint32_t elapsedSeconds);
+    static void cancelIncidentMessages();
+    static int formatIncidentKeyboard(uint8_t apartmentNumber, char* buffer, size_t size);
     
     // Storage Helpers
-    static void saveApartmentConfig(uint8_t apartmentNumber);
-    static void loadApartmentConfig(uint8_t apartmentNumber);
+    static void applyStoredConfig(const StoredConfig& config);
+    static bool loadLegacyConfig(StoredConfig& config);
+    static void removeLegacyConfig();
     static String generateStorageKey(const char* prefix, uint8_t apartmentNumber);
 
+    // Persisted Alert Helpers
+    static void initPersistedAlerts();
+    static void replayPersistedAlerts();
+    static void persistPendingAlerts();
+    static uint32_t persistAlert(uint8_t apartmentNumber, uint32_t theftMask, uint8_t flags, uint32_t eventMillis);
+    static void releasePersistedAlert(uint32_t sequence);
+    static void updatePersistedChecksum();
+    static uint32_t calculatePersistedChecksum();
+
     // Queue management methods
-    static bool enqueueMessage(const String& token, int64_t chatId, const String& message);
+    static bool enqueueMessage(uint8_t tokenIndex, int64_t chatId, const String& message, uint32_t sequence = 0,
+                               uint32_t incidentMask = 0, MessageTier tier = MessageTier::NORMAL,
+                               uint8_t keyboardApartment = 0);
     static bool processMessageQueue();
-    static bool sendMessageWithTimeout(const String& token, int64_t chatId, const String& message);
+    static bool sendMessageWithTimeout(uint8_t tokenIndex, int64_t chatId, const String& message, uint8_t keyboardApartment = 0);
+
+    // Bot API helpers
+    static bool readApiResponse(WiFiClient& client, JsonStream& parser, JsonCallback callback, void* context, uint32_t timeout);
+    static void onResponseValue(void* context, const JsonStream& stream, JsonEvent event, const char* value);
 };
 
 // External declaration for global access
@@ -22,6 +22,17 @@
 #define THEFT_ALERT_OTHER_SIDE_AR "ℹ️ إشعار أمني!\n\nتم اكتشاف اهتزاز محتمل في عداد المياه للشقة رقم %d.\nهذا العداد موجود في الجهة الأخرى من المبنى."
 #define THEFT_ALERT_OTHER_SIDE_EN "\n\nℹ️ Security Notice!\n\nPotential vibration detected in Apartment %d's water meter.\nThis meter is on the other side of the building."
 
+// Theft Digest Messages (several meters hit within one coalescing window)
+// %s is a comma separated list of apartment numbers, e.g. "5, 9, 13"
+#define THEFT_DIGEST_SAME_BOX_AR "⚠️ تنبيه أمني!\n\nتم اكتشاف اهتزاز محتمل في عدادات المياه للشقق أرقام %s.\nهذه العدادات موجودة في نفس الصندوق مع عدادك.\nالرجاء الحذر والمراقبة!"
+#define THEFT_DIGEST_SAME_BOX_EN "\n\n⚠️ Security Alert!\n\nPotential vibration detected in the water meters of Apartments %s in your box.\nPlease be vigilant!"
+
+#define THEFT_DIGEST_ADJACENT_BOX_AR "⚠️ تنبيه أمني!\n\nتم اكتشاف اهتزاز محتمل في عدادات المياه للشقق أرقام %s.\nهذه العدادات موجودة في الصندوق المجاور لصندوق عدادك.\nالرجاء الحذر والمراقبة!"
+#define THEFT_DIGEST_ADJACENT_BOX_EN "\n\n⚠️ Security Alert!\n\nPotential vibration detected in the water meters of Apartments %s in the box adjacent to yours.\nPlease be vigilant!"
+
+#define THEFT_DIGEST_OTHER_SIDE_AR "ℹ️ إشعار أمني!\n\nتم اكتشاف اهتزاز محتمل في عدادات المياه للشقق أرقام %s.\nهذه العدادات موجودة في الجهة الأخرى من المبنى."
+#define THEFT_DIGEST_OTHER_SIDE_EN "\n\nℹ️ Security Notice!\n\nPotential vibration detected in the water meters of Apartments %s on the other side of the building."
+
 // Sensor Wire Cut Detection Messages
 #define SENSOR_WIRE_CUT_ALERT_AR "🚨 تنبيه خطر - قطع سلك مستشعر!\n\nتم اكتشاف قطع في أحد أسلاك المستشعرات في صندوق العدادات الخاص بكم.\nلن يتم إخطارك بقطع الأسلاك مرة أخرى حتى يتم إصلاح المشكلة.\nالرجاء الاتصال بالصيانة."
 #define SENSOR_WIRE_CUT_ALERT_EN "\n\n🚨 Danger Alert - Sensor Wire Cut!\n\nA cut has been detected in one of the sensor cables in your meters box.\nYou won't be notified of wire cuts again until this is fixed.\nPlease contact maintenance."
@@ -38,6 +49,14 @@
 #define STARTUP_DIST_CTRL_WIRE_CUT_AR "🛠️ تنبيه هام!\n\nتمت إعادة تشغيل النظام وتم اكتشاف قطع في الأسلاك بين لوحة التوزيع ووحدة التحكم في جهتك من المبنى.\nلن يتمكن النظام من اكتشاف قطع الأسلاك في جهتك حتى يتم إصلاح المشكلة.\nالرجاء الاتصال بالصيانة في أقرب وقت ممكن لإصلاح المشكلة وإعادة تفعيل نظام كشف قطع الأسلاك."
 #define STARTUP_DIST_CTRL_WIRE_CUT_EN "\n\n🛠️ Important Alert!\n\nSystem has rebooted and a wire cut was detected between the distribution box and the control unit in your side of the building.\nThe system won't be able to detect wire cuts in your side until this issue is fixed.\nPlease contact maintenance as soon as possible to fix the issue and reactivate the wire cut detection system."
 
+// Delayed Alert Prefix (alert was still queued when the system restarted)
+// %s is the local date and time of the event, e.g. "2024-05-03 02:14:09"
+#define DELAYED_ALERT_AR "⏱️ تنبيه متأخر!\nتم اكتشاف هذا الحدث في %s قبل إعادة تشغيل النظام.\n\n"
+#define DELAYED_ALERT_EN "\n\n⏱️ Delayed Alert!\nThis event was detected at %s, before the system restarted."
+// Used when the clock was not synced yet; %lu is the number of seconds after the previous start-up
+#define DELAYED_ALERT_UPTIME_AR "⏱️ تنبيه متأخر!\nتم اكتشاف هذا الحدث بعد %lu ثانية من بدء التشغيل السابق، قبل إعادة تشغيل النظام.\n\n"
+#define DELAYED_ALERT_UPTIME_EN "\n\n⏱️ Delayed Alert!\nThis event was detected %lu seconds after the previous start-up, before the system restarted."
+
 // Service Subscription Messages
 #define SERVICE_ENABLED_AR "🎉 تهانينا!\n\nتم تفعيل خدمة مكافحة سرقة عداد المياه لشقتك رقم %d.\nسيتم إخطارك بأي نشاط مشبوه يتعلق بعدادك."
 #define SERVICE_ENABLED_EN "\n\n🎉 Congratulations!\n\nWater Meter Anti-Theft service has been activated for your Apartment %d.\nYou will be notified of any suspicious activity related to your meter."
@@ -46,5 +65,70 @@
 #define SERVICE_DISABLED_AR "⚠️ تنبيه!\n\nتم إيقاف خدمة مكافحة سرقة عداد المياه لشقتك رقم %d."
 #define SERVICE_DISABLED_EN "\n\n⚠️ Alert!\n\nWater Meter Anti-Theft service has been deactivated for your Apartment %d."
 
+// Bot Command Replies
+#define CMD_HELP_AR "🤖 الأوامر المتاحة:\n\n/status - حالة عداد شقتك\n/arm - تفعيل مستشعر عدادك\n/disarm - إيقاف مستشعر عدادك\n/ack - إيقاف تكرار تنبيهات السرقة لمدة %lu دقيقة\n/history - آخر الأحداث المسجلة"
+#define CMD_HELP_EN "\n\n🤖 Available commands:\n\n/status - Your meter's status\n/arm - Enable your meter's sensor\n/disarm - Disable your meter's sensor\n/ack - Mute repeat theft alerts for %lu minutes\n/history - Recent events"
+
+// %d is the apartment number, then sensor, meter, siren and wiring state
+#define CMD_STATUS_AR "📊 حالة الشقة رقم %d\n\nالمستشعر: %s\nالعداد: %s\nصفارة الإنذار: %s\nالأسلاك: %s"
+#define CMD_STATUS_EN "\n\n📊 Apartment %d Status\n\nSensor: %s\nMeter: %s\nSiren: %s\nWiring: %s"
+#define STATUS_ARMED_AR "مفعل"
+#define STATUS_ARMED_EN "Armed"
+#define STATUS_DISARMED_AR "متوقف"
+#define STATUS_DISARMED_EN "Disarmed"
+#define STATUS_METER_OK_AR "طبيعي"
+#define STATUS_METER_OK_EN "Normal"
+#define STATUS_METER_TRIGGERED_AR "تم اكتشاف اهتزاز"
+#define STATUS_METER_TRIGGERED_EN "Vibration detected"
+#define STATUS_SIREN_ON_AR "تعمل"
+#define STATUS_SIREN_ON_EN "On"
+#define STATUS_SIREN_OFF_AR "متوقفة"
+#define STATUS_SIREN_OFF_EN "Off"
+#define STATUS_WIRING_OK_AR "سليمة"
+#define STATUS_WIRING_OK_EN "OK"
+#define STATUS_WIRING_CUT_AR "مقطوعة"
+#define STATUS_WIRING_CUT_EN "Cut"
+
+#define CMD_ARMED_AR "✅ تم تفعيل مستشعر عداد الشقة رقم %d."
+#define CMD_ARMED_EN "\n\n✅ The meter sensor of Apartment %d is now armed."
+#define CMD_DISARMED_AR "⏸️ تم إيقاف مستشعر عداد الشقة رقم %d.\nلن يتم اكتشاف أي اهتزاز في عدادك حتى تقوم بتفعيله مرة أخرى باستخدام /arm."
+#define CMD_DISARMED_EN "\n\n⏸️ The meter sensor of Apartment %d is now disarmed.\nVibration at your meter won't be detected until you send /arm."
+#define CMD_ACK_AR "🔕 تم استلام التأكيد.\nلن تصلك تنبيهات سرقة متكررة لمدة %lu دقيقة. ستظل تنبيهات قطع الأسلاك تصلك."
+#define CMD_ACK_EN "\n\n🔕 Acknowledged.\nRepeat theft alerts are muted for %lu minutes. Wire cut alerts are still sent."
+#define CMD_FAILED_AR "❌ تعذر تنفيذ الأمر، الرجاء المحاولة لاحقاً."
+#define CMD_FAILED_EN "\n\n❌ The command could not be completed, please try again later."
+
+// History Reply (one line per event, %s is the event time)
+#define HISTORY_HEADER_AR "🕘 آخر الأحداث المسجلة:\n"
+#define HISTORY_HEADER_EN "\n\n🕘 Recent events:\n"
+#define HISTORY_EMPTY_AR "🕘 لا توجد أحداث مسجلة منذ آخر تشغيل للنظام."
+#define HISTORY_EMPTY_EN "\n\n🕘 No events recorded since the system started."
+#define HISTORY_THEFT_AR "\n%s - اهتزاز في عداد الشقة رقم %d"
+#define HISTORY_THEFT_EN "\n%s - Vibration at Apartment %d's meter"
+#define HISTORY_WIRE_CUT_AR "\n%s - قطع سلك مستشعر في الجهة %s"
+#define HISTORY_WIRE_CUT_EN "\n%s - Sensor wire cut on the %s side"
+#define HISTORY_DIST_WIRE_CUT_AR "\n%s - قطع السلك الرئيسي في الجهة %s"
+#define HISTORY_DIST_WIRE_CUT_EN "\n%s - Main wire cut on the %s side"
+#define SIDE_RIGHT_AR "اليمنى"
+#define SIDE_RIGHT_EN "right"
+#define SIDE_LEFT_AR "اليسرى"
+#define SIDE_LEFT_EN "left"
+
+// Incident Escalation Messages
+// Inline keyboard buttons attached to the owner's theft alert
+#define INCIDENT_BUTTON_CHECKING "🔍 أتحقق الآن | I'm checking"
+#define INCIDENT_BUTTON_FALSE_ALARM "✅ إنذار كاذب | False alarm"
+
+// %d is the apartment number, %lu the seconds since the first alert
+#define ESCALATION_SAME_BOX_AR "🚨🚨 تنبيه عاجل!\n\nلم يرد صاحب الشقة رقم %d على تنبيه السرقة منذ %lu ثانية.\nهذا العداد موجود في نفس الصندوق مع عدادك.\nالرجاء التحقق من الصندوق فوراً!"
+#define ESCALATION_SAME_BOX_EN "\n\n🚨🚨 Urgent Alert!\n\nThe owner of Apartment %d has not responded to the theft alert for %lu seconds.\nThis meter is in the same box as yours.\nPlease check the box immediately!"
+
+#define INCIDENT_ACK_AR "👍 شكراً لك!\nتم إيقاف تصعيد التنبيه ولن يتم إخطار جيرانك مرة أخرى بهذا الحادث."
+#define INCIDENT_ACK_EN "\n\n👍 Thank you!\nThe alert will not be escalated and your neighbours won't be notified about this incident again."
+#define INCIDENT_FALSE_ALARM_AR "✅ تم تسجيل البلاغ كإنذار كاذب.\nلن يتم إخطار جيرانك مرة أخرى بهذا الحادث."
+#define INCIDENT_FALSE_ALARM_EN "\n\n✅ Marked as a false alarm.\nYour neighbours won't be notified about this incident again."
+#define INCIDENT_NONE_AR "ℹ️ لا يوجد تنبيه سرقة مفتوح لعدادك."
+#define INCIDENT_NONE_EN "\n\nℹ️ There is no open theft alert for your meter."
+
 
 #endif // TELEGRAM_MESSAGES_H
\ No newline at end of file
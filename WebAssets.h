@@ -0,0 +1,322 @@
+// WebAssets.h
+// Generated by tools/build_web_assets.py from web/, do not edit
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <Arduino.h>
+
+// Static portal file, stored gzip-compressed
+struct WebAsset {
+    const char* route;
+    const char* contentType;
+    const uint8_t* data;
+    size_t length;
+    const char* etag;         // Strong ETag, quoted
+    bool versioned;           // Referenced with ?v=<hash>, safe to cache for a long time
+};
+
+// style.css: 3385 bytes, 1190 gzipped
+static const uint8_t WEB_ASSET_STYLE_CSS[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xa5, 0x57, 0xdd, 0x6f, 0xab, 0x36,
+    0x14, 0x7f, 0xcf, 0x5f, 0x61, 0xa9, 0x9a, 0x6e, 0x53, 0x05, 0x0a, 0xa4, 0xa4, 0x4d, 0xfa, 0x3a,
+    0x69, 0xda, 0xf3, 0xdd, 0x26, 0xed, 0xd1, 0xe0, 0x03, 0x78, 0x75, 0x6c, 0x64, 0x3b, 0x49, 0x7b,
+    0xa7, 0xfb, 0xbf, 0xef, 0xd8, 0x86, 0x04, 0x02, 0xa9, 0xee, 0xd5, 0x9a, 0x26, 0x01, 0x73, 0xce,
+    0xef, 0x7c, 0x7f, 0xe4, 0xf1, 0x81, 0x7c, 0x6d, 0xa8, 0x06, 0x46, 0x8c, 0xfd, 0x10, 0x40, 0x54,
+    0x45, 0xe0, 0x08, 0xfa, 0x83, 0xb4, 0x4a, 0x5b, 0x2a, 0x48, 0x4b, 0x6b, 0x58, 0x11, 0x03, 0xfa,
+    0x88, 0x24, 0xf5, 0x37, 0xde, 0xb6, 0xf8, 0x5d, 0x69, 0xb5, 0x27, 0x8f, 0xd4, 0x18, 0xb0, 0xe6,
+    0xd1, 0xf3, 0xc5, 0xa5, 0x31, 0xe4, 0xe1, 0x71, 0xb1, 0xd3, 0x4a, 0x59, 0xf2, 0xef, 0x82, 0x90,
+    0x28, 0x6a, 0x35, 0xdf, 0x53, 0xfd, 0xb1, 0x23, 0x77, 0x4f, 0xeb, 0x4d, 0x0a, 0xf0, 0xea, 0x4f,
+    0x0d, 0x94, 0x4a, 0xb2, 0x70, 0xbe, 0xa6, 0x49, 0x49, 0xd7, 0xe1, 0x5c, 0xf0, 0xba, 0xb1, 0x78,
+    0x56, 0xbd, 0x54, 0xdb, 0x8a, 0x86, 0x33, 0x24, 0x7b, 0xc3, 0xa3, 0x2c, 0xcd, 0xf2, 0x6c, 0xdb,
+    0xb1, 0x1f, 0xca, 0x12, 0x8c, 0x71, 0xa0, 0x45, 0x91, 0x3f, 0xad, 0x7b, 0x42, 0x59, 0x83, 0x76,
+    0xdc, 0xd5, 0x1a, 0xff, 0xc2, 0xe1, 0x89, 0x6a, 0xc9, 0x65, 0xed, 0x4f, 0x29, 0x4d, 0x92, 0xd7,
+    0xc5, 0xf7, 0xc5, 0x83, 0xd7, 0xad, 0x50, 0xef, 0x91, 0xe1, 0xdf, 0xfc, 0xc3, 0x42, 0x69, 0x06,
+    0x3a, 0xc2, 0x23, 0xf7, 0xbc, 0x50, 0xec, 0xc3, 0x93, 0x54, 0x4a, 0xda, 0xa8, 0xa2, 0x7b, 0x2e,
+    0x50, 0xd1, 0x2f, 0x5f, 0xa1, 0x56, 0x40, 0xfe, 0xfc, 0xfd, 0xcb, 0x8a, 0xfc, 0x41, 0x1b, 0xb5,
+    0xa7, 0x2b, 0xf2, 0x1b, 0x48, 0x38, 0xe2, 0xf7, 0x5f, 0xa0, 0x51, 0x3a, 0x5e, 0x18, 0x2a, 0x0d,
+    0x5a, 0xa7, 0x79, 0xe5, 0xc4, 0x17, 0xb4, 0x7c, 0xab, 0xb5, 0x3a, 0x48, 0xb6, 0x23, 0x82, 0x4b,
+    0xa0, 0x3a, 0xaa, 0x35, 0x65, 0x1c, 0xa4, 0xbd, 0x4f, 0xd7, 0x39, 0x83, 0x7a, 0x45, 0x8e, 0x54,
+    0xdf, 0x9f, 0xdd, 0xb4, 0xec, 0xef, 0xcf, 0x0e, 0x5a, 0x2e, 0x1d, 0x10, 0x3e, 0xab, 0xb9, 0xdc,
+    0x91, 0xc4, 0xdd, 0xb4, 0x94, 0x31, 0xaf, 0xb5, 0xbf, 0xdb, 0x73, 0x19, 0x35, 0x10, 0xfc, 0x96,
+    0x26, 0xc9, 0xb1, 0x71, 0x87, 0xa5, 0x12, 0x0a, 0x3d, 0x11, 0xb0, 0xbc, 0x53, 0x97, 0xce, 0xb0,
+    0x18, 0x41, 0x2d, 0x45, 0x45, 0xb4, 0x37, 0x6f, 0x4f, 0xdf, 0xa3, 0x13, 0x67, 0xb6, 0xd9, 0x91,
+    0x4d, 0x92, 0xb4, 0xef, 0x23, 0x49, 0x84, 0x1e, 0xac, 0x1a, 0x89, 0xcb, 0x34, 0xec, 0x03, 0x0a,
+    0xd5, 0x2c, 0xb8, 0x70, 0x60, 0x9f, 0xae, 0x0b, 0x7a, 0x9f, 0xe5, 0xf9, 0x8a, 0x5c, 0x3e, 0x92,
+    0x78, 0x9b, 0x7b, 0xfd, 0x3b, 0xff, 0x3a, 0xdb, 0x0f, 0xc6, 0xe9, 0x19, 0x84, 0x5d, 0x41, 0x77,
+    0x31, 0x69, 0x28, 0x53, 0x27, 0xa7, 0x81, 0x23, 0x23, 0x6b, 0xf7, 0xe1, 0xc1, 0x13, 0x04, 0x0c,
+    0xff, 0x71, 0xba, 0x9c, 0x58, 0xe9, 0xd2, 0x64, 0xe0, 0x2b, 0x8c, 0xa5, 0xb5, 0x6a, 0x7f, 0xd1,
+    0xba, 0x49, 0xbd, 0xca, 0x1d, 0xcf, 0xa9, 0xe1, 0xd6, 0xe7, 0xa2, 0x85, 0x77, 0x1b, 0x51, 0x74,
+    0x11, 0xda, 0x5c, 0x62, 0x5c, 0x40, 0xcf, 0x60, 0xa4, 0x71, 0xde, 0xa3, 0x64, 0x43, 0x94, 0xeb,
+    0x58, 0x0d, 0x58, 0xad, 0x6a, 0x7d, 0x80, 0xd0, 0x5d, 0x95, 0xd2, 0xfb, 0xc8, 0xb9, 0xa9, 0xed,
+    0xbc, 0x7e, 0x03, 0x5b, 0xd0, 0x02, 0x84, 0x27, 0x61, 0xdc, 0xb4, 0x82, 0x62, 0xce, 0x15, 0x42,
+    0x95, 0x6f, 0x33, 0x0a, 0x25, 0x1d, 0x53, 0x97, 0xa2, 0xa7, 0x2e, 0xfe, 0x9b, 0x90, 0xdf, 0x5c,
+    0xb6, 0x07, 0xeb, 0xea, 0x55, 0x40, 0x19, 0xea, 0xb0, 0x8b, 0x32, 0xe6, 0xc7, 0x2f, 0xe3, 0x0c,
+    0x8a, 0x9f, 0xf3, 0xb3, 0xeb, 0x5d, 0x88, 0x90, 0x06, 0xdd, 0x6d, 0x94, 0xe0, 0x8c, 0xdc, 0x31,
+    0xc6, 0x66, 0x82, 0xf7, 0x14, 0x62, 0xe7, 0x05, 0x63, 0xfd, 0x00, 0xb2, 0x74, 0x06, 0x14, 0x07,
+    0xd4, 0x4e, 0x4e, 0x32, 0x63, 0x9c, 0xe1, 0xaf, 0x33, 0x41, 0xe8, 0x65, 0x4b, 0x25, 0x61, 0xa4,
+    0x5f, 0x3a, 0x52, 0xee, 0x5a, 0x85, 0xf2, 0xa0, 0x8d, 0xc3, 0x69, 0x15, 0xef, 0x03, 0x37, 0xd1,
+    0x6a, 0x62, 0xbb, 0xd5, 0x58, 0xa2, 0xdc, 0x72, 0x85, 0x01, 0xa7, 0x42, 0xa0, 0x0b, 0xd6, 0x66,
+    0xde, 0x91, 0x57, 0xb1, 0x3c, 0xc7, 0x29, 0x98, 0xb9, 0x6b, 0xd4, 0xb1, 0xab, 0xa3, 0xa9, 0xb1,
+    0xe3, 0x94, 0xf0, 0x22, 0x5d, 0x16, 0xec, 0xc2, 0xa5, 0xa0, 0x16, 0xfe, 0xbe, 0x8f, 0xb2, 0xf6,
+    0x7d, 0x79, 0xc1, 0x8b, 0xbb, 0x4e, 0x75, 0x03, 0xb1, 0x7b, 0x3a, 0xc3, 0x70, 0x43, 0x91, 0x3b,
+    0xd8, 0x6c, 0xf3, 0x90, 0x0f, 0xb1, 0xb1, 0xd4, 0x1e, 0x8c, 0x27, 0xf9, 0x41, 0xd7, 0xf6, 0x6d,
+    0xc0, 0x51, 0x85, 0x3e, 0x33, 0x57, 0x28, 0x0e, 0x3a, 0xb4, 0xe2, 0x2b, 0xf1, 0x51, 0x17, 0x61,
+    0x5f, 0xb7, 0xcf, 0xd8, 0x09, 0xd2, 0x97, 0x74, 0x45, 0x36, 0xcf, 0xae, 0x76, 0xb3, 0x69, 0xed,
+    0x76, 0x20, 0xa1, 0x47, 0x81, 0xd6, 0x4a, 0x7f, 0x86, 0xe7, 0x5b, 0x4b, 0x9e, 0x86, 0xf7, 0x2c,
+    0x5e, 0x98, 0x04, 0x01, 0x8e, 0xcb, 0x4a, 0x7d, 0x86, 0x86, 0xfd, 0x24, 0xcd, 0xd6, 0xe7, 0x86,
+    0x35, 0x42, 0xbb, 0x4b, 0x92, 0xcd, 0x96, 0x6d, 0x3d, 0x4e, 0xc3, 0x19, 0x03, 0x39, 0x2e, 0xcf,
+    0x90, 0xaf, 0xf8, 0x50, 0x82, 0x3d, 0x29, 0xfd, 0x86, 0xad, 0xd6, 0xd8, 0x41, 0x91, 0x5f, 0xfc,
+    0x37, 0xa0, 0xc1, 0x9c, 0xdf, 0x8f, 0x43, 0xf1, 0x3f, 0xaa, 0xf0, 0x66, 0x5f, 0x98, 0xa9, 0x8d,
+    0x69, 0xe6, 0x67, 0x66, 0xa2, 0xd9, 0x6c, 0x36, 0xf5, 0x0e, 0xbb, 0xab, 0x72, 0xf7, 0x9a, 0x30,
+    0xc5, 0xb4, 0xb4, 0xfc, 0x08, 0xdd, 0x58, 0xf5, 0x7a, 0x8e, 0xe2, 0x31, 0xac, 0xfd, 0x1b, 0x61,
+    0x70, 0xb9, 0xb1, 0xc5, 0x77, 0xb6, 0x7e, 0xe9, 0x1b, 0xbc, 0xcb, 0x2e, 0x4c, 0x37, 0x2a, 0x22,
+    0x63, 0x35, 0xc8, 0xda, 0x36, 0x61, 0x28, 0x0b, 0x45, 0xb1, 0x44, 0xb5, 0xab, 0xd4, 0x61, 0xac,
+    0x36, 0x9b, 0x8d, 0xe7, 0x61, 0x70, 0xe4, 0x25, 0x44, 0x3f, 0x10, 0xf7, 0x7e, 0x9a, 0x24, 0x61,
+    0x48, 0xfd, 0x54, 0x69, 0x5c, 0xfa, 0x77, 0x3f, 0x15, 0x5b, 0x5c, 0x85, 0xd0, 0x23, 0x4e, 0xca,
+    0x70, 0xc8, 0xb6, 0xaa, 0xf7, 0xb9, 0x06, 0x2c, 0x7c, 0x74, 0xd3, 0x98, 0xda, 0xaa, 0xba, 0x16,
+    0x70, 0x45, 0x4a, 0x0b, 0x0c, 0xfe, 0x21, 0x34, 0x47, 0xdd, 0xcf, 0xf6, 0x20, 0xde, 0x37, 0xa3,
+    0x7c, 0xd0, 0xcb, 0xa6, 0x8d, 0x05, 0x9f, 0x2e, 0x67, 0x73, 0xe0, 0xfb, 0x62, 0xf1, 0xf8, 0x40,
+    0x7e, 0xa5, 0xa6, 0x29, 0x94, 0x9b, 0xe1, 0xb8, 0xab, 0xc5, 0x92, 0x1e, 0xc7, 0x49, 0x5d, 0x09,
+    0xf0, 0x82, 0xfe, 0x39, 0x18, 0xcb, 0xab, 0x0f, 0x6f, 0x0e, 0xd6, 0xfb, 0x8e, 0x98, 0x96, 0xa2,
+    0x5f, 0x0b, 0x8c, 0x3b, 0x80, 0x74, 0x14, 0xbe, 0x1b, 0xf8, 0x04, 0x30, 0x9f, 0x0d, 0xcf, 0xde,
+    0x41, 0x4e, 0x12, 0x1d, 0x8e, 0xc0, 0xde, 0xb2, 0x3e, 0x65, 0xe7, 0x46, 0x33, 0xc3, 0x4e, 0xaa,
+    0x69, 0xf0, 0xca, 0xa5, 0xdc, 0x1c, 0x52, 0x2c, 0x14, 0x82, 0x0c, 0xc7, 0xf1, 0x60, 0xc5, 0x8b,
+    0x4f, 0xbc, 0xe2, 0x91, 0xeb, 0x7b, 0x70, 0x5d, 0x6b, 0x6b, 0x5f, 0x92, 0xf1, 0xe6, 0x93, 0x20,
+    0x23, 0xbf, 0xa5, 0x85, 0x80, 0xe8, 0xa4, 0x69, 0x18, 0xda, 0xae, 0x28, 0x30, 0xf1, 0x4e, 0xd1,
+    0xfb, 0xae, 0x5b, 0x8c, 0xc6, 0x34, 0xfe, 0x72, 0x6e, 0xd4, 0x5e, 0xca, 0x41, 0xd0, 0xd6, 0xe0,
+    0x58, 0xea, 0xaf, 0x26, 0x08, 0x0d, 0x50, 0xf6, 0x33, 0x09, 0x7b, 0xcd, 0xbe, 0x22, 0xa3, 0x7b,
+    0x76, 0x6d, 0x77, 0xdf, 0x19, 0x6e, 0x34, 0xf2, 0x21, 0xaf, 0x5f, 0x80, 0xad, 0x1e, 0xd6, 0xf3,
+    0x39, 0x9a, 0x97, 0xc6, 0x54, 0x25, 0xee, 0x35, 0x61, 0x66, 0xf1, 0x65, 0x91, 0x19, 0xca, 0x12,
+    0x50, 0xd9, 0x90, 0xfa, 0x5c, 0x5c, 0xad, 0x39, 0x5c, 0xba, 0xed, 0x38, 0x3a, 0x6f, 0x3b, 0x03,
+    0xad, 0xb3, 0x10, 0xad, 0x5e, 0xf9, 0xc1, 0x22, 0x8c, 0x48, 0x54, 0x50, 0x5c, 0xad, 0x1c, 0xef,
+    0x74, 0x2b, 0x1b, 0xce, 0x80, 0x0a, 0x7f, 0x8f, 0x9c, 0x77, 0xde, 0xcb, 0x48, 0xcf, 0x3e, 0xf1,
+    0xc8, 0x68, 0x95, 0x48, 0xe2, 0x97, 0x71, 0x8e, 0x86, 0xa6, 0xfc, 0x7d, 0xf1, 0x1f, 0x95, 0x3c,
+    0xd7, 0x51, 0x39, 0x0d, 0x00, 0x00,
+};
+
+// dashboard.js: 7621 bytes, 2592 gzipped
+static const uint8_t WEB_ASSET_DASHBOARD_JS[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xa5, 0x19, 0xdb, 0x6e, 0x1b, 0xbb,
+    0xf1, 0xdd, 0x5f, 0xc1, 0x18, 0xa7, 0x5d, 0x09, 0x96, 0x57, 0xce, 0xb9, 0x04, 0x85, 0x64, 0x2b,
+    0x50, 0x12, 0x07, 0x71, 0xeb, 0xd8, 0xa9, 0xe5, 0x83, 0x3c, 0x18, 0x46, 0xb0, 0xda, 0xa5, 0xa4,
+    0x3d, 0x59, 0x91, 0x3a, 0x4b, 0xae, 0x1d, 0x37, 0xd1, 0x4b, 0xd1, 0x1e, 0x14, 0xfd, 0x8d, 0x3e,
+    0xb4, 0x05, 0x0a, 0x14, 0x45, 0xd1, 0x1f, 0xe8, 0x57, 0x24, 0x7f, 0xd3, 0x99, 0xe1, 0x65, 0xb9,
+    0xba, 0xf8, 0x24, 0xa8, 0x1f, 0x2c, 0x71, 0x66, 0x38, 0x33, 0x9c, 0x3b, 0xa9, 0x6e, 0x97, 0x3d,
+    0x4b, 0xd4, 0x6c, 0x2c, 0x93, 0x32, 0xeb, 0x31, 0x3d, 0xe3, 0x6c, 0x91, 0x4c, 0x39, 0xcb, 0xb5,
+    0xe2, 0xc5, 0x84, 0xe5, 0x8a, 0x29, 0x9d, 0xe8, 0x3c, 0xed, 0xd0, 0x27, 0x67, 0xa9, 0x9c, 0x73,
+    0xc5, 0x26, 0xa5, 0x9c, 0xb3, 0x6e, 0xb2, 0xc8, 0xbb, 0x4a, 0x24, 0x0b, 0x35, 0x93, 0x9a, 0x49,
+    0x91, 0xf2, 0x9d, 0x6e, 0x97, 0x25, 0x22, 0x43, 0x2e, 0xc2, 0xd0, 0x20, 0x3f, 0xa2, 0xe3, 0x37,
+    0x5c, 0x68, 0x64, 0x56, 0xf2, 0x64, 0xde, 0x61, 0xb7, 0xb3, 0x3c, 0x9d, 0xc1, 0x9e, 0xe2, 0x8e,
+    0x29, 0x2e, 0x32, 0x05, 0x80, 0x44, 0xb3, 0x74, 0x96, 0x88, 0x29, 0xcf, 0x76, 0x6e, 0x92, 0x92,
+    0x3d, 0xff, 0xfe, 0xf4, 0xf4, 0xcd, 0xc5, 0xf1, 0xf3, 0x8b, 0xe3, 0xd1, 0x0b, 0x76, 0xc4, 0x1e,
+    0x1d, 0xc0, 0x5f, 0x9f, 0xd1, 0x1f, 0x48, 0x19, 0x71, 0xad, 0x73, 0x31, 0x05, 0x86, 0x33, 0x79,
+    0x2b, 0x58, 0x2e, 0x48, 0x92, 0x4e, 0xc6, 0x05, 0x68, 0xd7, 0xe2, 0x02, 0xbf, 0x64, 0x1d, 0x76,
+    0xc9, 0x0b, 0x3e, 0x2d, 0x93, 0x79, 0x9b, 0xd4, 0x7a, 0x9d, 0xef, 0x3f, 0xcf, 0x89, 0xf9, 0xab,
+    0xf3, 0x06, 0xf3, 0xef, 0x6a, 0xde, 0xc8, 0xfc, 0x79, 0x52, 0x14, 0xe3, 0x24, 0x7d, 0x0b, 0x4a,
+    0x71, 0xc3, 0x98, 0xb4, 0xb7, 0xca, 0xa3, 0x4d, 0x2a, 0x91, 0xdc, 0x24, 0x79, 0x81, 0x52, 0x76,
+    0x88, 0xe1, 0xeb, 0x93, 0x8b, 0xe3, 0x37, 0xa7, 0xe7, 0x4f, 0x87, 0x97, 0x27, 0xe7, 0x67, 0x23,
+    0x60, 0x79, 0xb5, 0xc3, 0xd8, 0x55, 0x54, 0xe6, 0xd3, 0x99, 0x1e, 0xe5, 0x19, 0xbf, 0xc0, 0x2f,
+    0x4f, 0xe4, 0xbb, 0xa8, 0xc3, 0x22, 0xfa, 0xce, 0x10, 0xca, 0xf6, 0x99, 0x59, 0x20, 0xe6, 0xba,
+    0xd3, 0xdc, 0x72, 0xca, 0x27, 0x1b, 0x77, 0x20, 0x3c, 0xdc, 0x50, 0xc0, 0x7a, 0x55, 0x04, 0xd1,
+    0x6c, 0x93, 0xe0, 0x36, 0x04, 0x02, 0x42, 0xfa, 0x55, 0xfe, 0x5e, 0xa1, 0x67, 0x39, 0x18, 0x20,
+    0x1f, 0x57, 0x3a, 0x97, 0x62, 0x4d, 0xab, 0x06, 0x72, 0x45, 0xd0, 0xea, 0xc6, 0x50, 0x5a, 0x73,
+    0xdf, 0xce, 0x75, 0xdf, 0xd8, 0x73, 0x78, 0x3a, 0xbc, 0x78, 0xf9, 0x66, 0x74, 0x39, 0xbc, 0x3c,
+    0xae, 0xad, 0xa9, 0xaa, 0x34, 0xe5, 0x4a, 0x21, 0x8b, 0x33, 0x59, 0xce, 0x93, 0xc2, 0x09, 0xe2,
+    0x65, 0x29, 0x4b, 0x04, 0x5f, 0xce, 0x90, 0xf5, 0x33, 0xae, 0x79, 0xaa, 0x79, 0xb6, 0x86, 0x7e,
+    0x9d, 0x97, 0x9c, 0x3d, 0xad, 0x42, 0x0a, 0x2f, 0xd1, 0x84, 0xf7, 0x11, 0x7b, 0x0f, 0x5b, 0xf0,
+    0x7b, 0xa5, 0x7a, 0xec, 0x00, 0xf7, 0x27, 0x45, 0x52, 0xce, 0x7b, 0xec, 0x3d, 0x23, 0x43, 0xf4,
+    0xd8, 0x24, 0x29, 0x14, 0xef, 0x30, 0x3c, 0x9c, 0x5d, 0xb0, 0x25, 0xd2, 0x55, 0x0b, 0x9d, 0xcf,
+    0xb9, 0xdd, 0x64, 0x16, 0x43, 0xa0, 0x78, 0x06, 0x6c, 0x63, 0x21, 0x6f, 0x5b, 0x6d, 0x84, 0xff,
+    0x58, 0xf1, 0xca, 0xd1, 0xdc, 0xf0, 0x52, 0xc1, 0xa9, 0xed, 0x4a, 0xdd, 0x29, 0xcd, 0x41, 0x8e,
+    0xa8, 0x8a, 0x82, 0xc4, 0x2e, 0x92, 0x52, 0xcf, 0x31, 0x69, 0x7a, 0xec, 0x8a, 0x0e, 0x72, 0x0b,
+    0xda, 0xc3, 0xe2, 0xfd, 0x72, 0x67, 0xd9, 0x27, 0x95, 0x17, 0xb2, 0x28, 0x2e, 0x41, 0x4c, 0x09,
+    0x6a, 0xe3, 0x36, 0x38, 0xc9, 0xa4, 0x12, 0x29, 0x9a, 0x92, 0x7d, 0xd5, 0xca, 0xb3, 0x36, 0x1d,
+    0xa6, 0xe4, 0xba, 0x2a, 0x05, 0xcb, 0x64, 0x5a, 0x21, 0xbb, 0x78, 0xca, 0xf5, 0x71, 0xc1, 0xf1,
+    0xeb, 0x93, 0xbb, 0x93, 0x0c, 0xc9, 0xfa, 0x3b, 0xcb, 0x60, 0xa7, 0xe6, 0xef, 0x74, 0xeb, 0x26,
+    0x29, 0x2a, 0x6e, 0xf6, 0x93, 0x71, 0x16, 0x89, 0x00, 0x21, 0x9e, 0x47, 0x0a, 0x89, 0xa0, 0xb9,
+    0x65, 0xd3, 0x8a, 0x10, 0x1d, 0x01, 0x1b, 0x46, 0x84, 0x31, 0x72, 0x78, 0x2a, 0x85, 0xc6, 0x9c,
+    0x39, 0x62, 0xc4, 0xaa, 0x5f, 0x2b, 0x42, 0x24, 0xb9, 0x10, 0xbc, 0x7c, 0x71, 0xf9, 0xf2, 0xb4,
+    0x29, 0x7b, 0x91, 0x17, 0x45, 0x2b, 0x2d, 0x14, 0x98, 0x37, 0x19, 0xf3, 0xa2, 0x71, 0x80, 0xdd,
+    0x43, 0xd2, 0x22, 0x2d, 0x12, 0xa5, 0x8e, 0x22, 0xe3, 0x22, 0xda, 0xc0, 0x76, 0xd9, 0x1e, 0x80,
+    0x15, 0xfc, 0xdf, 0x8d, 0x06, 0xb8, 0xa0, 0xcd, 0xf0, 0x19, 0x1d, 0x76, 0x71, 0xcf, 0x20, 0x6a,
+    0x4a, 0x99, 0x60, 0xf0, 0x68, 0xb4, 0x5c, 0x4b, 0xf1, 0x54, 0x42, 0xf9, 0xa9, 0x4f, 0x9a, 0x25,
+    0x77, 0x0a, 0x94, 0x7e, 0x99, 0xe8, 0x59, 0x3c, 0x29, 0xa4, 0x2c, 0x1d, 0x09, 0xeb, 0xb2, 0x5f,
+    0x3d, 0xfa, 0xf6, 0xe0, 0x80, 0x8e, 0x89, 0x94, 0x33, 0x59, 0x95, 0x2b, 0xa4, 0x9e, 0xf6, 0x17,
+    0x96, 0x16, 0x36, 0x7d, 0xf3, 0x28, 0xd8, 0x33, 0xcf, 0x45, 0xa5, 0xf9, 0xf6, 0x5d, 0x44, 0x0c,
+    0x9b, 0x1e, 0xd5, 0x5b, 0xc0, 0xe7, 0x55, 0x81, 0x76, 0x8c, 0x22, 0x04, 0xe5, 0x13, 0xd6, 0x22,
+    0x1d, 0x07, 0x0c, 0x28, 0x2d, 0x72, 0xef, 0xc8, 0xe8, 0x0d, 0x27, 0xce, 0x98, 0x27, 0x33, 0x0a,
+    0xae, 0xd0, 0x19, 0x20, 0x10, 0xce, 0x6a, 0x42, 0xa7, 0xd5, 0x0a, 0xa9, 0x03, 0x03, 0xf1, 0xdc,
+    0x10, 0x5b, 0x4f, 0x38, 0x12, 0x16, 0x68, 0x0e, 0x1a, 0x23, 0xa1, 0x5a, 0x31, 0x35, 0x04, 0xdb,
+    0xaf, 0x47, 0xe7, 0x67, 0xad, 0xaa, 0x6c, 0x3a, 0x73, 0xc2, 0x75, 0x3a, 0x43, 0x68, 0x07, 0x12,
+    0x2b, 0x4d, 0xd2, 0x19, 0x24, 0x45, 0x24, 0xe4, 0xbe, 0xd2, 0xb2, 0xe4, 0x11, 0x5b, 0xb6, 0x63,
+    0xec, 0x21, 0x2d, 0xcf, 0xa7, 0x05, 0x32, 0x17, 0x86, 0x83, 0xd1, 0xf9, 0x01, 0x02, 0x62, 0xf9,
+    0xb6, 0x0d, 0xf5, 0xb9, 0x94, 0xb7, 0x4c, 0xf0, 0x5b, 0x76, 0x8c, 0x79, 0x8e, 0x4c, 0x51, 0x13,
+    0xe0, 0x07, 0x1f, 0x44, 0x65, 0x62, 0x85, 0x2c, 0x1a, 0x9e, 0x61, 0x11, 0xff, 0xa0, 0xa4, 0x68,
+    0x11, 0x7c, 0xb9, 0x92, 0x04, 0x8a, 0xeb, 0xef, 0x29, 0x85, 0x9b, 0x11, 0x42, 0x45, 0x22, 0x36,
+    0xc9, 0x0d, 0x2e, 0xb1, 0xb8, 0xfe, 0x0a, 0x66, 0x88, 0xee, 0xaa, 0xf3, 0x9e, 0x38, 0x43, 0x5b,
+    0xb9, 0x80, 0x46, 0xc7, 0x4b, 0xe8, 0x5a, 0x81, 0x9c, 0x92, 0x60, 0x56, 0x94, 0x91, 0xf1, 0x15,
+    0xe4, 0x13, 0xd5, 0x02, 0x03, 0x8d, 0xda, 0x2b, 0xf9, 0x14, 0x46, 0x6f, 0xa8, 0xce, 0x5e, 0x23,
+    0xa6, 0x6a, 0xf1, 0x50, 0x64, 0x9b, 0xca, 0x61, 0x80, 0x3d, 0x84, 0x8e, 0xd7, 0x5e, 0x39, 0xb3,
+    0xd1, 0x65, 0x44, 0xc6, 0x6a, 0xd5, 0x19, 0x41, 0xf5, 0x6f, 0x64, 0xab, 0x63, 0x58, 0x97, 0xaf,
+    0x0c, 0x5b, 0x63, 0xdd, 0x6b, 0xf6, 0xe1, 0x43, 0x13, 0x7b, 0x70, 0xdd, 0x37, 0xa7, 0xf1, 0x0c,
+    0x2a, 0x05, 0x87, 0xa1, 0xfc, 0x3d, 0x4b, 0xc8, 0x7e, 0x2e, 0x8b, 0xd1, 0x53, 0xb5, 0x98, 0x6d,
+    0x3b, 0x9b, 0x66, 0x08, 0xe8, 0x1f, 0xd6, 0xf4, 0xbc, 0xd4, 0xbf, 0xc5, 0x12, 0xbb, 0x46, 0x6e,
+    0x74, 0xa5, 0xf2, 0x0b, 0x65, 0x32, 0x38, 0x99, 0x6a, 0xa4, 0x96, 0x21, 0x23, 0x44, 0x4c, 0xf5,
+    0xbe, 0xed, 0xa8, 0x20, 0x21, 0x76, 0x0f, 0xb3, 0xfc, 0xc6, 0x15, 0x20, 0x02, 0xef, 0x17, 0xb9,
+    0xe0, 0xd1, 0xe0, 0x97, 0x63, 0xac, 0xbe, 0x2c, 0x68, 0x88, 0x43, 0xc4, 0xb2, 0x21, 0x18, 0xf6,
+    0x86, 0x1f, 0x76, 0x61, 0xdb, 0x60, 0x77, 0x93, 0x08, 0x6c, 0x22, 0x5f, 0x22, 0xa1, 0xee, 0x9c,
+    0x5b, 0x04, 0xa0, 0x11, 0x08, 0x46, 0x78, 0xb4, 0x9a, 0xaf, 0xb4, 0xce, 0x66, 0x8a, 0x3d, 0xb6,
+    0x72, 0x94, 0xbe, 0x2b, 0xf8, 0x51, 0x34, 0x4f, 0xca, 0x69, 0x2e, 0xf6, 0xb5, 0x5c, 0xf4, 0xd8,
+    0xc3, 0x92, 0xcf, 0xfb, 0xd1, 0xe0, 0x10, 0x9a, 0xb2, 0x14, 0xd3, 0x81, 0xe1, 0x6f, 0x84, 0xa9,
+    0x1e, 0x54, 0x53, 0x03, 0xb6, 0x02, 0x9d, 0xd7, 0x14, 0xeb, 0x59, 0x13, 0x36, 0xc3, 0x79, 0x63,
+    0x78, 0x51, 0x68, 0x43, 0x09, 0xd3, 0x89, 0x0f, 0xf7, 0xdb, 0x7c, 0x92, 0x8f, 0x54, 0x9e, 0xad,
+    0x39, 0x0d, 0xa9, 0x62, 0xc4, 0xc6, 0x0a, 0xd0, 0xf6, 0x7c, 0xe3, 0x2a, 0x2f, 0x32, 0xc8, 0xa2,
+    0xb3, 0x6a, 0x3e, 0xe6, 0xe5, 0xe6, 0x3d, 0x26, 0x81, 0xe2, 0x26, 0xa9, 0xf7, 0x3b, 0x98, 0xf4,
+    0x2d, 0xba, 0x7d, 0xf7, 0x30, 0x61, 0xb3, 0x92, 0x4f, 0x8e, 0xa2, 0x6e, 0x34, 0x78, 0x01, 0x83,
+    0xed, 0x61, 0x37, 0x19, 0xd4, 0xb0, 0xcc, 0x8d, 0xc5, 0xd1, 0xc0, 0x4f, 0xc8, 0x4d, 0x0a, 0x54,
+    0x6d, 0x1f, 0x4a, 0xc0, 0x24, 0x9f, 0x46, 0x83, 0xd7, 0xf9, 0xf3, 0xdc, 0xcf, 0xa5, 0x48, 0x47,
+    0x0e, 0x31, 0xb2, 0xf6, 0x9a, 0x7a, 0x25, 0x19, 0xd4, 0xd6, 0x11, 0x8c, 0x32, 0x60, 0x17, 0x2a,
+    0x4a, 0x8f, 0x43, 0x5d, 0x08, 0xbb, 0x0f, 0x7d, 0x8b, 0x17, 0xd1, 0x60, 0x88, 0x0b, 0xf6, 0x0a,
+    0x17, 0x56, 0xb6, 0x8d, 0x8e, 0x42, 0x82, 0xd3, 0xa2, 0xe6, 0x1e, 0x80, 0xc9, 0x4a, 0x47, 0x83,
+    0x53, 0xfa, 0x24, 0x1d, 0x88, 0x7d, 0x8f, 0xd8, 0x6f, 0xdf, 0xe8, 0xc4, 0x9c, 0x22, 0xca, 0xab,
+    0x0e, 0xb6, 0x86, 0x31, 0xf7, 0x14, 0x0f, 0xb0, 0x12, 0x47, 0x74, 0x28, 0x6f, 0x4e, 0xb4, 0x02,
+    0x00, 0x9d, 0x23, 0x31, 0xbc, 0xcd, 0x30, 0x60, 0x7a, 0x95, 0x73, 0x21, 0xd8, 0x49, 0xd0, 0xd0,
+    0xe5, 0xca, 0xb8, 0x81, 0x86, 0xe5, 0x80, 0xec, 0x69, 0x06, 0x31, 0x37, 0xeb, 0xf5, 0x6b, 0xd2,
+    0xa6, 0x9f, 0x23, 0x9a, 0xe6, 0x7b, 0xec, 0xa9, 0x63, 0xcb, 0x3e, 0xb0, 0x8b, 0xd1, 0xe8, 0xc4,
+    0xd4, 0xfd, 0x5a, 0x6c, 0x09, 0x56, 0xc6, 0x7e, 0xc0, 0xb2, 0x27, 0x73, 0xe2, 0xb6, 0x64, 0x1c,
+    0x67, 0xb6, 0xcf, 0xd0, 0xc1, 0xcc, 0x8d, 0x81, 0x06, 0xa1, 0x0d, 0x76, 0xad, 0x7c, 0x18, 0x60,
+    0xd3, 0x40, 0x85, 0x2d, 0xc1, 0xf1, 0x94, 0x3e, 0xab, 0x92, 0x7b, 0xeb, 0x2e, 0x77, 0x8c, 0x89,
+    0x27, 0x52, 0xea, 0x0d, 0x61, 0x1c, 0xbd, 0x06, 0x0d, 0x4a, 0xf6, 0x92, 0xe3, 0xff, 0xa1, 0xd0,
+    0xf9, 0xbe, 0x99, 0x6d, 0x4d, 0xfe, 0xb0, 0xff, 0xfe, 0x9d, 0x7d, 0x7d, 0xf0, 0xf5, 0x77, 0x20,
+    0xf0, 0x89, 0x8d, 0xf1, 0xfa, 0xd8, 0x5b, 0x82, 0x7f, 0x3d, 0x17, 0x87, 0x7e, 0xc4, 0x0c, 0xca,
+    0x3d, 0x34, 0xd3, 0xba, 0x24, 0xda, 0x5a, 0xe5, 0xe9, 0x62, 0x68, 0x3e, 0xc7, 0xd0, 0xad, 0x83,
+    0xc6, 0x9c, 0x2c, 0xb4, 0x73, 0xa8, 0x1b, 0xa3, 0x2b, 0x64, 0x00, 0xf0, 0x18, 0x26, 0xfb, 0xe9,
+    0x94, 0x97, 0x60, 0x98, 0xc7, 0x66, 0xb4, 0x0b, 0x26, 0x75, 0x87, 0x8a, 0xda, 0x10, 0x9e, 0x48,
+    0x6c, 0x2f, 0x6d, 0x9e, 0x34, 0x98, 0xf6, 0x8f, 0x0d, 0x8a, 0x48, 0x0d, 0x32, 0x17, 0x13, 0x89,
+    0x18, 0xb0, 0xbe, 0x45, 0xf5, 0xbd, 0x0a, 0xda, 0x5e, 0xfa, 0x40, 0x89, 0x07, 0xa4, 0x85, 0x5d,
+    0x7b, 0x1f, 0xd4, 0x32, 0x1c, 0x9b, 0x33, 0xb8, 0xc0, 0xd6, 0x68, 0xaf, 0x92, 0xdb, 0x79, 0xbc,
+    0x5d, 0x35, 0x53, 0x21, 0x3f, 0x43, 0x33, 0xb2, 0x2b, 0xd4, 0x81, 0xe8, 0x50, 0x97, 0x83, 0x43,
+    0x9d, 0x0d, 0xa8, 0xe9, 0x81, 0x10, 0x41, 0xfe, 0x31, 0xd3, 0x2a, 0x80, 0x1d, 0xca, 0x1a, 0xd2,
+    0x81, 0xa3, 0x35, 0x2e, 0x86, 0x0c, 0xed, 0x1f, 0x2b, 0xec, 0x08, 0x47, 0x47, 0x00, 0xa6, 0x9e,
+    0x15, 0x81, 0xa2, 0xd1, 0xc7, 0xbf, 0x7e, 0xfa, 0xc3, 0xc7, 0x7f, 0xc0, 0xff, 0x9f, 0x3e, 0xfe,
+    0x8d, 0xd1, 0xe2, 0x2f, 0x9f, 0xfe, 0xfc, 0xe9, 0x8f, 0x9f, 0x7e, 0x8a, 0xb0, 0x5a, 0x6f, 0xc4,
+    0x7e, 0xfc, 0xf7, 0xc7, 0x7f, 0x45, 0xed, 0xcf, 0x13, 0x39, 0x96, 0xef, 0x36, 0x4a, 0xfc, 0x0f,
+    0x70, 0xfc, 0xe7, 0xa7, 0x3f, 0x7d, 0xfa, 0xfd, 0x16, 0x99, 0xeb, 0xf8, 0xcf, 0x94, 0x4a, 0xd7,
+    0x12, 0x94, 0xbc, 0x90, 0x2a, 0xc7, 0xd0, 0x6b, 0xaf, 0x99, 0xcc, 0x3b, 0xde, 0x23, 0xba, 0x60,
+    0xeb, 0xc8, 0xcd, 0x77, 0xa6, 0x3b, 0xba, 0x58, 0xbe, 0x00, 0x01, 0x2b, 0x65, 0x0d, 0x65, 0x6e,
+    0xca, 0x13, 0xbc, 0x36, 0x6e, 0x4d, 0x91, 0xe6, 0xcd, 0x7f, 0x43, 0x82, 0x14, 0x32, 0x4d, 0x8c,
+    0xbe, 0x75, 0x96, 0xe0, 0x55, 0xce, 0x0f, 0x25, 0x74, 0xaf, 0xbb, 0x72, 0x64, 0x30, 0xfd, 0x5c,
+    0xf7, 0xeb, 0x31, 0x17, 0x91, 0x6d, 0x3b, 0xb4, 0x36, 0x2d, 0xb3, 0x6b, 0x03, 0xc9, 0xd7, 0x75,
+    0xbc, 0xf4, 0xd8, 0xfb, 0x8f, 0xe3, 0xf5, 0xf0, 0xfa, 0xe7, 0xbd, 0x89, 0x12, 0xe2, 0x14, 0x2e,
+    0xc5, 0x6b, 0x39, 0xda, 0xb8, 0x29, 0xd7, 0x11, 0x1e, 0x44, 0xff, 0xf9, 0x6f, 0xa2, 0x76, 0xfb,
+    0x33, 0x45, 0xfc, 0x9f, 0xf9, 0xdd, 0xbe, 0xcf, 0xab, 0x28, 0xe0, 0x3e, 0x87, 0xe2, 0xa3, 0x0e,
+    0x0c, 0x50, 0xf6, 0x92, 0xef, 0x5f, 0xa6, 0xfc, 0xe3, 0xd5, 0xf0, 0xd5, 0x49, 0x87, 0x49, 0xc1,
+    0xc1, 0xd0, 0x30, 0x22, 0x2a, 0x8d, 0x43, 0x36, 0x3e, 0xfa, 0x94, 0x77, 0x7a, 0xd6, 0x1c, 0xd8,
+    0x0b, 0x99, 0x64, 0x43, 0xd0, 0xd0, 0x78, 0x13, 0xf8, 0x0e, 0xd9, 0x37, 0x07, 0xdf, 0xb2, 0x96,
+    0x90, 0x44, 0xe9, 0x9e, 0xb0, 0x98, 0xca, 0x45, 0xca, 0x19, 0x5c, 0xb6, 0xdc, 0x35, 0xbf, 0x0d,
+    0xb7, 0x52, 0xbc, 0x2a, 0xd9, 0xa7, 0x2a, 0x70, 0x50, 0x3a, 0xb3, 0xf1, 0x84, 0x37, 0x16, 0x30,
+    0x57, 0xe3, 0x3d, 0x8d, 0xec, 0x66, 0xe2, 0xc3, 0x32, 0xc0, 0x14, 0x7b, 0x4c, 0x6c, 0x8f, 0x5c,
+    0x7d, 0xa8, 0x71, 0x38, 0x80, 0x91, 0x31, 0xc2, 0x0b, 0xd7, 0xea, 0x1d, 0xaa, 0x1e, 0xba, 0x56,
+    0x6a, 0xb5, 0x69, 0x1b, 0xb4, 0x32, 0x2e, 0x6c, 0x32, 0xb7, 0x04, 0x76, 0x19, 0x52, 0x34, 0x39,
+    0x98, 0x99, 0x76, 0x9d, 0x4f, 0x30, 0x4e, 0x37, 0x49, 0xfd, 0xd3, 0x92, 0xa9, 0xa2, 0xeb, 0x7b,
+    0x70, 0x3e, 0x6e, 0x6e, 0x71, 0x6f, 0x4a, 0xeb, 0x3b, 0x68, 0xb6, 0xb7, 0x49, 0x55, 0x29, 0x5f,
+    0xbb, 0x0d, 0x7c, 0x94, 0xff, 0xae, 0xc9, 0xde, 0xb7, 0x34, 0xcf, 0xde, 0x43, 0x42, 0x3a, 0xca,
+    0xcd, 0x7a, 0x12, 0x85, 0x85, 0xc5, 0xd6, 0xf7, 0x43, 0x23, 0xce, 0x36, 0x5d, 0x73, 0xc7, 0xf2,
+    0x57, 0xcd, 0x60, 0xe2, 0x5d, 0xb9, 0x84, 0x86, 0x57, 0xad, 0x10, 0x16, 0xf6, 0xe4, 0x10, 0x6e,
+    0x6b, 0x90, 0x89, 0xfa, 0x98, 0xa2, 0x27, 0xf0, 0x2c, 0x78, 0x75, 0xe9, 0xef, 0x99, 0xcf, 0x78,
+    0xa1, 0x13, 0x55, 0x47, 0x79, 0xf8, 0x78, 0x19, 0xbe, 0x82, 0xe4, 0x22, 0xf3, 0xd2, 0x5a, 0xa6,
+    0x0b, 0x99, 0xe8, 0xc0, 0xe0, 0x6f, 0x61, 0x80, 0xe0, 0x58, 0x77, 0xd0, 0x87, 0x8f, 0xc3, 0xf5,
+    0x49, 0xa0, 0xe0, 0x62, 0xaa, 0x67, 0x80, 0xdc, 0xdb, 0x0b, 0xef, 0xe5, 0xab, 0x74, 0x57, 0xf9,
+    0xb5, 0xeb, 0x70, 0xd8, 0x2e, 0x9c, 0x18, 0xf7, 0x16, 0xb4, 0x4e, 0x6d, 0x66, 0x23, 0x7f, 0x4f,
+    0x37, 0xef, 0x5a, 0x61, 0x4d, 0x96, 0xe2, 0x05, 0x2f, 0x0a, 0x19, 0x44, 0xf3, 0xa6, 0x58, 0xac,
+    0xa3, 0x30, 0x88, 0xa7, 0x46, 0x28, 0xd5, 0x38, 0x17, 0x39, 0x84, 0xb3, 0x57, 0xc4, 0xd0, 0xc5,
+    0x04, 0x0f, 0x3c, 0xfb, 0x65, 0x53, 0x51, 0x73, 0x10, 0xb2, 0x52, 0x3c, 0x00, 0xea, 0x55, 0xc6,
+    0xdf, 0x9d, 0x4f, 0x5a, 0xf5, 0x28, 0xd0, 0x66, 0x0f, 0xc0, 0x52, 0xfb, 0x0f, 0xeb, 0x0a, 0x77,
+    0x3e, 0xfe, 0x01, 0x8a, 0x70, 0xfc, 0x96, 0xdf, 0xa9, 0x56, 0x1d, 0x89, 0xed, 0x0d, 0x72, 0x05,
+    0x4c, 0xb1, 0xeb, 0xee, 0x30, 0x1d, 0x06, 0x71, 0xd7, 0x6d, 0xb6, 0x06, 0xa2, 0xe2, 0x1f, 0x86,
+    0xb8, 0x01, 0xd7, 0xe2, 0xd7, 0xa3, 0x75, 0x73, 0xac, 0xae, 0x44, 0x6a, 0xe8, 0xb4, 0x22, 0x87,
+    0x24, 0x10, 0xb6, 0x6a, 0xda, 0xc6, 0x26, 0x32, 0x79, 0x1b, 0x1f, 0x63, 0x70, 0x8e, 0xa0, 0x4e,
+    0xa6, 0x5e, 0xef, 0xf0, 0x59, 0x13, 0x9c, 0x70, 0x02, 0x23, 0x71, 0x79, 0x93, 0x14, 0x2d, 0x5b,
+    0x7a, 0x3b, 0x8d, 0xd7, 0xfb, 0xc6, 0xab, 0x8e, 0x9f, 0xab, 0xa9, 0xba, 0x11, 0x53, 0x7c, 0x1a,
+    0xc5, 0xa7, 0xa1, 0x5a, 0x4c, 0x2b, 0x0a, 0x7e, 0x90, 0x88, 0xea, 0xe7, 0x3c, 0xa8, 0xce, 0x05,
+    0xa7, 0x17, 0x3d, 0xa3, 0xc6, 0x0c, 0xa3, 0xac, 0xe7, 0xc2, 0xad, 0x63, 0xd3, 0x5e, 0x28, 0x59,
+    0xf6, 0xd8, 0xe6, 0x9a, 0x6a, 0x5f, 0x15, 0x16, 0xf4, 0x4a, 0xd3, 0xc8, 0x2e, 0x5b, 0x61, 0xb4,
+    0xd5, 0xd6, 0x98, 0x80, 0x62, 0xe4, 0xfe, 0xe8, 0x70, 0xe4, 0xdb, 0x6a, 0xc3, 0xd2, 0xa8, 0x65,
+    0x9f, 0xa8, 0xb7, 0x69, 0x15, 0x64, 0xc0, 0x95, 0x49, 0x0e, 0x28, 0xa0, 0xd7, 0x3e, 0x19, 0x82,
+    0x4a, 0xba, 0xb9, 0x32, 0x59, 0x29, 0x18, 0x1b, 0xdb, 0x85, 0xac, 0x46, 0x9b, 0x0f, 0xa7, 0x95,
+    0x90, 0xab, 0xe1, 0x61, 0xdc, 0xc1, 0xd7, 0xa6, 0x06, 0x41, 0xbd, 0xf3, 0x0a, 0xb8, 0x67, 0xf9,
+    0xfb, 0xcf, 0xb9, 0xbd, 0xab, 0xdd, 0x7b, 0x3a, 0xfb, 0x32, 0x7f, 0x3f, 0xef, 0x46, 0xa5, 0x50,
+    0xbe, 0xa7, 0xdc, 0xcb, 0x78, 0xc6, 0xc1, 0x6b, 0x63, 0x9e, 0xe8, 0x7b, 0x98, 0x6f, 0x2d, 0x35,
+    0xa6, 0x16, 0x2e, 0xe9, 0xae, 0x1d, 0x56, 0x01, 0x17, 0xad, 0x3f, 0x57, 0x03, 0x4c, 0x12, 0xc4,
+    0x49, 0x96, 0x51, 0x06, 0x9c, 0x52, 0x1a, 0xf2, 0x92, 0x68, 0x3a, 0x81, 0x3e, 0x94, 0x0d, 0xb5,
+    0x42, 0x8e, 0xbd, 0xa9, 0x04, 0x2d, 0x9c, 0x28, 0x62, 0x08, 0x3e, 0xc5, 0x0d, 0x61, 0x4c, 0xea,
+    0x3b, 0x05, 0xfd, 0x03, 0xaa, 0x19, 0x88, 0xe0, 0x9e, 0xca, 0xc6, 0x38, 0x79, 0x71, 0x7c, 0xbc,
+    0xb6, 0x77, 0x63, 0xc5, 0xc6, 0x77, 0xf6, 0x37, 0xc5, 0x0e, 0x25, 0x38, 0xcd, 0x4a, 0x12, 0x47,
+    0x0a, 0xf3, 0xcb, 0x1d, 0xbe, 0x60, 0xc2, 0x68, 0x34, 0xe6, 0xfa, 0x96, 0x73, 0x7c, 0x14, 0xb1,
+    0x9a, 0x4b, 0x21, 0x17, 0x1c, 0x47, 0x90, 0x46, 0xb3, 0xf3, 0xf5, 0xcd, 0xd7, 0x8a, 0x36, 0x8c,
+    0xc1, 0x60, 0x68, 0x5f, 0x2c, 0x6a, 0x44, 0x7f, 0xad, 0xa8, 0x98, 0x9e, 0x42, 0x66, 0x0d, 0xe4,
+    0xd0, 0xd8, 0xbb, 0x55, 0xd0, 0x83, 0x40, 0xd2, 0x97, 0x17, 0xa8, 0x25, 0x55, 0x43, 0x3f, 0x3b,
+    0xf6, 0x77, 0x5c, 0x3d, 0xec, 0xef, 0x84, 0x0c, 0xc2, 0xe7, 0xb3, 0x8e, 0x79, 0xa3, 0x6d, 0x12,
+    0x78, 0x09, 0xe1, 0xaf, 0xa3, 0x40, 0xf3, 0x3f, 0x34, 0xf3, 0x8a, 0x2f, 0xc5, 0x1d, 0x00, 0x00,
+};
+
+// dashboard.html: 1766 bytes, 696 gzipped
+static const uint8_t WEB_ASSET_DASHBOARD_HTML[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x55, 0x5d, 0x6f, 0xd3, 0x30,
+    0x14, 0x7d, 0xdf, 0xaf, 0x30, 0xe6, 0x95, 0x2e, 0xeb, 0xd6, 0x4d, 0x80, 0x12, 0xa3, 0x8e, 0x31,
+    0x81, 0xd4, 0x8d, 0x41, 0x37, 0x4d, 0x3c, 0x3a, 0xf6, 0x6d, 0x63, 0x70, 0xe2, 0xca, 0x76, 0x5b,
+    0xfa, 0xef, 0xb9, 0xb6, 0x93, 0xb4, 0x9d, 0xaa, 0x69, 0x93, 0x78, 0x68, 0x9d, 0x7b, 0xef, 0xf1,
+    0xb9, 0x1f, 0x76, 0x4e, 0xf2, 0x37, 0x57, 0xdf, 0x3f, 0xdf, 0xff, 0xba, 0xfb, 0x42, 0x2a, 0x5f,
+    0x6b, 0x76, 0x94, 0x77, 0x0b, 0x70, 0x89, 0x4b, 0x0d, 0x9e, 0x13, 0x51, 0x71, 0xeb, 0xc0, 0x17,
+    0xf4, 0xe1, 0xfe, 0x7a, 0xf0, 0x9e, 0x76, 0xee, 0x86, 0xd7, 0x50, 0xd0, 0x95, 0x82, 0xf5, 0xc2,
+    0x58, 0x4f, 0x89, 0x30, 0x8d, 0x87, 0x06, 0x61, 0x6b, 0x25, 0x7d, 0x55, 0x48, 0x58, 0x29, 0x01,
+    0x83, 0x68, 0xbc, 0x23, 0xaa, 0x51, 0x5e, 0x71, 0x3d, 0x70, 0x82, 0x6b, 0x28, 0x86, 0xc7, 0x27,
+    0x81, 0xc6, 0x2b, 0xaf, 0x81, 0x5d, 0x71, 0x57, 0x95, 0x86, 0x5b, 0x49, 0x06, 0xe4, 0x91, 0x7b,
+    0xb0, 0xe4, 0x06, 0xc2, 0xff, 0x14, 0xc4, 0xd2, 0x2a, 0xbf, 0xc9, 0xb3, 0x84, 0x3b, 0xca, 0xb5,
+    0x6a, 0xfe, 0x10, 0x0b, 0xba, 0xa0, 0xce, 0x6f, 0x34, 0xb8, 0x0a, 0x00, 0xf3, 0x56, 0x16, 0x66,
+    0x05, 0xcd, 0xb8, 0xc3, 0x1a, 0x5d, 0x16, 0x23, 0xc7, 0xc2, 0xb9, 0x4f, 0xab, 0x62, 0xc6, 0x3f,
+    0x8c, 0xe4, 0x50, 0x5e, 0xc8, 0x11, 0x17, 0x20, 0xca, 0xd3, 0x90, 0x33, 0x6b, 0x3b, 0x2b, 0x8d,
+    0xdc, 0xe0, 0x22, 0xd5, 0x8a, 0x08, 0x8d, 0x7b, 0x0b, 0xda, 0xf0, 0x15, 0x02, 0x08, 0x89, 0x3e,
+    0x25, 0xa3, 0x63, 0x82, 0x19, 0x5d, 0xf4, 0xa2, 0x9f, 0x77, 0xa9, 0x28, 0xfb, 0x6a, 0x6a, 0xc8,
+    0x33, 0xce, 0xb6, 0x3e, 0xd9, 0x75, 0x41, 0xb7, 0x0d, 0xed, 0x23, 0xd6, 0x6a, 0xa6, 0x06, 0x38,
+    0xa4, 0x99, 0x9a, 0x53, 0xf6, 0xa8, 0xae, 0x15, 0x76, 0xe8, 0xbd, 0x6a, 0xe6, 0xae, 0xc5, 0xb5,
+    0x75, 0x68, 0x33, 0x57, 0xcd, 0xb6, 0x2d, 0x59, 0xa3, 0xc5, 0xc6, 0x61, 0x21, 0x93, 0x10, 0x0a,
+    0xe8, 0x50, 0x66, 0x86, 0x75, 0xee, 0xd5, 0x1b, 0x12, 0x4c, 0x3d, 0x4e, 0x90, 0x76, 0x54, 0x31,
+    0xa5, 0x8b, 0x2e, 0xd6, 0xe2, 0xbb, 0x65, 0xa7, 0xf1, 0x70, 0x70, 0x5c, 0x35, 0x60, 0x53, 0xfb,
+    0xd5, 0x90, 0x1d, 0x3a, 0x06, 0x32, 0xdd, 0x38, 0x0f, 0x35, 0x0e, 0x70, 0xc8, 0x8e, 0xba, 0xb4,
+    0x1d, 0x43, 0xec, 0x3b, 0x4d, 0xa9, 0x3a, 0x65, 0x09, 0x49, 0x42, 0x2d, 0x4b, 0x6c, 0x0e, 0x3d,
+    0x29, 0xd4, 0x15, 0xca, 0x35, 0xb7, 0x75, 0x8a, 0xf6, 0xa5, 0xba, 0x68, 0x12, 0xb7, 0x14, 0x02,
+    0x1c, 0x8e, 0xfc, 0xd6, 0xd8, 0x9a, 0xeb, 0xbe, 0xc9, 0xfd, 0x7c, 0xed, 0xdd, 0x52, 0xcd, 0xcc,
+    0xb4, 0x69, 0x53, 0x9c, 0xe5, 0xce, 0x5b, 0xd3, 0xcc, 0xbb, 0x0a, 0x1e, 0x16, 0x5e, 0xd5, 0xf0,
+    0x31, 0xcf, 0x5a, 0x37, 0xc9, 0xdd, 0x82, 0x37, 0xb1, 0x06, 0x17, 0x11, 0x09, 0x40, 0xd9, 0x00,
+    0x21, 0x18, 0x61, 0x3b, 0xf9, 0x9e, 0x30, 0xa6, 0x03, 0x9b, 0x7e, 0xbb, 0x3a, 0xc8, 0x16, 0x47,
+    0xef, 0x94, 0x7c, 0x09, 0xd3, 0xe5, 0x52, 0x69, 0x89, 0xc7, 0x4e, 0x6e, 0x97, 0x75, 0x09, 0xf6,
+    0x20, 0x5f, 0xd9, 0x62, 0x12, 0xe4, 0x25, 0xac, 0x63, 0x0d, 0xd6, 0x93, 0x1f, 0x4b, 0x58, 0x1e,
+    0xee, 0x97, 0x87, 0x78, 0x0c, 0x3f, 0xc3, 0x96, 0x90, 0xc2, 0xab, 0x15, 0x8c, 0xc3, 0x19, 0x39,
+    0xba, 0x8b, 0xd9, 0xde, 0xb8, 0xf4, 0xf0, 0xfc, 0x25, 0x18, 0x2f, 0xb8, 0xf5, 0x35, 0x0a, 0x82,
+    0x3b, 0x7c, 0x11, 0xda, 0x5d, 0x9e, 0x97, 0x1a, 0x55, 0xc2, 0xf2, 0xc5, 0xf6, 0x24, 0xa3, 0xaf,
+    0xb3, 0x82, 0x1d, 0xdf, 0xd9, 0xdc, 0x5b, 0xfc, 0x55, 0x48, 0xec, 0xc9, 0x5b, 0x14, 0x85, 0x2a,
+    0x5a, 0x1d, 0x77, 0x67, 0x2a, 0x09, 0xbd, 0x71, 0x69, 0xfe, 0xf6, 0xcf, 0x77, 0xc6, 0xa1, 0x02,
+    0x99, 0xa6, 0x77, 0xdc, 0x83, 0x86, 0xb9, 0xe5, 0x75, 0x72, 0x64, 0x81, 0x3c, 0x4b, 0x89, 0x76,
+    0x12, 0x07, 0x95, 0x48, 0x43, 0xe9, 0xba, 0xf9, 0x69, 0xd6, 0x71, 0x2a, 0x3e, 0x09, 0x48, 0x0b,
+    0xcc, 0x76, 0x4a, 0x7e, 0xdd, 0x98, 0x1e, 0x95, 0x85, 0xff, 0x3b, 0xa0, 0x5e, 0x47, 0x78, 0x09,
+    0x9a, 0xb2, 0x89, 0x11, 0x7c, 0xaf, 0xf1, 0x27, 0x13, 0xbb, 0x31, 0x28, 0xcd, 0xc6, 0xe2, 0x65,
+    0x7b, 0xd9, 0x24, 0xd6, 0x58, 0xf0, 0xeb, 0x87, 0xb0, 0x2b, 0x3b, 0x81, 0x65, 0x66, 0x0c, 0x8a,
+    0x4b, 0xff, 0xf6, 0xb7, 0x66, 0x2f, 0x52, 0x4e, 0x58, 0x85, 0xc7, 0xec, 0xac, 0xd8, 0x2a, 0x7b,
+    0xaf, 0xb0, 0xc7, 0xbf, 0x83, 0xb8, 0xf3, 0xb3, 0x13, 0x71, 0x36, 0x82, 0xf3, 0xe1, 0xd9, 0xc5,
+    0xe8, 0xf4, 0x7c, 0x28, 0xc3, 0xe6, 0xb4, 0x2d, 0x64, 0x6b, 0xe5, 0x3d, 0x4b, 0x9f, 0xb3, 0x7f,
+    0x16, 0xc1, 0x84, 0x29, 0xe6, 0x06, 0x00, 0x00,
+};
+
+#define WEB_ASSET_STYLE_CSS_URL "/assets/style.css?v=fa94d1d6d4acecb2"
+#define WEB_ASSET_DASHBOARD_JS_URL "/assets/dashboard.js?v=a30c34e51364251d"
+
+static const WebAsset WEB_ASSETS[] = {
+    {"/assets/style.css", "text/css", WEB_ASSET_STYLE_CSS, sizeof(WEB_ASSET_STYLE_CSS), "\"fa94d1d6d4acecb2\"", true},
+    {"/assets/dashboard.js", "application/javascript", WEB_ASSET_DASHBOARD_JS, sizeof(WEB_ASSET_DASHBOARD_JS), "\"a30c34e51364251d\"", true},
+    {"/dashboard", "text/html", WEB_ASSET_DASHBOARD_HTML, sizeof(WEB_ASSET_DASHBOARD_HTML), "\"acfa02f47fe45276\"", false},
+};
+#define WEB_ASSET_COUNT (sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]))
+
+#endif // WEB_ASSETS_H
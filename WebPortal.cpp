@@ -1,14 +1,16 @@
 #include "WebPortal.h"
 #include <Preferences.h>
+#include "ConfigStore.h"
+#include <nvs.h>
 #include <ESPmDNS.h>
-
-// CSS Style definition
-const char *WEB_STYLE = R"(
-    <style> :root { --primary: #4361ee; --secondary: #3a0ca3; --light: #f8f9fa; --dark: #212529; --success: #4bb543; --danger: #ff3333; --warning: #ffaa00; } * { box-sizing: border-box; } body { font-family: 'Segoe UI', Tahoma, Geneva, Verdana, sans-serif; background: linear-gradient(135deg, var(--primary), var(--secondary)); margin: 0; padding: 0; min-height: 100vh; color: var(--light); } .container { max-width: 600px; margin: 0 auto; padding: 2rem; } .card { background: rgba(255, 255, 255, 0.95); border-radius: 10px; padding: 2rem; box-shadow: 0 10px 30px rgba(0, 0, 0, 0.1); color: var(--dark); margin-bottom: 2rem; } h1 { color: white; text-align: center; margin-bottom: 1.5rem; } h2 { color: var(--secondary); margin-top: 0; } .form-group { margin-bottom: 1.5rem; } label { display: block; margin-bottom: 0.5rem; font-weight: 600; } input, select { width: 100%; padding: 0.75rem; border: 1px solid #ddd; border-radius: 4px; font-size: 1rem; } button { background: var(--primary); color: white; border: none; padding: 1rem; border-radius: 4px; cursor: pointer; font-size: 1rem; width: 100%; transition: all 0.3s; font-weight: 600; margin-top: 0.5rem; } button:hover { background: var(--secondary); transform: translateY(-2px); } button.warning { background: var(--warning); } button.warning:hover { background: #e69500; } .status { padding: 1rem; border-radius: 4px; margin: 1rem 0; text-align: center; } .success { background-color: rgba(75, 181, 67, 0.2); color: var(--success); } .error { background-color: rgba(255, 51, 51, 0.2); color: var(--danger); } .info { background-color: rgba(0, 123, 255, 0.2); color: #0069d9; } .hidden { display: none; } .network-list { margin: 1rem 0; } .network-item { padding: 0.75rem; border: 1px solid #ddd; border-radius: 4px; margin-bottom: 0.5rem; cursor: pointer; transition: all 0.2s; } .network-item:hover { background-color: #f5f5f5; } .network-item.active { border-color: var(--primary); background-color: rgba(67, 97, 238, 0.1); } .signal-strength { float: right; color: #666; } .device-info { background-color: rgba(0, 0, 0, 0.05); padding: 1rem; border-radius: 4px; margin-bottom: 1rem; } .password-container { position: relative; } .password-toggle { position: absolute; right: 10px; top: 50%; transform: translateY(-50%); cursor: pointer; } </style>
-    )";
+#include "JsonWriter.h"
+#include "CborWriter.h"
+#include "DeferredLog.h"
+#include <esp_crc.h>
+#include "WebAssets.h"
 
 // Initialize static variables
-WebServer WebPortal::_server(WEB_SERVER_PORT);
+HttpServer WebPortal::_server(WEB_SERVER_PORT);
 String WebPortal::_adminPassword = "admin123";     // Default admin password
 String WebPortal::_wiFiConfigPassword = "user123"; // Default empty WiFi config password
 Session WebPortal::_adminSession = {"", AuthLevel::ADMIN, 0};
@@ -23,6 +25,12 @@ void (*WebPortal::_onAdminLoginCallback)() = nullptr;
 void (*WebPortal::_onAdminLogoutCallback)() = nullptr;
 void (*WebPortal::_onWiFiConfigStartCallback)() = nullptr;
 void (*WebPortal::_onWiFiConfigSaveCallback)() = nullptr;
+uint8_t *WebPortal::_importBuffer = nullptr;
+size_t WebPortal::_importSize = 0;
+bool WebPortal::_importTooLarge = false;
+uint32_t WebPortal::_restartTime = 0;
+uint32_t WebPortal::_stateVersion = 0;
+uint32_t WebPortal::_stateHash = 0;
 
 // Constants
 const char *WebPortal::PREFERENCE_NAMESPACE = "webPortal";
@@ -41,20 +49,29 @@ bool WebPortal::begin()
 
     _startTime = millis();
 
+    // Random start, so a version from before a reboot can't match a new one
+    _stateVersion = esp_random() >> 8;
+
     // Load stored settings
-    Preferences prefs;
-    if (prefs.begin(PREFERENCE_NAMESPACE, true))
-    {
-        _adminPassword = prefs.getString(ADMIN_PASSWORD_KEY, "admin123");
-        _wiFiConfigPassword = prefs.getString(WIFI_CONFIG_PASSWORD_KEY, "user123");
-        prefs.end();
-    }
+    loadConfiguration();
 
     // Set up server routes
     setupRoutes();
 
-    // Start the server
-    _server.begin();
+    // Dashboards on the event stream are dropped when their connection closes
+    _server.onClose(EventStream::removeClient);
+    EventStream::onActivity([](int socket)
+                            { _server.markActive(socket); });
+
+    // Web requests are the first thing shed when the heap runs low
+    _server.onAdmit(admitRequest);
+
+    // Start the server, requests are served from its own task
+    if (!_server.begin())
+    {
+        setError("Failed to start the HTTP server");
+        return false;
+    }
     _initialized = true;
 
     // Set up mDNS responder
@@ -91,19 +108,33 @@ void WebPortal::update()
         return;
     }
 
-    // Handle client requests
-    handleClient();
-
     // Check for expired sessions
     checkSessionTimeouts();
+
+    // An imported configuration is loaded by the subsystems on the next boot
+    if (_restartTime != 0 && millis() - _restartTime >= CONFIG_IMPORT_RESTART_DELAY)
+    {
+        Serial.println("Restarting to apply the imported configuration...");
+        DeferredLog::flush();
+        ESP.restart();
+    }
+}
+
+/**
+ * Take the lock shared with the request handlers
+ * The main loop holds it while updating, handlers never see a half-updated state
+ */
+void WebPortal::lock()
+{
+    _server.lock();
 }
 
 /**
- * Handle client requests
+ * Release the lock shared with the request handlers
  */
-void WebPortal::handleClient()
+void WebPortal::unlock()
 {
-    _server.handleClient();
+    _server.unlock();
 }
 
 /**
@@ -127,17 +158,10 @@ String WebPortal::getLastError()
  */
 void WebPortal::setAdminPassword(const String &password)
 {
-    if (password.length() >= 6)
+    if (password.length() >= 6 && password.length() < WEB_PASSWORD_SIZE)
     {
         _adminPassword = password;
-
-        // Save to preferences
-        Preferences prefs;
-        if (prefs.begin(PREFERENCE_NAMESPACE, false))
-        {
-            prefs.putString(ADMIN_PASSWORD_KEY, password);
-            prefs.end();
-        }
+        saveConfiguration();
     }
 }
 
@@ -162,15 +186,13 @@ bool WebPortal::verifyAdminPassword(const String &password)
  */
 void WebPortal::setWiFiConfigPassword(const String &password)
 {
-    _wiFiConfigPassword = password;
-
-    // Save to preferences
-    Preferences prefs;
-    if (prefs.begin(PREFERENCE_NAMESPACE, false))
+    if (password.length() >= WEB_PASSWORD_SIZE)
     {
-        prefs.putString(WIFI_CONFIG_PASSWORD_KEY, password);
-        prefs.end();
+        return;
     }
+
+    _wiFiConfigPassword = password;
+    saveConfiguration();
 }
 
 /**
@@ -194,6 +216,70 @@ bool WebPortal::verifyWiFiConfigPassword(const String &password)
     return password == _wiFiConfigPassword;
 }
 
+/**
+ * Load the passwords, migrating the legacy per-field keys on first boot
+ */
+void WebPortal::loadConfiguration()
+{
+    StoredConfig config;
+    memset(&config, 0, sizeof(config));
+    strcpy(config.adminPassword, _adminPassword.c_str());
+    strcpy(config.wiFiConfigPassword, _wiFiConfigPassword.c_str());
+
+    ConfigLoadResult result = ConfigStore::load(PREFERENCE_NAMESPACE, CONFIG_VERSION, &config, sizeof(config));
+    bool migrated = false;
+    if (result == ConfigLoadResult::MISSING)
+    {
+        Preferences prefs;
+        if (prefs.begin(PREFERENCE_NAMESPACE, true))
+        {
+            if (prefs.isKey(ADMIN_PASSWORD_KEY))
+            {
+                prefs.getString(ADMIN_PASSWORD_KEY, config.adminPassword, sizeof(config.adminPassword));
+                migrated = true;
+            }
+            if (prefs.isKey(WIFI_CONFIG_PASSWORD_KEY))
+            {
+                prefs.getString(WIFI_CONFIG_PASSWORD_KEY, config.wiFiConfigPassword, sizeof(config.wiFiConfigPassword));
+                migrated = true;
+            }
+            prefs.end();
+        }
+    }
+    else if (result == ConfigLoadResult::CORRUPT)
+    {
+        // Keep the defaults so the admin can still log in and save again
+        _lastError = ConfigStore::getLastError();
+        return;
+    }
+
+    config.adminPassword[WEB_PASSWORD_SIZE - 1] = '\0';
+    config.wiFiConfigPassword[WEB_PASSWORD_SIZE - 1] = '\0';
+    _adminPassword = config.adminPassword;
+    _wiFiConfigPassword = config.wiFiConfigPassword;
+
+    const char *legacyKeys[] = {ADMIN_PASSWORD_KEY, WIFI_CONFIG_PASSWORD_KEY};
+    ConfigStore::finishLoad(PREFERENCE_NAMESPACE, result, migrated, saveConfiguration, legacyKeys, 2);
+}
+
+/**
+ * Save the passwords as one blob
+ */
+bool WebPortal::saveConfiguration()
+{
+    StoredConfig config;
+    memset(&config, 0, sizeof(config));
+    strcpy(config.adminPassword, _adminPassword.c_str());
+    strcpy(config.wiFiConfigPassword, _wiFiConfigPassword.c_str());
+
+    if (!ConfigStore::save(PREFERENCE_NAMESPACE, CONFIG_VERSION, &config, sizeof(config)))
+    {
+        _lastError = ConfigStore::getLastError();
+        return false;
+    }
+    return true;
+}
+
 /**
  * Set the building number
  */
@@ -273,118 +359,478 @@ void WebPortal::checkSessionTimeouts()
 }
 
 /**
- * Get system status in JSON format
+ * Capture everything the status API reports in one pass
  */
-String WebPortal::getSystemStatusJSON()
+void WebPortal::captureSnapshot(SystemSnapshot &snapshot)
 {
-    String json = "{";
+    snapshot.timestamp = millis();
+
+    // WiFi
+    snapshot.wifiConnected = WiFiManager::isConnected();
+    memset(snapshot.ssid, 0, sizeof(snapshot.ssid));
+    memset(snapshot.ipAddress, 0, sizeof(snapshot.ipAddress));
+    snapshot.rssi = 0;
+    if (snapshot.wifiConnected)
+    {
+        strncpy(snapshot.ssid, WiFi.SSID().c_str(), sizeof(snapshot.ssid) - 1);
+        IPAddress ip = WiFi.localIP();
+        snprintf(snapshot.ipAddress, sizeof(snapshot.ipAddress), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+        snapshot.rssi = WiFiManager::getRSSI();
+    }
+    snapshot.wifiStats = WiFiManager::getStats();
 
+    // Alarm
+    snapshot.status = alarmSystem.getStatus();
+    snapshot.alarmActive[RIGHT_SIDE] = alarmSystem.isAlarmActive(RIGHT_SIDE);
+    snapshot.alarmActive[LEFT_SIDE] = alarmSystem.isAlarmActive(LEFT_SIDE);
+    snapshot.alarmUptime = alarmSystem.getUptime();
+    snapshot.lastAlarmTime = alarmSystem.getLastAlarmTime();
+    snapshot.wires = alarmSystem.getWireCutStatus();
+    snapshot.alarmStats = alarmSystem.getStats();
+    for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
+    {
+        uint8_t aptNumber = i + 1;
+        ApartmentSnapshot &apartment = snapshot.apartments[i];
+        apartment.enabled = alarmSystem.isSensorEnabled(aptNumber);
+        apartment.triggered = alarmSystem.isSensorTriggered(aptNumber);
+        apartment.telegramConfigured = telegramHandler.isApartmentConfigured(aptNumber);
+        apartment.telegramEnabled = telegramHandler.isApartmentEnabled(aptNumber);
+    }
+
+    // Telegram
+    snapshot.queueSize = telegramHandler.getQueueSize();
+    snapshot.queueHighWater = telegramHandler.getQueueHighWater();
+    memset(snapshot.apiBaseUrl, 0, sizeof(snapshot.apiBaseUrl));
+    strncpy(snapshot.apiBaseUrl, telegramHandler.getApiBaseUrl().c_str(), sizeof(snapshot.apiBaseUrl) - 1);
+    snapshot.telegramStats = telegramHandler.getStats();
+
+    // Settings Storage
+    nvs_stats_t nvsStats = {};
+    nvs_get_stats(NULL, &nvsStats);
+    snapshot.config = ConfigStore::getStats();
+    snapshot.corruptConfigs = ConfigStore::getCorruptCount();
+    snapshot.nvsUsedEntries = nvsStats.used_entries;
+    snapshot.nvsFreeEntries = nvsStats.free_entries;
+    snapshot.recordCount = 0;
+    while (snapshot.recordCount < MAX_CONFIG_RECORDS &&
+           ConfigStore::getRecordInfo(snapshot.recordCount, snapshot.records[snapshot.recordCount]))
+    {
+        snapshot.recordCount++;
+    }
+
+    // Web
+    snapshot.events = EventStream::getStats();
+    snapshot.http = _server.getStats();
+    snapshot.largestPage = HtmlStream::getLargestPage();
+    snapshot.adminSession = isAdminLoggedIn();
+
+    // System
+    snapshot.buildingNumber = getBuildingNumber();
+    snapshot.freeHeap = ESP.getFreeHeap();
+    snapshot.minFreeHeap = ESP.getMinFreeHeap();
+    snapshot.largestFreeBlock = ESP.getMaxAllocHeap();
+    snapshot.memory = MemoryBudget::getStats();
+    snapshot.logDropped = DeferredLog::getDropped();
+    snapshot.bus = EventBus::getStats();
+    for (uint8_t i = 0; i < (uint8_t)BusEventType::COUNT; i++)
+    {
+        snapshot.busEvents[i] = Metrics::getEventCount((BusEventType)i);
+    }
+    snapshot.busDelay = Metrics::getEventDelayHistogram();
+    snapshot.cpuFreqMHz = ESP.getCpuFreqMHz();
+    snapshot.loop = Metrics::getLoopHistogram();
+#ifdef LOOP_PROFILING
+    for (uint8_t i = 0; i < (uint8_t)LoopSection::COUNT; i++)
+    {
+        snapshot.profile[i] = LoopProfiler::getStats((LoopSection)i);
+    }
+#endif
+
+    // Version over the state; counters, uptimes and the time since the last
+    // alarm move on their own (a new alarm changes the flags anyway)
+    uint8_t flags[TOTAL_APARTMENTS + 4];
+    for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
+    {
+        const ApartmentSnapshot &apartment = snapshot.apartments[i];
+        flags[i] = apartment.enabled | apartment.triggered << 1 | apartment.telegramConfigured << 2 |
+                   apartment.telegramEnabled << 3;
+    }
+    const WireCutStatus &wires = snapshot.wires;
+    flags[TOTAL_APARTMENTS] = wires.rightSideRightBox | wires.rightSideLeftBox << 1 | wires.leftSideRightBox << 2 |
+                              wires.leftSideLeftBox << 3 | wires.rightSideDistribution << 4 | wires.leftSideDistribution << 5;
+    flags[TOTAL_APARTMENTS + 1] = wires.rightSideRightBoxEnabled | wires.rightSideLeftBoxEnabled << 1 |
+                                  wires.leftSideRightBoxEnabled << 2 | wires.leftSideLeftBoxEnabled << 3 |
+                                  wires.rightSideDistributionEnabled << 4 | wires.leftSideDistributionEnabled << 5;
+    flags[TOTAL_APARTMENTS + 2] = snapshot.wifiConnected | snapshot.alarmActive[RIGHT_SIDE] << 1 |
+                                  snapshot.alarmActive[LEFT_SIDE] << 2 | snapshot.adminSession << 3 |
+                                  (snapshot.config.pending > 0) << 4;
+    flags[TOTAL_APARTMENTS + 3] = static_cast<uint8_t>(snapshot.status) | static_cast<uint8_t>(snapshot.memory.level) << 4;
+
+    uint32_t hash = esp_crc32_le(0, flags, sizeof(flags));
+    hash = esp_crc32_le(hash, (const uint8_t *)snapshot.ssid, strlen(snapshot.ssid));
+    hash = esp_crc32_le(hash, (const uint8_t *)snapshot.ipAddress, strlen(snapshot.ipAddress));
+    hash = esp_crc32_le(hash, (const uint8_t *)snapshot.apiBaseUrl, strlen(snapshot.apiBaseUrl));
+    hash = esp_crc32_le(hash, &snapshot.queueSize, sizeof(snapshot.queueSize));
+    hash = esp_crc32_le(hash, &snapshot.buildingNumber, sizeof(snapshot.buildingNumber));
+    hash = esp_crc32_le(hash, (const uint8_t *)&snapshot.config.commits, sizeof(snapshot.config.commits));
+    if (hash != _stateHash)
+    {
+        _stateHash = hash;
+        _stateVersion++;
+    }
+    snapshot.version = _stateVersion;
+}
+
+/**
+ * Write system status members into the current object
+ */
+void WebPortal::writeSystemStatus(DocumentWriter &json, const SystemSnapshot &snapshot)
+{
     // WiFi Status
-    json += "\"wifi\":{";
-    json += "\"connected\":" + String(WiFiManager::isConnected() ? "true" : "false") + ",";
-    json += "\"ssid\":\"" + WiFiManager::getCurrentSSID() + "\",";
-    json += "\"rssi\":" + String(WiFiManager::getRSSI()) + ",";
-    json += "\"ipAddress\":\"" + WiFiManager::getLocalIP() + "\",";
-    json += "\"uptime\":" + String(WiFiManager::getUptime() / 1000) + "";
-    json += "},";
-
-    // Alarm Status
-    json += "\"alarm\":{";
-    json += "\"status\":\"" + String(static_cast<int>(alarmSystem.getStatus())) + "\",";
-    json += "\"rightSideActive\":" + String(alarmSystem.isAlarmActive(RIGHT_SIDE) ? "true" : "false") + ",";
-    json += "\"leftSideActive\":" + String(alarmSystem.isAlarmActive(LEFT_SIDE) ? "true" : "false") + ",";
-    json += "\"uptime\":" + String(alarmSystem.getUptime() / 1000) + ",";
-    json += "\"lastAlarm\":" + String(alarmSystem.getLastAlarmTime() / 1000) + "";
-    json += "},";
+    json.beginObject("wifi");
+    json.field("connected", snapshot.wifiConnected);
+    json.field("ssid", snapshot.ssid);
+    json.field("rssi", (long)snapshot.rssi);
+    json.field("ipAddress", snapshot.ipAddress);
+    json.field("uptime", (unsigned long)(snapshot.timestamp / 1000));
+    json.endObject();
+
+    // Alarm Status (status is reported as a string here, as a number in /api/alarm-status)
+    char status[4];
+    snprintf(status, sizeof(status), "%d", static_cast<int>(snapshot.status));
+    json.beginObject("alarm");
+    json.field("status", status);
+    json.field("rightSideActive", snapshot.alarmActive[RIGHT_SIDE]);
+    json.field("leftSideActive", snapshot.alarmActive[LEFT_SIDE]);
+    json.field("uptime", (unsigned long)(snapshot.alarmUptime / 1000));
+    json.field("lastAlarm", (unsigned long)(snapshot.lastAlarmTime / 1000));
+    json.endObject();
+
+    // Telegram Queue Status
+    json.beginObject("telegram");
+    json.field("queueSize", snapshot.queueSize);
+    json.field("queueHighWater", snapshot.queueHighWater);
+    json.field("apiBaseUrl", snapshot.apiBaseUrl);
+    json.endObject();
+
+    // Settings Storage (flash writes since boot, lifetime writes per namespace)
+    json.beginObject("config");
+    json.field("pending", snapshot.config.pending);
+    json.field("commits", (unsigned long)snapshot.config.commits);
+    json.field("writes", (unsigned long)snapshot.config.writes);
+    json.field("bytesWritten", (unsigned long)snapshot.config.bytesWritten);
+    json.field("unchanged", (unsigned long)snapshot.config.unchanged);
+    json.field("coalesced", (unsigned long)snapshot.config.coalesced);
+    json.field("corrupt", snapshot.corruptConfigs);
+    json.field("nvsUsedEntries", (unsigned long)snapshot.nvsUsedEntries);
+    json.field("nvsFreeEntries", (unsigned long)snapshot.nvsFreeEntries);
+    json.beginArray("records");
+    for (uint8_t i = 0; i < snapshot.recordCount; i++)
+    {
+        json.beginObject();
+        json.field("namespace", snapshot.records[i].ns);
+        json.field("writes", (unsigned long)snapshot.records[i].writeCount);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+
+    // Live Event Stream
+    json.beginObject("events");
+    json.field("clients", snapshot.events.clients);
+    json.field("connects", (unsigned long)snapshot.events.connects);
+    json.field("events", (unsigned long)snapshot.events.events);
+    json.field("bytesSent", (unsigned long)snapshot.events.bytesSent);
+    json.field("dropped", (unsigned long)snapshot.events.dropped);
+    json.endObject();
+
+    // HTTP Server
+    json.beginObject("http");
+    json.field("connections", snapshot.http.connections);
+    json.field("requests", (unsigned long)snapshot.http.requests);
+    json.field("rejected", (unsigned long)snapshot.http.rejected);
+    json.field("timeouts", (unsigned long)snapshot.http.timeouts);
+    json.endObject();
+
+    // Event Bus
+    json.beginObject("eventBus");
+    json.field("published", (unsigned long)snapshot.bus.published);
+    json.field("dispatched", (unsigned long)snapshot.bus.dispatched);
+    json.field("dropped", (unsigned long)snapshot.bus.dropped);
+    json.field("direct", (unsigned long)snapshot.bus.direct);
+    json.field("queueHighWater", snapshot.bus.queueHighWater);
+    json.field("subscribers", snapshot.bus.subscribers);
+    json.endObject();
 
     // General System Status
-    json += "\"system\":{";
-    json += "\"buildingNumber\":" + String(getBuildingNumber()) + ",";
-    json += "\"freeHeap\":" + String(ESP.getFreeHeap()) + ",";
-    json += "\"cpuFreqMHz\":" + String(ESP.getCpuFreqMHz()) + ",";
-    json += "\"uptime\":" + String(millis() / 1000) + "";
-    json += "}";
+    json.beginObject("system");
+    json.field("buildingNumber", snapshot.buildingNumber);
+    json.field("adminSession", snapshot.adminSession);
+    json.field("freeHeap", (unsigned long)snapshot.freeHeap);
+    json.field("largestPage", (unsigned long)snapshot.largestPage);
+    json.field("cpuFreqMHz", (unsigned long)snapshot.cpuFreqMHz);
+    json.field("uptime", (unsigned long)(snapshot.timestamp / 1000));
+    json.endObject();
+
+    // Memory Budget (clients in priority order, the lowest ones are shed first)
+    const MemoryBudgetStats &memory = snapshot.memory;
+    json.beginObject("memory");
+    json.field("level", MemoryBudget::getLevelName(memory.level));
+    json.field("freeHeap", (unsigned long)memory.freeHeap);
+    json.field("largestBlock", (unsigned long)memory.largestBlock);
+    json.field("minFreeHeap", (unsigned long)memory.minFreeHeap);
+    json.field("minLargestBlock", (unsigned long)memory.minLargestBlock);
+    json.field("levelChanges", (unsigned long)memory.levelChanges);
+    json.field("criticalFor", (unsigned long)(memory.criticalMillis / 1000));
+    json.beginArray("clients");
+    for (uint8_t i = 0; i < (uint8_t)MemoryClient::COUNT; i++)
+    {
+        MemoryClient client = (MemoryClient)i;
+        json.beginObject();
+        json.field("name", MemoryBudget::getClientName(client));
+        json.field("reserve", (unsigned long)MemoryBudget::getReserve(client));
+        json.field("block", (unsigned long)MemoryBudget::getBlock(client));
+        json.field("admitted", i < (uint8_t)MemoryClient::COUNT - (uint8_t)memory.level);
+        json.field("shed", (unsigned long)memory.shed[i]);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
+
+/**
+ * Write the apartments array into the current object
+ */
+void WebPortal::writeApartmentStatus(DocumentWriter &json, const SystemSnapshot &snapshot)
+{
+    json.beginArray("apartments");
+
+    for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
+    {
+        uint8_t aptNumber = i + 1;
+        const ApartmentSnapshot &apartment = snapshot.apartments[i];
+
+        // One lookup for the whole location instead of one per field
+        uint8_t locationIndex = getApartmentIndex(aptNumber);
+        const ApartmentLocation *location = locationIndex < TOTAL_APARTMENTS ? &APARTMENT_LOCATIONS[locationIndex] : nullptr;
+
+        json.beginObject();
+        json.field("number", aptNumber);
+        json.field("side", location == nullptr || location->side == RIGHT_SIDE ? "right" : "left");
+        json.field("box", location == nullptr || location->box == RIGHT_BOX ? "right" : "left");
+        json.field("position", location != nullptr ? location->position.c_str() : "Unknown");
+        json.field("enabled", (bool)apartment.enabled);
+        json.field("telegramConfigured", (bool)apartment.telegramConfigured);
+        json.field("telegramEnabled", (bool)apartment.telegramEnabled);
+        json.field("triggered", (bool)apartment.triggered);
+        json.endObject();
+    }
 
-    json += "}";
-    return json;
+    json.endArray();
 }
 
 /**
- * Get apartment status in JSON format
+ * Write one member per wire into the current object
  */
-String WebPortal::getApartmentStatusJSON()
+void WebPortal::writeWireStatus(DocumentWriter &json, const SystemSnapshot &snapshot)
 {
-    String json = "{\"apartments\":[";
-
-    bool firstItem = true;
-    for (int i = 0; i < TOTAL_APARTMENTS; i++)
+    const WireCutStatus &status = snapshot.wires;
+    const struct
     {
-        uint8_t aptNumber = i + 1;
-
-        if (!firstItem)
-        {
-            json += ",";
-        }
+        const char *name;
+        bool cut;
+        bool enabled;
+    } wires[] = {
+        {"rightSideRightBox", status.rightSideRightBox, status.rightSideRightBoxEnabled},
+        {"rightSideLeftBox", status.rightSideLeftBox, status.rightSideLeftBoxEnabled},
+        {"leftSideRightBox", status.leftSideRightBox, status.leftSideRightBoxEnabled},
+        {"leftSideLeftBox", status.leftSideLeftBox, status.leftSideLeftBoxEnabled},
+        {"rightSideDistribution", status.rightSideDistribution, status.rightSideDistributionEnabled},
+        {"leftSideDistribution", status.leftSideDistribution, status.leftSideDistributionEnabled}};
 
-        json += "{";
-        json += "\"number\":" + String(aptNumber) + ",";
-        json += "\"enabled\":" + String(alarmSystem.isSensorEnabled(aptNumber) ? "true" : "false") + ",";
-        json += "\"telegramConfigured\":" + String(telegramHandler.isApartmentConfigured(aptNumber) ? "true" : "false") + ",";
-        json += "\"telegramEnabled\":" + String(telegramHandler.isApartmentEnabled(aptNumber) ? "true" : "false") + ",";
-        json += "\"triggered\":" + String(alarmSystem.isSensorTriggered(aptNumber) ? "true" : "false") + "";
-        json += "}";
-
-        firstItem = false;
+    for (const auto &wire : wires)
+    {
+        json.beginObject(wire.name);
+        json.field("cut", wire.cut);
+        json.field("enabled", wire.enabled);
+        json.endObject();
     }
-
-    json += "]}";
-    return json;
 }
 
 /**
- * Get wire status in JSON format
+ * Write alarm status members into the current object
  */
-String WebPortal::getWireStatusJSON()
+void WebPortal::writeAlarmStatus(DocumentWriter &json, const SystemSnapshot &snapshot)
 {
-    WireCutStatus status = alarmSystem.getWireCutStatus();
-    String json = "{";
-
-    json += "\"rightSideRightBox\":{\"cut\":" + String(status.rightSideRightBox ? "true" : "false") +
-            ",\"enabled\":" + String(status.rightSideRightBoxEnabled ? "true" : "false") + "},";
-
-    json += "\"rightSideLeftBox\":{\"cut\":" + String(status.rightSideLeftBox ? "true" : "false") +
-            ",\"enabled\":" + String(status.rightSideLeftBoxEnabled ? "true" : "false") + "},";
-
-    json += "\"leftSideRightBox\":{\"cut\":" + String(status.leftSideRightBox ? "true" : "false") +
-            ",\"enabled\":" + String(status.leftSideRightBoxEnabled ? "true" : "false") + "},";
-
-    json += "\"leftSideLeftBox\":{\"cut\":" + String(status.leftSideLeftBox ? "true" : "false") +
-            ",\"enabled\":" + String(status.leftSideLeftBoxEnabled ? "true" : "false") + "},";
-
-    json += "\"rightSideDistribution\":{\"cut\":" + String(status.rightSideDistribution ? "true" : "false") +
-            ",\"enabled\":" + String(status.rightSideDistributionEnabled ? "true" : "false") + "},";
-
-    json += "\"leftSideDistribution\":{\"cut\":" + String(status.leftSideDistribution ? "true" : "false") +
-            ",\"enabled\":" + String(status.leftSideDistributionEnabled ? "true" : "false") + "}";
-
-    json += "}";
-    return json;
+    json.field("status", static_cast<int>(snapshot.status));
+    json.field("rightSideActive", snapshot.alarmActive[RIGHT_SIDE]);
+    json.field("leftSideActive", snapshot.alarmActive[LEFT_SIDE]);
+    json.field("lastAlarmTime", (unsigned long)(snapshot.lastAlarmTime / 1000));
 }
 
 /**
- * Get alarm status in JSON format
+ * Write the Prometheus metrics served by /metrics
  */
-String WebPortal::getAlarmStatusJSON()
+void WebPortal::writeMetrics(MetricsWriter &metrics, const SystemSnapshot &snapshot)
 {
-    String json = "{";
+    static const char *const SIDE_LABELS[2] = {"side=\"right\"", "side=\"left\""};
+    static const char *const CLASS_LABELS[4] = {"class=\"2xx\"", "class=\"3xx\"", "class=\"4xx\"", "class=\"5xx\""};
+    char labels[48];
 
-    json += "\"status\":" + String(static_cast<int>(alarmSystem.getStatus())) + ",";
-    json += "\"rightSideActive\":" + String(alarmSystem.isAlarmActive(RIGHT_SIDE) ? "true" : "false") + ",";
-    json += "\"leftSideActive\":" + String(alarmSystem.isAlarmActive(LEFT_SIDE) ? "true" : "false") + ",";
-    json += "\"lastAlarmTime\":" + String(alarmSystem.getLastAlarmTime() / 1000) + "";
+    // Main loop and sensor scanning
+    metrics.histogram("watermeter_loop_duration_seconds", "Main loop iteration time.", snapshot.loop);
+#ifdef LOOP_PROFILING
+    metrics.family("watermeter_loop_section_duration_seconds", "histogram", "Main loop time per section.");
+    for (uint8_t i = 0; i < (uint8_t)LoopSection::COUNT; i++)
+    {
+        snprintf(labels, sizeof(labels), "section=\"%s\"", LoopProfiler::getSectionName((LoopSection)i));
+        metrics.histogramSamples("watermeter_loop_section_duration_seconds", labels, snapshot.profile[i].histogram);
+    }
+    metrics.family("watermeter_loop_section_over_budget_total", "counter", "Loop section calls over their budget.");
+    for (uint8_t i = 0; i < (uint8_t)LoopSection::COUNT; i++)
+    {
+        snprintf(labels, sizeof(labels), "section=\"%s\"", LoopProfiler::getSectionName((LoopSection)i));
+        metrics.sample("watermeter_loop_section_over_budget_total", labels, snapshot.profile[i].overBudget);
+    }
+#endif
+    metrics.family("watermeter_side_scans_total", "counter", "Completed sensor scan windows per building side.");
+    for (uint8_t side = 0; side < 2; side++)
+    {
+        metrics.sample("watermeter_side_scans_total", SIDE_LABELS[side], snapshot.alarmStats.sideScans[side]);
+    }
+    metrics.family("watermeter_sensor_reads_total", "counter", "Sensor reads per building side.");
+    for (uint8_t side = 0; side < 2; side++)
+    {
+        metrics.sample("watermeter_sensor_reads_total", SIDE_LABELS[side], snapshot.alarmStats.sensorReads[side]);
+    }
+    metrics.family("watermeter_sensor_triggers_total", "counter", "Theft triggers per apartment.");
+    for (uint8_t i = 0; i < TOTAL_APARTMENTS; i++)
+    {
+        snprintf(labels, sizeof(labels), "apartment=\"%u\"", i + 1);
+        metrics.sample("watermeter_sensor_triggers_total", labels, snapshot.alarmStats.triggers[i]);
+    }
+    metrics.family("watermeter_wire_cuts_total", "counter", "Box and distribution wire cuts detected.");
+    metrics.sample("watermeter_wire_cuts_total", nullptr, snapshot.alarmStats.wireCuts);
+    metrics.family("watermeter_alarm_active", "gauge", "Siren running per building side.");
+    for (uint8_t side = 0; side < 2; side++)
+    {
+        metrics.sample("watermeter_alarm_active", SIDE_LABELS[side], snapshot.alarmActive[side]);
+    }
+    metrics.family("watermeter_alarm_status", "gauge", "0 normal, 1 theft detected, 2 wire cut detected.");
+    metrics.sample("watermeter_alarm_status", nullptr, static_cast<int>(snapshot.status));
 
-    json += "}";
-    return json;
+    // Telegram queue
+    const TelegramStats &telegram = snapshot.telegramStats;
+    metrics.family("watermeter_telegram_queue_depth", "gauge", "Messages waiting in the Telegram queue.");
+    metrics.sample("watermeter_telegram_queue_depth", nullptr, snapshot.queueSize);
+    metrics.family("watermeter_telegram_queue_high_water", "gauge", "Largest Telegram queue depth since boot.");
+    metrics.sample("watermeter_telegram_queue_high_water", nullptr, snapshot.queueHighWater);
+    metrics.family("watermeter_telegram_sent_total", "counter", "Telegram messages delivered.");
+    metrics.sample("watermeter_telegram_sent_total", nullptr, telegram.sent);
+    metrics.family("watermeter_telegram_failures_total", "counter", "Telegram send attempts that did not deliver.");
+    metrics.sample("watermeter_telegram_failures_total", nullptr, telegram.failed);
+    metrics.family("watermeter_telegram_retries_total", "counter", "Failed Telegram sends scheduled again.");
+    metrics.sample("watermeter_telegram_retries_total", nullptr, telegram.retries);
+    metrics.family("watermeter_telegram_rate_limited_total", "counter", "Telegram sends answered with 429.");
+    metrics.sample("watermeter_telegram_rate_limited_total", nullptr, telegram.rateLimited);
+    metrics.family("watermeter_telegram_dropped_total", "counter", "Telegram messages given up on.");
+    metrics.sample("watermeter_telegram_dropped_total", nullptr, telegram.dropped);
+    metrics.histogram("watermeter_telegram_send_duration_seconds", "Telegram send attempt time, connect to response.",
+                      telegram.latency);
+
+    // Heap
+    metrics.family("watermeter_heap_free_bytes", "gauge", "Free heap.");
+    metrics.sample("watermeter_heap_free_bytes", nullptr, snapshot.freeHeap);
+    metrics.family("watermeter_heap_min_free_bytes", "gauge", "Lowest free heap since boot.");
+    metrics.sample("watermeter_heap_min_free_bytes", nullptr, snapshot.minFreeHeap);
+    metrics.family("watermeter_heap_largest_free_block_bytes", "gauge", "Largest block that can be allocated.");
+    metrics.sample("watermeter_heap_largest_free_block_bytes", nullptr, snapshot.largestFreeBlock);
+    metrics.family("watermeter_heap_fragmentation_ratio", "gauge", "Share of the free heap outside the largest block.");
+    metrics.sampleRatio("watermeter_heap_fragmentation_ratio", nullptr,
+                        snapshot.freeHeap > snapshot.largestFreeBlock ? snapshot.freeHeap - snapshot.largestFreeBlock : 0,
+                        snapshot.freeHeap);
+    metrics.family("watermeter_memory_level", "gauge", "0 normal, 1 web shed, 2 informational alerts shed, 3 critical.");
+    metrics.sample("watermeter_memory_level", nullptr, static_cast<int>(snapshot.memory.level));
+    metrics.family("watermeter_memory_min_largest_block_bytes", "gauge", "Smallest largest free block seen since boot.");
+    metrics.sample("watermeter_memory_min_largest_block_bytes", nullptr, snapshot.memory.minLargestBlock);
+    metrics.family("watermeter_memory_shed_total", "counter", "Requests refused by the memory budget.");
+    for (uint8_t i = 0; i < (uint8_t)MemoryClient::COUNT; i++)
+    {
+        snprintf(labels, sizeof(labels), "client=\"%s\"", MemoryBudget::getClientName((MemoryClient)i));
+        metrics.sample("watermeter_memory_shed_total", labels, snapshot.memory.shed[i]);
+    }
+
+    // Event bus
+    metrics.family("watermeter_bus_events_total", "counter", "Events dispatched on the internal event bus.");
+    for (uint8_t i = 0; i < (uint8_t)BusEventType::COUNT; i++)
+    {
+        snprintf(labels, sizeof(labels), "type=\"%s\"", EventBus::getEventName((BusEventType)i));
+        metrics.sample("watermeter_bus_events_total", labels, snapshot.busEvents[i]);
+    }
+    metrics.family("watermeter_bus_dropped_total", "counter", "Events lost because the event bus queue was full.");
+    metrics.sample("watermeter_bus_dropped_total", nullptr, snapshot.bus.dropped);
+    metrics.family("watermeter_bus_direct_total", "counter", "Alarm events dispatched at once because the event bus queue was full.");
+    metrics.sample("watermeter_bus_direct_total", nullptr, snapshot.bus.direct);
+    metrics.histogram("watermeter_bus_dispatch_delay_seconds", "Time from publishing an event to its dispatch.",
+                      snapshot.busDelay);
+
+    // Log
+    metrics.family("watermeter_log_dropped_total", "counter", "Log messages dropped because the log queue was full.");
+    metrics.sample("watermeter_log_dropped_total", nullptr, snapshot.logDropped);
+
+    // WiFi
+    metrics.family("watermeter_wifi_connected", "gauge", "Station connected with an IP address.");
+    metrics.sample("watermeter_wifi_connected", nullptr, snapshot.wifiConnected);
+    metrics.family("watermeter_wifi_rssi_dbm", "gauge", "Signal strength, 0 while disconnected.");
+    metrics.sample("watermeter_wifi_rssi_dbm", nullptr, snapshot.rssi);
+    metrics.family("watermeter_wifi_connects_total", "counter", "Connections established.");
+    metrics.sample("watermeter_wifi_connects_total", nullptr, snapshot.wifiStats.connects);
+    metrics.family("watermeter_wifi_disconnects_total", "counter", "Established connections lost.");
+    metrics.sample("watermeter_wifi_disconnects_total", nullptr, snapshot.wifiStats.disconnects);
+    metrics.family("watermeter_wifi_reconnect_attempts_total", "counter", "Reconnection attempts.");
+    metrics.sample("watermeter_wifi_reconnect_attempts_total", nullptr, snapshot.wifiStats.reconnectAttempts);
+
+    // Web server
+    metrics.family("watermeter_http_requests_total", "counter", "HTTP requests received.");
+    metrics.sample("watermeter_http_requests_total", nullptr, snapshot.http.requests);
+    metrics.family("watermeter_http_responses_total", "counter", "HTTP responses by status class.");
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        metrics.sample("watermeter_http_responses_total", CLASS_LABELS[i], snapshot.http.responses[i]);
+    }
+    metrics.family("watermeter_http_rejected_total", "counter", "Request bodies over the size limits.");
+    metrics.sample("watermeter_http_rejected_total", nullptr, snapshot.http.rejected);
+    metrics.family("watermeter_http_timeouts_total", "counter", "Clients that stalled mid-request or ran past the request deadline.");
+    metrics.sample("watermeter_http_timeouts_total", nullptr, snapshot.http.timeouts);
+    metrics.family("watermeter_http_connections", "gauge", "Open HTTP connections.");
+    metrics.sample("watermeter_http_connections", nullptr, snapshot.http.connections);
+    metrics.family("watermeter_event_clients", "gauge", "Dashboards on the live event stream.");
+    metrics.sample("watermeter_event_clients", nullptr, snapshot.events.clients);
+    metrics.histogram("watermeter_http_request_duration_seconds", "HTTP request time, received to handler done.",
+                      snapshot.http.latency);
+
+    // System
+    metrics.family("watermeter_uptime_seconds", "gauge", "Time since boot.");
+    metrics.sample("watermeter_uptime_seconds", nullptr, snapshot.timestamp / 1000);
+}
+
+/**
+ * Write the combined document served by /api/snapshot
+ * Same members as the four status endpoints, from one capture
+ */
+void WebPortal::writeSnapshot(DocumentWriter &json, const SystemSnapshot &snapshot)
+{
+    json.field("version", (unsigned long)snapshot.version);
+    json.beginObject("status");
+    writeSystemStatus(json, snapshot);
+    json.endObject();
+    writeApartmentStatus(json, snapshot);
+    json.beginObject("wires");
+    writeWireStatus(json, snapshot);
+    json.endObject();
+    json.beginObject("alarm");
+    writeAlarmStatus(json, snapshot);
+    json.endObject();
 }
 
 /**
@@ -451,8 +897,13 @@ void WebPortal::setupRoutes()
     // Main routes
     _server.on(ROUTE_ROOT, HTTP_GET, []()
                { WebPortal::handleRoot(); });
-    _server.on(ROUTE_DASHBOARD, HTTP_GET, []()
-               { WebPortal::handleDashboard(); });
+
+    // Static pages, stylesheets and scripts (the dashboard is one of them), served without the lock
+    for (size_t i = 0; i < WEB_ASSET_COUNT; i++)
+    {
+        _server.onUnlocked(WEB_ASSETS[i].route, HTTP_GET, [i]()
+                           { WebPortal::serveAsset(WEB_ASSETS[i]); });
+    }
     _server.on(ROUTE_WIFI_CONFIG, HTTP_GET, []()
                { WebPortal::handleWiFiConfigPage(); });
     _server.on(ROUTE_WIFI_CONFIG, HTTP_POST, []()
@@ -475,6 +926,22 @@ void WebPortal::setupRoutes()
                { WebPortal::handleAPIWireStatus(); });
     _server.on(ROUTE_API_ALARM_STATUS, HTTP_GET, []()
                { WebPortal::handleAPIAlarmStatus(); });
+    _server.on(ROUTE_API_EVENTS, HTTP_GET, []()
+               { WebPortal::handleAPIEvents(); });
+    _server.on(ROUTE_API_SNAPSHOT, HTTP_GET, []()
+               { WebPortal::handleAPISnapshot(); });
+    _server.on(ROUTE_METRICS, HTTP_GET, []()
+               { WebPortal::handleMetrics(); });
+#ifdef LOOP_PROFILING
+    _server.on(ROUTE_API_PROFILE, HTTP_GET, []()
+               { WebPortal::handleAPIProfile(); });
+    _server.on(ROUTE_API_PROFILE, HTTP_POST, []()
+               { WebPortal::handleAPIProfile(); });
+#endif
+#ifdef ALERT_LOAD_TEST
+    _server.on(ROUTE_API_TEST_TRIGGER, HTTP_POST, []()
+               { WebPortal::handleAPITestTrigger(); });
+#endif
 
     // Admin configuration pages
     _server.on(ROUTE_ADMIN_TELEGRAM_CONFIG, HTTP_GET, []()
@@ -499,12 +966,43 @@ void WebPortal::setupRoutes()
                { WebPortal::handleSaveAdvancedConfig(); });
     _server.on(ROUTE_ADMIN_APARTMENT_TOGGLE, HTTP_POST, []()
                { WebPortal::handleToggleApartment(); });
+    _server.on(ROUTE_ADMIN_CONFIG_EXPORT, HTTP_GET, []()
+               { WebPortal::handleConfigExport(); });
+    _server.on(ROUTE_ADMIN_CONFIG_IMPORT, HTTP_POST, []()
+               { WebPortal::handleConfigImport(); }, []()
+               { WebPortal::handleConfigUpload(); });
 
     // Handle not found
     _server.onNotFound([]()
                        { WebPortal::handleNotFound(); });
 }
 
+/**
+ * Serve a gzip-compressed asset from flash, or 304 when the client's copy is current
+ */
+void WebPortal::serveAsset(const WebAsset &asset)
+{
+    if (strcmp(asset.contentType, HTML_CONTENT_TYPE) == 0)
+    {
+        _pageRequests++;
+        updateLastActivity();
+    }
+
+    // Pages keep their URL across firmware updates, so they are always revalidated
+    _server.sendHeader("ETag", asset.etag);
+    _server.sendHeader("Cache-Control", asset.versioned ? WEB_ASSET_CACHE_VERSIONED : WEB_ASSET_CACHE_PAGE);
+
+    if (_server.header("If-None-Match") == asset.etag)
+    {
+        _server.send(304);
+        return;
+    }
+
+    // Every browser accepts gzip, the blob is sent as stored
+    _server.sendHeader("Content-Encoding", "gzip");
+    _server.send_P(200, asset.contentType, (PGM_P)asset.data, asset.length);
+}
+
 /**
  * Serve static content
  */
@@ -664,88 +1162,99 @@ void WebPortal::updateLastActivity()
 }
 
 /**
- * Get HTML header with title
+ * Admission check, runs in the server task before the request body is read
  */
-String WebPortal::getHTMLHeader(const String &title, bool includeRefresh)
+bool WebPortal::admitRequest()
 {
-    String header = "<!DOCTYPE html><html><head>";
-    header += "<meta charset='UTF-8'>";
-    header += "<meta name='viewport' content='width=device-width, initial-scale=1.0'>";
-    header += "<title>" + title + " - Water Meter Security</title>";
+    // Monitoring stays reachable, both stream their answer without building it in memory
+    String uri = _server.uri();
+    if (uri == ROUTE_METRICS || uri == ROUTE_API_STATUS)
+    {
+        return true;
+    }
+    return MemoryBudget::admit(MemoryClient::WEB);
+}
+
+/**
+ * Write HTML header with title
+ */
+void WebPortal::writeHTMLHeader(HtmlStream &html, const String &title, bool includeRefresh)
+{
+    html += "<!DOCTYPE html><html><head>";
+    html += "<meta charset='UTF-8'>";
+    html += "<meta name='viewport' content='width=device-width, initial-scale=1.0'>";
+    html += "<title>" + title + " - Water Meter Security</title>";
 
     // Include auto-refresh if needed
     if (includeRefresh)
     {
-        header += "<meta http-equiv='refresh' content='30'>";
+        html += "<meta http-equiv='refresh' content='30'>";
     }
 
-    // Include common CSS
-    header += WEB_STYLE;
+    // Common CSS, cached by the browser
+    html += "<link rel='stylesheet' href='" + String(WEB_ASSET_STYLE_CSS_URL) + "'>";
 
-    header += "</head><body>";
-    return header;
+    html += "</head><body>";
 }
 
 /**
- * Get HTML footer
+ * Write HTML footer
  */
-String WebPortal::getHTMLFooter()
+void WebPortal::writeHTMLFooter(HtmlStream &html)
 {
-    String footer = "<div style='margin-top: 2rem; text-align: center; font-size: 0.8rem; color: #ddd;'>";
-    footer += "Water Meter Anti-Theft System &copy; " + String(2025) + " | Building " + String(getBuildingNumber());
-    footer += "</div>";
-    footer += "</body></html>";
-    return footer;
+    html += "<div style='margin-top: 2rem; text-align: center; font-size: 0.8rem; color: #ddd;'>";
+    html += "Water Meter Anti-Theft System &copy; " + String(2025) + " | Building " + String(getBuildingNumber());
+    html += "</div>";
+    html += "</body></html>";
 }
 
 /**
- * Get navigation menu HTML
+ * Write navigation menu HTML
  */
-String WebPortal::getNavigationMenu(bool isAdmin)
+void WebPortal::writeNavigationMenu(HtmlStream &html, bool isAdmin)
 {
-    String menu = "<div style='margin-bottom: 1rem; display: flex; justify-content: space-between; align-items: center;'>";
-    menu += "<div>";
-    menu += "<a href='" + String(ROUTE_ROOT) + "' style='margin-right: 1rem; color: white; text-decoration: none;'>Home</a>";
-    menu += "<a href='" + String(ROUTE_DASHBOARD) + "' style='margin-right: 1rem; color: white; text-decoration: none;'>Dashboard</a>";
-    menu += "<a href='" + String(ROUTE_WIFI_CONFIG) + "' style='margin-right: 1rem; color: white; text-decoration: none;'>WiFi Settings</a>";
+    html += "<div style='margin-bottom: 1rem; display: flex; justify-content: space-between; align-items: center;'>";
+    html += "<div>";
+    html += "<a href='" + String(ROUTE_ROOT) + "' style='margin-right: 1rem; color: white; text-decoration: none;'>Home</a>";
+    html += "<a href='" + String(ROUTE_DASHBOARD) + "' style='margin-right: 1rem; color: white; text-decoration: none;'>Dashboard</a>";
+    html += "<a href='" + String(ROUTE_WIFI_CONFIG) + "' style='margin-right: 1rem; color: white; text-decoration: none;'>WiFi Settings</a>";
 
     if (isAdmin)
     {
-        menu += "<a href='" + String(ROUTE_ADMIN_PANEL) + "' style='margin-right: 1rem; color: white; text-decoration: none;'>Admin Panel</a>";
-        menu += "<a href='" + String(ROUTE_ADMIN_LOGOUT) + "' style='color: #ffaa00; text-decoration: none;'>Logout</a>";
+        html += "<a href='" + String(ROUTE_ADMIN_PANEL) + "' style='margin-right: 1rem; color: white; text-decoration: none;'>Admin Panel</a>";
+        html += "<a href='" + String(ROUTE_ADMIN_LOGOUT) + "' style='color: #ffaa00; text-decoration: none;'>Logout</a>";
     }
     else
     {
-        menu += "<a href='" + String(ROUTE_ADMIN_LOGIN) + "' style='color: #ffaa00; text-decoration: none;'>Admin Login</a>";
+        html += "<a href='" + String(ROUTE_ADMIN_LOGIN) + "' style='color: #ffaa00; text-decoration: none;'>Admin Login</a>";
     }
 
-    menu += "</div>";
+    html += "</div>";
 
     // WiFi status indicator
     if (WiFiManager::isConnected())
     {
-        menu += "<div style='background: rgba(75, 181, 67, 0.2); padding: 0.3rem 0.6rem; border-radius: 4px; color: var(--success);'>";
-        menu += "Wi-Fi: Connected | RSSI: " + String(WiFiManager::getRSSI()) + " dBm";
-        menu += "</div>";
+        html += "<div style='background: rgba(75, 181, 67, 0.2); padding: 0.3rem 0.6rem; border-radius: 4px; color: var(--success);'>";
+        html += "Wi-Fi: Connected | RSSI: " + String(WiFiManager::getRSSI()) + " dBm";
+        html += "</div>";
     }
     else
     {
-        menu += "<div style='background: rgba(255, 51, 51, 0.2); padding: 0.3rem 0.6rem; border-radius: 4px; color: var(--danger);'>";
-        menu += "Wi-Fi: Disconnected | <a href='" + String(ROUTE_WIFI_CONFIG) + "' style='color: var(--danger);'>Configure</a>";
-        menu += "</div>";
+        html += "<div style='background: rgba(255, 51, 51, 0.2); padding: 0.3rem 0.6rem; border-radius: 4px; color: var(--danger);'>";
+        html += "Wi-Fi: Disconnected | <a href='" + String(ROUTE_WIFI_CONFIG) + "' style='color: var(--danger);'>Configure</a>";
+        html += "</div>";
     }
 
-    menu += "</div>";
-    return menu;
+    html += "</div>";
 }
 
 /**
- * Get system status widget HTML
+ * Write system status widget HTML
  */
-String WebPortal::getSystemStatusWidget()
+void WebPortal::writeSystemStatusWidget(HtmlStream &html)
 {
-    String widget = "<div class='card'>";
-    widget += "<h2>System Status</h2>";
+    html += "<div class='card'>";
+    html += "<h2>System Status</h2>";
 
     // Alarm status
     String alarmStatusClass = "success";
@@ -767,34 +1276,32 @@ String WebPortal::getSystemStatusWidget()
         break;
     }
 
-    widget += "<div class='status " + alarmStatusClass + "'>" + alarmStatusText + "</div>";
+    html += "<div class='status " + alarmStatusClass + "'>" + alarmStatusText + "</div>";
 
     // Other system info
-    widget += "<div class='device-info'>";
-    widget += "<div><strong>System Uptime:</strong> <span id='systemUptime'>" + String(millis() / 1000) + "s</span></div>";
-    widget += "<div><strong>WiFi SSID:</strong> " + WiFiManager::getCurrentSSID() + "</div>";
-    widget += "<div><strong>Building Number:</strong> " + String(getBuildingNumber()) + "</div>";
+    html += "<div class='device-info'>";
+    html += "<div><strong>System Uptime:</strong> <span id='systemUptime'>" + String(millis() / 1000) + "s</span></div>";
+    html += "<div><strong>WiFi SSID:</strong> " + WiFiManager::getCurrentSSID() + "</div>";
+    html += "<div><strong>Building Number:</strong> " + String(getBuildingNumber()) + "</div>";
 
     // Show alarm details if any alarm is active
     if (alarmSystem.isAlarmActive(RIGHT_SIDE) || alarmSystem.isAlarmActive(LEFT_SIDE))
     {
-        widget += "<div style='margin-top: 1rem;'><strong>Active Alarms:</strong></div>";
+        html += "<div style='margin-top: 1rem;'><strong>Active Alarms:</strong></div>";
 
         if (alarmSystem.isAlarmActive(RIGHT_SIDE))
         {
-            widget += "<div style='color: var(--danger);'>• Right Side Alarm Active</div>";
+            html += "<div style='color: var(--danger);'>• Right Side Alarm Active</div>";
         }
 
         if (alarmSystem.isAlarmActive(LEFT_SIDE))
         {
-            widget += "<div style='color: var(--danger);'>• Left Side Alarm Active</div>";
+            html += "<div style='color: var(--danger);'>• Left Side Alarm Active</div>";
         }
     }
 
-    widget += "</div>";
-    widget += "</div>";
-
-    return widget;
+    html += "</div>";
+    html += "</div>";
 }
 
 /**
@@ -808,150 +1315,13 @@ void WebPortal::handleRoot()
 }
 
 /**
- * Handle dashboard page request
- */
-void WebPortal::handleDashboard()
-{
-    _pageRequests++;
-    updateLastActivity();
-
-    String html = getHTMLHeader("Dashboard", true); // Include auto-refresh
-
-    // Add navigation menu (pass admin status)
-    html += getNavigationMenu(isAdminLoggedIn());
-
-    html += "<div class='container'>";
-    html += "<h1>Water Meter Security System</h1>";
-
-    // System status widget
-    html += getSystemStatusWidget();
-
-    // Sensor Status Table
-    html += buildSensorStatusTable();
-
-    // Wire Cut Status Table
-    html += buildWireCutStatusTable();
-
-    html += "</div>";
-
-    html += "<script>";
-
-    // Utility functions for time formatting
-    html += "function formatTime(seconds) {";
-    html += "  const days = Math.floor(seconds / 86400);";
-    html += "  const hours = Math.floor((seconds % 86400) / 3600);";
-    html += "  const minutes = Math.floor((seconds % 3600) / 60);";
-    html += "  const secs = seconds % 60;";
-    html += "  let result = '';";
-    html += "  if (days > 0) result += days + 'd ';";
-    html += "  if (hours > 0) result += hours + 'h ';";
-    html += "  if (minutes > 0) result += minutes + 'm ';";
-    html += "  result += secs + 's';";
-    html += "  return result;";
-    html += "}";
-
-    // Update function for real-time data
-    html += "function updateData() {";
-    html += "  fetch('/api/status').then(resp => resp.json()).then(data => {";
-    html += "    document.getElementById('systemUptime').textContent = formatTime(data.system.uptime);";
-    html += "  });";
-    html += "}";
-
-    // Set interval for updates
-    html += "setInterval(updateData, 1000);";
-    html += "updateData();";
-
-    html += "</script>";
-
-    html += getHTMLFooter();
-
-    _server.send(200, HTML_CONTENT_TYPE, html);
-}
-
-/**
- * Build HTML for sensor status table
- */
-String WebPortal::buildSensorStatusTable()
-{
-    String html = "<div class='card'>";
-    html += "<h2>Apartments Status</h2>";
-
-    html += "<div style='overflow-x: auto;'>";
-    html += "<table style='width: 100%; border-collapse: collapse;'>";
-    html += "<thead style='background-color: rgba(0,0,0,0.05);'>";
-    html += "<tr>";
-    html += "<th style='padding: 0.5rem; text-align: center;'>Apt #</th>";
-    html += "<th style='padding: 0.5rem; text-align: center;'>Status</th>";
-    html += "<th style='padding: 0.5rem; text-align: center;'>Side</th>";
-    html += "<th style='padding: 0.5rem; text-align: center;'>Box</th>";
-    html += "<th style='padding: 0.5rem; text-align: center;'>Position</th>";
-    html += "<th style='padding: 0.5rem; text-align: center;'>Telegram</th>";
-    html += "</tr>";
-    html += "</thead>";
-    html += "<tbody>";
-
-    for (int i = 0; i < TOTAL_APARTMENTS; i++)
-    {
-        uint8_t aptNumber = i + 1;
-        BuildingSide side = getApartmentSide(aptNumber);
-        BoxPosition box = getApartmentBox(aptNumber);
-        String position = "Unknown";
-
-        // Find the apartment in the APARTMENT_LOCATIONS array to get its position
-        for (int j = 0; j < TOTAL_APARTMENTS; j++)
-        {
-            if (APARTMENT_LOCATIONS[j].side == side &&
-                APARTMENT_LOCATIONS[j].box == box &&
-                getApartmentIndex(aptNumber) == j)
-            {
-                position = APARTMENT_LOCATIONS[j].position;
-                break;
-            }
-        }
-
-        String sideText = (side == RIGHT_SIDE) ? "الجانب الأيمن" : "الجانب الأيسر";
-        String boxText = (box == RIGHT_BOX) ? "الصندوق الأيمن" : "الصندوق الأيسر";
-
-        String statusClass = alarmSystem.isSensorEnabled(aptNumber) ? "success" : "info";
-        String statusText = alarmSystem.isSensorEnabled(aptNumber) ? "Enabled" : "Disabled";
-
-        // If sensor is triggered, show warning
-        if (alarmSystem.isSensorTriggered(aptNumber))
-        {
-            statusClass = "error";
-            statusText = "Triggered";
-        }
-
-        String telegramStatus = telegramHandler.isApartmentConfigured(aptNumber) ? (telegramHandler.isApartmentEnabled(aptNumber) ? "Active" : "Disabled") : "Not Configured";
-
-        String telegramClass = telegramHandler.isApartmentConfigured(aptNumber) ? (telegramHandler.isApartmentEnabled(aptNumber) ? "success" : "info") : "info";
-
-        html += "<tr style='border-bottom: 1px solid #f0f0f0;'>";
-        html += "<td style='padding: 0.5rem; text-align: center;'>" + String(aptNumber) + "</td>";
-        html += "<td style='padding: 0.5rem; text-align: center;'><span class='status " + statusClass + "' style='display: inline-block; padding: 0.2rem 0.5rem;'>" + statusText + "</span></td>";
-        html += "<td style='padding: 0.5rem; text-align: center;'>" + sideText + "</td>";
-        html += "<td style='padding: 0.5rem; text-align: center;'>" + boxText + "</td>";
-        html += "<td style='padding: 0.5rem; text-align: center;'>" + String(position) + "</td>";
-        html += "<td style='padding: 0.5rem; text-align: center;'><span class='status " + telegramClass + "' style='display: inline-block; padding: 0.2rem 0.5rem;'>" + telegramStatus + "</span></td>";
-        html += "</tr>";
-    }
-
-    html += "</tbody>";
-    html += "</table>";
-    html += "</div>";
-    html += "</div>";
-
-    return html;
-}
-
-/**
- * Build HTML for wire cut status table
+ * Write HTML for wire cut status table
  */
-String WebPortal::buildWireCutStatusTable()
+void WebPortal::writeWireCutStatusTable(HtmlStream &html)
 {
     WireCutStatus wireStatus = alarmSystem.getWireCutStatus();
 
-    String html = "<div class='card'>";
+    html += "<div class='card'>";
     html += "<h2>Wire Status</h2>";
 
     html += "<div style='overflow-x: auto;'>";
@@ -1047,16 +1417,14 @@ String WebPortal::buildWireCutStatusTable()
     html += "</table>";
     html += "</div>";
     html += "</div>";
-
-    return html;
 }
 
 /**
- * Build HTML for alarm status table
+ * Write HTML for alarm status table
  */
-String WebPortal::buildAlarmStatusTable()
+void WebPortal::writeAlarmStatusTable(HtmlStream &html)
 {
-    String html = "<div class='card'>";
+    html += "<div class='card'>";
     html += "<h2>Alarm Status</h2>";
 
     // Alarm system status
@@ -1113,8 +1481,6 @@ String WebPortal::buildAlarmStatusTable()
     }
 
     html += "</div>";
-
-    return html;
 }
 
 /**
@@ -1153,8 +1519,10 @@ void WebPortal::handleWiFiConfigPage()
         }
 
         // Show login form
-        String html = getHTMLHeader("WiFi Configuration");
-        html += getNavigationMenu(false);
+        HtmlStream html(_server);
+        html.begin();
+        writeHTMLHeader(html, "WiFi Configuration");
+        writeNavigationMenu(html, false);
 
         html += "<div class='container'>";
         html += "<h1>WiFi Configuration</h1>";
@@ -1178,9 +1546,9 @@ void WebPortal::handleWiFiConfigPage()
         html += "</div>";
 
         html += "</div>";
-        html += getHTMLFooter();
+        writeHTMLFooter(html);
 
-        _server.send(200, HTML_CONTENT_TYPE, html);
+        html.end();
     }
     else
     {
@@ -1191,8 +1559,10 @@ void WebPortal::handleWiFiConfigPage()
             _onWiFiConfigStartCallback();
         }
 
-        String html = getHTMLHeader("WiFi Configuration");
-        html += getNavigationMenu(isAdminLoggedIn());
+        HtmlStream html(_server);
+        html.begin();
+        writeHTMLHeader(html, "WiFi Configuration");
+        writeNavigationMenu(html, isAdminLoggedIn());
 
         html += "<div class='container'>";
         html += "<h1>WiFi Configuration</h1>";
@@ -1226,7 +1596,7 @@ void WebPortal::handleWiFiConfigPage()
         // WiFi network scan
         html += "<div class='card'>";
         html += "<h2>Available Networks</h2>";
-        html += "<button id='scanBtn' onclick='scanNetworks()'>Scan for Networks</button>";
+        html += "<button id='scanBtn' onclick='scanNetworks(true)'>Scan for Networks</button>";
         html += "<div id='networkList' class='network-list'></div>";
         html += "</div>";
 
@@ -1252,11 +1622,14 @@ void WebPortal::handleWiFiConfigPage()
 
         html += "<script>";
         // Scan for networks
-        html += "function scanNetworks() {";
+        // Cached results come back at once, while a scan runs the list is polled until it finishes
+        html += "function scanNetworks(refresh) {";
         html += "  document.getElementById('scanBtn').disabled = true;";
         html += "  document.getElementById('scanBtn').innerText = 'Scanning...';";
-        html += "  document.getElementById('networkList').innerHTML = '<div class=\"status info\">Scanning for networks...</div>';";
-        html += "  fetch('/scan-networks')";
+        html += "  if (document.getElementsByClassName('network-item').length === 0) {";
+        html += "    document.getElementById('networkList').innerHTML = '<div class=\"status info\">Scanning for networks...</div>';";
+        html += "  }";
+        html += "  fetch('/scan-networks' + (refresh ? '?refresh=1' : ''))";
         html += "    .then(function(response) {";
         html += "      if (!response.ok) {";
         html += "        throw new Error('Network scan failed: ' + response.status);";
@@ -1266,9 +1639,11 @@ void WebPortal::handleWiFiConfigPage()
         html += "    .then(function(data) {";
         html += "      console.log('Network scan response:', data);";
         html += "      const networkList = document.getElementById('networkList');";
-        html += "      networkList.innerHTML = '';";
-        html += "      if (!data.networks || data.networks.length === 0) {";
-        html += "        networkList.innerHTML = '<div class=\"status info\">No networks found</div>';";
+        html += "      const hasNetworks = data.networks && data.networks.length > 0;";
+        html += "      if (hasNetworks || !data.scanning) networkList.innerHTML = '';";
+        html += "      if (data.scanning) setTimeout(function() { scanNetworks(false); }, 1000);";
+        html += "      if (!hasNetworks) {";
+        html += "        if (!data.scanning) networkList.innerHTML = '<div class=\"status info\">No networks found</div>';";
         html += "      } else {";
         html += "        data.networks.forEach(function(network) {";
         html += "          const item = document.createElement('div');";
@@ -1282,6 +1657,7 @@ void WebPortal::handleWiFiConfigPage()
         html += "          networkList.appendChild(item);";
         html += "        });";
         html += "      }";
+        html += "      if (data.scanning) return;";
         html += "      document.getElementById('scanBtn').disabled = false;";
         html += "      document.getElementById('scanBtn').innerText = 'Scan for Networks';";
         html += "    })";
@@ -1362,13 +1738,13 @@ void WebPortal::handleWiFiConfigPage()
 
         // Scan networks on page load
         html += "window.onload = function() {";
-        html += "  scanNetworks();";
+        html += "  scanNetworks(false);";
         html += "};";
         html += "</script>";
 
-        html += getHTMLFooter();
+        writeHTMLFooter(html);
 
-        _server.send(200, HTML_CONTENT_TYPE, html);
+        html.end();
     }
 }
 
@@ -1417,8 +1793,10 @@ void WebPortal::handleAdminLogin()
     }
 
     // Show login form
-    String html = getHTMLHeader("Admin Login");
-    html += getNavigationMenu(false);
+    HtmlStream html(_server);
+    html.begin();
+    writeHTMLHeader(html, "Admin Login");
+    writeNavigationMenu(html, false);
 
     html += "<div class='container'>";
     html += "<h1>Admin Login</h1>";
@@ -1442,9 +1820,9 @@ void WebPortal::handleAdminLogin()
     html += "</div>";
 
     html += "</div>";
-    html += getHTMLFooter();
+    writeHTMLFooter(html);
 
-    _server.send(200, HTML_CONTENT_TYPE, html);
+    html.end();
 }
 
 /**
@@ -1460,8 +1838,10 @@ void WebPortal::handleAdminPanel()
     _pageRequests++;
     updateLastActivity();
 
-    String html = getHTMLHeader("Admin Panel");
-    html += getNavigationMenu(true);
+    HtmlStream html(_server);
+    html.begin();
+    writeHTMLHeader(html, "Admin Panel");
+    writeNavigationMenu(html, true);
 
     html += "<div class='container'>";
     html += "<h1>Admin Panel</h1>";
@@ -1499,13 +1879,13 @@ void WebPortal::handleAdminPanel()
     html += "</div>"; // End card
 
     // System status
-    html += getSystemStatusWidget();
+    writeSystemStatusWidget(html);
 
     // Apartment status table
-    html += buildApartmentRowsHTML();
+    writeApartmentRows(html);
 
     // Wire cut status table
-    html += buildWireCutStatusTable();
+    writeWireCutStatusTable(html);
 
     html += "<script>";
     // Function to handle reset wire cut detection
@@ -1515,17 +1895,17 @@ void WebPortal::handleAdminPanel()
     html += "</script>";
 
     html += "</div>"; // End container
-    html += getHTMLFooter();
+    writeHTMLFooter(html);
 
-    _server.send(200, HTML_CONTENT_TYPE, html);
+    html.end();
 }
 
 /**
  * Build apartment rows HTML for admin panel
  */
-String WebPortal::buildApartmentRowsHTML()
+void WebPortal::writeApartmentRows(HtmlStream &html)
 {
-    String html = "<div class='card'>";
+    html += "<div class='card'>";
     html += "<h2>Apartment Configuration</h2>";
 
     html += "<div style='overflow-x: auto;'>";
@@ -1628,8 +2008,6 @@ String WebPortal::buildApartmentRowsHTML()
     html += "</script>";
 
     html += "</div>"; // End card
-
-    return html;
 }
 
 /**
@@ -1657,7 +2035,7 @@ void WebPortal::handleAdminLogout()
  */
 void WebPortal::handleAPIStatus()
 {
-    _server.send(200, JSON_CONTENT_TYPE, getSystemStatusJSON());
+    sendSnapshotJSON(writeSystemStatus);
 }
 
 /**
@@ -1665,7 +2043,7 @@ void WebPortal::handleAPIStatus()
  */
 void WebPortal::handleAPIApartmentStatus()
 {
-    _server.send(200, JSON_CONTENT_TYPE, getApartmentStatusJSON());
+    sendSnapshotJSON(writeApartmentStatus);
 }
 
 /**
@@ -1673,7 +2051,7 @@ void WebPortal::handleAPIApartmentStatus()
  */
 void WebPortal::handleAPIWireStatus()
 {
-    _server.send(200, JSON_CONTENT_TYPE, getWireStatusJSON());
+    sendSnapshotJSON(writeWireStatus);
 }
 
 /**
@@ -1681,53 +2059,256 @@ void WebPortal::handleAPIWireStatus()
  */
 void WebPortal::handleAPIAlarmStatus()
 {
-    _server.send(200, JSON_CONTENT_TYPE, getAlarmStatusJSON());
+    sendSnapshotJSON(writeAlarmStatus);
 }
 
 /**
- * Handle admin Telegram configuration page
+ * Send a {"success":...,"message":...} answer, the message is escaped
  */
-void WebPortal::handleAdminTelegramConfig()
+void WebPortal::sendJSONResult(int code, bool success, const String &message)
 {
-    if (!authenticate(AuthLevel::ADMIN))
-    {
-        return;
-    }
-
-    _pageRequests++;
-    updateLastActivity();
-
-    String html = getHTMLHeader("Telegram Configuration");
-    html += getNavigationMenu(true);
-
-    html += "<div class='container'>";
-    html += "<h1>Telegram Configuration</h1>";
+    HtmlStream out(_server);
+    out.begin(code, JSON_CONTENT_TYPE);
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("success", success);
+    json.field("message", message);
+    json.endObject();
+    out.end();
+}
 
-    html += "<div class='card'>";
-    html += "<h2>Configure Telegram Notifications</h2>";
-    html += "<p>Configure Telegram notifications for each apartment. You'll need the Telegram Bot Token and Chat ID for each apartment.</p>";
+/**
+ * Stream a snapshot to the client as one JSON object filled by a status writer
+ */
+void WebPortal::sendSnapshotJSON(void (*write)(DocumentWriter &, const SystemSnapshot &))
+{
+    SystemSnapshot snapshot;
+    captureSnapshot(snapshot);
 
-    // Telegram configuration form
-    html += "<form id='telegramForm' method='post' action='" + String(ROUTE_ADMIN_SAVE_TELEGRAM) + "'>";
+    HtmlStream out(_server);
+    out.begin(200, JSON_CONTENT_TYPE);
+    JsonWriter json(out);
+    json.beginObject();
+    write(json, snapshot);
+    json.endObject();
+    out.end();
+}
 
-    // Apartment selection
-    html += "<div class='form-group'>";
-    html += "<label for='apartment'>Select Apartment:</label>";
-    html += "<select id='apartment' name='apartment' onchange='loadTelegramConfig()'>";
+/**
+ * Handle API Snapshot request
+ * All status in one capture, as compact JSON or as CBOR when the client asks
+ * for it; ?since=<version> answers 304 while the state is unchanged
+ */
+void WebPortal::handleAPISnapshot()
+{
+    SystemSnapshot snapshot;
+    captureSnapshot(snapshot);
 
-    for (int i = 0; i < TOTAL_APARTMENTS; i++)
+    if (_server.hasArg("since") && strtoul(_server.arg("since").c_str(), nullptr, 10) == snapshot.version)
     {
-        uint8_t aptNumber = i + 1;
-        BuildingSide side = getApartmentSide(aptNumber);
-        BoxPosition box = getApartmentBox(aptNumber);
+        _server.send(304);
+        return;
+    }
 
-        String sideText = (side == RIGHT_SIDE) ? "Right Side" : "Left Side";
-        String boxText = (box == RIGHT_BOX) ? "Right Box" : "Left Box";
+    // ?format= wins over the Accept header
+    String format = _server.arg("format");
+    bool cbor = format == "cbor" || (format != "json" && _server.header("Accept").indexOf(CBOR_CONTENT_TYPE) >= 0);
 
-        html += "<option value='" + String(aptNumber) + "'>Apartment " + String(aptNumber) + " (" + sideText + ", " + boxText + ")</option>";
+    HtmlStream out(_server);
+    _server.sendHeader("Vary", "Accept");
+    _server.sendHeader("Cache-Control", "no-cache");
+    out.begin(200, cbor ? CBOR_CONTENT_TYPE : JSON_CONTENT_TYPE);
+    if (cbor)
+    {
+        CborWriter writer(out);
+        writer.beginObject();
+        writeSnapshot(writer, snapshot);
+        writer.endObject();
+    }
+    else
+    {
+        JsonWriter writer(out);
+        writer.beginObject();
+        writeSnapshot(writer, snapshot);
+        writer.endObject();
     }
+    out.end();
+}
 
-    html += "</select>";
+/**
+ * Handle Metrics request, Prometheus text format
+ */
+void WebPortal::handleMetrics()
+{
+    SystemSnapshot snapshot;
+    captureSnapshot(snapshot);
+
+    HtmlStream out(_server);
+    out.begin(200, METRICS_CONTENT_TYPE);
+    MetricsWriter metrics(out);
+    writeMetrics(metrics, snapshot);
+    out.end();
+}
+
+#ifdef LOOP_PROFILING
+/**
+ * Handle API Profile request
+ * GET reports the loop sections; POST (admin) sets a section's budget
+ * (section=<name>&budget=<us>) or clears the statistics (reset=1)
+ */
+void WebPortal::handleAPIProfile()
+{
+    if (_server.method() == HTTP_POST)
+    {
+        if (!authenticate(AuthLevel::ADMIN))
+        {
+            return;
+        }
+
+        if (_server.hasArg("reset"))
+        {
+            LoopProfiler::reset();
+            sendJSONResult(200, true, "Loop statistics cleared");
+            return;
+        }
+
+        String name = _server.arg("section");
+        for (uint8_t i = 0; i < (uint8_t)LoopSection::COUNT; i++)
+        {
+            if (name == LoopProfiler::getSectionName((LoopSection)i))
+            {
+                bool ok = LoopProfiler::setBudget((LoopSection)i, strtoul(_server.arg("budget").c_str(), nullptr, 10));
+                sendJSONResult(ok ? 200 : 400, ok, ok ? "Budget updated" : "Invalid budget");
+                return;
+            }
+        }
+        sendJSONResult(400, false, "Unknown section");
+        return;
+    }
+
+    // Copied first, the lock is released while the answer is sent
+    LoopSectionStats sections[(uint8_t)LoopSection::COUNT];
+    for (uint8_t i = 0; i < (uint8_t)LoopSection::COUNT; i++)
+    {
+        sections[i] = LoopProfiler::getStats((LoopSection)i);
+    }
+    uint32_t cyclesPerMicro = ESP.getCpuFreqMHz();
+    const char *resetSection = LoopProfiler::getResetSection();
+
+    HtmlStream out(_server);
+    out.begin(200, JSON_CONTENT_TYPE);
+    JsonWriter json(out);
+    json.beginObject();
+    if (resetSection != nullptr)
+    {
+        json.field("watchdogSection", resetSection);
+    }
+    else
+    {
+        json.fieldNull("watchdogSection");
+    }
+    json.beginArray("sections");
+    for (uint8_t i = 0; i < (uint8_t)LoopSection::COUNT; i++)
+    {
+        const LoopSectionStats &stats = sections[i];
+        json.beginObject();
+        json.field("name", LoopProfiler::getSectionName((LoopSection)i));
+        json.field("calls", (unsigned long)stats.calls);
+        json.field("minUs", (unsigned long)(stats.calls > 0 ? stats.minCycles / cyclesPerMicro : 0));
+        json.field("avgUs", (unsigned long)(stats.calls > 0 ? stats.totalCycles / stats.calls / cyclesPerMicro : 0));
+        json.field("maxUs", (unsigned long)(stats.maxCycles / cyclesPerMicro));
+        json.field("budgetUs", (unsigned long)stats.budget);
+        json.field("overBudget", (unsigned long)stats.overBudget);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    out.end();
+}
+#endif
+
+/**
+ * Handle API Events request, the connection is handed over to the event stream
+ */
+void WebPortal::handleAPIEvents()
+{
+    EventStream::addClient(_server.clientSocket());
+}
+
+#ifdef ALERT_LOAD_TEST
+/**
+ * Handle API Test Trigger request
+ * Raises a theft alert through the notifiers without sounding the siren
+ */
+void WebPortal::handleAPITestTrigger()
+{
+    uint8_t apartmentNumber = _server.arg("apartment").toInt();
+    if (apartmentNumber < 1 || apartmentNumber > TOTAL_APARTMENTS)
+    {
+        _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Invalid apartment number\"}");
+        return;
+    }
+
+    EventBus::publish(BusEventType::THEFT, apartmentNumber, getApartmentSide(apartmentNumber),
+                      getApartmentBox(apartmentNumber));
+
+    HtmlStream out(_server);
+    out.begin(200, JSON_CONTENT_TYPE);
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("success", true);
+    json.field("queueSize", telegramHandler.getQueueSize());
+    json.endObject();
+    out.end();
+}
+#endif
+
+/**
+ * Handle admin Telegram configuration page
+ */
+void WebPortal::handleAdminTelegramConfig()
+{
+    if (!authenticate(AuthLevel::ADMIN))
+    {
+        return;
+    }
+
+    _pageRequests++;
+    updateLastActivity();
+
+    HtmlStream html(_server);
+    html.begin();
+    writeHTMLHeader(html, "Telegram Configuration");
+    writeNavigationMenu(html, true);
+
+    html += "<div class='container'>";
+    html += "<h1>Telegram Configuration</h1>";
+
+    html += "<div class='card'>";
+    html += "<h2>Configure Telegram Notifications</h2>";
+    html += "<p>Configure Telegram notifications for each apartment. You'll need the Telegram Bot Token and Chat ID for each apartment.</p>";
+
+    // Telegram configuration form
+    html += "<form id='telegramForm' method='post' action='" + String(ROUTE_ADMIN_SAVE_TELEGRAM) + "'>";
+
+    // Apartment selection
+    html += "<div class='form-group'>";
+    html += "<label for='apartment'>Select Apartment:</label>";
+    html += "<select id='apartment' name='apartment' onchange='loadTelegramConfig()'>";
+
+    for (int i = 0; i < TOTAL_APARTMENTS; i++)
+    {
+        uint8_t aptNumber = i + 1;
+        BuildingSide side = getApartmentSide(aptNumber);
+        BoxPosition box = getApartmentBox(aptNumber);
+
+        String sideText = (side == RIGHT_SIDE) ? "Right Side" : "Left Side";
+        String boxText = (box == RIGHT_BOX) ? "Right Box" : "Left Box";
+
+        html += "<option value='" + String(aptNumber) + "'>Apartment " + String(aptNumber) + " (" + sideText + ", " + boxText + ")</option>";
+    }
+
+    html += "</select>";
     html += "</div>";
 
     // Display current configuration if any
@@ -1765,6 +2346,74 @@ void WebPortal::handleAdminTelegramConfig()
     html += "</form>";
     html += "</div>"; // End card
 
+    // Per-bot health, apartments sharing a token share one entry
+    html += "<div class='card'>";
+    html += "<h2>Bot Health</h2>";
+    html += "<div style='overflow-x: auto;'>";
+    html += "<table style='width: 100%; border-collapse: collapse;'>";
+    html += "<thead style='background-color: rgba(0,0,0,0.05);'>";
+    html += "<tr>";
+    html += "<th style='padding: 0.5rem; text-align: center;'>Bot</th>";
+    html += "<th style='padding: 0.5rem; text-align: center;'>Status</th>";
+    html += "<th style='padding: 0.5rem; text-align: center;'>Apartments</th>";
+    html += "<th style='padding: 0.5rem; text-align: center;'>Sent</th>";
+    html += "<th style='padding: 0.5rem; text-align: center;'>Failed</th>";
+    html += "<th style='padding: 0.5rem; text-align: center;'>Last Delivery</th>";
+    html += "</tr>";
+    html += "</thead>";
+    html += "<tbody>";
+
+    bool hasBots = false;
+    for (uint8_t i = 0; i < MAX_BOT_TOKENS; i++)
+    {
+        BotTokenStats stats;
+        if (!telegramHandler.getBotTokenStats(i, stats))
+        {
+            continue;
+        }
+        hasBots = true;
+
+        String statusClass = "info";
+        String statusText = "Not Used Yet";
+        if (stats.state == BotTokenState::VALID)
+        {
+            statusClass = "success";
+            statusText = "OK";
+        }
+        else if (stats.state == BotTokenState::UNAUTHORIZED)
+        {
+            statusClass = "error";
+            statusText = "Token Rejected";
+        }
+        else if (stats.failed > 0)
+        {
+            statusClass = "error";
+            statusText = "Error " + String(stats.lastErrorCode);
+        }
+
+        String lastDelivery = stats.lastSuccess == 0 ? "Never" : String((millis() - stats.lastSuccess) / 1000) + " s ago";
+
+        html += "<tr style='border-bottom: 1px solid #f0f0f0;'>";
+        html += "<td style='padding: 0.5rem; text-align: center;'>" + telegramHandler.getBotTokenLabel(i) + "</td>";
+        html += "<td style='padding: 0.5rem; text-align: center;'><span class='status " + statusClass + "' style='display: inline-block; padding: 0.2rem 0.5rem;'>" + statusText + "</span></td>";
+        html += "<td style='padding: 0.5rem; text-align: center;'>" + String(stats.apartments) + "</td>";
+        html += "<td style='padding: 0.5rem; text-align: center;'>" + String(stats.sent) + "</td>";
+        html += "<td style='padding: 0.5rem; text-align: center;'>" + String(stats.failed) + "</td>";
+        html += "<td style='padding: 0.5rem; text-align: center;'>" + lastDelivery + "</td>";
+        html += "</tr>";
+    }
+
+    if (!hasBots)
+    {
+        html += "<tr><td colspan='6' style='padding: 0.5rem; text-align: center;'>No bot tokens configured</td></tr>";
+    }
+
+    html += "</tbody>";
+    html += "</table>";
+    html += "</div>";
+    html += "<p style='font-size: 0.9rem; color: #666; margin-top: 0.5rem;'>Apartments using the same bot token share one entry. Up to " + String(MAX_BOT_TOKENS) + " different bots can be used.</p>";
+    html += "</div>"; // End card
+
     // JavaScript for telegram configuration
     html += "<script>";
 
@@ -1834,9 +2483,9 @@ void WebPortal::handleAdminTelegramConfig()
     html += "</script>";
 
     html += "</div>"; // End container
-    html += getHTMLFooter();
+    writeHTMLFooter(html);
 
-    _server.send(200, HTML_CONTENT_TYPE, html);
+    html.end();
 }
 
 /**
@@ -1852,8 +2501,10 @@ void WebPortal::handleAdminBuildingConfig()
     _pageRequests++;
     updateLastActivity();
 
-    String html = getHTMLHeader("Building Configuration");
-    html += getNavigationMenu(true);
+    HtmlStream html(_server);
+    html.begin();
+    writeHTMLHeader(html, "Building Configuration");
+    writeNavigationMenu(html, true);
 
     html += "<div class='container'>";
     html += "<h1>Building Configuration</h1>";
@@ -1883,9 +2534,22 @@ void WebPortal::handleAdminBuildingConfig()
     html += "</div>"; // End card
 
     html += "</div>"; // End container
-    html += getHTMLFooter();
+    writeHTMLFooter(html);
 
-    _server.send(200, HTML_CONTENT_TYPE, html);
+    html.end();
+}
+
+/**
+ * Escape special characters in HTML attribute values
+ */
+String escapeHTML(const String &input) {
+    String output = input;
+    output.replace("&", "&amp;");
+    output.replace("<", "&lt;");
+    output.replace(">", "&gt;");
+    output.replace("'", "&#39;");
+    output.replace("\"", "&quot;");
+    return output;
 }
 
 /**
@@ -1901,8 +2565,10 @@ void WebPortal::handleAdminAdvancedConfig()
     _pageRequests++;
     updateLastActivity();
 
-    String html = getHTMLHeader("Advanced Configuration");
-    html += getNavigationMenu(true);
+    HtmlStream html(_server);
+    html.begin();
+    writeHTMLHeader(html, "Advanced Configuration");
+    writeNavigationMenu(html, true);
 
     html += "<div class='container'>";
     html += "<h1>Advanced Configuration</h1>";
@@ -1942,25 +2608,70 @@ void WebPortal::handleAdminAdvancedConfig()
     html += "<div class='card'>";
     html += "<h2>Alarm Settings</h2>";
 
+    // Stored alarm profiles, the active one is used for every alarm
+    uint8_t profileCount = alarmSystem.getAlarmProfileCount();
+    uint8_t activeProfile = alarmSystem.getActiveAlarmProfile();
+    AlarmProfile profile;
+    html += "<p>Profiles: ";
+    for (uint8_t i = 0; i < profileCount && alarmSystem.getAlarmProfile(i, profile); i++)
+    {
+        html += (i > 0 ? ", " : "") + String(i == activeProfile ? "<strong>" : "") + escapeHTML(profile.name) +
+                String(i == activeProfile ? "</strong> (active)" : "");
+    }
+    html += "</p>";
+    if (alarmSystem.isAlarmTimingPending())
+    {
+        html += "<p>A running siren switches to the new interval at its next cycle.</p>";
+    }
+    alarmSystem.getAlarmProfile(activeProfile, profile);
+
     // Alarm settings form
     html += "<form method='post' action='" + String(ROUTE_ADMIN_SAVE_ADVANCED) + "'>";
 
+    // Profile to edit
+    html += "<div class='form-group'>";
+    html += "<label for='profileIndex'>Profile:</label>";
+    html += "<select id='profileIndex' name='profileIndex' onchange='fillAlarmProfile()'>";
+    for (uint8_t i = 0; i < profileCount; i++)
+    {
+        AlarmProfile option;
+        alarmSystem.getAlarmProfile(i, option);
+        html += "<option value='" + String(i) + "'" + String(i == activeProfile ? " selected" : "") + ">" + escapeHTML(option.name) + "</option>";
+    }
+    if (profileCount < MAX_ALARM_PROFILES)
+    {
+        html += "<option value='" + String(profileCount) + "'>New profile</option>";
+    }
+    html += "</select>";
+    html += "</div>";
+
+    // Profile name
+    html += "<div class='form-group'>";
+    html += "<label for='profileName'>Profile Name:</label>";
+    html += "<input type='text' id='profileName' name='profileName' value='" + escapeHTML(profile.name) + "' maxlength='" + String(ALARM_PROFILE_NAME_SIZE - 1) + "' required>";
+    html += "</div>";
+
     // Alarm duration
     html += "<div class='form-group'>";
     html += "<label for='alarmDuration'>Alarm Duration (milliseconds):</label>";
-    html += "<input type='number' id='alarmDuration' name='alarmDuration' value='20000' min='5000' max='60000' step='1000'>";
+    html += "<input type='number' id='alarmDuration' name='alarmDuration' value='" + String(profile.duration) + "' min='" + String(ALARM_DURATION_MIN) + "' max='" + String(ALARM_DURATION_MAX) + "' step='1000'>";
     html += "</div>";
 
     // Alarm interval
     html += "<div class='form-group'>";
     html += "<label for='alarmInterval'>Alarm Interval (milliseconds):</label>";
-    html += "<input type='number' id='alarmInterval' name='alarmInterval' value='1000' min='500' max='5000' step='100'>";
+    html += "<input type='number' id='alarmInterval' name='alarmInterval' value='" + String(profile.interval) + "' min='" + String(ALARM_INTERVAL_MIN) + "' max='" + String(ALARM_INTERVAL_MAX) + "' step='100'>";
     html += "</div>";
 
     // Sensor settling time
     html += "<div class='form-group'>";
     html += "<label for='sensorSettlingTime'>Sensor Settling Time (milliseconds):</label>";
-    html += "<input type='number' id='sensorSettlingTime' name='sensorSettlingTime' value='100' min='50' max='500' step='10'>";
+    html += "<input type='number' id='sensorSettlingTime' name='sensorSettlingTime' value='" + String(profile.settlingTime) + "' min='" + String(SETTLING_TIME_MIN) + "' max='" + String(SETTLING_TIME_MAX) + "' step='10'>";
+    html += "</div>";
+
+    // Make the saved profile the active one
+    html += "<div class='form-group'>";
+    html += "<label><input type='checkbox' name='activate' value='1'> Use this profile</label>";
     html += "</div>";
 
     // Hidden field for action
@@ -1969,52 +2680,244 @@ void WebPortal::handleAdminAdvancedConfig()
     // Save button
     html += "<button type='submit'>Save Alarm Settings</button>";
     html += "</form>";
+
+    // Fill the fields with the selected profile, a new profile starts from the defaults
+    html += "<script>";
+    // Names are JavaScript strings here, not HTML, so they get JSON escaping
+    html += "var alarmProfiles=[";
+    for (uint8_t i = 0; i < profileCount; i++)
+    {
+        AlarmProfile option;
+        alarmSystem.getAlarmProfile(i, option);
+        html += (i > 0 ? ",[" : "[") + String(option.duration) + "," + String(option.interval) + "," +
+                String(option.settlingTime) + ",\"";
+        JsonWriter::writeEscaped(html, option.name);
+        html += "\"]";
+    }
+    html += "];";
+    html += "function fillAlarmProfile(){";
+    html += "var i=document.getElementById('profileIndex').value;";
+    html += "var p=alarmProfiles[i]||[" + String(ALARM_DURATION) + "," + String(ALARM_INTERVAL) + "," + String(VCC_SETTLING_TIME) + ",''];";
+    html += "document.getElementById('alarmDuration').value=p[0];";
+    html += "document.getElementById('alarmInterval').value=p[1];";
+    html += "document.getElementById('sensorSettlingTime').value=p[2];";
+    html += "document.getElementById('profileName').value=p[3];";
+    html += "}";
+    html += "</script>";
+
+    // Select or delete a stored profile
+    html += "<form method='post' action='" + String(ROUTE_ADMIN_SAVE_ADVANCED) + "'>";
+    html += "<div class='form-group'>";
+    html += "<label for='storedProfile'>Stored Profile:</label>";
+    html += "<select id='storedProfile' name='profileIndex'>";
+    for (uint8_t i = 0; i < profileCount; i++)
+    {
+        AlarmProfile option;
+        alarmSystem.getAlarmProfile(i, option);
+        html += "<option value='" + String(i) + "'" + String(i == activeProfile ? " selected" : "") + ">" + escapeHTML(option.name) + "</option>";
+    }
+    html += "</select>";
+    html += "</div>";
+    html += "<input type='hidden' name='action' value='alarmProfile'>";
+    html += "<button type='submit' name='profileAction' value='activate'>Use Profile</button> ";
+    html += "<button type='submit' name='profileAction' value='delete'>Delete Profile</button>";
+    html += "</form>";
+    html += "</div>"; // End card
+
+    html += "<div class='card'>";
+    html += "<h2>Alert Settings</h2>";
+
+    // Alert settings form
+    html += "<form method='post' action='" + String(ROUTE_ADMIN_SAVE_ADVANCED) + "'>";
+
+    // Alert coalescing window
+    html += "<div class='form-group'>";
+    html += "<label for='coalesceWindow'>Alert Coalescing Window (milliseconds):</label>";
+    html += "<input type='number' id='coalesceWindow' name='coalesceWindow' value='" + String(telegramHandler.getAlertCoalesceWindow()) + "' min='0' max='10000' step='100'>";
+    html += "<p style='font-size: 0.9rem; color: #666; margin-top: 0.5rem;'>Theft and wire cut events within this window are merged into one message per resident. Use 0 to send every event immediately.</p>";
+    html += "</div>";
+
+    // Incident escalation delay
+    html += "<div class='form-group'>";
+    html += "<label for='escalationDelay'>Escalation Delay (seconds):</label>";
+    html += "<input type='number' id='escalationDelay' name='escalationDelay' value='" + String(telegramHandler.getEscalationDelay()) + "' min='0' max='3600' step='10'>";
+    html += "<p style='font-size: 0.9rem; color: #666; margin-top: 0.5rem;'>If the owner doesn't press \"I'm checking\" or \"False alarm\" within this time, residents of the same box are alerted again. Use 0 to disable escalation.</p>";
+    html += "</div>";
+
+    // Bot API server
+    html += "<div class='form-group'>";
+    html += "<label for='apiBaseUrl'>Telegram API Server:</label>";
+    html += "<input type='text' id='apiBaseUrl' name='apiBaseUrl' value='" + escapeHTML(telegramHandler.getApiBaseUrl()) + "' placeholder='" + String(TELEGRAM_API_BASE_URL) + "'>";
+    html += "<p style='font-size: 0.9rem; color: #666; margin-top: 0.5rem;'>Only change this to point at a local test server. Leave empty to use " + String(TELEGRAM_API_BASE_URL) + ".</p>";
+    html += "</div>";
+
+    // Hidden field for action
+    html += "<input type='hidden' name='action' value='alertSettings'>";
+
+    // Save button
+    html += "<button type='submit'>Save Alert Settings</button>";
+    html += "</form>";
+    html += "</div>"; // End card
+
+    html += "<div class='card'>";
+    html += "<h2>Network Settings</h2>";
+
+    // Network settings form
+    html += "<form method='post' action='" + String(ROUTE_ADMIN_SAVE_ADVANCED) + "'>";
+
+    // WiFi scan cache
+    html += "<div class='form-group'>";
+    html += "<label for='scanCacheTTL'>WiFi Scan Cache (seconds):</label>";
+    html += "<input type='number' id='scanCacheTTL' name='scanCacheTTL' value='" + String(WiFiManager::getScanCacheTTL() / 1000) + "' min='0' max='" + String(WIFI_SCAN_CACHE_TTL_MAX / 1000) + "' step='1'>";
+    html += "<p style='font-size: 0.9rem; color: #666; margin-top: 0.5rem;'>Network lists younger than this are shared instead of scanning again. Use 0 to scan on every request.</p>";
+    html += "</div>";
+
+    // Hidden field for action
+    html += "<input type='hidden' name='action' value='networkSettings'>";
+
+    // Save button
+    html += "<button type='submit'>Save Network Settings</button>";
+    html += "</form>";
+    html += "</div>"; // End card
+
+    html += "<div class='card'>";
+    html += "<h2>Notification Backends</h2>";
+    html += "<p>Events are also delivered to a local MQTT broker and an HTTP webhook, which keep working when the internet connection is down.</p>";
+
+    // Notifier settings form
+    html += "<form method='post' action='" + String(ROUTE_ADMIN_SAVE_ADVANCED) + "'>";
+
+    // MQTT
+    String mqttState = mqttNotifier.isEnabled() ? (mqttNotifier.isConnected() ? "Connected" : "Not connected") : "Disabled";
+    html += "<div class='device-info'>";
+    html += "<p><strong>MQTT:</strong> " + mqttState + ", " + String(mqttNotifier.getQueueSize()) + " event(s) queued</p>";
+    html += "<p><strong>Webhook:</strong> " + String(webhookNotifier.isEnabled() ? (webhookNotifier.isConnected() ? "OK" : "Not reachable yet") : "Disabled") + ", " + String(webhookNotifier.getQueueSize()) + " event(s) queued</p>";
+    html += "</div>";
+
+    html += "<div class='form-group'>";
+    html += "<label for='mqttEnabled'>MQTT:</label>";
+    html += "<select id='mqttEnabled' name='mqttEnabled'>";
+    html += "<option value='1'" + String(mqttNotifier.isEnabled() ? " selected" : "") + ">Enabled</option>";
+    html += "<option value='0'" + String(mqttNotifier.isEnabled() ? "" : " selected") + ">Disabled</option>";
+    html += "</select>";
+    html += "</div>";
+
+    html += "<div class='form-group'>";
+    html += "<label for='mqttUri'>Broker URI:</label>";
+    html += "<input type='text' id='mqttUri' name='mqttUri' value='" + escapeHTML(mqttNotifier.getBrokerUri()) + "' placeholder='mqtt://192.168.1.10:1883'>";
+    html += "</div>";
+
+    html += "<div class='form-group'>";
+    html += "<label for='mqttUser'>Username:</label>";
+    html += "<input type='text' id='mqttUser' name='mqttUser' value='" + escapeHTML(mqttNotifier.getUsername()) + "'>";
+    html += "</div>";
+
+    html += "<div class='form-group'>";
+    html += "<label for='mqttPassword'>Password:</label>";
+    html += "<input type='password' id='mqttPassword' name='mqttPassword' placeholder='Leave empty to keep the current password'>";
+    html += "</div>";
+
+    html += "<div class='form-group'>";
+    html += "<label for='mqttTopic'>Base Topic:</label>";
+    html += "<input type='text' id='mqttTopic' name='mqttTopic' value='" + escapeHTML(mqttNotifier.getBaseTopic()) + "'>";
+    html += "<p style='font-size: 0.9rem; color: #666; margin-top: 0.5rem;'>Events are published with QoS 1 to &lt;topic&gt;/event/&lt;name&gt;, the retained &lt;topic&gt;/status shows whether the system is online.</p>";
+    html += "</div>";
+
+    // Webhook
+    html += "<div class='form-group'>";
+    html += "<label for='webhookEnabled'>Webhook:</label>";
+    html += "<select id='webhookEnabled' name='webhookEnabled'>";
+    html += "<option value='1'" + String(webhookNotifier.isEnabled() ? " selected" : "") + ">Enabled</option>";
+    html += "<option value='0'" + String(webhookNotifier.isEnabled() ? "" : " selected") + ">Disabled</option>";
+    html += "</select>";
+    html += "</div>";
+
+    html += "<div class='form-group'>";
+    html += "<label for='webhookUrl'>Webhook URL:</label>";
+    html += "<input type='text' id='webhookUrl' name='webhookUrl' value='" + escapeHTML(webhookNotifier.getUrl()) + "' placeholder='http://192.168.1.20:8080/alerts'>";
+    html += "</div>";
+
+    html += "<div class='form-group'>";
+    html += "<label for='webhookSecret'>Bearer Token:</label>";
+    html += "<input type='password' id='webhookSecret' name='webhookSecret' placeholder='Leave empty to keep the current token'>";
+    html += "</div>";
+
+    // Hidden field for action
+    html += "<input type='hidden' name='action' value='notifierSettings'>";
+
+    // Save button
+    html += "<button type='submit'>Save Notification Backends</button>";
+    html += "</form>";
+    html += "</div>"; // End card
+
+    html += "<div class='card'>";
+    html += "<h2>Configuration Backup</h2>";
+    html += "<p>The snapshot holds every setting, including Telegram tokens and passwords. Keep it private.</p>";
+    html += "<p><a href='" + String(ROUTE_ADMIN_CONFIG_EXPORT) + "'>Download snapshot</a> | ";
+    html += "<a href='" + String(ROUTE_ADMIN_CONFIG_EXPORT) + "?format=json'>View as JSON</a></p>";
+
+    // Snapshot import form, the device restarts once it is applied
+    html += "<form method='post' action='" + String(ROUTE_ADMIN_CONFIG_IMPORT) + "' enctype='multipart/form-data'>";
+    html += "<div class='form-group'>";
+    html += "<label for='snapshot'>Import Snapshot:</label>";
+    html += "<input type='file' id='snapshot' name='snapshot' accept='.wmcfg' required>";
+    html += "</div>";
+    html += "<button type='submit'>Import and Restart</button>";
+    html += "</form>";
     html += "</div>"; // End card
 
     html += "</div>"; // End container
-    html += getHTMLFooter();
+    writeHTMLFooter(html);
 
-    _server.send(200, HTML_CONTENT_TYPE, html);
+    html.end();
 }
 
 /**
  * Handle Scan Networks request
+ * Answers from the scan cache right away; a stale cache or ?refresh starts a
+ * background scan, reported with "scanning" until its results are in
  */
 void WebPortal::handleScanNetworks()
 {
     updateLastActivity();
-    Serial.println("Starting network scan from web interface...");
 
     // Add CORS headers for modern browsers
     _server.sendHeader("Access-Control-Allow-Origin", "*");
     _server.sendHeader("Access-Control-Allow-Methods", "GET");
     _server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
 
-    // Clear existing scan results
-    WiFi.scanDelete();
-
-    // Perform direct WiFi scan - this works on ESP32 while staying connected
-    Serial.println("Scanning for networks...");
-    int networkCount = WiFi.scanNetworks();
-    Serial.printf("Scan completed, found %d networks\n", networkCount);
+    // Concurrent clients share one scan and its results
+    WiFiManager::startScan(_server.hasArg("refresh"));
 
     // Build response JSON
-    String response = "{\"networks\":[";
+    uint32_t age = WiFiManager::getScanAge();
+    HtmlStream out(_server);
+    out.begin(200, JSON_CONTENT_TYPE);
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("scanning", WiFiManager::isScanRunning());
+    if (age == UINT32_MAX)
+    {
+        json.fieldNull("age");
+    }
+    else
+    {
+        json.field("age", (unsigned long)(age / 1000));
+    }
+    json.beginArray("networks");
 
-    for (int i = 0; i < networkCount; i++)
+    uint8_t networkCount = WiFiManager::getScanResultCount();
+    for (uint8_t i = 0; i < networkCount; i++)
     {
-        if (i > 0)
+        ScanResult network;
+        if (!WiFiManager::getScanResult(i, network))
         {
-            response += ",";
+            continue;
         }
 
-        // Get network details and escape special characters in SSID
-        String ssid = WiFi.SSID(i);
-        ssid.replace("\"", "\\\""); // Escape double quotes
-
         // Get encryption type
-        String encryption = "UNKNOWN";
-        switch (WiFi.encryptionType(i))
+        const char *encryption = "UNKNOWN";
+        switch (network.encryption)
         {
         case WIFI_AUTH_OPEN:
             encryption = "OPEN";
@@ -2036,20 +2939,16 @@ void WebPortal::handleScanNetworks()
         }
 
         // Build network object with proper keys
-        response += "{";
-        response += "\"ssid\":\"" + ssid + "\",";
-        response += "\"rssi\":" + String(WiFi.RSSI(i)) + ",";
-        response += "\"encrypted\":\"" + encryption + "\"";
-        response += "}";
-
-        // Small delay to prevent watchdog triggers
-        yield();
+        json.beginObject();
+        json.field("ssid", network.ssid);
+        json.field("rssi", network.rssi);
+        json.field("encrypted", encryption);
+        json.endObject();
     }
 
-    response += "]}";
-
-    Serial.println("Sending scan results to client");
-    _server.send(200, JSON_CONTENT_TYPE, response);
+    json.endArray();
+    json.endObject();
+    out.end();
 }
 
 /**
@@ -2089,7 +2988,15 @@ void WebPortal::handleSaveWiFi()
             Serial.println("WiFi Reconnected successfully!");
 
             // Success - connected with new credentials
-            _server.send(200, JSON_CONTENT_TYPE, "{\"success\":true,\"message\":\"Connected to " + ssid + "\",\"ip\":\"" + WiFiManager::getLocalIP() + "\"}");
+            HtmlStream out(_server);
+            out.begin(200, JSON_CONTENT_TYPE);
+            JsonWriter json(out);
+            json.beginObject();
+            json.field("success", true);
+            json.field("message", "Connected to " + ssid);
+            json.field("ip", WiFiManager::getLocalIP());
+            json.endObject();
+            out.end();
 
             // Call the callback
             if (_onWiFiConfigSaveCallback)
@@ -2111,19 +3018,6 @@ void WebPortal::handleSaveWiFi()
 }
 
 
-/**
- * Escape special characters in JSON strings
- */
-String escapeJSON(const String &input) {
-    String output = input;
-    output.replace("\\", "\\\\");
-    output.replace("\"", "\\\"");
-    output.replace("\n", "\\n");
-    output.replace("\r", "\\r");
-    output.replace("\t", "\\t");
-    return output;
-}
-
 /**
  * Handle getting Telegram configuration for a specific apartment
  */
@@ -2144,30 +3038,31 @@ void WebPortal::handleGetTelegramConfig()
     uint8_t apartmentNumber = _server.arg("apartment").toInt();
 
     // Create JSON response
-    String json = "{";
-    json += "\"success\":true,";
-    json += "\"apartment\":" + String(apartmentNumber) + ",";
-    json += "\"configured\":" + String(telegramHandler.isApartmentConfigured(apartmentNumber) ? "true" : "false") + ",";
+    bool configured = telegramHandler.isApartmentConfigured(apartmentNumber);
+    HtmlStream out(_server);
+    out.begin(200, JSON_CONTENT_TYPE);
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("success", true);
+    json.field("apartment", apartmentNumber);
+    json.field("configured", configured);
 
     // If configured, include token and chatId
-    if (telegramHandler.isApartmentConfigured(apartmentNumber))
+    if (configured)
     {
-        // We need a way to get these values from TelegramHandler
-        // Assuming TelegramHandler class has these methods
-        json += "\"enabled\":" + String(telegramHandler.isApartmentEnabled(apartmentNumber) ? "true" : "false") + ",";
-        json += "\"token\":\"" + String(escapeJSON(telegramHandler.getApartmentToken(apartmentNumber))) + "\",";
-        json += "\"chatId\":\"" + String(escapeJSON(String((telegramHandler.getApartmentChatId(apartmentNumber))))) + "\"";
+        json.field("enabled", telegramHandler.isApartmentEnabled(apartmentNumber));
+        json.field("token", telegramHandler.getApartmentToken(apartmentNumber));
+        json.field("chatId", String(telegramHandler.getApartmentChatId(apartmentNumber)));
     }
     else
     {
-        json += "\"enabled\":false,";
-        json += "\"token\":\"\",";
-        json += "\"chatId\":\"\"";
+        json.field("enabled", false);
+        json.field("token", "");
+        json.field("chatId", "");
     }
 
-    json += "}";
-
-    _server.send(200, JSON_CONTENT_TYPE, json);
+    json.endObject();
+    out.end();
 }
 
 /**
@@ -2255,6 +3150,11 @@ void WebPortal::handleSaveBuildingConfig()
 
     uint8_t buildingNumber = _server.arg("buildingNumber").toInt();
     String wifiConfigPassword = _server.arg("wifiConfigPassword");
+    if (wifiConfigPassword.length() >= WEB_PASSWORD_SIZE)
+    {
+        _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"WiFi config password must be at most 64 characters\"}");
+        return;
+    }
 
     // Save building number
     if (WiFiManager::saveBuildingNumber(buildingNumber))
@@ -2315,6 +3215,11 @@ void WebPortal::handleSaveAdvancedConfig()
             _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"New password must be at least 6 characters\"}");
             return;
         }
+        if (newPassword.length() >= WEB_PASSWORD_SIZE)
+        {
+            _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"New password must be at most 64 characters\"}");
+            return;
+        }
 
         // Set new password
         setAdminPassword(newPassword);
@@ -2330,17 +3235,175 @@ void WebPortal::handleSaveAdvancedConfig()
             return;
         }
 
-        uint32_t alarmDuration = _server.arg("alarmDuration").toInt();
-        uint32_t alarmInterval = _server.arg("alarmInterval").toInt();
-        uint32_t sensorSettlingTime = _server.arg("sensorSettlingTime").toInt();
+        // Without a profile index the active profile is edited
+        long profileIndex = _server.hasArg("profileIndex") ? _server.arg("profileIndex").toInt() : alarmSystem.getActiveAlarmProfile();
+        if (profileIndex < 0 || profileIndex > alarmSystem.getAlarmProfileCount())
+        {
+            _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Invalid alarm profile\"}");
+            return;
+        }
+
+        AlarmProfile profile;
+        memset(&profile, 0, sizeof(profile));
+        if (!alarmSystem.getAlarmProfile(profileIndex, profile))
+        {
+            strncpy(profile.name, "Profile", sizeof(profile.name) - 1);
+        }
+        if (_server.hasArg("profileName"))
+        {
+            String profileName = _server.arg("profileName");
+            profileName.trim();
+            if (profileName.length() >= ALARM_PROFILE_NAME_SIZE)
+            {
+                _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Profile name must be at most " + String(ALARM_PROFILE_NAME_SIZE - 1) + " characters\"}");
+                return;
+            }
+            memset(profile.name, 0, sizeof(profile.name));
+            strncpy(profile.name, profileName.c_str(), sizeof(profile.name) - 1);
+        }
+
+        // Out of range values are rejected by the alarm system, clamp only to the field widths
+        profile.duration = max(0L, _server.arg("alarmDuration").toInt());
+        profile.interval = constrain(_server.arg("alarmInterval").toInt(), 0L, (long)UINT16_MAX);
+        profile.settlingTime = constrain(_server.arg("sensorSettlingTime").toInt(), 0L, (long)UINT16_MAX);
 
-        // Set alarm parameters
-        alarmSystem.setAlarmDuration(alarmDuration);
-        alarmSystem.setAlarmInterval(alarmInterval);
-        alarmSystem.setSensorSettlingTime(sensorSettlingTime);
+        if (!alarmSystem.saveAlarmProfile(profileIndex, profile) ||
+            (_server.arg("activate") == "1" && !alarmSystem.selectAlarmProfile(profileIndex)))
+        {
+            sendJSONResult(400, false, alarmSystem.getLastError());
+            return;
+        }
 
         _server.send(200, JSON_CONTENT_TYPE, "{\"success\":true,\"message\":\"Alarm settings saved successfully\"}");
     }
+    else if (action == "alarmProfile")
+    {
+        // Alarm profile selection or removal
+        String profileAction = _server.arg("profileAction");
+        long profileIndex = _server.arg("profileIndex").toInt();
+        if (!_server.hasArg("profileIndex") || profileIndex < 0 || profileIndex >= alarmSystem.getAlarmProfileCount())
+        {
+            _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Invalid alarm profile\"}");
+            return;
+        }
+
+        bool ok;
+        if (profileAction == "activate")
+        {
+            ok = alarmSystem.selectAlarmProfile(profileIndex);
+        }
+        else if (profileAction == "delete")
+        {
+            ok = alarmSystem.deleteAlarmProfile(profileIndex);
+        }
+        else
+        {
+            _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Unknown profile action\"}");
+            return;
+        }
+
+        if (!ok)
+        {
+            sendJSONResult(400, false, alarmSystem.getLastError());
+            return;
+        }
+
+        _server.send(200, JSON_CONTENT_TYPE, "{\"success\":true,\"message\":\"Alarm profile updated\"}");
+    }
+    else if (action == "alertSettings")
+    {
+        // Alert settings change request
+        if (!_server.hasArg("coalesceWindow"))
+        {
+            _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Coalescing window is required\"}");
+            return;
+        }
+
+        long coalesceWindow = _server.arg("coalesceWindow").toInt();
+        if (coalesceWindow < 0 || coalesceWindow > 10000)
+        {
+            _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Coalescing window must be between 0 and 10000 ms\"}");
+            return;
+        }
+
+        long escalationDelay = telegramHandler.getEscalationDelay();
+        if (_server.hasArg("escalationDelay"))
+        {
+            escalationDelay = _server.arg("escalationDelay").toInt();
+            if (escalationDelay < 0 || escalationDelay > 3600)
+            {
+                _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Escalation delay must be between 0 and 3600 seconds\"}");
+                return;
+            }
+        }
+
+        if (_server.hasArg("apiBaseUrl") && _server.arg("apiBaseUrl") != telegramHandler.getApiBaseUrl() &&
+            !telegramHandler.setApiBaseUrl(_server.arg("apiBaseUrl")))
+        {
+            _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"API server must be http(s)://host[:port]\"}");
+            return;
+        }
+
+        telegramHandler.setAlertCoalesceWindow(coalesceWindow);
+        telegramHandler.setEscalationDelay(escalationDelay);
+
+        _server.send(200, JSON_CONTENT_TYPE, "{\"success\":true,\"message\":\"Alert settings saved successfully\"}");
+    }
+    else if (action == "networkSettings")
+    {
+        // Network settings change request
+        if (!_server.hasArg("scanCacheTTL"))
+        {
+            _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Scan cache time is required\"}");
+            return;
+        }
+
+        long scanCacheTTL = _server.arg("scanCacheTTL").toInt();
+        if (scanCacheTTL < 0 || scanCacheTTL > WIFI_SCAN_CACHE_TTL_MAX / 1000)
+        {
+            _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Scan cache time must be between 0 and " + String(WIFI_SCAN_CACHE_TTL_MAX / 1000) + " seconds\"}");
+            return;
+        }
+
+        if (!WiFiManager::setScanCacheTTL(scanCacheTTL * 1000))
+        {
+            _server.send(500, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Failed to save network settings\"}");
+            return;
+        }
+
+        _server.send(200, JSON_CONTENT_TYPE, "{\"success\":true,\"message\":\"Network settings saved successfully\"}");
+    }
+    else if (action == "notifierSettings")
+    {
+        // Notification backend settings change request
+        // Empty secret fields keep the stored value, the page never shows them
+        String mqttPassword = _server.arg("mqttPassword");
+        if (mqttPassword.length() == 0)
+        {
+            mqttPassword = mqttNotifier.getPassword();
+        }
+
+        String webhookSecret = _server.arg("webhookSecret");
+        if (webhookSecret.length() == 0)
+        {
+            webhookSecret = webhookNotifier.getSecret();
+        }
+
+        if (!mqttNotifier.configure(_server.arg("mqttEnabled") == "1", _server.arg("mqttUri"),
+                                    _server.arg("mqttUser"), mqttPassword, _server.arg("mqttTopic")))
+        {
+            sendJSONResult(400, false, mqttNotifier.getLastError());
+            return;
+        }
+
+        if (!webhookNotifier.configure(_server.arg("webhookEnabled") == "1", _server.arg("webhookUrl"), webhookSecret))
+        {
+            sendJSONResult(400, false, webhookNotifier.getLastError());
+            return;
+        }
+
+        _server.send(200, JSON_CONTENT_TYPE, "{\"success\":true,\"message\":\"Notification backends saved successfully\"}");
+    }
     else
     {
         _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Invalid action\"}");
@@ -2455,6 +3518,118 @@ void WebPortal::handleResetWireCut()
     _server.send(200, JSON_CONTENT_TYPE, "{\"success\":true,\"message\":\"Wire cut detection reset successfully\"}");
 }
 
+/**
+ * Handle configuration snapshot export
+ */
+void WebPortal::handleConfigExport()
+{
+    if (!authenticate(AuthLevel::ADMIN))
+    {
+        return;
+    }
+
+    // Deferred changes belong in the snapshot
+    ConfigStore::flush();
+
+    if (_server.arg("format") == "json")
+    {
+        HtmlStream out(_server);
+        out.begin(200, JSON_CONTENT_TYPE);
+        ConfigStore::writeSnapshotJson(out);
+        out.end();
+        return;
+    }
+
+    // Streamed record by record in chunks
+    _server.sendHeader("Content-Disposition", "attachment; filename=\"water-meter-" + String(WiFiManager::getBuildingNumber()) + ".wmcfg\"");
+    HtmlStream out(_server);
+    out.begin(200, "application/octet-stream");
+    if (!ConfigStore::writeSnapshot(out))
+    {
+        Serial.println("Configuration export failed: " + ConfigStore::getLastError());
+    }
+    out.end();
+}
+
+/**
+ * Collect an uploaded configuration snapshot
+ */
+void WebPortal::handleConfigUpload()
+{
+    HttpUpload &upload = _server.upload();
+
+    if (upload.status == HTTP_UPLOAD_START)
+    {
+        free(_importBuffer);
+        _importBuffer = nullptr;
+        _importSize = 0;
+        _importTooLarge = false;
+
+        // Only buffered for an admin, handleConfigImport() sends the answer
+        if (hasValidSession(AuthLevel::ADMIN))
+        {
+            _importBuffer = (uint8_t *)malloc(CONFIG_SNAPSHOT_MAX_SIZE);
+        }
+    }
+    else if (upload.status == HTTP_UPLOAD_WRITE && _importBuffer != nullptr)
+    {
+        if (_importSize + upload.currentSize > CONFIG_SNAPSHOT_MAX_SIZE)
+        {
+            _importTooLarge = true;
+            return;
+        }
+        memcpy(_importBuffer + _importSize, upload.buf, upload.currentSize);
+        _importSize += upload.currentSize;
+    }
+    else if (upload.status == HTTP_UPLOAD_ABORTED)
+    {
+        free(_importBuffer);
+        _importBuffer = nullptr;
+        _importSize = 0;
+    }
+}
+
+/**
+ * Apply an uploaded configuration snapshot
+ */
+void WebPortal::handleConfigImport()
+{
+    if (!authenticate(AuthLevel::ADMIN))
+    {
+        free(_importBuffer);
+        _importBuffer = nullptr;
+        return;
+    }
+
+    if (_importBuffer == nullptr || _importSize == 0)
+    {
+        _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"No snapshot was uploaded\"}");
+    }
+    else if (_importTooLarge)
+    {
+        _server.send(400, JSON_CONTENT_TYPE, "{\"success\":false,\"message\":\"Snapshot is larger than " + String(CONFIG_SNAPSHOT_MAX_SIZE) + " bytes\"}");
+    }
+    else if (ConfigStore::importSnapshot(_importBuffer, _importSize))
+    {
+        _server.send(200, JSON_CONTENT_TYPE, "{\"success\":true,\"message\":\"Configuration imported, restarting\"}");
+        _restartTime = millis();
+    }
+    else if (ConfigStore::isImportPending())
+    {
+        // Some records were written, restart so every subsystem runs on what is in flash
+        sendJSONResult(500, false, ConfigStore::getLastError() + ", restarting");
+        _restartTime = millis();
+    }
+    else
+    {
+        sendJSONResult(400, false, ConfigStore::getLastError());
+    }
+
+    free(_importBuffer);
+    _importBuffer = nullptr;
+    _importSize = 0;
+}
+
 /**
  * Handle Not Found request
  */
@@ -2488,7 +3663,7 @@ void WebPortal::clearError()
  */
 String WebPortal::getClientIP()
 {
-    return _server.client().remoteIP().toString();
+    return _server.remoteIP();
 }
 
 /**
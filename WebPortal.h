@@ -3,19 +3,37 @@
 #define WEB_PORTAL_H
 
 #include <Arduino.h>
-#include <WebServer.h>
+#include "HttpServer.h"
 #include <ESPmDNS.h>
 #include <Update.h>
 #include "WiFiConfig.h"
 #include "TelegramHandler.h"
+#include "MqttNotifier.h"
+#include "WebhookNotifier.h"
 #include "AlarmSystem.h"
 #include "PinsConfig.h"
 #include "ApartmentGrouping.h"
+#include "HtmlStream.h"
+#include "EventStream.h"
+#include "JsonWriter.h"
+#include "CborWriter.h"
+#include "Metrics.h"
+#include "SystemSnapshot.h"
+
+struct WebAsset;
 
 // Web Portal Configuration
 #define WEB_SERVER_PORT 80
 #define ADMIN_SESSION_TIMEOUT 300000 // 5 minutes timeout for admin session
 #define WIFI_CONFIG_SESSION_TIMEOUT 180000 // 3 minutes timeout for WiFi config session
+#define WEB_PASSWORD_SIZE 65 // 64 characters + terminator
+#define WEB_ASSET_CACHE_VERSIONED "public, max-age=31536000, immutable" // Stylesheets and scripts, URL changes with content
+#define WEB_ASSET_CACHE_PAGE "no-cache" // Static pages, revalidated with their ETag
+#define CONFIG_IMPORT_RESTART_DELAY 1000 // Time to deliver the answer before restarting after an import
+
+// Uncomment to expose ROUTE_API_TEST_TRIGGER for alert load tests (tools/telegram_standin.py)
+// Never enable on an installed system: it raises theft alerts without authentication
+// #define ALERT_LOAD_TEST
 
 // HTML Content Types
 #define HTML_CONTENT_TYPE "text/html"
@@ -33,6 +51,10 @@
 #define ROUTE_API_APARTMENT_STATUS "/api/apartment-status"
 #define ROUTE_API_WIRE_STATUS "/api/wire-status"
 #define ROUTE_API_ALARM_STATUS "/api/alarm-status"
+#define ROUTE_API_EVENTS "/api/events"
+#define ROUTE_API_SNAPSHOT "/api/snapshot"
+#define ROUTE_METRICS "/metrics"
+#define ROUTE_API_PROFILE "/api/profile"
 #define ROUTE_SCAN_NETWORKS "/scan-networks"
 #define ROUTE_SAVE_WIFI "/save-wifi"
 #define ROUTE_ADMIN_TELEGRAM_CONFIG "/admin/telegram"
@@ -42,6 +64,9 @@
 #define ROUTE_ADMIN_APARTMENT_TOGGLE "/admin/toggle-apartment"
 #define ROUTE_ADMIN_ADVANCED_CONFIG "/admin/advanced"
 #define ROUTE_ADMIN_SAVE_ADVANCED "/admin/save-advanced"
+#define ROUTE_ADMIN_CONFIG_EXPORT "/admin/config-export"
+#define ROUTE_ADMIN_CONFIG_IMPORT "/admin/config-import"
+#define ROUTE_API_TEST_TRIGGER "/api/test/trigger"
 
 // Authentication levels
 enum class AuthLevel {
@@ -65,6 +90,10 @@ public:
     static void end();
     static void update();  // Call this from loop()
     
+    // Shared state lock, held by loop() while it updates
+    static void lock();
+    static void unlock();
+    
     // Server status
     static bool isRunning();
     static String getLastError();
@@ -88,14 +117,14 @@ public:
     static void invalidateSession(AuthLevel level);
     static void checkSessionTimeouts();
     
-    // Handle requests directly
-    static void handleClient();
-    
-    // Status reporting
-    static String getSystemStatusJSON();
-    static String getApartmentStatusJSON();
-    static String getWireStatusJSON();
-    static String getAlarmStatusJSON();
+    // Status reporting, the writers only read from the snapshot
+    static void captureSnapshot(SystemSnapshot& snapshot);
+    static void writeSystemStatus(DocumentWriter& json, const SystemSnapshot& snapshot);
+    static void writeApartmentStatus(DocumentWriter& json, const SystemSnapshot& snapshot);
+    static void writeWireStatus(DocumentWriter& json, const SystemSnapshot& snapshot);
+    static void writeAlarmStatus(DocumentWriter& json, const SystemSnapshot& snapshot);
+    static void writeSnapshot(DocumentWriter& json, const SystemSnapshot& snapshot);
+    static void writeMetrics(MetricsWriter& metrics, const SystemSnapshot& snapshot);
     
     // Authentication state
     static bool isAdminLoggedIn();
@@ -110,7 +139,7 @@ public:
 
 private:
     // Server instance
-    static WebServer _server;
+    static HttpServer _server;
     
     // Authentication
     static String _adminPassword;
@@ -129,27 +158,38 @@ private:
     static void (*_onAdminLogoutCallback)();
     static void (*_onWiFiConfigStartCallback)();
     static void (*_onWiFiConfigSaveCallback)();
+
+    // Configuration import
+    static uint8_t* _importBuffer;
+    static size_t _importSize;
+    static bool _importTooLarge;
+    static uint32_t _restartTime;
+
+    // Snapshot versioning, the version moves when the state hash changes
+    static uint32_t _stateVersion;
+    static uint32_t _stateHash;
     
     // Helper methods
     static void setupRoutes();
+    static void serveAsset(const WebAsset& asset);
     static void serveStatic(const String& path, const char* contentType, const char* content);
     static bool authenticate(AuthLevel requiredLevel);
     static String createSession(AuthLevel level);
     static String generateSessionId();
     static bool validateSession(const String& sessionId, AuthLevel level);
     static void updateLastActivity();
+    static bool admitRequest();
     
     // Common HTML components
-    static String getHTMLHeader(const String& title, bool includeRefresh = false);
-    static String getHTMLFooter();
+    static void writeHTMLHeader(HtmlStream& html, const String& title, bool includeRefresh = false);
+    static void writeHTMLFooter(HtmlStream& html);
     static String getCommonCSS();
     static String getCommonJavaScript();
-    static String getNavigationMenu(bool isAdmin);
-    static String getSystemStatusWidget();
+    static void writeNavigationMenu(HtmlStream& html, bool isAdmin);
+    static void writeSystemStatusWidget(HtmlStream& html);
     
     // Main page handlers
     static void handleRoot();
-    static void handleDashboard();
     static void handleWiFiConfigPage();
     static void handleAdminLogin();
     static void handleAdminPanel();
@@ -161,6 +201,17 @@ private:
     static void handleAPIApartmentStatus();
     static void handleAPIWireStatus();
     static void handleAPIAlarmStatus();
+    static void handleAPIEvents();
+    static void handleAPISnapshot();
+    static void handleMetrics();
+#ifdef LOOP_PROFILING
+    static void handleAPIProfile();
+#endif
+    static void sendSnapshotJSON(void (*write)(DocumentWriter& json, const SystemSnapshot& snapshot));
+    static void sendJSONResult(int code, bool success, const String& message);
+#ifdef ALERT_LOAD_TEST
+    static void handleAPITestTrigger();
+#endif
     
     // Admin page handlers
     static void handleAdminTelegramConfig();
@@ -176,6 +227,9 @@ private:
     static void handleSaveAdvancedConfig();
     static void handleToggleApartment();
     static void handleResetWireCut();
+    static void handleConfigExport();
+    static void handleConfigImport();
+    static void handleConfigUpload();
     
     // Error handling
     static void handleNotFound();
@@ -195,15 +249,25 @@ private:
     static String buildTelegramConfigContent();
     static String buildBuildingConfigContent();
     static String buildAdvancedConfigContent();
-    static String buildApartmentRowsHTML();
-    static String buildSensorStatusTable();
-    static String buildWireCutStatusTable();
-    static String buildAlarmStatusTable();
+    static void writeApartmentRows(HtmlStream& html);
+    static void writeWireCutStatusTable(HtmlStream& html);
+    static void writeAlarmStatusTable(HtmlStream& html);
     
     // Session management
     static void saveSessionToPreferences();
     static void loadSessionFromPreferences();
+
+    // Admin and WiFi setup passwords
+    struct StoredConfig {
+        char adminPassword[WEB_PASSWORD_SIZE];
+        char wiFiConfigPassword[WEB_PASSWORD_SIZE];
+    } __attribute__((packed));
+    static const uint16_t CONFIG_VERSION = 1;
+    static void loadConfiguration();
+    static bool saveConfiguration();
+
     static const char* PREFERENCE_NAMESPACE;
+    // Legacy per-field keys, only read to migrate older configurations
     static const char* ADMIN_PASSWORD_KEY;
     static const char* WIFI_CONFIG_PASSWORD_KEY;
 };
@@ -0,0 +1,232 @@
+// WebhookNotifier.cpp
+
+#include "WebhookNotifier.h"
+#include "WiFiConfig.h"
+#include "ConfigStore.h"
+#include <HTTPClient.h>
+#include <Preferences.h>
+
+const char* WebhookNotifier::PREFERENCE_NAMESPACE = "webhook";
+
+WebhookNotifier::WebhookNotifier()
+    : _queue(WEBHOOK_RATE_LIMIT), _lastRequestOk(false), _lastError(""), _enabled(false)
+{
+    _url[0] = '\0';
+    _secret[0] = '\0';
+}
+
+const char* WebhookNotifier::getName() const
+{
+    return "Webhook";
+}
+
+bool WebhookNotifier::begin()
+{
+    loadConfiguration();
+
+    // Receivers on the LAN usually have self-signed certificates
+    _secureClient.setInsecure();
+    return true;
+}
+
+void WebhookNotifier::update()
+{
+    if (!_enabled || !WiFiManager::isConnected())
+        return;
+
+    if (_queue.isReady())
+    {
+        postNext();
+    }
+}
+
+bool WebhookNotifier::notify(const NotifierEvent& event)
+{
+    if (!_queue.push(event))
+    {
+        _lastError = "Event queue is full";
+        return false;
+    }
+    return true;
+}
+
+bool WebhookNotifier::isEnabled() const
+{
+    return _enabled;
+}
+
+bool WebhookNotifier::isConnected() const
+{
+    return _enabled && _lastRequestOk;
+}
+
+String WebhookNotifier::getLastError() const
+{
+    return _lastError;
+}
+
+// Configuration
+bool WebhookNotifier::configure(bool enabled, const String& url, const String& secret)
+{
+    if (enabled && !url.startsWith("http://") && !url.startsWith("https://"))
+    {
+        _lastError = "Webhook URL must start with http:// or https://";
+        return false;
+    }
+
+    if (url.length() >= WEBHOOK_URL_SIZE || secret.length() >= WEBHOOK_SECRET_SIZE)
+    {
+        _lastError = "Webhook setting is too long";
+        return false;
+    }
+
+    _enabled = enabled;
+    strcpy(_url, url.c_str());
+    strcpy(_secret, secret.c_str());
+    _lastRequestOk = false;
+    saveConfiguration();
+
+    if (!_enabled)
+        _queue.clear();
+
+    return true;
+}
+
+String WebhookNotifier::getUrl() const
+{
+    return String(_url);
+}
+
+String WebhookNotifier::getSecret() const
+{
+    return String(_secret);
+}
+
+uint8_t WebhookNotifier::getQueueSize() const
+{
+    return _queue.size();
+}
+
+// Private Helpers
+void WebhookNotifier::loadConfiguration()
+{
+    StoredConfig config;
+    memset(&config, 0, sizeof(config));
+
+    ConfigLoadResult result = ConfigStore::load(PREFERENCE_NAMESPACE, CONFIG_VERSION, &config, sizeof(config));
+    bool migrated = false;
+    if (result == ConfigLoadResult::MISSING)
+    {
+        // Settings from before the configuration blob
+        Preferences prefs;
+        if (prefs.begin(PREFERENCE_NAMESPACE, true))
+        {
+            if (prefs.isKey("url"))
+            {
+                config.enabled = prefs.getBool("enabled", false);
+                prefs.getString("url", config.url, sizeof(config.url));
+                prefs.getString("secret", config.secret, sizeof(config.secret));
+                migrated = true;
+            }
+            prefs.end();
+        }
+    }
+    else if (result == ConfigLoadResult::CORRUPT)
+    {
+        _lastError = ConfigStore::getLastError();
+    }
+
+    if (result != ConfigLoadResult::CORRUPT)
+    {
+        _enabled = config.enabled != 0;
+        memcpy(_url, config.url, sizeof(_url));
+        memcpy(_secret, config.secret, sizeof(_secret));
+        _url[sizeof(_url) - 1] = '\0';
+        _secret[sizeof(_secret) - 1] = '\0';
+    }
+
+    if (_url[0] == '\0')
+        _enabled = false;
+
+    const char* legacyKeys[] = {"enabled", "url", "secret"};
+    ConfigStore::finishLoad(PREFERENCE_NAMESPACE, result, migrated, []()
+                            { return webhookNotifier.saveConfiguration(); }, legacyKeys, 3);
+}
+
+bool WebhookNotifier::saveConfiguration()
+{
+    StoredConfig config;
+    memset(&config, 0, sizeof(config));
+    config.enabled = _enabled;
+    strcpy(config.url, _url);
+    strcpy(config.secret, _secret);
+
+    if (!ConfigStore::save(PREFERENCE_NAMESPACE, CONFIG_VERSION, &config, sizeof(config)))
+    {
+        _lastError = ConfigStore::getLastError();
+        return false;
+    }
+    return true;
+}
+
+void WebhookNotifier::postNext()
+{
+    char payload[NOTIFIER_PAYLOAD_SIZE];
+    size_t length = Notifier::formatEventJson(_queue.front(), payload, sizeof(payload));
+    if (length == 0)
+    {
+        _queue.pop();
+        return;
+    }
+
+    _queue.startAttempt();
+
+    HTTPClient http;
+    bool secure = strncmp(_url, "https://", 8) == 0;
+    if (!http.begin(secure ? (WiFiClient&)_secureClient : _plainClient, String(_url)))
+    {
+        _lastError = "Invalid webhook URL";
+        _lastRequestOk = false;
+        _queue.retry();
+        return;
+    }
+
+    http.setConnectTimeout(WEBHOOK_TIMEOUT);
+    http.setTimeout(WEBHOOK_TIMEOUT);
+    http.addHeader("Content-Type", "application/json");
+    if (_secret[0] != '\0')
+        http.addHeader("Authorization", String("Bearer ") + _secret);
+
+    // The request holds its own copies of the URL and headers, web requests are served while it waits
+    Notifier::releaseStateLock();
+    int statusCode = http.POST((uint8_t*)payload, length);
+    http.end();
+    Notifier::acquireStateLock();
+
+    // Disabling the webhook in the meantime emptied the queue
+    if (_queue.isEmpty())
+        return;
+
+    if (statusCode >= 200 && statusCode < 300)
+    {
+        _lastRequestOk = true;
+        _queue.pop();
+        return;
+    }
+
+    _lastRequestOk = false;
+    if (statusCode < 0)
+        _lastError = "Webhook request failed: " + HTTPClient::errorToString(statusCode);
+    else
+        _lastError = "Webhook returned HTTP " + String(statusCode);
+    Serial.printf("[Webhook] %s\n", _lastError.c_str());
+
+    // The receiver rejected the payload itself, sending it again won't help
+    if (statusCode >= 400 && statusCode < 500 && statusCode != 408 && statusCode != 429)
+        _queue.pop();
+    else
+        _queue.retry();
+}
+
+// Create a global instance
+WebhookNotifier webhookNotifier;
@@ -0,0 +1,67 @@
+// WebhookNotifier.h
+
+#ifndef WEBHOOK_NOTIFIER_H
+#define WEBHOOK_NOTIFIER_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+#include "Notifier.h"
+
+// Webhook Configuration Constants
+#define WEBHOOK_RATE_LIMIT 250          // Min delay between requests (ms)
+#define WEBHOOK_TIMEOUT 2000            // Connect and response timeout, the receiver is on the LAN (ms)
+#define WEBHOOK_URL_SIZE 128
+#define WEBHOOK_SECRET_SIZE 64
+
+// Webhook backend, POSTs every event as a JSON object to a fixed URL
+// An optional secret is sent as "Authorization: Bearer <secret>"
+class WebhookNotifier : public NotifierBackend {
+public:
+    WebhookNotifier();
+
+    const char* getName() const override;
+    bool begin() override;
+    void update() override;
+    bool notify(const NotifierEvent& event) override;
+    bool isEnabled() const override;
+    bool isConnected() const override;
+    String getLastError() const override;
+
+    // Configuration
+    bool configure(bool enabled, const String& url, const String& secret);
+    String getUrl() const;
+    String getSecret() const;
+    uint8_t getQueueSize() const;
+
+private:
+    NotifierQueue _queue;
+    WiFiClient _plainClient;
+    WiFiClientSecure _secureClient;
+    bool _lastRequestOk;
+    String _lastError;
+
+    bool _enabled;
+    char _url[WEBHOOK_URL_SIZE];
+    char _secret[WEBHOOK_SECRET_SIZE];
+
+    // Receiver URL and its bearer token
+    struct StoredConfig {
+        uint8_t enabled;
+        char url[WEBHOOK_URL_SIZE];
+        char secret[WEBHOOK_SECRET_SIZE];
+    } __attribute__((packed));
+
+    // Constants for Storage
+    static const uint16_t CONFIG_VERSION = 1;
+    static const char* PREFERENCE_NAMESPACE;
+
+    void loadConfiguration();
+    bool saveConfiguration();
+    void postNext();
+};
+
+// External declaration for global access
+extern WebhookNotifier webhookNotifier;
+
+#endif // WEBHOOK_NOTIFIER_H
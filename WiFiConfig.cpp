@@ -1,5 +1,7 @@
 // WiFiConfig.cpp
 #include "WiFiConfig.h"
+#include "ConfigStore.h"
+#include "EventBus.h"
 
 // Initialize static member variables
 bool WiFiManager::_isAPMode = false;
@@ -15,6 +17,16 @@ bool WiFiManager::_isInitializing = false;
 bool WiFiManager::_isSystemReady = false;
 bool WiFiManager::_dualModeActive = false;
 uint32_t WiFiManager::_lastReconnectAttempt = 0;
+ScanResult WiFiManager::_scanResults[MAX_SCAN_RESULTS];
+uint8_t WiFiManager::_scanResultCount = 0;
+bool WiFiManager::_scanRunning = false;
+bool WiFiManager::_hasScanResults = false;
+uint32_t WiFiManager::_scanStartTime = 0;
+uint32_t WiFiManager::_scanTime = 0;
+uint32_t WiFiManager::_scanCacheTTL = WIFI_SCAN_CACHE_TTL;
+wifi_mode_t WiFiManager::_scanRestoreMode = WIFI_OFF;
+WiFiManager::StoredConfig WiFiManager::_storedConfig = {};
+WiFiStats WiFiManager::_stats = {};
 
 // Initialize callback function pointers
 void (*WiFiManager::_onConnectCallback)() = nullptr;
@@ -43,8 +55,8 @@ bool WiFiManager::begin()
     WiFi.mode(WIFI_OFF);
     delay(100);
 
-    initializePreferences();
-    _buildingNumber = static_cast<uint8_t>(loadFromPreferences(BUILDING_NUMBER_KEY).toInt());
+    loadConfiguration();
+    _buildingNumber = _storedConfig.buildingNumber;
     WiFi.onEvent(onWiFiEvent);
     WiFi.setSleep(false); // Disable WiFi sleep mode
 
@@ -129,6 +141,9 @@ String WiFiManager::getCurrentSSID()
 
 void WiFiManager::handleConnection()
 {
+    // Collect the results of a background scan
+    updateScan();
+
     if (!_isConnected)
     {
         // Start AP mode if not already active
@@ -146,6 +161,7 @@ void WiFiManager::handleConnection()
             loadWiFiCredentials(ssid, password);
             if (!ssid.isEmpty())
             {
+                _stats.reconnectAttempts++;
                 WiFi.begin(ssid.c_str(), password.c_str());
             }
         }
@@ -182,6 +198,7 @@ bool WiFiManager::reconnect()
     }
 
     Serial.printf("Reconnecting to WiFi: %s (Attempt %d)\n", ssid.c_str(), _connectionAttempts);
+    _stats.reconnectAttempts++;
     
     WiFi.disconnect(true);
     WiFi.mode(WIFI_OFF);
@@ -256,28 +273,23 @@ bool WiFiManager::saveWiFiCredentials(const String &ssid, const String &password
         return false;
     }
 
-    saveToPreferences(SSID_KEY, ssid);
-    saveToPreferences(PASSWORD_KEY, password);
+    strcpy(_storedConfig.ssid, ssid.c_str());
+    strcpy(_storedConfig.password, password.c_str());
 
-    return true;
+    return saveConfiguration();
 }
 
 bool WiFiManager::clearWiFiCredentials()
 {
-    Preferences preferences;
-    preferences.begin(PREFERENCE_NAMESPACE, false);
+    _storedConfig.ssid[0] = '\0';
+    _storedConfig.password[0] = '\0';
 
-    preferences.remove(SSID_KEY);
-    preferences.remove(PASSWORD_KEY);
-
-    preferences.end();
-    return true;
+    return saveConfiguration();
 }
 
 bool WiFiManager::hasStoredCredentials()
 {
-    String ssid = loadFromPreferences(SSID_KEY);
-    return !ssid.isEmpty();
+    return _storedConfig.ssid[0] != '\0';
 }
 
 void WiFiManager::setBuildingNumber(uint8_t number)
@@ -293,46 +305,103 @@ uint8_t WiFiManager::getBuildingNumber()
 bool WiFiManager::saveBuildingNumber(uint8_t number)
 {
     _buildingNumber = number;
-    saveToPreferences(BUILDING_NUMBER_KEY, String(number));
-    return true;
+    _storedConfig.buildingNumber = number;
+    return saveConfiguration();
 }
 
-int16_t WiFiManager::scanNetworks()
+bool WiFiManager::startScan(bool force)
 {
-    // Save current WiFi mode
-    wifi_mode_t currentMode = WiFi.getMode();
-    
-    // Set to AP+STA mode to scan if not already in a mode that allows scanning
-    if (currentMode == WIFI_OFF || currentMode == WIFI_AP) {
+    if (_scanRunning)
+        return true;
+
+    // Fresh results are shared instead of scanning again
+    if (!force && getScanAge() < _scanCacheTTL)
+        return false;
+
+    // Scanning needs the station interface
+    _scanRestoreMode = WiFi.getMode();
+    if (_scanRestoreMode == WIFI_OFF || _scanRestoreMode == WIFI_AP)
+    {
         WiFi.mode(WIFI_AP_STA);
-        delay(100); // Brief delay to ensure mode change applies
     }
-    
+
+    WiFi.scanDelete();
+    if (WiFi.scanNetworks(true, true) == WIFI_SCAN_FAILED) // Async, returns at once; hidden networks included
+    {
+        _lastError = "Failed to start WiFi scan";
+        Serial.println(_lastError);
+        finishScan();
+        return false;
+    }
+
     Serial.println("Starting WiFi scan...");
-    int16_t numNetworks = WiFi.scanNetworks(false, true); // Async = false, show hidden = true
-    Serial.printf("Scan completed, found %d networks\n", numNetworks);
-    
-    // Restore original mode if we changed it
-    if (currentMode != WiFi.getMode() && (currentMode == WIFI_OFF || currentMode == WIFI_AP)) {
-        WiFi.mode(currentMode);
+    _scanRunning = true;
+    _scanStartTime = millis();
+    return true;
+}
+
+bool WiFiManager::isScanRunning()
+{
+    return _scanRunning;
+}
+
+uint32_t WiFiManager::getScanAge()
+{
+    return _hasScanResults ? millis() - _scanTime : UINT32_MAX;
+}
+
+bool WiFiManager::setScanCacheTTL(uint32_t ttl)
+{
+    if (ttl > WIFI_SCAN_CACHE_TTL_MAX)
+    {
+        _lastError = "Scan cache TTL is too long";
+        return false;
     }
-    
-    return numNetworks;
+
+    _scanCacheTTL = ttl;
+    _storedConfig.scanCacheTTL = ttl;
+    return saveConfiguration();
+}
+
+uint32_t WiFiManager::getScanCacheTTL()
+{
+    return _scanCacheTTL;
+}
+
+uint8_t WiFiManager::getScanResultCount()
+{
+    return _scanResultCount;
+}
+
+bool WiFiManager::getScanResult(uint8_t index, ScanResult &result)
+{
+    if (index >= _scanResultCount)
+    {
+        return false;
+    }
+
+    result = _scanResults[index];
+    return true;
 }
 
 String WiFiManager::getScannedSSID(uint8_t index)
 {
-    return WiFi.SSID(index);
+    return index < _scanResultCount ? String(_scanResults[index].ssid) : String();
 }
 
 int32_t WiFiManager::getScannedRSSI(uint8_t index)
 {
-    return WiFi.RSSI(index);
+    return index < _scanResultCount ? _scanResults[index].rssi : 0;
 }
 
 String WiFiManager::getScannedEncryption(uint8_t index)
 {
-    switch (WiFi.encryptionType(index))
+    if (index >= _scanResultCount)
+    {
+        return "Unknown";
+    }
+
+    switch (_scanResults[index].encryption)
     {
     case WIFI_AUTH_OPEN:
         return "Open";
@@ -351,6 +420,61 @@ String WiFiManager::getScannedEncryption(uint8_t index)
     }
 }
 
+void WiFiManager::updateScan()
+{
+    if (!_scanRunning)
+    {
+        return;
+    }
+
+    int16_t count = WiFi.scanComplete();
+    if (count == WIFI_SCAN_RUNNING)
+    {
+        if (millis() - _scanStartTime < WIFI_SCAN_TIMEOUT)
+        {
+            return;
+        }
+        Serial.println("WiFi scan timed out");
+        finishScan();
+        return;
+    }
+
+    if (count < 0)
+    {
+        Serial.println("WiFi scan failed");
+        finishScan();
+        return;
+    }
+
+    // The driver's result list is freed right away, the cache keeps a copy
+    _scanResultCount = min((int16_t)MAX_SCAN_RESULTS, count);
+    for (uint8_t i = 0; i < _scanResultCount; i++)
+    {
+        ScanResult &result = _scanResults[i];
+        memset(result.ssid, 0, sizeof(result.ssid));
+        strncpy(result.ssid, WiFi.SSID(i).c_str(), sizeof(result.ssid) - 1);
+        result.rssi = (int8_t)WiFi.RSSI(i);
+        result.encryption = WiFi.encryptionType(i);
+    }
+    _hasScanResults = true;
+    _scanTime = millis();
+    Serial.printf("Scan completed, found %d networks\n", count);
+
+    finishScan();
+}
+
+void WiFiManager::finishScan()
+{
+    WiFi.scanDelete();
+    _scanRunning = false;
+
+    // Restore original mode if we changed it, unless dual mode was started meanwhile
+    if ((_scanRestoreMode == WIFI_OFF || _scanRestoreMode == WIFI_AP) && WiFi.getMode() == WIFI_AP_STA && !_dualModeActive)
+    {
+        WiFi.mode(_scanRestoreMode);
+    }
+}
+
 void WiFiManager::setOnConnectCallback(void (*callback)())
 {
     _onConnectCallback = callback;
@@ -407,6 +531,21 @@ uint8_t WiFiManager::getConnectionAttempts()
     return _connectionAttempts;
 }
 
+WiFiStats WiFiManager::getStats()
+{
+    return _stats;
+}
+
+uint32_t WiFiManager::getEpochTime()
+{
+    time_t now = time(nullptr);
+    if (now < (time_t)MIN_VALID_EPOCH)
+    {
+        return 0;
+    }
+    return (uint32_t)now;
+}
+
 // Implementation of private methods
 bool WiFiManager::connectToSavedNetwork()
 {
@@ -452,25 +591,8 @@ bool WiFiManager::connectToSavedNetwork()
 
 void WiFiManager::loadWiFiCredentials(String &ssid, String &password)
 {
-    ssid = loadFromPreferences(SSID_KEY);
-    password = loadFromPreferences(PASSWORD_KEY);
-}
-
-void WiFiManager::initializePreferences()
-{
-    Preferences preferences;
-    if (!preferences.begin(PREFERENCE_NAMESPACE, false))
-    {
-        Serial.println("Failed to initialize Preferences");
-    };
-
-    // If first run, initialize with defaults
-    if (!preferences.isKey(BUILDING_NUMBER_KEY))
-    {
-        preferences.putUInt(BUILDING_NUMBER_KEY, 0);
-    }
-
-    preferences.end();
+    ssid = _storedConfig.ssid;
+    password = _storedConfig.password;
 }
 
 void WiFiManager::setupMDNS()
@@ -492,6 +614,13 @@ void WiFiManager::setupMDNS()
     }
 }
 
+void WiFiManager::setupTimeSync()
+{
+    // SNTP keeps resyncing in the background once started
+    configTzTime(NTP_TIMEZONE, NTP_SERVER);
+    Serial.println("NTP time sync started");
+}
+
 void WiFiManager::generateAPSSID()
 {
     // Not needed as we're using building number
@@ -510,6 +639,11 @@ bool WiFiManager::validateCredentials(const String &ssid, const String &password
         return false;
     }
 
+    if (ssid.length() >= WIFI_SSID_SIZE || password.length() >= WIFI_PASSWORD_SIZE)
+    {
+        return false;
+    }
+
     return true;
 }
 
@@ -528,21 +662,71 @@ void WiFiManager::logConnectionDetails()
     Serial.println(WiFi.RSSI());
 }
 
-void WiFiManager::saveToPreferences(const char *key, const String &value)
+void WiFiManager::loadConfiguration()
 {
-    Preferences preferences;
-    preferences.begin(PREFERENCE_NAMESPACE, false);
-    preferences.putString(key, value);
-    preferences.end();
+    memset(&_storedConfig, 0, sizeof(_storedConfig));
+    _storedConfig.scanCacheTTL = WIFI_SCAN_CACHE_TTL;
+
+    ConfigLoadResult result = ConfigStore::load(PREFERENCE_NAMESPACE, CONFIG_VERSION, &_storedConfig, sizeof(_storedConfig));
+    if (result == ConfigLoadResult::CORRUPT)
+    {
+        // Falls back to AP mode, the same as a fresh device
+        memset(&_storedConfig, 0, sizeof(_storedConfig));
+        _storedConfig.scanCacheTTL = WIFI_SCAN_CACHE_TTL;
+    }
+    _storedConfig.ssid[WIFI_SSID_SIZE - 1] = '\0';
+    _storedConfig.password[WIFI_PASSWORD_SIZE - 1] = '\0';
+    if (_storedConfig.scanCacheTTL > WIFI_SCAN_CACHE_TTL_MAX)
+        _storedConfig.scanCacheTTL = WIFI_SCAN_CACHE_TTL;
+    _scanCacheTTL = _storedConfig.scanCacheTTL;
+
+    bool migrated = result == ConfigLoadResult::MISSING && loadLegacyConfig();
+    const char *legacyKeys[] = {SSID_KEY, PASSWORD_KEY, BUILDING_NUMBER_KEY};
+    ConfigStore::finishLoad(PREFERENCE_NAMESPACE, result, migrated, saveConfiguration, legacyKeys, 3);
+}
+
+bool WiFiManager::saveConfiguration()
+{
+    if (!ConfigStore::save(PREFERENCE_NAMESPACE, CONFIG_VERSION, &_storedConfig, sizeof(_storedConfig)))
+    {
+        _lastError = ConfigStore::getLastError();
+        return false;
+    }
+    return true;
 }
 
-String WiFiManager::loadFromPreferences(const char *key)
+bool WiFiManager::loadLegacyConfig()
 {
     Preferences preferences;
-    preferences.begin(PREFERENCE_NAMESPACE, false);
-    String value = preferences.getString(key, "");
+    if (!preferences.begin(PREFERENCE_NAMESPACE, true))
+    {
+        return false;
+    }
+
+    bool found = false;
+    if (preferences.isKey(SSID_KEY))
+    {
+        found = true;
+        preferences.getString(SSID_KEY, _storedConfig.ssid, sizeof(_storedConfig.ssid));
+        preferences.getString(PASSWORD_KEY, _storedConfig.password, sizeof(_storedConfig.password));
+    }
+
+    // First boot stored the building number as an integer, later saves as a string
+    if (preferences.isKey(BUILDING_NUMBER_KEY))
+    {
+        found = true;
+        if (preferences.getType(BUILDING_NUMBER_KEY) == PT_STR)
+        {
+            _storedConfig.buildingNumber = static_cast<uint8_t>(preferences.getString(BUILDING_NUMBER_KEY, "0").toInt());
+        }
+        else
+        {
+            _storedConfig.buildingNumber = static_cast<uint8_t>(preferences.getUInt(BUILDING_NUMBER_KEY, 0));
+        }
+    }
+
     preferences.end();
-    return value;
+    return found;
 }
 
 void WiFiManager::onWiFiEvent(WiFiEvent_t event)
@@ -552,6 +736,12 @@ void WiFiManager::onWiFiEvent(WiFiEvent_t event)
     switch (event)
     {
     case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        // Failed attempts report a disconnect as well, count only lost connections
+        if (isStaConnected)
+        {
+            _stats.disconnects++;
+            EventBus::publish(BusEventType::WIFI_DISCONNECTED);
+        }
         _isConnected = false;
         isStaConnected = false;
         _isReconnecting = false;
@@ -575,12 +765,16 @@ void WiFiManager::onWiFiEvent(WiFiEvent_t event)
     case ARDUINO_EVENT_WIFI_STA_GOT_IP:
         if (isStaConnected) {
             Serial.println("WiFi got IP");
+            _stats.connects++;
             WiFiManager::_isConnected = true;
             WiFiManager::_isSystemReady = true;
             WiFiManager::setupMDNS();
+            WiFiManager::setupTimeSync();
             _isConnected = true;
             _isReconnecting = false;
 
+            // Runs on the WiFi task, subscribers get it from the main loop
+            EventBus::publish(BusEventType::WIFI_CONNECTED);
 
             if (WiFiManager::_onConnectCallback != nullptr)
             {
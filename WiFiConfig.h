@@ -5,7 +5,6 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WebServer.h>
 #include <Preferences.h>
 #include <ESPmDNS.h>
 
@@ -14,6 +13,31 @@
 #define AP_CONFIG_TIMEOUT 180000    // 3 minutes timeout for AP configuration mode
 #define WIFI_RETRY_DELAY 5000       // 5 seconds between connection retries
 #define MAX_WIFI_RETRIES 3          // Maximum number of connection retry attempts
+#define WIFI_SSID_SIZE 33           // 32 characters + terminator
+#define WIFI_PASSWORD_SIZE 65       // 64 characters (WPA2 hex key) + terminator
+#define MAX_SCAN_RESULTS 20         // Networks kept from the last scan, strongest first
+#define WIFI_SCAN_CACHE_TTL 30000   // Default age after which scan results are refreshed (ms)
+#define WIFI_SCAN_CACHE_TTL_MAX 600000 // Longest TTL the portal accepts (ms)
+#define WIFI_SCAN_TIMEOUT 15000     // A scan still running after this is abandoned (ms)
+
+// Time Synchronization Constants
+#define NTP_SERVER "pool.ntp.org"
+#define NTP_TIMEZONE "EET-2EEST,M4.5.5/0,M10.5.4/24"  // Egypt, including daylight saving time
+#define MIN_VALID_EPOCH 1700000000UL // Anything earlier means the clock has not been set yet
+
+// One network from the last scan
+struct ScanResult {
+    char ssid[WIFI_SSID_SIZE];
+    int8_t rssi;
+    wifi_auth_mode_t encryption;
+};
+
+// Connection counters since boot, exported on /metrics
+struct WiFiStats {
+    uint32_t connects;          // Station got an IP address
+    uint32_t disconnects;       // An established connection was lost
+    uint32_t reconnectAttempts;
+};
 
 class WiFiManager {
 public:
@@ -50,7 +74,16 @@ public:
     static bool saveBuildingNumber(uint8_t number);
     
     // Network Scanning
-    static int16_t scanNetworks();
+    // Scans run in the background and are polled from handleConnection(); the
+    // results are cached and shared by every caller until they are older than
+    // the TTL, so asking for networks never blocks.
+    static bool startScan(bool force = false);  // Starts a scan unless one is running or the cache is fresh
+    static bool isScanRunning();
+    static uint32_t getScanAge();                // Age of the cached results (ms), UINT32_MAX before the first scan
+    static bool setScanCacheTTL(uint32_t ttl);   // Stored, up to WIFI_SCAN_CACHE_TTL_MAX
+    static uint32_t getScanCacheTTL();
+    static uint8_t getScanResultCount();
+    static bool getScanResult(uint8_t index, ScanResult& result);
     static String getScannedSSID(uint8_t index);
     static int32_t getScannedRSSI(uint8_t index);
     static String getScannedEncryption(uint8_t index);
@@ -68,6 +101,10 @@ public:
     static uint32_t getUptime();
     static uint32_t getLastConnectTime();
     static uint8_t getConnectionAttempts();
+    static WiFiStats getStats();
+
+    // Time Synchronization
+    static uint32_t getEpochTime();  // Unix time, 0 until the clock has been synced over NTP
 
     static bool isSystemReady();
 
@@ -86,6 +123,17 @@ private:
     static bool _isSystemReady;
     static bool _dualModeActive;  // New variable to track dual mode
     static uint32_t _lastReconnectAttempt;  // Track last reconnection attempt
+    static WiFiStats _stats;
+
+    // Network scan cache
+    static ScanResult _scanResults[MAX_SCAN_RESULTS];
+    static uint8_t _scanResultCount;
+    static bool _scanRunning;
+    static bool _hasScanResults;
+    static uint32_t _scanStartTime;
+    static uint32_t _scanTime;              // When the cached results were taken
+    static uint32_t _scanCacheTTL;
+    static wifi_mode_t _scanRestoreMode;    // Mode to return to when the scan needed STA enabled
 
     // Callback function pointers
     static void (*_onConnectCallback)();
@@ -96,23 +144,37 @@ private:
     // Private methods
     static bool connectToSavedNetwork();
     static void loadWiFiCredentials(String& ssid, String& password);
-    static void initializePreferences();
     static void setupMDNS();
+    static void setupTimeSync();
     static void updateConnectionStatus();
     static void generateAPSSID();
     static bool validateCredentials(const String& ssid, const String& password);
     static void logConnectionDetails();
     static void handleDualMode(); // New private method for dual mode handling
+    static void updateScan();
+    static void finishScan();
     
-    // EEPROM/Preferences helpers
-    static void saveToPreferences(const char* key, const String& value);
-    static String loadFromPreferences(const char* key);
+    // Saved network, building number and scan cache TTL
+    struct StoredConfig {
+        char ssid[WIFI_SSID_SIZE];
+        char password[WIFI_PASSWORD_SIZE];
+        uint8_t buildingNumber;
+        uint32_t scanCacheTTL;    // ms, version 2
+    } __attribute__((packed));
+    static StoredConfig _storedConfig;
+    static const uint16_t CONFIG_VERSION = 2;
+
+    // Preferences helpers
+    static void loadConfiguration();
+    static bool saveConfiguration();
+    static bool loadLegacyConfig();
     
     // Event handlers
     static void onWiFiEvent(WiFiEvent_t event);
     
     // Constants
     static const char* PREFERENCE_NAMESPACE;
+    // Legacy per-field keys, only read to migrate older configurations
     static const char* SSID_KEY;
     static const char* PASSWORD_KEY;
     static const char* BUILDING_NUMBER_KEY;
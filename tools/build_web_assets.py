@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Compress the portal's static files in web/ into WebAssets.h.
+
+Each file is gzipped and embedded as a byte array in flash, together with
+its route, content type and a strong ETag (a hash of the compressed bytes).
+Stylesheets and scripts are versioned: pages reference them as
+{{name}}, which is replaced by "<route>?v=<hash>", so the browser can keep
+them for a year and still picks up a new firmware's copy right away.
+
+Run it after changing anything in web/ and commit the regenerated header:
+
+  python3 tools/build_web_assets.py
+
+Only the Python standard library is used.
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+WEB_DIR = os.path.join(ROOT, "web")
+OUTPUT = os.path.join(ROOT, "WebAssets.h")
+
+# (file in web/, route, content type, versioned)
+# Versioned files come first, pages refer to them through {{file}}
+ASSETS = [
+    ("style.css", "/assets/style.css", "text/css", True),
+    ("dashboard.js", "/assets/dashboard.js", "application/javascript", True),
+    ("dashboard.html", "/dashboard", "text/html", False),
+]
+
+
+def symbol(name):
+    return "WEB_ASSET_" + "".join(c if c.isalnum() else "_" for c in name).upper()
+
+
+def build():
+    urls = {}
+    blobs = []
+    for name, route, content_type, versioned in ASSETS:
+        with open(os.path.join(WEB_DIR, name), "rb") as source:
+            content = source.read()
+        for placeholder, url in urls.items():
+            content = content.replace(("{{%s}}" % placeholder).encode("utf-8"), url.encode("utf-8"))
+        if b"{{" in content:
+            sys.exit("%s: unresolved placeholder, list the file it refers to first" % name)
+
+        # mtime=0 keeps the output identical for identical input
+        data = gzip.compress(content, compresslevel=9, mtime=0)
+        digest = hashlib.sha256(data).hexdigest()[:16]
+        if versioned:
+            urls[name] = "%s?v=%s" % (route, digest)
+        blobs.append((name, route, content_type, versioned, data, digest, len(content)))
+
+    lines = [
+        "// WebAssets.h",
+        "// Generated by tools/build_web_assets.py from web/, do not edit",
+        "",
+        "#ifndef WEB_ASSETS_H",
+        "#define WEB_ASSETS_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "// Static portal file, stored gzip-compressed",
+        "struct WebAsset {",
+        "    const char* route;",
+        "    const char* contentType;",
+        "    const uint8_t* data;",
+        "    size_t length;",
+        "    const char* etag;         // Strong ETag, quoted",
+        "    bool versioned;           // Referenced with ?v=<hash>, safe to cache for a long time",
+        "};",
+        "",
+    ]
+    for name, route, content_type, versioned, data, digest, size in blobs:
+        lines.append("// %s: %d bytes, %d gzipped" % (name, size, len(data)))
+        lines.append("static const uint8_t %s[] PROGMEM = {" % symbol(name))
+        for offset in range(0, len(data), 16):
+            lines.append("    " + ", ".join("0x%02x" % b for b in data[offset:offset + 16]) + ",")
+        lines.append("};")
+        lines.append("")
+
+    for name, url in urls.items():
+        lines.append('#define %s_URL "%s"' % (symbol(name), url))
+    lines.append("")
+
+    lines.append("static const WebAsset WEB_ASSETS[] = {")
+    for name, route, content_type, versioned, data, digest, size in blobs:
+        lines.append('    {"%s", "%s", %s, sizeof(%s), "\\"%s\\"", %s},' % (
+            route, content_type, symbol(name), symbol(name), digest, "true" if versioned else "false"))
+    lines.append("};")
+    lines.append("#define WEB_ASSET_COUNT (sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]))")
+    lines.append("")
+    lines.append("#endif // WEB_ASSETS_H")
+    lines.append("")
+
+    with open(OUTPUT, "w", newline="\r\n") as output:
+        output.write("\n".join(lines))
+
+    for name, route, content_type, versioned, data, digest, size in blobs:
+        print("%-16s %6d -> %5d bytes  %s" % (name, size, len(data), route))
+
+
+if __name__ == "__main__":
+    build()
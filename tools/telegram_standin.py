@@ -0,0 +1,328 @@
+#!/usr/bin/env python3
+"""Local stand-in for the Telegram Bot API, for load and soak testing.
+
+Emulates the three methods the control unit uses (sendMessage, getUpdates and
+answerCallbackQuery) and can inject latency, 429 rate limiting with
+retry_after, 400 "chat not found" and 401 responses.
+
+  serve   run the stand-in until interrupted
+  storm   run the stand-in and fire a theft alert storm at the control unit
+          (needs a firmware built with ALERT_LOAD_TEST, see tools/README.md)
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import json
+import random
+import ssl
+import statistics
+import sys
+import threading
+import time
+import urllib.parse
+import urllib.request
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+class StandinState:
+    """Fault settings and everything the server has seen, shared by all request threads."""
+
+    def __init__(self, args):
+        self.latency = args.latency / 1000.0
+        self.jitter = args.jitter / 1000.0
+        self.rate_limit_prob = args.rate_limit_prob
+        self.retry_after = args.retry_after
+        self.chat_not_found = set(args.chat_not_found)
+        self.unauthorized = set(args.unauthorized)
+        self.poll_hold = args.poll_hold
+        self.verbose = args.verbose
+        self.random = random.Random(args.seed)
+        self.lock = threading.Lock()
+        self.messages = []      # (arrival time, token, chat_id, status)
+        self.polls = 0
+        self.callbacks = 0
+        self.message_id = 0
+
+    def delay(self):
+        with self.lock:
+            extra = self.random.uniform(-self.jitter, self.jitter) if self.jitter else 0.0
+        time.sleep(max(0.0, self.latency + extra))
+
+    def rate_limited(self):
+        with self.lock:
+            return self.random.random() < self.rate_limit_prob
+
+    def record_message(self, token, chat_id, status):
+        with self.lock:
+            self.messages.append((time.monotonic(), token, chat_id, status))
+            self.message_id += 1
+            return self.message_id
+
+    def stats(self):
+        with self.lock:
+            by_status = {}
+            for _, _, _, status in self.messages:
+                by_status[str(status)] = by_status.get(str(status), 0) + 1
+            return {
+                "messages": len(self.messages),
+                "byStatus": by_status,
+                "polls": self.polls,
+                "callbacks": self.callbacks,
+            }
+
+    def reset(self):
+        with self.lock:
+            self.messages = []
+            self.polls = 0
+            self.callbacks = 0
+
+
+def make_handler(state):
+    class StandinHandler(BaseHTTPRequestHandler):
+        # The firmware talks HTTP/1.0 and closes the connection after each response
+        protocol_version = "HTTP/1.0"
+
+        def log_message(self, fmt, *args):
+            if state.verbose:
+                sys.stderr.write("[standin] " + (fmt % args) + "\n")
+
+        def send_json(self, status, body):
+            payload = json.dumps(body).encode("utf-8")
+            self.send_response(status)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(payload)))
+            self.end_headers()
+            self.wfile.write(payload)
+
+        def send_error_json(self, status, description, parameters=None):
+            body = {"ok": False, "error_code": status, "description": description}
+            if parameters:
+                body["parameters"] = parameters
+            self.send_json(status, body)
+
+        def route(self):
+            # /bot<token>/<method>?<query>
+            parsed = urllib.parse.urlsplit(self.path)
+            if parsed.path == "/_stats":
+                return None, "_stats", {}
+            if parsed.path == "/_reset":
+                return None, "_reset", {}
+            parts = parsed.path.strip("/").split("/")
+            if len(parts) != 2 or not parts[0].startswith("bot"):
+                return None, None, {}
+            query = dict(urllib.parse.parse_qsl(parsed.query))
+            return parts[0][3:], parts[1], query
+
+        def do_GET(self):
+            token, method, query = self.route()
+            if method == "_stats":
+                self.send_json(200, state.stats())
+            elif method == "_reset":
+                state.reset()
+                self.send_json(200, {"ok": True})
+            elif method == "getUpdates":
+                self.get_updates(token, query)
+            elif method == "answerCallbackQuery":
+                with state.lock:
+                    state.callbacks += 1
+                self.send_json(200, {"ok": True, "result": True})
+            else:
+                self.send_error_json(404, "Not Found")
+
+        def do_POST(self):
+            token, method, _ = self.route()
+            length = int(self.headers.get("Content-Length", "0"))
+            body = self.rfile.read(length) if length else b""
+            if method == "sendMessage":
+                self.send_message(token, body)
+            else:
+                self.send_error_json(404, "Not Found")
+
+        def send_message(self, token, body):
+            state.delay()
+            try:
+                request = json.loads(body.decode("utf-8"))
+                chat_id = int(request["chat_id"])
+                text = request["text"]
+            except (ValueError, KeyError, UnicodeDecodeError):
+                state.record_message(token, None, 400)
+                self.send_error_json(400, "Bad Request: can't parse request JSON")
+                return
+
+            if token in state.unauthorized:
+                state.record_message(token, chat_id, 401)
+                self.send_error_json(401, "Unauthorized")
+            elif chat_id in state.chat_not_found:
+                state.record_message(token, chat_id, 400)
+                self.send_error_json(400, "Bad Request: chat not found")
+            elif state.rate_limited():
+                state.record_message(token, chat_id, 429)
+                self.send_error_json(429, "Too Many Requests: retry after %d" % state.retry_after,
+                                     {"retry_after": state.retry_after})
+            else:
+                message_id = state.record_message(token, chat_id, 200)
+                self.send_json(200, {"ok": True, "result": {
+                    "message_id": message_id,
+                    "chat": {"id": chat_id},
+                    "date": int(time.time()),
+                    "text": text,
+                }})
+
+        def get_updates(self, token, query):
+            with state.lock:
+                state.polls += 1
+            if token in state.unauthorized:
+                self.send_error_json(401, "Unauthorized")
+                return
+            # No updates are ever pending; hold the long poll like Telegram does
+            timeout = min(int(query.get("timeout", "0")), state.poll_hold)
+            time.sleep(max(0, timeout))
+            self.send_json(200, {"ok": True, "result": []})
+
+    return StandinHandler
+
+
+def start_server(args, state):
+    server = ThreadingHTTPServer((args.bind, args.port), make_handler(state))
+    server.daemon_threads = True
+    scheme = "http"
+    if args.tls_cert:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(args.tls_cert, args.tls_key)
+        server.socket = context.wrap_socket(server.socket, server_side=True)
+        scheme = "https"
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+    print("Stand-in listening on %s://%s:%d" % (scheme, args.bind, args.port))
+    return server
+
+
+def device_request(device, path, data=None, timeout=5):
+    url = device.rstrip("/") + path
+    body = urllib.parse.urlencode(data).encode("ascii") if data is not None else None
+    with urllib.request.urlopen(url, data=body, timeout=timeout) as response:
+        return json.loads(response.read().decode("utf-8"))
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, int(round(fraction * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def run_storm(args, state):
+    apartments = list(range(1, args.apartments + 1))
+    triggers = []           # (trigger time, apartment)
+    high_water = 0
+    rng = random.Random(args.seed)
+
+    status = device_request(args.device, "/api/status")
+    print("Device Bot API server: %s" % status["telegram"]["apiBaseUrl"])
+    state.reset()
+
+    start = time.monotonic()
+    for round_number in range(args.rounds):
+        order = apartments[:]
+        rng.shuffle(order)
+        for apartment in order[:args.triggers_per_round]:
+            triggers.append((time.monotonic(), apartment))
+            result = device_request(args.device, "/api/test/trigger", {"apartment": apartment})
+            if not result.get("success"):
+                print("Trigger for apartment %d failed: %s" % (apartment, result))
+            time.sleep(args.trigger_interval / 1000.0)
+        print("Round %d/%d sent" % (round_number + 1, args.rounds))
+        time.sleep(args.round_interval / 1000.0)
+
+    # Wait for the device queue to drain and the stand-in to go quiet
+    deadline = time.monotonic() + args.drain_timeout
+    while time.monotonic() < deadline:
+        telegram = device_request(args.device, "/api/status")["telegram"]
+        high_water = max(high_water, telegram["queueHighWater"])
+        with state.lock:
+            last_arrival = state.messages[-1][0] if state.messages else start
+        if telegram["queueSize"] == 0 and time.monotonic() - last_arrival > args.settle:
+            break
+        time.sleep(0.5)
+    else:
+        print("Warning: queue did not drain within %d s" % args.drain_timeout)
+
+    with state.lock:
+        messages = list(state.messages)
+
+    delivered = [m for m in messages if m[3] == 200]
+    stats = state.stats()
+    print()
+    print("Triggers sent:        %d" % len(triggers))
+    print("Requests received:    %d %s" % (stats["messages"], stats["byStatus"]))
+    if len(delivered) > 1:
+        window = delivered[-1][0] - delivered[0][0]
+        print("Throughput:           %.2f msg/s over %.1f s" % ((len(delivered) - 1) / window if window else 0, window))
+    print("Queue high-water:     %d (since device boot)" % high_water)
+
+    # End-to-end latency: trigger until the owner's chat receives its first message afterwards
+    latencies = []
+    for trigger_time, apartment in triggers:
+        chat_id = args.chat_base + apartment
+        for arrival, _, chat, _ in delivered:
+            if chat == chat_id and arrival >= trigger_time:
+                latencies.append((arrival - trigger_time) * 1000.0)
+                break
+    if latencies:
+        print("Owner latency (ms):   min %.0f  median %.0f  p95 %.0f  max %.0f  (%d of %d triggers)" % (
+            min(latencies), statistics.median(latencies), percentile(latencies, 0.95), max(latencies),
+            len(latencies), len(triggers)))
+    else:
+        print("Owner latency:        no owner message matched; check --chat-base")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("command", choices=["serve", "storm"])
+    parser.add_argument("--bind", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8081)
+    parser.add_argument("--tls-cert", help="serve HTTPS with this certificate (PEM)")
+    parser.add_argument("--tls-key", help="private key for --tls-cert (PEM)")
+    parser.add_argument("--latency", type=float, default=150, help="sendMessage latency in ms")
+    parser.add_argument("--jitter", type=float, default=50, help="latency jitter in ms")
+    parser.add_argument("--rate-limit-prob", type=float, default=0.0, help="probability of a 429 answer")
+    parser.add_argument("--retry-after", type=int, default=3, help="retry_after sent with 429 answers")
+    parser.add_argument("--chat-not-found", type=int, nargs="*", default=[], help="chat IDs answered with 400")
+    parser.add_argument("--unauthorized", nargs="*", default=[], help="bot tokens answered with 401")
+    parser.add_argument("--poll-hold", type=int, default=25, help="longest getUpdates hold in seconds")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--verbose", action="store_true")
+
+    storm = parser.add_argument_group("storm")
+    storm.add_argument("--device", default="http://water-meter.local", help="control unit base URL")
+    storm.add_argument("--apartments", type=int, default=24)
+    storm.add_argument("--rounds", type=int, default=3)
+    storm.add_argument("--triggers-per-round", type=int, default=24)
+    storm.add_argument("--trigger-interval", type=float, default=200, help="ms between triggers")
+    storm.add_argument("--round-interval", type=float, default=5000, help="ms between rounds")
+    storm.add_argument("--chat-base", type=int, default=1000, help="apartment N uses chat ID chat-base + N")
+    storm.add_argument("--settle", type=float, default=5, help="quiet seconds before the run is over")
+    storm.add_argument("--drain-timeout", type=int, default=600)
+    args = parser.parse_args()
+
+    if bool(args.tls_cert) != bool(args.tls_key):
+        parser.error("--tls-cert and --tls-key go together")
+
+    state = StandinState(args)
+    server = start_server(args, state)
+    try:
+        if args.command == "storm":
+            run_storm(args, state)
+        else:
+            while True:
+                time.sleep(10)
+                if args.verbose:
+                    print(state.stats())
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.shutdown()
+
+
+if __name__ == "__main__":
+    main()
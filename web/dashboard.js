@@ -0,0 +1,238 @@
+// Dashboard: the page itself is static, state comes from /api/snapshot once
+// and then from the /api/events stream, which only sends what changed
+var FULL_REFRESH = 60000;      // Settings shown in the tables (enabled, Telegram) and Wi-Fi
+var POLL_REFRESH = 5000;       // Fallback when the event stream is unavailable
+
+var WIRE_LOCATIONS = [
+  ['rightSideRightBox', 'Right Side - Right Box'],
+  ['rightSideLeftBox', 'Right Side - Left Box'],
+  ['leftSideRightBox', 'Left Side - Right Box'],
+  ['leftSideLeftBox', 'Left Side - Left Box'],
+  ['rightSideDistribution', 'Right Side - Distribution'],
+  ['leftSideDistribution', 'Left Side - Distribution']
+];
+
+var ALARM_STATES = [
+  ['success', 'Normal'],
+  ['error', 'Theft Detected'],
+  ['error', 'Wire Cut Detected']
+];
+
+var state = {
+  status: 0,
+  alarm: { right: false, left: false },
+  uptime: 0,
+  uptimeAt: Date.now(),
+  queue: 0,
+  version: 0,
+  system: null,
+  apartments: [],
+  wires: {}
+};
+var pollTimer = null;
+
+function $(id) {
+  return document.getElementById(id);
+}
+
+function text(value) {
+  var span = document.createElement('span');
+  span.textContent = value;
+  return span.innerHTML;
+}
+
+function pill(cls, label) {
+  return "<span class='status pill " + cls + "'>" + label + '</span>';
+}
+
+function formatTime(seconds) {
+  var days = Math.floor(seconds / 86400);
+  var hours = Math.floor((seconds % 86400) / 3600);
+  var minutes = Math.floor((seconds % 3600) / 60);
+  var result = '';
+  if (days > 0) result += days + 'd ';
+  if (hours > 0) result += hours + 'h ';
+  if (minutes > 0) result += minutes + 'm ';
+  return result + (seconds % 60) + 's';
+}
+
+function getJSON(url) {
+  return fetch(url, { cache: 'no-store' }).then(function (resp) {
+    if (!resp.ok) throw new Error(url + ': ' + resp.status);
+    return resp.json();
+  });
+}
+
+function setUptime(seconds) {
+  state.uptime = seconds;
+  state.uptimeAt = Date.now();
+}
+
+// Rendering
+
+function renderUptime() {
+  $('systemUptime').textContent = formatTime(state.uptime + Math.floor((Date.now() - state.uptimeAt) / 1000));
+}
+
+function renderStatus() {
+  var alarmState = ALARM_STATES[state.status] || ALARM_STATES[0];
+  $('alarmStatus').className = 'status ' + alarmState[0];
+  $('alarmStatus').textContent = alarmState[1];
+  $('alertQueue').textContent = state.queue;
+
+  var alarms = '';
+  if (state.alarm.right) alarms += "<div class='alarm-line'>&bull; Right Side Alarm Active</div>";
+  if (state.alarm.left) alarms += "<div class='alarm-line'>&bull; Left Side Alarm Active</div>";
+  $('activeAlarms').innerHTML = alarms ? "<div style='margin-top: 1rem;'><strong>Active Alarms:</strong></div>" + alarms : '';
+  renderUptime();
+}
+
+function renderSystem(data) {
+  $('wifiSsid').textContent = data.wifi.ssid;
+  $('buildingNumber').textContent = data.system.buildingNumber;
+
+  var links = "<a href='/'>Home</a><a href='/dashboard'>Dashboard</a><a href='/wifi-config'>WiFi Settings</a>";
+  links += data.system.adminSession
+    ? "<a href='/admin-panel'>Admin Panel</a><a class='login' href='/admin-logout'>Logout</a>"
+    : "<a class='login' href='/admin'>Admin Login</a>";
+  $('navLinks').innerHTML = links;
+
+  var wifi = $('wifiState');
+  if (data.wifi.connected) {
+    wifi.className = 'wifi-state success';
+    wifi.textContent = 'Wi-Fi: Connected | RSSI: ' + data.wifi.rssi + ' dBm';
+  } else {
+    wifi.className = 'wifi-state error';
+    wifi.innerHTML = "Wi-Fi: Disconnected | <a href='/wifi-config'>Configure</a>";
+  }
+
+  $('footer').textContent = 'Water Meter Anti-Theft System © 2025 | Building ' + data.system.buildingNumber;
+}
+
+function renderApartments() {
+  var rows = '';
+  state.apartments.forEach(function (apt) {
+    var status = apt.triggered ? pill('error', 'Triggered') : apt.enabled ? pill('success', 'Enabled') : pill('info', 'Disabled');
+    var telegram = !apt.telegramConfigured ? pill('info', 'Not Configured') : apt.telegramEnabled ? pill('success', 'Active') : pill('info', 'Disabled');
+    rows += '<tr><td>' + apt.number + '</td><td>' + status + '</td>';
+    rows += '<td>' + (apt.side === 'right' ? 'الجانب الأيمن' : 'الجانب الأيسر') + '</td>';
+    rows += '<td>' + (apt.box === 'right' ? 'الصندوق الأيمن' : 'الصندوق الأيسر') + '</td>';
+    rows += '<td>' + text(apt.position) + '</td><td>' + telegram + '</td></tr>';
+  });
+  $('apartmentRows').innerHTML = rows;
+}
+
+function renderWires() {
+  var rows = '';
+  WIRE_LOCATIONS.forEach(function (location) {
+    var wire = state.wires[location[0]];
+    if (!wire) return;
+    rows += "<tr><td class='label'>" + location[1] + '</td>';
+    rows += '<td>' + (wire.cut ? pill('error', 'Cut Detected') : pill('success', 'OK')) + '</td>';
+    rows += '<td>' + (wire.enabled ? pill('success', 'Enabled') : pill('info', 'Disabled')) + '</td></tr>';
+  });
+  $('wireRows').innerHTML = rows;
+}
+
+// Full state from the snapshot API, one request for everything
+
+function loadAll() {
+  // A 304 (nothing changed since our version) lands in the catch
+  var url = '/api/snapshot' + (state.version ? '?since=' + state.version : '');
+  getJSON(url).then(function (data) {
+    var status = data.status;
+    state.version = data.version;
+    state.status = data.alarm.status;
+    state.alarm.right = data.alarm.rightSideActive;
+    state.alarm.left = data.alarm.leftSideActive;
+    state.queue = status.telegram.queueSize;
+    state.apartments = data.apartments;
+    state.wires = data.wires;
+    setUptime(status.system.uptime);
+    renderSystem(status);
+    renderStatus();
+    renderApartments();
+    renderWires();
+  }).catch(function () {});
+}
+
+// Deltas from the event stream
+
+function findApartment(number) {
+  for (var i = 0; i < state.apartments.length; i++) {
+    if (state.apartments[i].number === number) return state.apartments[i];
+  }
+  return null;
+}
+
+function onHello(data) {
+  state.status = data.status;
+  state.alarm = data.alarm;
+  state.queue = data.queue;
+  setUptime(data.uptime);
+  state.apartments.forEach(function (apt) {
+    apt.triggered = data.triggered.indexOf(apt.number) !== -1;
+  });
+  Object.keys(data.wires).forEach(function (name) {
+    if (state.wires[name]) state.wires[name].cut = data.wires[name];
+  });
+  renderStatus();
+  renderApartments();
+  renderWires();
+}
+
+function listen() {
+  if (!window.EventSource) {
+    pollTimer = setInterval(loadAll, POLL_REFRESH);
+    return;
+  }
+
+  var source = new EventSource('/api/events');
+  var handlers = {
+    hello: onHello,
+    sensor: function (data) {
+      var apt = findApartment(data.apt);
+      if (apt) apt.triggered = data.triggered;
+      renderApartments();
+    },
+    alarm: function (data) {
+      state.alarm[data.side] = data.active;
+      renderStatus();
+    },
+    wire: function (data) {
+      if (state.wires[data.wire]) state.wires[data.wire].cut = data.cut;
+      renderWires();
+    },
+    status: function (data) {
+      state.status = data.status;
+      renderStatus();
+    },
+    queue: function (data) {
+      state.queue = data.size;
+      renderStatus();
+    },
+    heartbeat: function (data) {
+      setUptime(data.uptime);
+    }
+  };
+
+  Object.keys(handlers).forEach(function (name) {
+    source.addEventListener(name, function (event) {
+      handlers[name](JSON.parse(event.data));
+    });
+  });
+
+  // The browser reconnects by itself, polling covers the time in between
+  source.onopen = function () {
+    if (pollTimer) clearInterval(pollTimer);
+    pollTimer = null;
+  };
+  source.onerror = function () {
+    if (!pollTimer) pollTimer = setInterval(loadAll, POLL_REFRESH);
+  };
+}
+
+loadAll();
+listen();
+setInterval(renderUptime, 1000);
+setInterval(loadAll, FULL_REFRESH);